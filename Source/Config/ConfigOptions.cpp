@@ -32,6 +32,10 @@ u32		gSpeedSyncEnabled			= 0;		// Enable to limit frame rate.
 bool	gDynarecEnabled				= true;		// Use dynamic recompilation
 bool	gDynarecLoopOptimisation	= false;	// Enable the dynarec loop optmisation
 bool	gDynarecDoublesOptimisation	= false;	// Enable the dynarec Doubles optmisation
+bool	gIdleLoopSkipEnabled		= true;		// Skip to the next event from detected idle loops
+bool	gDynarecConstantPropagation	= true;		// Specialise dynarec code on register values known at compile time
+u32		gDynarecMaxTraceLength		= 1500;		// Most ops recorded into a single fragment
+u32		gDynarecMaxInlineLength		= 48;		// Most ops followed into a leaf function called from a trace (0 to disable)
 bool	gOSHooksEnabled				= true;		// Apply os-hooks
 u32		gCheckTextureHashFrequency	= 0;		// How often to check textures for updates (every N frames, 0 to disable)
 bool	gDoubleDisplayEnabled		= true;		// Workaround for games that have shaking issues
@@ -42,6 +46,9 @@ bool	gVideoRateMatch				= false;	// Matches VI rate with framerate
 bool	gFogEnabled					= false;	// Enable fog
 bool    gMemoryAccessOptimisation   = false;    // Enable the memory access optmisation
 bool	gCheatsEnabled				= false;	// Enable cheat codes
+u32		gRewindBufferSize			= 32 * 1024 * 1024;	// Bytes of snapshots kept for rewinding (0 to disable)
+u32		gRewindInterval				= 6;		// Vertical blanks between snapshots
+u32		gRewindKeyframeInterval		= 30;		// Snapshots between full snapshots
 u32		gControllerIndex			= 0;		// Which controller config to set
 
 DaedalusConfig g_DaedalusConfig;
@@ -39,6 +39,10 @@ extern DaedalusConfig	g_DaedalusConfig;
 extern bool gDynarecEnabled;			// Use dynamic recompilation
 extern bool gDynarecLoopOptimisation;	// Enable the dynarec loop optmisation
 extern bool gDynarecDoublesOptimisation;	// Enable the dynarec loop optmisation
+extern bool gIdleLoopSkipEnabled;		// Skip to the next event from detected idle loops
+extern bool gDynarecConstantPropagation;	// Specialise dynarec code on register values known at compile time
+extern u32	gDynarecMaxTraceLength;		// Most ops recorded into a single fragment
+extern u32	gDynarecMaxInlineLength;	// Most ops followed into a leaf function called from a trace (0 to disable)
 extern bool gOSHooksEnabled;			// Apply os-hooks
 extern u32	gSpeedSyncEnabled;
 extern bool gDoubleDisplayEnabled;
@@ -47,6 +51,9 @@ extern bool gVideoRateMatch;
 extern bool gFogEnabled;
 extern bool gMemoryAccessOptimisation;
 extern bool gCheatsEnabled;
+extern u32	gRewindBufferSize;			// Bytes of snapshots kept for rewinding (0 to disable)
+extern u32	gRewindInterval;			// Vertical blanks between snapshots
+extern u32	gRewindKeyframeInterval;	// Snapshots between full snapshots
 //ToDo: Needs moving to Graphics plugin config
 extern bool	gCleanSceneEnabled;
 extern bool	gClearDepthFrameBuffer;
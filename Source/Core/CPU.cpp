@@ -135,15 +135,146 @@ void CPU_SkipToNextEvent()
 	LOCK_EVENT_QUEUE();
 
 	DAEDALUS_ASSERT( gCPUState.NumEvents > 0, "There are no events" );
-	gCPUState.CPUControl[C0_COUNT]._u32 += (gCPUState.Events[ 0 ].mCount - 1);
+	gCPUState.CPUControl[C0_COUNT]._u32 += (CPU_GetCyclesUntilNextEvent() - 1);
 	gCPUState.Events[ 0 ].mCount = 1;
 }
 
+//*****************************************************************************
+//	Pending events are kept in a binary min-heap ordered by the (absolute)
+//	cycle they are due on. Each event type can only be scheduled once, and
+//	gEventHeapIndex maps the type to its slot in the heap so it can be
+//	rescheduled or removed without a search.
+//
+//	The head of the heap is mirrored into gCPUState.Events[0] as a countdown,
+//	which the cores decrement as they execute (see CPU_ProcessEventCycles).
+//	The current time is derived from how far that countdown has progressed
+//	since it was last armed.
+//*****************************************************************************
+struct CPUEventHeapEntry
+{
+	s64					mDue;
+	ECPUEventType		mEventType;
+};
+
+static const u32			kNumEventTypes = CPU_EVENT_SPINT + 1;
+static const s32			kEventNotScheduled = -1;
+
+static CPUEventHeapEntry	gEventHeap[ MAX_CPU_EVENTS ];
+static s32					gEventHeapIndex[ kNumEventTypes ];
+static s64					gEventArmedTime = 0;		// Time at which Events[0] was last armed
+static s32					gEventArmedCount = 0;		// Value Events[0].mCount was armed with
+
+static inline s64 CPU_GetEventTime()
+{
+	return gEventArmedTime + (gEventArmedCount - gCPUState.Events[ 0 ].mCount);
+}
+
+static void CPU_ArmNextEvent( s64 now )
+{
+#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( gCPUState.NumEvents > 0, "Should always have at least one event queued up" );
+#endif
+	s64 delta = gEventHeap[ 0 ].mDue - now;
+	if( delta > 0x7fffffff )
+		delta = 0x7fffffff;
+
+	gCPUState.Events[ 0 ].mCount = s32( delta );
+	gCPUState.Events[ 0 ].mEventType = gEventHeap[ 0 ].mEventType;
+
+	gEventArmedTime = now;
+	gEventArmedCount = s32( delta );
+}
+
+static inline void CPU_SetEventHeapEntry( u32 idx, const CPUEventHeapEntry & entry )
+{
+	gEventHeap[ idx ] = entry;
+	gEventHeapIndex[ entry.mEventType ] = s32( idx );
+}
+
+static void CPU_SiftEventUp( u32 idx )
+{
+	CPUEventHeapEntry entry = gEventHeap[ idx ];
+	while( idx > 0 )
+	{
+		u32 parent = (idx - 1) / 2;
+		if( gEventHeap[ parent ].mDue <= entry.mDue )
+			break;
+
+		CPU_SetEventHeapEntry( idx, gEventHeap[ parent ] );
+		idx = parent;
+	}
+	CPU_SetEventHeapEntry( idx, entry );
+}
+
+static void CPU_SiftEventDown( u32 idx )
+{
+	CPUEventHeapEntry entry = gEventHeap[ idx ];
+	u32 num_events = gCPUState.NumEvents;
+	for( ;; )
+	{
+		u32 child = idx * 2 + 1;
+		if( child >= num_events )
+			break;
+		if( child + 1 < num_events && gEventHeap[ child + 1 ].mDue < gEventHeap[ child ].mDue )
+			child++;
+		if( entry.mDue <= gEventHeap[ child ].mDue )
+			break;
+
+		CPU_SetEventHeapEntry( idx, gEventHeap[ child ] );
+		idx = child;
+	}
+	CPU_SetEventHeapEntry( idx, entry );
+}
+
+static void CPU_RemoveEventAt( u32 idx )
+{
+	gEventHeapIndex[ gEventHeap[ idx ].mEventType ] = kEventNotScheduled;
+
+	u32 last = --gCPUState.NumEvents;
+	if( idx != last )
+	{
+		ECPUEventType moved_type = gEventHeap[ last ].mEventType;
+		CPU_SetEventHeapEntry( idx, gEventHeap[ last ] );
+		CPU_SiftEventDown( idx );
+		CPU_SiftEventUp( gEventHeapIndex[ moved_type ] );
+	}
+}
+
+// Add an event, or reschedule it if one of this type is already pending
+static void CPU_ScheduleEvent( s64 due, ECPUEventType event_type )
+{
+	s32 idx = gEventHeapIndex[ event_type ];
+	if( idx == kEventNotScheduled )
+	{
+		DAEDALUS_ASSERT( gCPUState.NumEvents < MAX_CPU_EVENTS, "Too many events" );
+
+		CPUEventHeapEntry entry = { due, event_type };
+		idx = s32( gCPUState.NumEvents++ );
+		CPU_SetEventHeapEntry( idx, entry );
+		CPU_SiftEventUp( idx );
+	}
+	else
+	{
+		gEventHeap[ idx ].mDue = due;
+		CPU_SiftEventDown( idx );
+		CPU_SiftEventUp( gEventHeapIndex[ event_type ] );
+	}
+}
+
 static void CPU_ResetEventList()
 {
-	gCPUState.Events[ 0 ].mCount     = kInitialVIInterruptCycles;
-	gCPUState.Events[ 0 ].mEventType = CPU_EVENT_VBL;
-	gCPUState.NumEvents = 1;
+	for( u32 i = 0; i < kNumEventTypes; ++i )
+	{
+		gEventHeapIndex[ i ] = kEventNotScheduled;
+	}
+	gCPUState.NumEvents = 0;
+	gCPUState.Events[ 0 ].mCount = 0;
+
+	gEventArmedTime = 0;
+	gEventArmedCount = 0;
+
+	CPU_ScheduleEvent( kInitialVIInterruptCycles, CPU_EVENT_VBL );
+	CPU_ArmNextEvent( 0 );
 
 	RESET_EVENT_QUEUE_LOCK();
 }
@@ -153,71 +284,31 @@ void CPU_AddEvent( s32 count, ECPUEventType event_type )
 	LOCK_EVENT_QUEUE();
 
 	DAEDALUS_ASSERT( count > 0, "Count is invalid" );
-	DAEDALUS_ASSERT( gCPUState.NumEvents < MAX_CPU_EVENTS, "Too many events" );
 
-	u32 event_idx;
-	for( event_idx = 0; event_idx < gCPUState.NumEvents; ++event_idx )
-	{
-		CPUEvent & event = gCPUState.Events[ event_idx ];
+	s64 now = CPU_GetEventTime();
+	CPU_ScheduleEvent( now + count, event_type );
+	CPU_ArmNextEvent( now );
+}
 
-		if( count <= event.mCount )
-		{
-			//
-			//	This event belongs before the subsequent one so insert a space for it here and break out
-			//	Don't forget to decrement the counter for the subsequent event
-			//
-			event.mCount -= count;
-
-			u32 num_to_copy = gCPUState.NumEvents - event_idx;
-			if( num_to_copy > 0 )
-			{
-				memmove( &gCPUState.Events[ event_idx+1 ], &gCPUState.Events[ event_idx ], num_to_copy * sizeof( CPUEvent ) );
-			}
-			break;
-		}
+void CPU_RemoveEvent( ECPUEventType event_type )
+{
+	LOCK_EVENT_QUEUE();
 
-		//
-		//	Decrease counter by that for this event
-		//
-		count -= event.mCount;
+	s32 idx = gEventHeapIndex[ event_type ];
+	if( idx != kEventNotScheduled )
+	{
+		s64 now = CPU_GetEventTime();
+		CPU_RemoveEventAt( idx );
+		CPU_ArmNextEvent( now );
 	}
-#ifdef DAEDALUS_ENABLE_ASSERTS
-	DAEDALUS_ASSERT( event_idx <= gCPUState.NumEvents, "Invalid idx" );
-#endif
-	gCPUState.Events[ event_idx ].mCount = count;
-	gCPUState.Events[ event_idx ].mEventType = event_type;
-	gCPUState.NumEvents++;
 }
 
 static void CPU_SetCompareEvent( s32 count )
 {
-	{
-		LOCK_EVENT_QUEUE();
 #ifdef DAEDALUS_ENABLE_ASSERTS
-		DAEDALUS_ASSERT( count > 0, "Count is invalid" );
+	DAEDALUS_ASSERT( count > 0, "Count is invalid" );
 #endif
-		//
-		//	Remove any existing compare events. Need to adjust any subsequent timer's count.
-		//
-		for( u32 i = 0; i < gCPUState.NumEvents; ++i )
-		{
-			if( gCPUState.Events[ i ].mEventType == CPU_EVENT_COMPARE )
-			{
-				//
-				//	Check for a following event, and remove
-				//
-				if( i+1 < gCPUState.NumEvents )
-				{
-					gCPUState.Events[ i+1 ].mCount += gCPUState.Events[ i ].mCount;
-					u32 num_to_copy = gCPUState.NumEvents - (i+1);
-					memmove( &gCPUState.Events[ i ], &gCPUState.Events[ i+1 ], num_to_copy * sizeof( CPUEvent ) );
-				}
-				gCPUState.NumEvents--;
-				break;
-			}
-		}
-	}
-
+	// Any existing compare event is rescheduled
 	CPU_AddEvent( count, CPU_EVENT_COMPARE );
 }
 
@@ -230,14 +321,22 @@ static ECPUEventType CPU_PopEvent()
 #endif
 	//DAEDALUS_ASSERT( gCPUState.Events[ 0 ].mCount == 0, "Popping event with a bit of underflow" );
 
-	ECPUEventType event_type = gCPUState.Events[ 0 ].mEventType;
+	ECPUEventType event_type = gEventHeap[ 0 ].mEventType;
+	s64 now = CPU_GetEventTime();
+
+	CPU_RemoveEventAt( 0 );
 
-	u32	num_to_copy = gCPUState.NumEvents - 1;
-	if( num_to_copy > 0 )
+	// The next event is re-armed when its replacement is added (e.g. VBL), so
+	// only arm here if there's something left to count down to.
+	if( gCPUState.NumEvents > 0 )
+	{
+		CPU_ArmNextEvent( now );
+	}
+	else
 	{
-		memmove( &gCPUState.Events[ 0 ], &gCPUState.Events[ 1 ], num_to_copy * sizeof( CPUEvent ) );
+		gEventArmedTime = now;
+		gEventArmedCount = gCPUState.Events[ 0 ].mCount;
 	}
-	gCPUState.NumEvents--;
 
 	return event_type;
 }
@@ -245,12 +344,10 @@ static ECPUEventType CPU_PopEvent()
 // XXXX This is for savestate. Looks very suspicious to me
 u32 CPU_GetVideoInterruptEventCount()
 {
-	for( u32 i = 0; i < gCPUState.NumEvents; ++i )
+	s32 idx = gEventHeapIndex[ CPU_EVENT_VBL ];
+	if( idx != kEventNotScheduled )
 	{
-		if(gCPUState.Events[ i ].mEventType == CPU_EVENT_VBL)
-		{
-			return gCPUState.Events[ i ].mCount;
-		}
+		return u32( gEventHeap[ idx ].mDue - CPU_GetEventTime() );
 	}
 
 	return 0;
@@ -259,13 +356,9 @@ u32 CPU_GetVideoInterruptEventCount()
 // XXXX This is for savestate. Looks very suspicious to me
 void CPU_SetVideoInterruptEventCount( u32 count )
 {
-	for( u32 i = 0; i < gCPUState.NumEvents; ++i )
+	if( gEventHeapIndex[ CPU_EVENT_VBL ] != kEventNotScheduled )
 	{
-		if(gCPUState.Events[ i ].mEventType == CPU_EVENT_VBL)
-		{
-			gCPUState.Events[ i ].mCount = count;
-			return;
-		}
+		CPU_AddEvent( count, CPU_EVENT_VBL );
 	}
 }
 
@@ -352,6 +445,7 @@ bool CPU_RomOpen()
 	{
 		g_TLBs[i].Reset();
 	}
+	TLB_InvalidatePageTable();
 
 	// From R4300 manual
 	gCPUState.CPUControl[C0_RAND]._u32   = 32-1;			// TLBENTRIES-1
@@ -381,6 +475,7 @@ bool CPU_RomOpen()
 #endif
 
 	Dynamo_Reset();
+	Inter_Reset();
 
 	CPU_SelectCore();
 	return true;
@@ -388,6 +483,8 @@ bool CPU_RomOpen()
 
 void CPU_RomClose()
 {
+	Dynamo_Fini();
+
 #ifdef DAEDALUS_ENABLE_DYNAREC
 	#ifdef DAEDALUS_DEBUG_CONSOLE_DYNAREC
 		//This will dump the fragment cache on exit to ROMs menu
@@ -489,7 +586,13 @@ static void HandleSaveStateOperationOnVerticalBlank()
     #ifdef DAEDALUS_DEBUG_CONSOLE
 		DBGConsole_Msg(0, "Saving '%s'\n", gSaveStateFilename.c_str());
     #endif
-		SaveState_SaveToFile( gSaveStateFilename.c_str() );
+		// Only the capture happens here, the file is written in the background
+		if( !SaveState_SaveToFileAsync( gSaveStateFilename.c_str(), NULL, NULL ) )
+		{
+			// Too many saves in flight - wait for them rather than drop this one
+			SaveState_WaitForPendingSaves();
+			SaveState_SaveToFileAsync( gSaveStateFilename.c_str(), NULL, NULL );
+		}
 		gSaveStateOperation = SSO_NONE;
 		break;
 	case SSO_LOAD:
@@ -504,6 +607,7 @@ static void HandleSaveStateOperationOnVerticalBlank()
 		if (SaveState_LoadFromFile( gSaveStateFilename.c_str() ))
 		{
 			CPU_ResetFragmentCache();
+			Inter_Reset();
 			gSaveStateOperation = SSO_NONE;
 		}
 		else
@@ -874,6 +978,11 @@ bool CPU_CheckStuffToDo()
 	u32	stuff_to_do = gCPUState.GetStuffToDo();
 	if( stuff_to_do )
 	{
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+		// Pick up anything the compile thread has finished with
+		Dynamo_PublishFragments();
+#endif
+
 		// Process Interrupts/Exceptions on a priority basis
 		// Call most likely first!
 		if( stuff_to_do & CPU_CHECK_INTERRUPTS )
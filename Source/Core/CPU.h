@@ -75,7 +75,7 @@ enum	ECPUEventType
 	CPU_EVENT_SPINT,
 };
 
-// In practice there should only ever be 2
+// One of each ECPUEventType at most
 #define MAX_CPU_EVENTS 4
 
 struct CPUEvent
@@ -128,8 +128,8 @@ ALIGNED_TYPE(struct, SCPUState, CACHE_ALIGN)
 	REG32			Temp3;				// 0x2A8	Temp storage Dynarec
 	REG32			Temp4;				// 0x2AC	Temp storage Dynarec
 
-	CPUEvent		Events[ MAX_CPU_EVENTS ];	// 0x2B0 //In practice there should only ever be 2 CPU_EVENTS
-	u32				NumEvents;
+	CPUEvent		Events[ 1 ];		// 0x2B0	Next event due. The cores count Events[0].mCount down as they execute
+	u32				NumEvents;			// 0x2B8	Number of scheduled events (the queue itself lives in CPU.cpp)
 
 	void			AddJob( u32 job );
 	void			ClearJob( u32 job );
@@ -172,7 +172,8 @@ void	CPU_AddBreakPoint( u32 address );						// Add a break point at address dwAd
 void	CPU_EnableBreakPoint( u32 address, bool enable );		// Enable/Disable the breakpoint as the specified address
 #endif
 bool	CPU_IsRunning();
-void	CPU_AddEvent( s32 count, ECPUEventType event_type );
+void	CPU_AddEvent( s32 count, ECPUEventType event_type );		// Reschedules the event if it's already pending
+void	CPU_RemoveEvent( ECPUEventType event_type );
 void	CPU_SkipToNextEvent();
 bool	CPU_CheckStuffToDo();
 
@@ -242,6 +243,16 @@ extern	void (* g_pCPUCore)();
 			return;													\
 	}
 
+//***********************************************
+// Cycles that can be executed before the next event is due. Cores can run
+// a whole block against this budget and settle it with
+// CPU_ProcessEventCycles/CPU_UpdateCounter once the block is done.
+//***********************************************
+inline s32 CPU_GetCyclesUntilNextEvent()
+{
+	return gCPUState.Events[ 0 ].mCount;
+}
+
 //***********************************************
 //This function gets called *alot* //Corn
 //CPU_ProcessEventCycles
@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Memory.h"
 #include "Interrupt.h"
 #include "R4300.h"
+#include "Interpret.h"
 
 #include "Config/ConfigOptions.h"
 #include "Debug/DBGConsole.h"
@@ -36,6 +37,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "DynaRec/DynaRecProfile.h"
 #include "DynaRec/Fragment.h"
 #include "DynaRec/FragmentCache.h"
+#include "DynaRec/FragmentCompiler.h"
+#include "DynaRec/HotTraceTable.h"
+#include "DynaRec/TraceCache.h"
 #include "DynaRec/TraceRecorder.h"
 #include "OSHLE/patch.h"				// GetCorrectOp
 #include "OSHLE/ultra_R4300.h"
@@ -61,16 +65,34 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 static const u32					gMaxFragmentCacheSize = (8192 + 1024); //Maximum amount of fragments in the cache
 static const u32					gMaxHotTraceMapSize = (2048 + TRACE_SIZE);
 static const u32					gHotTraceThreshold = 10;	//How many times interpreter has to loop a trace before it becomes hot and sent to dynarec
+static const u32					gHotTraceSampleShift = 0;	//Only count one in (1 << gHotTraceSampleShift) backwards branches. 0 counts them all
 
-//typedef CMemoryPoolAllocator< std::pair< const u32, u32 > > MyAllocator;
-//std::map< u32, u32, std::less<u32>, MyAllocator >				gHotTraceCountMap;
-//std::map< u32, u32, std::less<u32>, boost::pool_allocator<std::pair< const u32, u32 > > >				gHotTraceCountMap;
-std::map< u32, u32 >				gHotTraceCountMap;
+DAEDALUS_STATIC_ASSERT( gMaxHotTraceMapSize <= CHotTraceTable::kMaxSize );
+DAEDALUS_STATIC_ASSERT( (gHotTraceThreshold >> gHotTraceSampleShift) > 0 );
+
+//#define RECORD_HOT_TRACE_LOOKUPS		// Write every address looked up in gHotTraceCounts to DynarecDump/ (see DynaRec/HotTraceTable_bench.cpp)
+
+CHotTraceTable						gHotTraceCounts( gHotTraceSampleShift );
 CFragmentCache						gFragmentCache;
 static bool							gResetFragmentCache = false;
 
+// Writes to code are queued up and the overlapping fragments removed at the next safe point
+struct SPendingInvalidation
+{
+	u32		Address;
+	u32		Length;
+};
+static const u32					gMaxPendingInvalidations = 16;	// Flush everything if there are any more than this
+static SPendingInvalidation			gPendingInvalidations[ gMaxPendingInvalidations ];
+static u32							gNumPendingInvalidations = 0;
+static bool							gValidateFragmentCache = false;	// Remove the fragments whose code has changed
+
+#ifdef RECORD_HOT_TRACE_LOOKUPS
+static FILE *						gHotTraceLookupsFile = NULL;
+#endif
+
 #ifdef DAEDALUS_DEBUG_CONSOLE_DYNAREC
-std::map< u32, u32 >				gAbortedTraceReasons;
+CHotTraceTable						gAbortedTraceReasons;
 
 void								CPU_DumpFragmentCache();
 #endif
@@ -78,6 +100,8 @@ void								CPU_DumpFragmentCache();
 static void							CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled );
 static void							CPU_UpdateTrace( u32 address, OpCode op_code, bool branch_delay_slot, bool branch_taken );
 static void							CPU_CreateAndAddFragment();
+static void							CPU_InvalidateFragments();
+static void							CPU_EvictFragments();
 
 
 #ifdef DAEDALUS_PROFILE_EXECUTION
@@ -86,13 +110,14 @@ u32 gFragmentLookupSuccess;
 #endif
 
 //*****************************************************************************
-//	Indicate that the instruction cache is invalid
-//	(we have to dump the dynarec contents and start over, but this is
-//	better than crashing :) )
+//	Indicate that the instruction cache is invalid. Rather than dumping the
+//	dynarec contents, fragments are checked against the code they were built
+//	from at the next safe point and the ones which have changed are removed.
 //*****************************************************************************
 void R4300_CALL_TYPE CPU_InvalidateICache()
 {
-	CPU_ResetFragmentCache();
+	Inter_Reset();
+	gValidateFragmentCache = true;
 }
 
 //*****************************************************************************
@@ -105,20 +130,62 @@ void CPU_DynarecEnable()
 }
 
 //*****************************************************************************
-// If fragments overlap dynarec has to start all over which is very costly
+// If fragments overlap they're removed at the next safe point. This can be
+// called from within a fragment, so it can't happen right away.
 //*****************************************************************************
 void R4300_CALL_TYPE CPU_InvalidateICacheRange( u32 address, u32 length )
 {
+	Inter_InvalidateICacheRange( address, length );
+	gFragmentCompiler.CancelRange( address, length );
+
 	if( gFragmentCache.ShouldInvalidateOnWrite( address, length ) )
 	{
 #ifndef DAEDALUS_SILENT
 		printf( "Write to %08x (%d bytes) overlaps fragment cache entries\n", address, length );
 #endif
-		CPU_ResetFragmentCache();
+		if( gNumPendingInvalidations < gMaxPendingInvalidations )
+		{
+			gPendingInvalidations[ gNumPendingInvalidations ].Address = address;
+			gPendingInvalidations[ gNumPendingInvalidations ].Length = length;
+			gNumPendingInvalidations++;
+		}
+		else
+		{
+			CPU_ResetFragmentCache();
+		}
 	}
 }
 
 
+//*****************************************************************************
+//	Cheap test for the conditional branches whose direction the trace recorder
+//	keeps count of. Most are identified from the primary opcode alone, and
+//	the mask rejects nearly every other op with a single shift and test
+//	before the switch is reached.
+//*****************************************************************************
+static const u32 kConditionalBranchOps = (1 << OP_REGIMM) | (1 << OP_COPRO1) |
+										 (1 << OP_BEQ) | (1 << OP_BNE) | (1 << OP_BLEZ) | (1 << OP_BGTZ) |
+										 (1 << OP_BEQL) | (1 << OP_BNEL) | (1 << OP_BLEZL) | (1 << OP_BGTZL);
+
+static DAEDALUS_FORCEINLINE bool CPU_IsConditionalBranch( OpCode op_code )
+{
+	if( DAEDALUS_EXPECT_LIKELY( op_code.op >= 32 || ( ( kConditionalBranchOps >> op_code.op ) & 1 ) == 0 ) )
+		return false;
+
+	switch( op_code.op )
+	{
+	case OP_BEQ:	case OP_BNE:	case OP_BLEZ:	case OP_BGTZ:
+	case OP_BEQL:	case OP_BNEL:	case OP_BLEZL:	case OP_BGTZL:
+		return true;
+	case OP_REGIMM:
+		return ( op_code.rt & 0x0c ) == 0;		// BLTZ/BGEZ(L) and BLTZAL/BGEZAL(L)
+	case OP_COPRO1:
+		return op_code.cop1_op == Cop1Op_BCInstr;
+	default:
+		return false;
+	}
+}
+
 //*****************************************************************************
 //	Execute a single MIPS op. The conditionals for the templated arguments
 //	are completely optimised away by the compiler.
@@ -166,10 +233,16 @@ template< bool TraceEnabled > DAEDALUS_FORCEINLINE void CPU_EXECUTE_OP()
         #ifdef DAEDALUS_ENABLE_ASSERTS
 		DAEDALUS_ASSERT( !gTraceRecorder.IsTraceActive(), "If TraceEnabled is not set, trace should be inactive" );
         #endif
-		
+		u32		pc( gCPUState.CurrentPC );	// Likely branches which aren't taken step over their delay slot
+
         R4300_ExecuteInstruction(op_code);
 		gGPR[0]._u64 = 0;	//Ensure r0 is zero
 
+		if( CPU_IsConditionalBranch( op_code ) )
+		{
+			gTraceRecorder.RecordBranchDirection( pc, gCPUState.Delay == DO_DELAY );
+		}
+
 #ifdef DAEDALUS_PROFILE_EXECUTION
 		gTotalInstructionsEmulated++;
 #endif
@@ -253,7 +326,7 @@ template < bool DynaRec, bool TraceEnabled > void CPU_Go()
 				u32 start_address( gTraceRecorder.GetStartTraceAddress() );
 				//DBGConsole_Msg( 0, "Aborting tracing of [R%08x] - StuffToDo is %08x", start_address, stuff_to_do );
 
-				gAbortedTraceReasons[ start_address ] = stuff_to_do;
+				gAbortedTraceReasons.Set( start_address, stuff_to_do );
 #endif
 
 #ifdef ALLOW_TRACES_WHICH_EXCEPT
@@ -286,13 +359,7 @@ struct SAddressHitCount
 
 	u32		GetAbortReason() const
 	{
-		std::map<u32, u32>::const_iterator		it( gAbortedTraceReasons.find( Address ) );
-		if( it != gAbortedTraceReasons.end() )
-		{
-			return it->second;
-		}
-
-		return 0;
+		return gAbortedTraceReasons.Find( Address );
 	}
 };
 
@@ -313,11 +380,15 @@ void	CPU_DumpFragmentCache()
 	{
 		std::vector< SAddressHitCount >	hit_counts;
 
-		hit_counts.reserve( gHotTraceCountMap.size() );
+		hit_counts.reserve( gHotTraceCounts.GetSize() );
 
-		for(std::map<u32,u32>::const_iterator it = gHotTraceCountMap.begin(); it != gHotTraceCountMap.end(); ++it )
+		for( u32 i = 0; i < CHotTraceTable::GetNumEntries(); ++i )
 		{
-			hit_counts.push_back( SAddressHitCount( it->first, it->second ) );
+			const CHotTraceTable::SEntry & entry( gHotTraceCounts.GetEntry( i ) );
+			if( entry.Value != 0 )
+			{
+				hit_counts.push_back( SAddressHitCount( entry.Address, entry.Value ) );
+			}
 		}
 
 		std::sort( hit_counts.begin(), hit_counts.end(), SortByHitCount );
@@ -358,22 +429,141 @@ void	CPU_DumpFragmentCache()
 }
 #endif
 
+//*****************************************************************************
+//	Remove the fragments invalidated since the last safe point
+//*****************************************************************************
+void CPU_InvalidateFragments()
+{
+	u32		num_removed( 0 );
+
+	for( u32 i = 0; i < gNumPendingInvalidations; ++i )
+	{
+		num_removed += gFragmentCache.InvalidateRange( gPendingInvalidations[ i ].Address, gPendingInvalidations[ i ].Length );
+	}
+	gNumPendingInvalidations = 0;
+
+	if( gValidateFragmentCache )
+	{
+		// Anything being compiled may have been recorded from the old code
+		gFragmentCompiler.CancelAll();
+		num_removed += gFragmentCache.InvalidateStale();
+		gValidateFragmentCache = false;
+	}
+
+#ifdef DAEDALUS_ENABLE_OS_HOOKS
+	// Put back any of the OS functions which were removed
+	if( num_removed > 0 )
+	{
+		Patch_PatchAll();
+	}
+#endif
+}
+
+//*****************************************************************************
+//	Make room in the code buffer. Only the coldest region is thrown away if the
+//	code buffer manager supports it, otherwise everything goes.
+//*****************************************************************************
+void CPU_EvictFragments()
+{
+	gFragmentCompiler.CancelAll();
+
+	if( !gFragmentCache.EvictColdRegion() )
+	{
+		gFragmentCache.Clear();
+		gHotTraceCounts.Clear();		// Makes sense to clear this now, to get accurate usage stats
+	}
+
+#ifdef DAEDALUS_ENABLE_OS_HOOKS
+	// Put back any of the OS functions which were removed
+	Patch_PatchAll();
+#endif
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
 void CPU_CreateAndAddFragment()
 {
-	CFragment * p_fragment( gTraceRecorder.CreateFragment( gFragmentCache.GetCodeBufferManager() ) );
+	if( gFragmentCompiler.GetNumOutstandingJobs() >= CFragmentCompiler::kMaxJobs )
+	{
+		// Compile queue is full. Drop the trace so that it can become hot again later.
+		u32 address( gTraceRecorder.GetStartTraceAddress() );
+		gTraceRecorder.AbortTrace();
+		gHotTraceCounts.Remove( address );
+		DYNAREC_PROFILE_LOGCOMPILE( DynarecProfile::COMPILE_DROPPED );
+		return;
+	}
+
+	SFragmentCompileJob * job( new SFragmentCompileJob );
+	gTraceRecorder.CreateCompileJob( job );
 
-	if( p_fragment != NULL )
+	gFragmentCompiler.QueueJob( gFragmentCache.GetCodeBufferManager(), job );
+	DYNAREC_PROFILE_LOGCOMPILE( DynarecProfile::COMPILE_QUEUED );
+
+#ifndef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	// The fragment has been assembled already
+	Dynamo_PublishFragments();
+#endif
+}
+
+//*****************************************************************************
+//	Move fragments finished by the compiler into the fragment cache. This is
+//	only called when no fragments are executing.
+//*****************************************************************************
+void Dynamo_PublishFragments()
+{
+	while( SFragmentCompileJob * job = gFragmentCompiler.PopCompletedJob() )
 	{
-		gHotTraceCountMap.erase( p_fragment->GetEntryAddress() );
-		gFragmentCache.InsertFragment( p_fragment );
+		CFragment *	p_fragment( job->Fragment );
+		u32			address( job->EntryAddress );
 
-		//DBGConsole_Msg( 0, "Inserted hot trace at [R%08x]! (size is %d. %dKB)", p_fragment->GetEntryAddress(), gFragmentCache.GetCacheSize(), gFragmentCache.GetMemoryUsage() / 1024 );
+		gHotTraceCounts.Remove( address );
+
+		if( p_fragment == NULL || job->Cancelled || gFragmentCache.LookupFragmentQ( address ) != NULL )
+		{
+			// Overwritten whilst being compiled (or beaten to it). The trace can become hot again.
+			delete p_fragment;
+			DYNAREC_PROFILE_LOGCOMPILE( DynarecProfile::COMPILE_CANCELLED );
+		}
+		else
+		{
+			gFragmentCache.InsertFragment( p_fragment );
+			DYNAREC_PROFILE_LOGCOMPILE( DynarecProfile::COMPILE_PUBLISHED );
+#ifdef DAEDALUS_ENABLE_TRACE_CACHE
+			gTraceCache.Record( *job );
+#endif
+
+			//DBGConsole_Msg( 0, "Inserted hot trace at [R%08x]! (size is %d. %dKB)", address, gFragmentCache.GetCacheSize(), gFragmentCache.GetMemoryUsage() / 1024 );
+		}
+
+		delete job;
 	}
 }
 
+#ifdef DAEDALUS_ENABLE_TRACE_CACHE
+//*****************************************************************************
+//	Hand a trace stored on a previous run straight to the compiler, rather
+//	than waiting for it to become hot and recording it again.
+//*****************************************************************************
+static bool CPU_QueueStoredTrace( u32 address )
+{
+	if( !gTraceCache.HasStoredTraces() || gFragmentCompiler.GetNumOutstandingJobs() >= CFragmentCompiler::kMaxJobs )
+		return false;
+
+	SFragmentCompileJob * job( gTraceCache.Restore( address ) );
+	if( job == NULL )
+		return false;
+
+	gFragmentCompiler.QueueJob( gFragmentCache.GetCodeBufferManager(), job );
+	DYNAREC_PROFILE_LOGCOMPILE( DynarecProfile::COMPILE_QUEUED );
+
+#ifndef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	Dynamo_PublishFragments();
+#endif
+	return true;
+}
+#endif
+
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -480,8 +670,9 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 						if(true)
 #endif
 						{
+							gFragmentCompiler.CancelAll();
 							gFragmentCache.Clear();
-							gHotTraceCountMap.clear();		// Makes sense to clear this now, to get accurate usage stats
+							gHotTraceCounts.Clear();		// Makes sense to clear this now, to get accurate usage stats
 #ifdef DAEDALUS_ENABLE_OS_HOOKS
 							Patch_PatchAll();
 #endif
@@ -493,33 +684,55 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 						}
 #endif
 						gResetFragmentCache = false;
+						gNumPendingInvalidations = 0;
+						gValidateFragmentCache = false;
+					}
+					else if( gNumPendingInvalidations > 0 || gValidateFragmentCache )
+					{
+						CPU_InvalidateFragments();
 					}
 
-					if( gFragmentCache.GetCacheSize() > gMaxFragmentCacheSize)
+					// Make sure there's room for whatever is compiled next, as well as the jobs already queued
+					bool	needs_eviction( gFragmentCache.GetCacheSize() > gMaxFragmentCacheSize );
+					if( !needs_eviction )
 					{
-						gFragmentCache.Clear();
-						gHotTraceCountMap.clear();		// Makes sense to clear this now, to get accurate usage stats
-#ifdef DAEDALUS_ENABLE_OS_HOOKS
-						Patch_PatchAll();
-#endif
+						// The compile thread may be allocating from the code buffer
+						AUTO_CRIT_SECT( gFragmentCompiler.GetCodeBufferLock() );
+						needs_eviction = gFragmentCache.NeedsEviction( gFragmentCompiler.GetNumOutstandingJobs() + 1 );
 					}
+					if( needs_eviction )
+					{
+						CPU_EvictFragments();
+					}
+
+#ifdef DAEDALUS_ENABLE_TRACE_CACHE
+					if( CPU_QueueStoredTrace( gCPUState.CurrentPC ) )
+						break;
+#endif
 
 					// If there is no fragment for this target, start tracing
-					u32 trace_count( ++gHotTraceCountMap[ gCPUState.CurrentPC ] );
-					if( gHotTraceCountMap.size() >= gMaxHotTraceMapSize )
+#ifdef RECORD_HOT_TRACE_LOOKUPS
+					if( gHotTraceLookupsFile != NULL )
+						fwrite( &gCPUState.CurrentPC, sizeof( u32 ), 1, gHotTraceLookupsFile );
+#endif
+					// Returns 0 if this branch wasn't sampled
+					u32 trace_count( gHotTraceCounts.Increment( gCPUState.CurrentPC ) );
+					if( gHotTraceCounts.GetSize() >= gMaxHotTraceMapSize )
 					{
 #ifdef DAEDALUS_DEBUG_CONSOLE
-						DBGConsole_Msg( 0, "Hot trace cache hit %d, dumping", gHotTraceCountMap.size() );
+						DBGConsole_Msg( 0, "Hot trace cache hit %d, decaying", gHotTraceCounts.GetSize() );
 #endif
-						gHotTraceCountMap.clear();
+						// Keep the addresses that are still warming up
+						gHotTraceCounts.Decay();
+						gFragmentCompiler.CancelAll();
 						gFragmentCache.Clear();
 #ifdef DAEDALUS_ENABLE_OS_HOOKS
 						Patch_PatchAll();
 #endif
 					}
-					else if( trace_count == gHotTraceThreshold )
+					else if( trace_count == (gHotTraceThreshold >> gHotTraceSampleShift) )
 					{
-						//DBGConsole_Msg( 0, "Identified hot trace at [R%08x]! (size is %d)", gCPUState.CurrentPC, gHotTraceCountMap.size() );
+						//DBGConsole_Msg( 0, "Identified hot trace at [R%08x]! (size is %d)", gCPUState.CurrentPC, gHotTraceCounts.GetSize() );
 						gTraceRecorder.StartTrace( gCPUState.CurrentPC );
 
 						if(!trace_already_enabled)
@@ -531,14 +744,13 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 #endif
 					}
 #ifdef DAEDALUS_DEBUG_CONSOLE_DYNAREC
-					else if( trace_count > gHotTraceThreshold )
+					else if( trace_count > (gHotTraceThreshold >> gHotTraceSampleShift) )
 					{
-						if(gAbortedTraceReasons.find( gCPUState.CurrentPC ) != gAbortedTraceReasons.end() )
+						u32 reason( gAbortedTraceReasons.Find( gCPUState.CurrentPC ) );
+						if( reason != 0 )
 						{
-							u32 reason( gAbortedTraceReasons[ gCPUState.CurrentPC ] );
-							use( reason );
-							//DBGConsole_Msg( 0, "Hot trace at [R%08x] has count of %d! (reason is %x) size %d", gCPUState.CurrentPC, trace_count, reason, gHotTraceCountMap.size( ) );
-							DAED_LOG( DEBUG_DYNAREC_CACHE, "Hot trace at %08x has count of %d! (reason is %x) size %d", gCPUState.CurrentPC, trace_count, reason, gHotTraceCountMap.size( ) );
+							//DBGConsole_Msg( 0, "Hot trace at [R%08x] has count of %d! (reason is %x) size %d", gCPUState.CurrentPC, trace_count, reason, gHotTraceCounts.GetSize() );
+							DAED_LOG( DEBUG_DYNAREC_CACHE, "Hot trace at %08x has count of %d! (reason is %x) size %d", gCPUState.CurrentPC, trace_count, reason, gHotTraceCounts.GetSize() );
 						}
 						else
 						{
@@ -567,12 +779,42 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 
 void Dynamo_Reset()
 {
-	gHotTraceCountMap.clear();
+	gHotTraceCounts.Clear();
+	gFragmentCompiler.CancelAll();
 	gFragmentCache.Clear();
 	gResetFragmentCache = false;
+	gNumPendingInvalidations = 0;
+	gValidateFragmentCache = false;
 	gTraceRecorder.AbortTrace();
 #ifdef DAEDALUS_DEBUG_CONSOLE_DYNAREC
-	gAbortedTraceReasons.clear();
+	gAbortedTraceReasons.Clear();
+#endif
+#ifdef DAEDALUS_ENABLE_TRACE_CACHE
+	gTraceCache.Open();
+#endif
+#ifdef RECORD_HOT_TRACE_LOOKUPS
+	if( gHotTraceLookupsFile == NULL )
+	{
+		IO::Directory::EnsureExists( "DynarecDump" );
+		gHotTraceLookupsFile = fopen( "DynarecDump/hot_trace_lookups.bin", "wb" );
+	}
+#endif
+}
+
+void Dynamo_Fini()
+{
+	// Anything still being compiled is lost, it'll be recorded again next time
+	gFragmentCompiler.CancelAll();
+	gTraceRecorder.AbortTrace();
+#ifdef DAEDALUS_ENABLE_TRACE_CACHE
+	gTraceCache.Close();
+#endif
+#ifdef RECORD_HOT_TRACE_LOOKUPS
+	if( gHotTraceLookupsFile != NULL )
+	{
+		fclose( gHotTraceLookupsFile );
+		gHotTraceLookupsFile = NULL;
+	}
 #endif
 }
 
@@ -594,7 +836,10 @@ void Dynamo_SelectCore()
 
 void CPU_ResetFragmentCache() {}
 void Dynamo_Reset() {}
-void R4300_CALL_TYPE CPU_InvalidateICacheRange( u32 address, u32 length ) {}
+void Dynamo_Fini() {}
+void Dynamo_PublishFragments() {}
+void R4300_CALL_TYPE CPU_InvalidateICache() { Inter_Reset(); }
+void R4300_CALL_TYPE CPU_InvalidateICacheRange( u32 address, u32 length ) { Inter_InvalidateICacheRange( address, length ); }
 
 #endif //DAEDALUS_ENABLE_DYNAREC
 
@@ -21,6 +21,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 void Dynamo_SelectCore();
 void Dynamo_Reset();
+void Dynamo_Fini();
+void Dynamo_PublishFragments();
 
 #ifdef DAEDALUS_DEBUG_DYNAREC
 	void			CPU_DumpFragmentCache();
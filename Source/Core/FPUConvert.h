@@ -0,0 +1,61 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef CORE_FPUCONVERT_H_
+#define CORE_FPUCONVERT_H_
+
+#include <math.h>
+
+#include "Utility/DaedalusTypes.h"
+
+//
+//	Float rounding with the direction given explicitly, for the R4300's
+//	ROUND/TRUNC/CEIL/FLOOR and CVT conversions. None of these depend on the
+//	host's rounding mode, so the interpreter only has to change that when
+//	the guest's mode changes (i.e. on CTC1). Truncation is just the C cast.
+//
+//	With SSE4.1 these are a single roundss/roundsd. Otherwise floor/ceil
+//	are fine, and nearest is built from round(), which goes away from zero
+//	on ties where the R4300 (like the host in FE_TONEAREST) goes to even.
+//
+#if defined( __SSE4_1__ )
+#include <smmintrin.h>
+
+inline f32 FPU_RoundNearest( f32 x )	{ __m128 v( _mm_set_ss( x ) ); return _mm_cvtss_f32( _mm_round_ss( v, v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) ); }
+inline f32 FPU_RoundCeil( f32 x )		{ __m128 v( _mm_set_ss( x ) ); return _mm_cvtss_f32( _mm_round_ss( v, v, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC ) ); }
+inline f32 FPU_RoundFloor( f32 x )		{ __m128 v( _mm_set_ss( x ) ); return _mm_cvtss_f32( _mm_round_ss( v, v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC ) ); }
+
+inline f64 FPU_RoundNearest( f64 x )	{ __m128d v( _mm_set_sd( x ) ); return _mm_cvtsd_f64( _mm_round_sd( v, v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) ); }
+inline f64 FPU_RoundCeil( f64 x )		{ __m128d v( _mm_set_sd( x ) ); return _mm_cvtsd_f64( _mm_round_sd( v, v, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC ) ); }
+inline f64 FPU_RoundFloor( f64 x )		{ __m128d v( _mm_set_sd( x ) ); return _mm_cvtsd_f64( _mm_round_sd( v, v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC ) ); }
+
+#else
+
+// Ties are exact (x - trunc(x) can't round), and halving them is exact too
+inline f32 FPU_RoundNearest( f32 x )	{ return fabsf( x - truncf( x ) ) == 0.5f ? 2.0f * roundf( x * 0.5f ) : roundf( x ); }
+inline f32 FPU_RoundCeil( f32 x )		{ return ceilf( x ); }
+inline f32 FPU_RoundFloor( f32 x )		{ return floorf( x ); }
+
+inline f64 FPU_RoundNearest( f64 x )	{ return fabs( x - trunc( x ) ) == 0.5 ? 2.0 * round( x * 0.5 ) : round( x ); }
+inline f64 FPU_RoundCeil( f64 x )		{ return ceil( x ); }
+inline f64 FPU_RoundFloor( f64 x )		{ return floor( x ); }
+
+#endif
+
+#endif // CORE_FPUCONVERT_H_
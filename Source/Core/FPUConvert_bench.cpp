@@ -0,0 +1,164 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Micro-benchmark for the interpreter's float -> int conversions. Runs a
+//	mix of TRUNC.W.D, FLOOR.W.D, CVT.W.D and ADD.D the way R4300.cpp used to
+//	(setting the host's rounding mode for every conversion, then back for
+//	the arithmetic) and the way it does now (explicit rounding, with the mode
+//	only written when it changes).
+//
+//	Usage: FPUConvert_bench
+//
+
+#include "stdafx.h"
+#include "Core/FPUConvert.h"
+
+#include <fenv.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "Utility/Timing.h"
+
+namespace
+{
+	const u32	kNumValues = 1024 * 1024;
+	const u32	kNumRepeats = 20;
+	const u32	kOpsPerValue = 4;
+
+	void MakeValues( std::vector< f64 > & values )
+	{
+		u32 seed( 1 );
+		for( u32 i = 0; i < kNumValues; ++i )
+		{
+			seed = seed * 1664525 + 1013904223;
+			s32 r( s32( seed ) >> 8 );
+
+			// Plenty of exact halves, to exercise the ties
+			values.push_back( ( seed & 0x10 ) ? f64( r ) * 0.5 : f64( r ) / 1000.0 );
+		}
+	}
+
+	u64 Now()
+	{
+		u64 time;
+		NTiming::GetPreciseTime( &time );
+		return time;
+	}
+
+	s32 RunOld( const std::vector< f64 > & values, f64 * p_sum )
+	{
+		s32		total( 0 );
+		f64		sum( 0.0 );
+
+		for( std::vector< f64 >::const_iterator it = values.begin(); it != values.end(); ++it )
+		{
+			f64 x( *it );
+
+			fesetround( FE_TOWARDZERO );	total += s32( trunc( x ) );		// TRUNC.W.D
+			fesetround( FE_DOWNWARD );		total += s32( floor( x ) );		// FLOOR.W.D
+			fesetround( FE_TONEAREST );		total += s32( round( x ) );		// CVT.W.D, FCR31 is RN
+			fesetround( FE_TONEAREST );		sum += x;						// ADD.D
+		}
+		*p_sum = sum;
+		return total;
+	}
+
+	int		gHostMode( FE_TONEAREST );
+
+	inline void SetRoundMode( int mode )
+	{
+		if( mode != gHostMode )
+		{
+			fesetround( mode );
+			gHostMode = mode;
+		}
+	}
+
+	s32 RunNew( const std::vector< f64 > & values, f64 * p_sum )
+	{
+		s32		total( 0 );
+		f64		sum( 0.0 );
+
+		for( std::vector< f64 >::const_iterator it = values.begin(); it != values.end(); ++it )
+		{
+			f64 x( *it );
+
+			total += s32( x );							// TRUNC.W.D
+			total += s32( FPU_RoundFloor( x ) );		// FLOOR.W.D
+			total += s32( FPU_RoundNearest( x ) );		// CVT.W.D, FCR31 is RN
+			SetRoundMode( FE_TONEAREST );	sum += x;	// ADD.D
+		}
+		*p_sum = sum;
+		return total;
+	}
+
+	u32 CountTies( const std::vector< f64 > & values )
+	{
+		u32 ties( 0 );
+		for( std::vector< f64 >::const_iterator it = values.begin(); it != values.end(); ++it )
+		{
+			if( FPU_RoundNearest( *it ) != round( *it ) )
+				++ties;
+		}
+		return ties;
+	}
+
+	void Report( const char * name, u64 ticks, s32 total, f64 sum )
+	{
+		u64 freq;
+		NTiming::GetPreciseFrequency( &freq );
+
+		double ns( double( ticks ) * 1000000000.0 / double( freq ) / double( kNumValues * kOpsPerValue ) );
+		printf( "%-24s %8.2f ns/op   (%d, %g)\n", name, ns, total, sum );
+	}
+}
+
+int main( int argc, char * argv[] )
+{
+	std::vector< f64 >	values;
+	MakeValues( values );
+
+	printf( "%u values x %u ops, best of %u runs\n", kNumValues, kOpsPerValue, kNumRepeats );
+
+	u64	best_old( ~0ULL ), best_new( ~0ULL );
+	s32	total_old( 0 ), total_new( 0 );
+	f64	sum_old( 0.0 ), sum_new( 0.0 );
+
+	for( u32 i = 0; i < kNumRepeats; ++i )
+	{
+		u64 start( Now() );
+		total_old = RunOld( values, &sum_old );
+		u64 end( Now() );
+		if( end - start < best_old )	best_old = end - start;
+
+		start = Now();
+		total_new = RunNew( values, &sum_new );
+		end = Now();
+		if( end - start < best_new )	best_new = end - start;
+	}
+
+	Report( "fesetround per op", best_old, total_old, sum_old );
+	Report( "explicit rounding", best_new, total_new, sum_new );
+
+	// The totals only differ by the ties, which now go to even as on the R4300
+	printf( "%u ties rounded to even\n", CountTies( values ) );
+	return 0;
+}
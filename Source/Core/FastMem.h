@@ -0,0 +1,129 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef CORE_FASTMEM_H_
+#define CORE_FASTMEM_H_
+
+#include <stddef.h>
+
+#include "Utility/DaedalusTypes.h"
+
+//
+//	Fastmem reserves a 4GB block of host address space and maps the
+//	directly addressable regions (RDRAM and SP memory) into it at their
+//	KSEG0 and KSEG1 addresses. Everything else (registers, ROM, invalid
+//	ranges) is left inaccessible; accesses to those fault, and the fault
+//	handler routes them through the regular g_MemoryLookupTable handlers.
+//
+//	This means a guest access to KSEG0/KSEG1 is a single load or store
+//	from gFastMemBase + address. The dynarec doesn't use the window, it
+//	goes through g_pu8RamBase_8000 and the lookup tables either way.
+//
+#ifdef DAEDALUS_ENABLE_FASTMEM
+
+extern u8 *		gFastMemBase;
+
+bool	FastMem_Init();
+void	FastMem_Fini();
+
+// Creates a region which is mapped at both (0x80000000 | physical_address)
+// and (0xA0000000 | physical_address). Returns a host pointer to the
+// region which is valid regardless of the protection of the guest views.
+// Regions are released by FastMem_Fini().
+u8 *	FastMem_MapRegion( u32 physical_address, u32 size );
+
+// Makes the guest views of part of a region (in)accessible, so that
+// e.g. the expansion pak can be disabled.
+void	FastMem_SetAccessible( u32 physical_address, u32 size, bool accessible );
+
+// Only KSEG0/KSEG1 are mapped - TLB mapped addresses need translating.
+// gFastMemBase is NULL if the window couldn't be reserved, in which case
+// everything goes through the lookup tables.
+inline bool FastMem_IsDirect( u32 address )
+{
+	return (address >> 30) == 2 && gFastMemBase != NULL;
+}
+
+//
+//	The accesses are done with inline assembly so that the instruction
+//	forms are known to the fault handler (which has to decode them).
+//	Only the forms used here are supported:
+//		movzx r32, byte/word [base+index]
+//		mov r32/r64, [base+index]
+//		mov [base+index], r8/r16/r32/r64
+//
+#if defined(__x86_64__)
+
+inline u8 FastMem_Read8( u32 address )
+{
+	u32 value;
+	asm volatile( "movzbl (%1,%2,1), %k0" : "=r"(value) : "r"(gFastMemBase), "r"(u64(address)) : "memory" );
+	return u8( value );
+}
+
+inline u16 FastMem_Read16( u32 address )
+{
+	u32 value;
+	asm volatile( "movzwl (%1,%2,1), %k0" : "=r"(value) : "r"(gFastMemBase), "r"(u64(address)) : "memory" );
+	return u16( value );
+}
+
+inline u32 FastMem_Read32( u32 address )
+{
+	u32 value;
+	asm volatile( "movl (%1,%2,1), %k0" : "=r"(value) : "r"(gFastMemBase), "r"(u64(address)) : "memory" );
+	return value;
+}
+
+inline u64 FastMem_Read64( u32 address )
+{
+	u64 value;
+	asm volatile( "movq (%1,%2,1), %q0" : "=r"(value) : "r"(gFastMemBase), "r"(u64(address)) : "memory" );
+	return value;
+}
+
+inline void FastMem_Write8( u32 address, u8 value )
+{
+	asm volatile( "movb %b0, (%1,%2,1)" : : "q"(value), "r"(gFastMemBase), "r"(u64(address)) : "memory" );
+}
+
+inline void FastMem_Write16( u32 address, u16 value )
+{
+	asm volatile( "movw %w0, (%1,%2,1)" : : "r"(value), "r"(gFastMemBase), "r"(u64(address)) : "memory" );
+}
+
+inline void FastMem_Write32( u32 address, u32 value )
+{
+	asm volatile( "movl %k0, (%1,%2,1)" : : "r"(value), "r"(gFastMemBase), "r"(u64(address)) : "memory" );
+}
+
+inline void FastMem_Write64( u32 address, u64 value )
+{
+	asm volatile( "movq %q0, (%1,%2,1)" : : "r"(value), "r"(gFastMemBase), "r"(u64(address)) : "memory" );
+}
+
+#else
+#error Fastmem accessors are not implemented for this architecture
+#endif
+
+#endif // DAEDALUS_ENABLE_FASTMEM
+
+#endif // CORE_FASTMEM_H_
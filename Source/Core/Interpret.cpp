@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Config/ConfigOptions.h"
 #include "Debug/DBGConsole.h"
 #include "Debug/DebugLog.h"
+#include "Math/MathUtil.h"
 #include "OSHLE/patch.h"				// GetCorrectOp
 #include "OSHLE/ultra_R4300.h"
 #include "Utility/Macros.h"
@@ -158,10 +159,357 @@ void CPU_Go()
 	}
 }
 
+//*****************************************************************************
+//	Cached interpreter
+//
+//	Rather than fetching and dispatching every op through CPU_EXECUTE_OP,
+//	each basic block is decoded once into a list of handler/opcode pairs
+//	(with the branch delay slot folded in) and stored in a direct-mapped
+//	table keyed by the RDRAM offset of the first op. The COUNT register and
+//	the event queue are updated once per block rather than once per op.
+//	Blocks are discarded by CPU_InvalidateICacheRange()/CPU_InvalidateICache().
+//*****************************************************************************
+#ifdef DAEDALUS_PSP
+static const u32	kCachedBlockCount	= 1024;
+#else
+static const u32	kCachedBlockCount	= 4096;
+#endif
+static const u32	kMaxCachedBlockOps	= 32;		// Including the delay slot
+static const u32	kInvalidBlockPC		= ~0;
+
+DAEDALUS_STATIC_ASSERT( (kCachedBlockCount & (kCachedBlockCount - 1)) == 0 );
+
+#ifdef DAEDALUS_THREADED_INTERPRETER
+typedef SThreadedOp		SCachedOp;
+#else
+struct SCachedOp
+{
+	CPU_Instruction		Handler;
+	OpCode				Op;
+};
+#endif
+
+struct SCachedBlock
+{
+	u32					StartPC;		// Virtual address of the first op
+	u32					PhysAddress;	// Offset of the first op into RDRAM
+	u32					NumOps;
+	SCachedOp			Ops[ kMaxCachedBlockOps ];
+};
+
+static SCachedBlock		gCachedBlocks[ kCachedBlockCount ];
+
+enum ECachedOpType
+{
+	COT_NORMAL = 0,
+	COT_BRANCH,				// Block ends after the delay slot
+	COT_END_BLOCK,			// Block ends after this op
+};
+
+static ECachedOpType	GetCachedOpType( OpCode op_code )
+{
+	switch( op_code.op )
+	{
+	case OP_J:
+	case OP_JAL:
+	case OP_BEQ:
+	case OP_BNE:
+	case OP_BLEZ:
+	case OP_BGTZ:
+	case OP_BEQL:
+	case OP_BNEL:
+	case OP_BLEZL:
+	case OP_BGTZL:
+	case OP_REGIMM:
+		return COT_BRANCH;
+
+	case OP_SPECOP:
+		switch( op_code.spec_op )
+		{
+		case SpecOp_JR:
+		case SpecOp_JALR:
+			return COT_BRANCH;
+		case SpecOp_SYSCALL:
+		case SpecOp_BREAK:
+			return COT_END_BLOCK;
+		default:
+			return COT_NORMAL;
+		}
+
+	case OP_COPRO0:			// Can read COUNT, or change SR/EPC
+	case OP_CACHE:			// Can invalidate the block we're executing
+		return COT_END_BLOCK;
+
+	case OP_COPRO1:
+		return op_code.cop1_op == Cop1Op_BCInstr ? COT_BRANCH : COT_NORMAL;
+
+	default:
+		return COT_NORMAL;
+	}
+}
+
+#ifdef DAEDALUS_THREADED_INTERPRETER
+static void	CPU_SetCachedOp( SCachedOp & op, OpCode op_code )
+{
+	op.Label = R4300_GetThreadedLabel( op_code );
+	op.Op = op_code;
+}
+#else
+//*****************************************************************************
+//	The top level handlers for these ops are swapped when COP1 is
+//	enabled/disabled, so they have to be looked up each time they are executed
+//*****************************************************************************
+static void R4300_CALL_TYPE CPU_ExecuteDispatchedOp( R4300_CALL_SIGNATURE )
+{
+	OpCode op_code;
+	op_code._u32 = op_code_bits;
+
+	R4300_ExecuteInstruction( op_code );
+}
+
+static CPU_Instruction	GetCachedOpHandler( OpCode op_code )
+{
+	switch( op_code.op )
+	{
+	case OP_COPRO1:
+	case OP_LWC1:
+	case OP_LDC1:
+	case OP_SWC1:
+	case OP_SDC1:
+		return CPU_ExecuteDispatchedOp;
+	default:
+		return R4300_GetInstructionHandler( op_code );
+	}
+}
+
+static void	CPU_SetCachedOp( SCachedOp & op, OpCode op_code )
+{
+	op.Handler = GetCachedOpHandler( op_code );
+	op.Op = op_code;
+}
+#endif
+
+//*****************************************************************************
+//	Returns false if no block could be built at this address, in which case
+//	the caller should fall back to executing a single op.
+//*****************************************************************************
+static bool CPU_DecodeCachedBlock( SCachedBlock & block, u32 pc, const u8 * p_ops, u32 phys_address )
+{
+	// Don't let the block run past the end of this memory region or RDRAM
+	u32		page_remaining( (0x40000 - (pc & 0x3ffff)) >> 2 );
+	u32		ram_remaining( (gRamSize - phys_address) >> 2 );
+	u32		max_ops( Min( kMaxCachedBlockOps, Min( page_remaining, ram_remaining ) ) );
+
+	u32		num_ops( 0 );
+	while( num_ops < max_ops )
+	{
+		OpCode			op_code( *(const OpCode *)(p_ops + num_ops * 4) );
+		ECachedOpType	type( GetCachedOpType( op_code ) );
+
+		if( type == COT_END_BLOCK && num_ops > 0 )
+		{
+			// Make sure COUNT is up to date before this op is executed
+			break;
+		}
+		if( type == COT_BRANCH && num_ops + 2 > max_ops )
+		{
+			// The delay slot doesn't fit in this block
+			break;
+		}
+
+		CPU_SetCachedOp( block.Ops[ num_ops ], op_code );
+		num_ops++;
+
+		if( type == COT_END_BLOCK )
+			break;
+
+		if( type == COT_BRANCH )
+		{
+			OpCode	delay_op( *(const OpCode *)(p_ops + num_ops * 4) );
+			CPU_SetCachedOp( block.Ops[ num_ops ], delay_op );
+			num_ops++;
+			break;
+		}
+	}
+
+	if( num_ops == 0 )
+	{
+		block.StartPC = kInvalidBlockPC;
+		return false;
+	}
+
+	block.StartPC = pc;
+	block.PhysAddress = phys_address;
+	block.NumOps = num_ops;
+	return true;
+}
+
+DAEDALUS_FORCEINLINE void CPU_EXECUTE_CACHED_BLOCK()
+{
+	u32			pc( gCPUState.CurrentPC );
+
+	// Only start blocks on a clean instruction boundary
+	if( gCPUState.Delay != NO_DELAY )
+	{
+		CPU_EXECUTE_OP< false >();
+		return;
+	}
+
+	const MemFuncRead & m( g_MemoryLookupTableRead[ pc >> 18 ] );
+	if( DAEDALUS_EXPECT_UNLIKELY( m.pRead == NULL ) )
+	{
+		// ROM or TLB mapped
+		CPU_EXECUTE_OP< false >();
+		return;
+	}
+
+	u8 *		p_ops( m.pRead + pc );
+	u32			phys_address( (u32)( p_ops - g_pu8RamBase ) );
+	if( DAEDALUS_EXPECT_UNLIKELY( uintptr_t( p_ops - g_pu8RamBase ) >= gRamSize ) )
+	{
+		// Executing out of SP memory
+		CPU_EXECUTE_OP< false >();
+		return;
+	}
+
+	SCachedBlock & block( gCachedBlocks[ (phys_address >> 2) & (kCachedBlockCount - 1) ] );
+	if( block.StartPC != pc || block.PhysAddress != phys_address )
+	{
+		if( !CPU_DecodeCachedBlock( block, pc, p_ops, phys_address ) )
+		{
+			CPU_EXECUTE_OP< false >();
+			return;
+		}
+	}
+
+#ifdef DAEDALUS_THREADED_INTERPRETER
+	u32			ops_executed( R4300_ExecuteThreadedOps( block.Ops, block.NumOps, p_ops ) );
+#else
+	u32			num_ops( block.NumOps );
+	u32			ops_executed( 0 );
+	while( ops_executed < num_ops )
+	{
+		const SCachedOp & op( block.Ops[ ops_executed ] );
+
+		// Cache instruction base pointer (used for SpeedHack() @ R4300.0)
+		gLastAddress = p_ops + ops_executed * 4;
+
+		op.Handler( op.Op._u32 );
+		gGPR[0]._u64 = 0;	//Ensure r0 is zero
+
+		ops_executed++;
+
+		switch (gCPUState.Delay)
+		{
+		case DO_DELAY:
+			INCREMENT_PC();
+			gCPUState.Delay = EXEC_DELAY;
+			break;
+		case EXEC_DELAY:
+			CPU_SetPC(gCPUState.TargetPC);
+			gCPUState.Delay = NO_DELAY;
+			break;
+		case NO_DELAY:
+			INCREMENT_PC();
+			break;
+		default:
+			NODEFAULT;
+		}
+
+		// Bail out on exceptions/interrupts, or if the op didn't fall through
+		// to the next decoded op (e.g. a likely branch skipping its delay slot)
+		if( gCPUState.GetStuffToDo() || gCPUState.CurrentPC != pc + ops_executed * 4 )
+			break;
+	}
+#endif
+
+#ifdef DAEDALUS_PROFILE_EXECUTION
+	gTotalInstructionsEmulated += ops_executed;
+#endif
+
+	CPU_UpdateCounter( ops_executed );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CPU_GoCached()
+{
+    #ifdef DAEDALUS_ENABLE_PROFILING
+	DAEDALUS_PROFILE( __FUNCTION__ );
+#endif
+	while (CPU_KeepRunning())
+	{
+		u32	stuff_to_do( gCPUState.GetStuffToDo() );
+		while(stuff_to_do == 0)
+		{
+			CPU_EXECUTE_CACHED_BLOCK();
+
+			stuff_to_do = gCPUState.GetStuffToDo();
+		}
+
+		if (CPU_CheckStuffToDo())
+			break;
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void Inter_Reset()
+{
+	for( u32 i = 0; i < kCachedBlockCount; ++i )
+	{
+		gCachedBlocks[ i ].StartPC = kInvalidBlockPC;
+	}
+}
+
+//*****************************************************************************
+//	Discard any decoded blocks overlapping the specified range
+//*****************************************************************************
+void Inter_InvalidateICacheRange( u32 address, u32 length )
+{
+	const MemFuncRead & m( g_MemoryLookupTableRead[ address >> 18 ] );
+	if( m.pRead == NULL )
+	{
+		Inter_Reset();
+		return;
+	}
+
+	uintptr_t	offset( uintptr_t( m.pRead + address - g_pu8RamBase ) );
+	if( offset >= gRamSize )
+		return;
+
+	u32		start( (u32)offset );
+	u32		end( start + length );
+
+	// Blocks starting up to kMaxCachedBlockOps ops before the range can overlap it
+	u32		first( start > (kMaxCachedBlockOps - 1) * 4 ? start - (kMaxCachedBlockOps - 1) * 4 : 0 );
+	if( ((end - first) >> 2) >= kCachedBlockCount )
+	{
+		Inter_Reset();
+		return;
+	}
+
+	for( u32 phys = first & ~3; phys < end; phys += 4 )
+	{
+		SCachedBlock & block( gCachedBlocks[ (phys >> 2) & (kCachedBlockCount - 1) ] );
+		if( block.StartPC != kInvalidBlockPC &&
+			block.PhysAddress < end && block.PhysAddress + block.NumOps * 4 > start )
+		{
+			block.StartPC = kInvalidBlockPC;
+		}
+	}
+}
 
 void Inter_SelectCore()
 {
-   g_pCPUCore = CPU_Go;
+#if defined(DAEDALUS_BREAKPOINTS_ENABLED) || defined(DAEDALUS_ENABLE_SYNCHRONISATION)
+	// Breakpoints patch ops in memory and sync points are per-op, so use the plain interpreter
+	g_pCPUCore = CPU_Go;
+#else
+	g_pCPUCore = CPU_GoCached;
+#endif
 }
 
 //*****************************************************************************
@@ -139,12 +139,12 @@ void jpeg_decode_PS(OSTask *task)
         return;
     }
 #endif
-    u32       address          = rdram_read_u32((u32)task->t.data_ptr);
-    const u32 macroblock_count = rdram_read_u32((u32)task->t.data_ptr + 4);
-    const u32 mode             = rdram_read_u32((u32)task->t.data_ptr + 8);
-    const u32 qtableY_ptr      = rdram_read_u32((u32)task->t.data_ptr + 12);
-    const u32 qtableU_ptr      = rdram_read_u32((u32)task->t.data_ptr + 16);
-    const u32 qtableV_ptr      = rdram_read_u32((u32)task->t.data_ptr + 20);
+    u32       address          = rdram_read_u32(task->t.data_ptr);
+    const u32 macroblock_count = rdram_read_u32(task->t.data_ptr + 4);
+    const u32 mode             = rdram_read_u32(task->t.data_ptr + 8);
+    const u32 qtableY_ptr      = rdram_read_u32(task->t.data_ptr + 12);
+    const u32 qtableU_ptr      = rdram_read_u32(task->t.data_ptr + 16);
+    const u32 qtableV_ptr      = rdram_read_u32(task->t.data_ptr + 20);
 
     #ifdef DAEDALUS_DEBUG_CONSOLE
     if (mode != 0 && mode != 2)
@@ -202,7 +202,7 @@ void jpeg_decode_OB(OSTask *task)
     s32 u_dc = 0;
     s32 v_dc = 0;
 
-	u32  address  = (u32)task->t.data_ptr;
+	u32  address  = task->t.data_ptr;
 	const u32 macroblock_count = task->t.data_size;
 	const int  qscale   = task->t.yield_data_size;
 
@@ -94,6 +94,8 @@ u32			gRamSize =  kMaximumMemSize;	// Size of emulated RAM
 #ifdef DAEDALUS_PROFILE_EXECUTION
 u32			gTLBReadHit  = 0;
 u32			gTLBWriteHit = 0;
+u32			gTLBReadMiss  = 0;
+u32			gTLBWriteMiss = 0;
 #endif
 
 #ifdef DAED_USE_VIRTUAL_ALLOC
@@ -155,6 +157,30 @@ bool Memory_Init()
 	g_pMemoryBuffers[ MEM_UNUSED    ] = new u8[ MemoryRegionSizes[MEM_UNUSED] ];
 
 #else
+#ifdef DAEDALUS_ENABLE_FASTMEM
+	// RDRAM and SP memory are also mapped into the fastmem window. If the
+	// window can't be set up they're allocated like everything else, and
+	// accesses go through the lookup tables (FastMem_IsDirect is false)
+	u8 * fastmem_rdram = NULL;
+	u8 * fastmem_spmem = NULL;
+	if (FastMem_Init())
+	{
+		fastmem_rdram = FastMem_MapRegion(MEMORY_START_RDRAM, MemoryRegionSizes[MEM_RD_RAM]);
+		fastmem_spmem = FastMem_MapRegion(MEMORY_START_SPMEM, MemoryRegionSizes[MEM_SP_MEM]);
+		if (fastmem_rdram == NULL || fastmem_spmem == NULL)
+		{
+			FastMem_Fini();
+			fastmem_rdram = NULL;
+			fastmem_spmem = NULL;
+		}
+	}
+#ifdef DAEDALUS_DEBUG_CONSOLE
+	if (gFastMemBase == NULL)
+	{
+		DBGConsole_Msg(0, "Fastmem is unavailable, using the memory lookup tables");
+	}
+#endif
+#endif
 	//u32 count = 0;
 	for (u32 m = 0; m < NUM_MEM_BUFFERS; m++)
 	{
@@ -163,6 +189,13 @@ bool Memory_Init()
 		if (region_size > 0)
 		{
 			//count+=region_size;
+#ifdef DAEDALUS_ENABLE_FASTMEM
+			if (m == MEM_RD_RAM && fastmem_rdram != NULL)
+				g_pMemoryBuffers[m] = fastmem_rdram;
+			else if (m == MEM_SP_MEM && fastmem_spmem != NULL)
+				g_pMemoryBuffers[m] = fastmem_spmem;
+			else
+#endif
 			g_pMemoryBuffers[m] = new u8[region_size];
 			//g_pMemoryBuffers[m] = Memory_AllocRegion(region_size);
 
@@ -216,12 +249,20 @@ void Memory_Fini(void)
 #else
 	for (u32 m = 0; m < NUM_MEM_BUFFERS; m++)
 	{
+#ifdef DAEDALUS_ENABLE_FASTMEM
+		// Released by FastMem_Fini(), unless fastmem couldn't be set up
+		if (gFastMemBase != NULL && (m == MEM_RD_RAM || m == MEM_SP_MEM))
+			continue;
+#endif
 		if (g_pMemoryBuffers[m] != NULL)
 		{
 			delete [] (u8*)(g_pMemoryBuffers[m]);
 			g_pMemoryBuffers[m] = NULL;
 		}
 	}
+#ifdef DAEDALUS_ENABLE_FASTMEM
+	FastMem_Fini();
+#endif
 #endif
 
 	g_pu8RamBase_8000 = NULL;
@@ -290,7 +331,7 @@ static void Memory_Tlb_Hack()
 	   u32 start_addr = 0x7F000000 >> 18;
 	   u32 end_addr   = 0x7FFFFFFF >> 18;
 
-	   u8 * pRead = (u8*)(reinterpret_cast< u32 >(rom_address) + offset - (start_addr << 18));
+	   u8 * pRead = (u8*)(reinterpret_cast< uintptr_t >(rom_address) + offset - (start_addr << 18));
 
 	   for (u32 i = start_addr; i <= end_addr; i++)
 	   {
@@ -298,7 +339,7 @@ static void Memory_Tlb_Hack()
 	   }
 	}
 
-	g_MemoryLookupTableRead[0x70000000 >> 18].pRead = (u8*)(reinterpret_cast< u32 >( g_pMemoryBuffers[MEM_RD_RAM]) - 0x70000000);
+	g_MemoryLookupTableRead[0x70000000 >> 18].pRead = (u8*)(reinterpret_cast< uintptr_t >( g_pMemoryBuffers[MEM_RD_RAM]) - 0x70000000);
 }
 
 static void Memory_InitFunc(u32 start, u32 size, const u32 ReadRegion, const u32 WriteRegion, mReadFunction ReadFunc, mWriteFunction WriteFunc)
@@ -316,14 +357,14 @@ static void Memory_InitFunc(u32 start, u32 size, const u32 ReadRegion, const u32
 
 		if (ReadRegion)
 		{
-			g_MemoryLookupTableRead[start_addr|(0x8000>>2)].pRead = (u8*)(reinterpret_cast< u32 >(g_pMemoryBuffers[ReadRegion]) - (((start>>16)|0x8000) << 16));
-			g_MemoryLookupTableRead[start_addr|(0xA000>>2)].pRead = (u8*)(reinterpret_cast< u32 >(g_pMemoryBuffers[ReadRegion]) - (((start>>16)|0xA000) << 16));
+			g_MemoryLookupTableRead[start_addr|(0x8000>>2)].pRead = (u8*)(reinterpret_cast< uintptr_t >(g_pMemoryBuffers[ReadRegion]) - (((start>>16)|0x8000) << 16));
+			g_MemoryLookupTableRead[start_addr|(0xA000>>2)].pRead = (u8*)(reinterpret_cast< uintptr_t >(g_pMemoryBuffers[ReadRegion]) - (((start>>16)|0xA000) << 16));
 		}
 
 		if (WriteRegion)
 		{
-			g_MemoryLookupTableWrite[start_addr|(0x8000>>2)].pWrite = (u8*)(reinterpret_cast< u32 >(g_pMemoryBuffers[WriteRegion]) - (((start>>16)|0x8000) << 16));
-			g_MemoryLookupTableWrite[start_addr|(0xA000>>2)].pWrite = (u8*)(reinterpret_cast< u32 >(g_pMemoryBuffers[WriteRegion]) - (((start>>16)|0xA000) << 16));
+			g_MemoryLookupTableWrite[start_addr|(0x8000>>2)].pWrite = (u8*)(reinterpret_cast< uintptr_t >(g_pMemoryBuffers[WriteRegion]) - (((start>>16)|0x8000) << 16));
+			g_MemoryLookupTableWrite[start_addr|(0xA000>>2)].pWrite = (u8*)(reinterpret_cast< uintptr_t >(g_pMemoryBuffers[WriteRegion]) - (((start>>16)|0xA000) << 16));
 		}
 
 		start_addr++;
@@ -381,6 +422,10 @@ void Memory_InitTables()
 		WriteValue_8000_807F
 	);
 
+#ifdef DAEDALUS_ENABLE_FASTMEM
+	FastMem_SetAccessible(MEMORY_START_EXRDRAM, MEMORY_SIZE_EXRDRAM, ram_size == MEMORY_8_MEG);
+#endif
+
 	// Need to turn off the EPAK
 	if (ram_size != MEMORY_8_MEG)
 	{
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifndef CORE_MEMORY_H_
 #define CORE_MEMORY_H_
 
+#include "Core/FastMem.h"
 #include "OSHLE/ultra_rcp.h"
 #include "Utility/AtomicPrimitives.h"
 #include "Utility/Endian.h"
@@ -77,6 +78,8 @@ extern u32		gRamSize;
 #ifdef DAEDALUS_PROFILE_EXECUTION
 extern u32		gTLBReadHit;
 extern u32		gTLBWriteHit;
+extern u32		gTLBReadMiss;
+extern u32		gTLBWriteMiss;
 #endif
 extern void *	g_pMemoryBuffers[NUM_MEM_BUFFERS];
 extern const u32 MemoryRegionSizes[NUM_MEM_BUFFERS];
@@ -256,6 +259,19 @@ inline void Write32Bits( u32 address, u32 data )	{ MEMORY_CHECK_ALIGN( address,
 inline void Write16Bits( u32 address, u16 data )	{ MEMORY_CHECK_ALIGN( address, 2 ); *(u16 *)ReadAddress(address) = data; }
 inline void Write8Bits( u32 address, u8 data )		{                                   *(u8 *)ReadAddress(address) = data;}
 
+#elif (DAEDALUS_ENDIAN_MODE == DAEDALUS_ENDIAN_LITTLE) && defined(DAEDALUS_ENABLE_FASTMEM)
+
+// KSEG0/KSEG1 go straight through the fastmem window, anything else is TLB mapped
+inline u64 Read64Bits( u32 address )				{ MEMORY_CHECK_ALIGN( address, 8 ); u64 data = FastMem_IsDirect( address ) ? FastMem_Read64( address ) : *(u64 *)ReadAddress( address ); return (data>>32) + (data<<32); }
+inline u32 Read32Bits( u32 address )				{ MEMORY_CHECK_ALIGN( address, 4 ); return FastMem_IsDirect( address ) ? FastMem_Read32( address ) : *(u32 *)ReadAddress( address ); }
+inline u16 Read16Bits( u32 address )				{ MEMORY_CHECK_ALIGN( address, 2 ); address ^= U16_TWIDDLE; return FastMem_IsDirect( address ) ? FastMem_Read16( address ) : *(u16 *)ReadAddress( address ); }
+inline u8 Read8Bits( u32 address )					{                                   address ^= U8_TWIDDLE;  return FastMem_IsDirect( address ) ? FastMem_Read8( address ) : *(u8 *)ReadAddress( address ); }
+
+inline void Write64Bits( u32 address, u64 data )	{ MEMORY_CHECK_ALIGN( address, 8 ); data = (data>>32) + (data<<32); if( FastMem_IsDirect( address ) ) FastMem_Write64( address, data ); else *(u64 *)ReadAddress( address ) = data; }
+inline void Write32Bits( u32 address, u32 data )	{ MEMORY_CHECK_ALIGN( address, 4 ); if( FastMem_IsDirect( address ) ) FastMem_Write32( address, data ); else WriteAddress(address, data); }
+inline void Write16Bits( u32 address, u16 data )	{ MEMORY_CHECK_ALIGN( address, 2 ); address ^= U16_TWIDDLE; if( FastMem_IsDirect( address ) ) FastMem_Write16( address, data ); else *(u16 *)ReadAddress(address) = data; }
+inline void Write8Bits( u32 address, u8 data )		{                                   address ^= U8_TWIDDLE;  if( FastMem_IsDirect( address ) ) FastMem_Write8( address, data ); else *(u8 *)ReadAddress(address) = data; }
+
 #elif (DAEDALUS_ENDIAN_MODE == DAEDALUS_ENDIAN_LITTLE)
 
 inline u64 Read64Bits( u32 address )				{ MEMORY_CHECK_ALIGN( address, 8 ); u64 data = *(u64 *)ReadAddress( address ); data = (data>>32) + (data<<32); return data; }
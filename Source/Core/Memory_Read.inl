@@ -32,12 +32,20 @@ static void * ReadInvalid( u32 address )
 
 static void * ReadMapped( u32 address )
 {
-	bool missing;
+	u8 * base = TLB_GetReadBase( address );
+	if( DAEDALUS_EXPECT_LIKELY( base != NULL ) )
+	{
+#ifdef DAEDALUS_PROFILE_EXECUTION
+		gTLBReadHit++;
+#endif
+		return base + address;
+	}
 
 #ifdef DAEDALUS_PROFILE_EXECUTION
-	gTLBReadHit++;
+	gTLBReadMiss++;
 #endif
 
+	bool missing;
 	u32 physical_addr = TLBEntry::Translate(address, missing);
 	if (physical_addr != 0)
 	{
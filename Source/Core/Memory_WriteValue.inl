@@ -27,12 +27,21 @@ static void WriteValueInvalid( u32 address, u32 value )
 
 static void WriteValueMapped( u32 address, u32 value )
 {
-	bool missing;
+	u8 * base = TLB_GetWriteBase( address );
+	if( DAEDALUS_EXPECT_LIKELY( base != NULL ) )
+	{
+#ifdef DAEDALUS_PROFILE_EXECUTION
+		gTLBWriteHit++;
+#endif
+		*(u32*)(base + address) = value;
+		return;
+	}
 
 #ifdef DAEDALUS_PROFILE_EXECUTION
-	gTLBWriteHit++;
+	gTLBWriteMiss++;
 #endif
 
+	bool missing;
 	u32 physical_addr = TLBEntry::Translate(address, missing);
 	if (physical_addr != 0)
 	{
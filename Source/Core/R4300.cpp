@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ROM.h"
 
 #include "Config/ConfigOptions.h"
+#include "Core/FPUConvert.h"
 #include "Core/Registers.h"			// For REG_?? defines
 #include "Debug/DBGConsole.h"
 #include "Debug/DebugLog.h"
@@ -126,6 +127,9 @@ enum ERoundingMode
 	RM_NUM_MODES,
 };
 static ERoundingMode	gRoundingMode( RM_ROUND );
+#ifndef DAEDALUS_PSP
+static ERoundingMode	gHostRoundingMode( RM_ROUND );		// What we last set the host to
+#endif
 
 #if defined(DAEDALUS_PSP)
 
@@ -157,7 +161,11 @@ static const int		gNativeRoundingModes[ RM_NUM_MODES ] =
 
 DAEDALUS_FORCEINLINE void SET_ROUND_MODE( ERoundingMode mode )
 {
-	_controlfp( gNativeRoundingModes[ mode ], _MCW_RC );
+	if( mode != gHostRoundingMode )
+	{
+		_controlfp( gNativeRoundingModes[ mode ], _MCW_RC );
+		gHostRoundingMode = mode;
+	}
 }
 
 #elif defined(DAEDALUS_OSX) || defined(DAEDALUS_LINUX)
@@ -170,9 +178,15 @@ static const int		gNativeRoundingModes[ RM_NUM_MODES ] =
 	FE_DOWNWARD,	// RM_FLOOR,
 };
 
+// The conversions below don't need the host's mode, so in practice this
+// only writes to the control register when CTC1 changes the guest's mode
 inline void SET_ROUND_MODE( ERoundingMode mode )
 {
-	fesetround( gNativeRoundingModes[ mode ] );
+	if( mode != gHostRoundingMode )
+	{
+		fesetround( gNativeRoundingModes[ mode ] );
+		gHostRoundingMode = mode;
+	}
 }
 
 #else
@@ -420,10 +434,11 @@ inline s64 d64_to_s64( d64 x )						{ pspFpuSetRoundmode( gNativeRoundingModes[
 
 #else
 
-DAEDALUS_FORCEINLINE s32 f32_to_s32_trunc( f32 x )	{ SET_ROUND_MODE( RM_TRUNC ); return (s32)truncf(x); }
-DAEDALUS_FORCEINLINE s32 f32_to_s32_round( f32 x )	{ SET_ROUND_MODE( RM_ROUND ); return (s32)roundf(x); }
-DAEDALUS_FORCEINLINE s32 f32_to_s32_ceil( f32 x )	{ SET_ROUND_MODE( RM_CEIL ); return (s32)ceilf(x); }
-DAEDALUS_FORCEINLINE s32 f32_to_s32_floor( f32 x )	{ SET_ROUND_MODE( RM_FLOOR ); return (s32)floorf(x); }
+// Rounding is explicit (see FPUConvert.h), so these leave the host's mode alone
+DAEDALUS_FORCEINLINE s32 f32_to_s32_trunc( f32 x )	{ return (s32)x; }
+DAEDALUS_FORCEINLINE s32 f32_to_s32_round( f32 x )	{ return (s32)FPU_RoundNearest(x); }
+DAEDALUS_FORCEINLINE s32 f32_to_s32_ceil( f32 x )	{ return (s32)FPU_RoundCeil(x); }
+DAEDALUS_FORCEINLINE s32 f32_to_s32_floor( f32 x )	{ return (s32)FPU_RoundFloor(x); }
 DAEDALUS_FORCEINLINE s32 f32_to_s32( f32 x )	
 { 
 #ifdef ACCURATE_CVT
@@ -440,10 +455,10 @@ DAEDALUS_FORCEINLINE s32 f32_to_s32( f32 x )
 	return (s32)x;
 #endif
 }
-DAEDALUS_FORCEINLINE s64 f32_to_s64_trunc( f32 x )	{ SET_ROUND_MODE( RM_TRUNC ); return (s64)truncf(x); }
-DAEDALUS_FORCEINLINE s64 f32_to_s64_round( f32 x )	{ SET_ROUND_MODE( RM_ROUND ); return (s64)roundf(x); }
-DAEDALUS_FORCEINLINE s64 f32_to_s64_ceil( f32 x )	{ SET_ROUND_MODE( RM_CEIL ); return (s64)ceilf(x); }
-DAEDALUS_FORCEINLINE s64 f32_to_s64_floor( f32 x )	{ SET_ROUND_MODE( RM_FLOOR ); return (s64)floorf(x); }
+DAEDALUS_FORCEINLINE s64 f32_to_s64_trunc( f32 x )	{ return (s64)x; }
+DAEDALUS_FORCEINLINE s64 f32_to_s64_round( f32 x )	{ return (s64)FPU_RoundNearest(x); }
+DAEDALUS_FORCEINLINE s64 f32_to_s64_ceil( f32 x )	{ return (s64)FPU_RoundCeil(x); }
+DAEDALUS_FORCEINLINE s64 f32_to_s64_floor( f32 x )	{ return (s64)FPU_RoundFloor(x); }
 DAEDALUS_FORCEINLINE s64 f32_to_s64( f32 x ) 
 { 
 #ifdef ACCURATE_CVT
@@ -460,10 +475,10 @@ DAEDALUS_FORCEINLINE s64 f32_to_s64( f32 x )
 	return (s64)x; 
 #endif
 }
-DAEDALUS_FORCEINLINE s32 d64_to_s32_trunc( d64 x )	{ SET_ROUND_MODE( RM_TRUNC ); return (s32)trunc(x); }
-DAEDALUS_FORCEINLINE s32 d64_to_s32_round( d64 x )	{ SET_ROUND_MODE( RM_ROUND ); return (s32)round(x); }
-DAEDALUS_FORCEINLINE s32 d64_to_s32_ceil( d64 x )	{ SET_ROUND_MODE( RM_CEIL ); return (s32)ceil(x); }
-DAEDALUS_FORCEINLINE s32 d64_to_s32_floor( d64 x )	{ SET_ROUND_MODE( RM_FLOOR ); return (s32)floor(x); }
+DAEDALUS_FORCEINLINE s32 d64_to_s32_trunc( d64 x )	{ return (s32)x; }
+DAEDALUS_FORCEINLINE s32 d64_to_s32_round( d64 x )	{ return (s32)FPU_RoundNearest(x); }
+DAEDALUS_FORCEINLINE s32 d64_to_s32_ceil( d64 x )	{ return (s32)FPU_RoundCeil(x); }
+DAEDALUS_FORCEINLINE s32 d64_to_s32_floor( d64 x )	{ return (s32)FPU_RoundFloor(x); }
 DAEDALUS_FORCEINLINE s32 d64_to_s32( d64 x )
 {
 #ifdef ACCURATE_CVT
@@ -480,10 +495,10 @@ DAEDALUS_FORCEINLINE s32 d64_to_s32( d64 x )
 	return (s32)x; 
 #endif
 }
-DAEDALUS_FORCEINLINE s64 d64_to_s64_trunc( d64 x ) { SET_ROUND_MODE( RM_TRUNC ); return (s64)trunc(x); }
-DAEDALUS_FORCEINLINE s64 d64_to_s64_round( d64 x ) { SET_ROUND_MODE( RM_ROUND ); return (s64)round(x); }
-DAEDALUS_FORCEINLINE s64 d64_to_s64_ceil( d64 x )  { SET_ROUND_MODE( RM_CEIL ); return (s64)ceil(x); }
-DAEDALUS_FORCEINLINE s64 d64_to_s64_floor( d64 x ) { SET_ROUND_MODE( RM_FLOOR ); return (s64)floor(x); }
+DAEDALUS_FORCEINLINE s64 d64_to_s64_trunc( d64 x ) { return (s64)x; }
+DAEDALUS_FORCEINLINE s64 d64_to_s64_round( d64 x ) { return (s64)FPU_RoundNearest(x); }
+DAEDALUS_FORCEINLINE s64 d64_to_s64_ceil( d64 x )  { return (s64)FPU_RoundCeil(x); }
+DAEDALUS_FORCEINLINE s64 d64_to_s64_floor( d64 x ) { return (s64)FPU_RoundFloor(x); }
 DAEDALUS_FORCEINLINE s64 d64_to_s64( d64 x )
 { 
 #ifdef ACCURATE_CVT
@@ -1366,7 +1381,6 @@ static void R4300_CALL_TYPE R4300_CACHE( R4300_CALL_SIGNATURE )
 
 //	return;
 
-#ifdef DAEDALUS_ENABLE_DYNAREC
 	u32 cache_op  = op_code.rt;
 
 	u32 address = (u32)( gGPR[op_code.base]._s32_0 + (s32)(s16)op_code.immediate );
@@ -1382,7 +1396,6 @@ static void R4300_CALL_TYPE R4300_CACHE( R4300_CALL_SIGNATURE )
 	}
 
 	//DBGConsole_Msg(0, "CACHE %s/%d, 0x%08x", gCacheNames[dwCache], dwAction, address);
-#endif
 }
 
 static void R4300_CALL_TYPE R4300_LWC1( R4300_CALL_SIGNATURE ) 				// Load Word to Copro 1 (FPU)
@@ -2231,6 +2244,15 @@ static void R4300_CALL_TYPE R4300_Cop0_MTC0( R4300_CALL_SIGNATURE )
 			//DBGConsole_Msg(0, "Setting PageMask register to 0x%08x", new_value);
 			break;
 
+		case C0_ENTRYHI:
+			// Non-global pages cached in the TLB page table belong to the current ASID
+			if( (new_value ^ gCPUState.CPUControl[C0_ENTRYHI]._u32) & TLBHI_PIDMASK )
+			{
+				TLB_InvalidatePageTable();
+			}
+			gCPUState.CPUControl[C0_ENTRYHI]._u32 = new_value;
+			break;
+
 		case C0_WIRED:
 			// Set to top limit on write to wired
 			gCPUState.CPUControl[C0_RAND]._u32 = 31;
@@ -3642,6 +3664,9 @@ static void R4300_CALL_TYPE R4300_Cop1_D_NGT( R4300_CALL_SIGNATURE )
 }
 
 #include "R4300_Jump.inl"		// Jump table
+#ifdef DAEDALUS_THREADED_INTERPRETER
+#include "R4300_Threaded.inl"	// Label table built from the jump tables
+#endif
 
 CPU_Instruction	R4300_GetInstructionHandler( OpCode op_code )
 {
@@ -3715,4 +3740,8 @@ void R4300_Init()
 		R4300Cop1Instruction[Cop1Op_CTC1]	= R4300_Cop1_CTC1;
 	}
 #endif
+#ifdef DAEDALUS_THREADED_INTERPRETER
+	// Pick up the swaps above
+	R4300_ExecuteThreadedOps( NULL, 0, NULL );
+#endif
 }
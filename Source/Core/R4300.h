@@ -40,4 +40,16 @@ inline void			R4300_ExecuteInstruction( OpCode op_code )
 	R4300Instruction[ op_code.op ]( op_code._u32 );
 }
 
+#ifdef DAEDALUS_THREADED_INTERPRETER
+// An op decoded for R4300_ExecuteThreadedOps()
+struct SThreadedOp
+{
+	const void *	Label;
+	OpCode			Op;
+};
+
+const void *	R4300_GetThreadedLabel( OpCode op_code );
+u32				R4300_ExecuteThreadedOps( const SThreadedOp * p_ops, u32 num_ops, const u8 * p_code );
+#endif
+
 #endif // CORE_R4300_H_
@@ -0,0 +1,261 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//*****************************************************************************
+//	Threaded interpreter dispatch (DAEDALUS_THREADED_INTERPRETER)
+//
+//	The cached interpreter (see Core/Interpret.cpp) decodes each op once into
+//	a label in R4300_ExecuteThreadedOps(), rather than into a handler that is
+//	called through R4300Instruction[] and the second level tables. Every
+//	handler gets its own label, which ends by jumping straight to the next
+//	op's label, so the host sees one indirect jump per op (which it can
+//	predict per handler) and the handlers can be inlined.
+//
+//	Needs GCC/Clang (labels as values). Included by R4300.cpp after the
+//	jump tables, which the label table is built from.
+//*****************************************************************************
+
+//	Every leaf handler in R4300_Jump.inl. Anything missing goes through
+//	R4300_ExecuteInstruction(), so this only needs to be kept up to date for speed.
+#define R4300_THREADED_HANDLERS( X ) \
+	X( R4300_J ) X( R4300_JAL ) X( R4300_BEQ ) X( R4300_BNE ) X( R4300_BLEZ ) X( R4300_BGTZ ) \
+	X( R4300_ADDI ) X( R4300_ADDIU ) X( R4300_SLTI ) X( R4300_SLTIU ) X( R4300_ANDI ) X( R4300_ORI ) \
+	X( R4300_XORI ) X( R4300_LUI ) X( R4300_Unk ) X( R4300_BEQL ) X( R4300_BNEL ) X( R4300_BLEZL ) \
+	X( R4300_BGTZL ) X( R4300_DADDI ) X( R4300_DADDIU ) X( R4300_LDL ) X( R4300_LDR ) X( R4300_LB ) \
+	X( R4300_LH ) X( R4300_LWL ) X( R4300_LW ) X( R4300_LBU ) X( R4300_LHU ) X( R4300_LWR ) \
+	X( R4300_LWU ) X( R4300_SB ) X( R4300_SH ) X( R4300_SWL ) X( R4300_SW ) X( R4300_SDL ) \
+	X( R4300_SDR ) X( R4300_SWR ) X( R4300_CACHE ) X( R4300_LL ) X( R4300_LLD ) X( R4300_LDC2 ) \
+	X( R4300_LD ) X( R4300_SC ) X( R4300_DBG_Bkpt ) X( R4300_SCD ) X( R4300_SDC2 ) X( R4300_SD ) \
+	X( R4300_Special_SLL ) X( R4300_Special_Unk ) X( R4300_Special_SRL ) X( R4300_Special_SRA ) X( R4300_Special_SLLV ) X( R4300_Special_SRLV ) \
+	X( R4300_Special_SRAV ) X( R4300_Special_JR ) X( R4300_Special_JALR ) X( R4300_Special_SYSCALL ) X( R4300_Special_BREAK ) X( R4300_Special_SYNC ) \
+	X( R4300_Special_MFHI ) X( R4300_Special_MTHI ) X( R4300_Special_MFLO ) X( R4300_Special_MTLO ) X( R4300_Special_DSLLV ) X( R4300_Special_DSRLV ) \
+	X( R4300_Special_DSRAV ) X( R4300_Special_MULT ) X( R4300_Special_MULTU ) X( R4300_Special_DIV ) X( R4300_Special_DIVU ) X( R4300_Special_DMULT ) \
+	X( R4300_Special_DMULTU ) X( R4300_Special_DDIV ) X( R4300_Special_DDIVU ) X( R4300_Special_ADD ) X( R4300_Special_ADDU ) X( R4300_Special_SUB ) \
+	X( R4300_Special_SUBU ) X( R4300_Special_AND ) X( R4300_Special_OR ) X( R4300_Special_XOR ) X( R4300_Special_NOR ) X( R4300_Special_SLT ) \
+	X( R4300_Special_SLTU ) X( R4300_Special_DADD ) X( R4300_Special_DADDU ) X( R4300_Special_DSUB ) X( R4300_Special_DSUBU ) X( R4300_Special_TGE ) \
+	X( R4300_Special_TGEU ) X( R4300_Special_TLT ) X( R4300_Special_TLTU ) X( R4300_Special_TEQ ) X( R4300_Special_TNE ) X( R4300_Special_DSLL ) \
+	X( R4300_Special_DSRL ) X( R4300_Special_DSRA ) X( R4300_Special_DSLL32 ) X( R4300_Special_DSRL32 ) X( R4300_Special_DSRA32 ) X( R4300_RegImm_BLTZ ) \
+	X( R4300_RegImm_BGEZ ) X( R4300_RegImm_BLTZL ) X( R4300_RegImm_BGEZL ) X( R4300_RegImm_Unk ) X( R4300_RegImm_TGEI ) X( R4300_RegImm_TGEIU ) \
+	X( R4300_RegImm_TLTI ) X( R4300_RegImm_TLTIU ) X( R4300_RegImm_TEQI ) X( R4300_RegImm_TNEI ) X( R4300_RegImm_BLTZAL ) X( R4300_RegImm_BGEZAL ) \
+	X( R4300_RegImm_BLTZALL ) X( R4300_RegImm_BGEZALL ) X( R4300_Cop0_MFC0 ) X( R4300_Cop0_Unk ) X( R4300_Cop0_MTC0 ) X( R4300_TLB_Unk ) \
+	X( R4300_TLB_TLBR ) X( R4300_TLB_TLBWI ) X( R4300_TLB_TLBWR ) X( R4300_TLB_TLBP ) X( R4300_TLB_ERET )
+
+//	As above, but only valid when COP1 is usable. R4300_SetSR() swaps the
+//	top level handlers for these, so the labels check SR_CU1 themselves.
+#define R4300_THREADED_COP1_HANDLERS( X ) \
+	X( R4300_LWC1 ) X( R4300_LDC1 ) X( R4300_SWC1 ) X( R4300_SDC1 ) X( R4300_Cop1_MFC1 ) X( R4300_Cop1_DMFC1 ) \
+	X( R4300_Cop1_CFC1 ) X( R4300_Cop1_Unk ) X( R4300_Cop1_MTC1 ) X( R4300_Cop1_DMTC1 ) X( R4300_Cop1_CTC1 ) X( R4300_Cop1_WInstr ) \
+	X( R4300_Cop1_LInstr ) X( R4300_BC1_BC1F ) X( R4300_BC1_BC1T ) X( R4300_BC1_BC1FL ) X( R4300_BC1_BC1TL ) X( R4300_Cop1_S_ADD ) \
+	X( R4300_Cop1_S_SUB ) X( R4300_Cop1_S_MUL ) X( R4300_Cop1_S_DIV ) X( R4300_Cop1_S_SQRT ) X( R4300_Cop1_S_ABS ) X( R4300_Cop1_S_MOV ) \
+	X( R4300_Cop1_S_NEG ) X( R4300_Cop1_S_ROUND_L ) X( R4300_Cop1_S_TRUNC_L ) X( R4300_Cop1_S_CEIL_L ) X( R4300_Cop1_S_FLOOR_L ) X( R4300_Cop1_S_ROUND_W ) \
+	X( R4300_Cop1_S_TRUNC_W ) X( R4300_Cop1_S_CEIL_W ) X( R4300_Cop1_S_FLOOR_W ) X( R4300_Cop1_S_Unk ) X( R4300_Cop1_S_CVT_D ) X( R4300_Cop1_S_CVT_W ) \
+	X( R4300_Cop1_S_CVT_L ) X( R4300_Cop1_S_F ) X( R4300_Cop1_S_UN ) X( R4300_Cop1_S_EQ ) X( R4300_Cop1_S_UEQ ) X( R4300_Cop1_S_OLT ) \
+	X( R4300_Cop1_S_ULT ) X( R4300_Cop1_S_OLE ) X( R4300_Cop1_S_ULE ) X( R4300_Cop1_S_SF ) X( R4300_Cop1_S_NGLE ) X( R4300_Cop1_S_SEQ ) \
+	X( R4300_Cop1_S_NGL ) X( R4300_Cop1_S_LT ) X( R4300_Cop1_S_NGE ) X( R4300_Cop1_S_LE ) X( R4300_Cop1_S_NGT ) X( R4300_Cop1_D_ADD ) \
+	X( R4300_Cop1_D_SUB ) X( R4300_Cop1_D_MUL ) X( R4300_Cop1_D_DIV ) X( R4300_Cop1_D_SQRT ) X( R4300_Cop1_D_ABS ) X( R4300_Cop1_D_MOV ) \
+	X( R4300_Cop1_D_NEG ) X( R4300_Cop1_D_ROUND_L ) X( R4300_Cop1_D_TRUNC_L ) X( R4300_Cop1_D_CEIL_L ) X( R4300_Cop1_D_FLOOR_L ) X( R4300_Cop1_D_ROUND_W ) \
+	X( R4300_Cop1_D_TRUNC_W ) X( R4300_Cop1_D_CEIL_W ) X( R4300_Cop1_D_FLOOR_W ) X( R4300_Cop1_D_Unk ) X( R4300_Cop1_D_CVT_S ) X( R4300_Cop1_D_CVT_W ) \
+	X( R4300_Cop1_D_CVT_L ) X( R4300_Cop1_D_F ) X( R4300_Cop1_D_UN ) X( R4300_Cop1_D_EQ ) X( R4300_Cop1_D_UEQ ) X( R4300_Cop1_D_OLT ) \
+	X( R4300_Cop1_D_ULT ) X( R4300_Cop1_D_OLE ) X( R4300_Cop1_D_ULE ) X( R4300_Cop1_D_SF ) X( R4300_Cop1_D_NGLE ) X( R4300_Cop1_D_SEQ ) \
+	X( R4300_Cop1_D_NGL ) X( R4300_Cop1_D_LT ) X( R4300_Cop1_D_NGE ) X( R4300_Cop1_D_LE ) X( R4300_Cop1_D_NGT )
+
+//	Offsets of each table in the flat label table
+enum EThreadedTable
+{
+	TT_PRIMARY	= 0,
+	TT_SPECIAL	= TT_PRIMARY + 64,
+	TT_REGIMM	= TT_SPECIAL + 64,
+	TT_COP0		= TT_REGIMM + 32,
+	TT_TLB		= TT_COP0 + 32,
+	TT_COP1		= TT_TLB + 64,
+	TT_BC1		= TT_COP1 + 32,
+	TT_COP1_S	= TT_BC1 + 4,
+	TT_COP1_D	= TT_COP1_S + 64,
+	TT_NUM_ENTRIES = TT_COP1_D + 64,
+};
+
+struct SThreadedHandler
+{
+	CPU_Instruction		Handler;
+	const void *		Label;
+};
+
+static const void *		gThreadedLabels[ TT_NUM_ENTRIES ];
+
+static u32	R4300_GetThreadedIndex( OpCode op_code )
+{
+	switch( op_code.op )
+	{
+	case OP_SPECOP:
+		return TT_SPECIAL + op_code.spec_op;
+
+	case OP_REGIMM:
+		return TT_REGIMM + op_code.regimm_op;
+
+	case OP_COPRO0:
+		return op_code.cop0_op == Cop0Op_TLB ? TT_TLB + op_code.cop0tlb_funct : TT_COP0 + op_code.cop0_op;
+
+	case OP_COPRO1:
+		switch( op_code.cop1_op )
+		{
+		case Cop1Op_BCInstr:	return TT_BC1 + op_code.cop1_bc;
+		case Cop1Op_SInstr:		return TT_COP1_S + op_code.cop1_funct;
+		case Cop1Op_DInstr:		return TT_COP1_D + op_code.cop1_funct;
+		default:				return TT_COP1 + op_code.cop1_op;
+		}
+
+	default:
+		return TT_PRIMARY + op_code.op;
+	}
+}
+
+static const void *	R4300_FindThreadedLabel( CPU_Instruction handler, const SThreadedHandler * p_handlers, u32 num_handlers, const void * p_default )
+{
+	for( u32 i = 0; i < num_handlers; ++i )
+	{
+		if( p_handlers[ i ].Handler == handler )
+			return p_handlers[ i ].Label;
+	}
+	return p_default;
+}
+
+static void	R4300_BuildThreadedTable( u32 offset, const CPU_Instruction * p_table, u32 count, const SThreadedHandler * p_handlers, u32 num_handlers, const void * p_default )
+{
+	for( u32 i = 0; i < count; ++i )
+	{
+		gThreadedLabels[ offset + i ] = R4300_FindThreadedLabel( p_table[ i ], p_handlers, num_handlers, p_default );
+	}
+}
+
+DAEDALUS_FORCEINLINE bool R4300_ThreadedOpDone( u32 next_pc )
+{
+	gGPR[0]._u64 = 0;	//Ensure r0 is zero
+
+	switch (gCPUState.Delay)
+	{
+	case DO_DELAY:
+		INCREMENT_PC();
+		gCPUState.Delay = EXEC_DELAY;
+		break;
+	case EXEC_DELAY:
+		CPU_SetPC(gCPUState.TargetPC);
+		gCPUState.Delay = NO_DELAY;
+		break;
+	case NO_DELAY:
+		INCREMENT_PC();
+		break;
+	default:
+		NODEFAULT;
+	}
+
+	// Bail out on exceptions/interrupts, or if the op didn't fall through
+	// to the next decoded op (e.g. a likely branch skipping its delay slot)
+	return gCPUState.GetStuffToDo() == 0 && gCPUState.CurrentPC == next_pc;
+}
+
+//*****************************************************************************
+//	Executes up to num_ops decoded ops, starting at gCPUState.CurrentPC.
+//	Returns the number executed. Called with p_ops == NULL to (re)build
+//	gThreadedLabels from the current jump tables.
+//*****************************************************************************
+u32 R4300_ExecuteThreadedOps( const SThreadedOp * p_ops, u32 num_ops, const u8 * p_code )
+{
+#define R4300_THREADED_ENTRY( fn )	{ fn, &&L_##fn },
+	static const SThreadedHandler	handlers[] =
+	{
+		R4300_THREADED_HANDLERS( R4300_THREADED_ENTRY )
+		R4300_THREADED_COP1_HANDLERS( R4300_THREADED_ENTRY )
+	};
+#undef R4300_THREADED_ENTRY
+
+	if( p_ops == NULL )
+	{
+		const u32		num_handlers( sizeof( handlers ) / sizeof( handlers[ 0 ] ) );
+		const void *	p_default( &&L_Dispatch );
+
+		R4300_BuildThreadedTable( TT_PRIMARY, R4300Instruction, 64, handlers, num_handlers, p_default );
+		R4300_BuildThreadedTable( TT_SPECIAL, R4300SpecialInstruction, 64, handlers, num_handlers, p_default );
+		R4300_BuildThreadedTable( TT_REGIMM, R4300RegImmInstruction, 32, handlers, num_handlers, p_default );
+		R4300_BuildThreadedTable( TT_COP0, R4300Cop0Instruction, 32, handlers, num_handlers, p_default );
+		R4300_BuildThreadedTable( TT_TLB, R4300TLBInstruction, 64, handlers, num_handlers, p_default );
+		R4300_BuildThreadedTable( TT_COP1, R4300Cop1Instruction, 32, handlers, num_handlers, p_default );
+		R4300_BuildThreadedTable( TT_BC1, R4300Cop1BC1Instruction, 4, handlers, num_handlers, p_default );
+		R4300_BuildThreadedTable( TT_COP1_S, R4300Cop1SInstruction, 64, handlers, num_handlers, p_default );
+		R4300_BuildThreadedTable( TT_COP1_D, R4300Cop1DInstruction, 64, handlers, num_handlers, p_default );
+
+		// R4300Instruction[] may hold R4300_CoPro1_Disabled for these right now
+		gThreadedLabels[ TT_PRIMARY + OP_LWC1 ] = &&L_R4300_LWC1;
+		gThreadedLabels[ TT_PRIMARY + OP_LDC1 ] = &&L_R4300_LDC1;
+		gThreadedLabels[ TT_PRIMARY + OP_SWC1 ] = &&L_R4300_SWC1;
+		gThreadedLabels[ TT_PRIMARY + OP_SDC1 ] = &&L_R4300_SDC1;
+		return 0;
+	}
+
+	DAEDALUS_ASSERT( num_ops > 0, "Nothing to execute" );
+
+	const u32			pc( gCPUState.CurrentPC );
+	const SThreadedOp *	p_op( p_ops );
+	u32					ops_executed( 0 );
+
+#define R4300_THREADED_NEXT()													\
+	++ops_executed;																\
+	if( !R4300_ThreadedOpDone( pc + ops_executed * 4 ) || ops_executed == num_ops )	\
+		return ops_executed;													\
+	++p_op;																		\
+	gLastAddress = const_cast< u8 * >( p_code ) + ops_executed * 4;				\
+	goto *p_op->Label
+
+#define R4300_THREADED_OP( fn )													\
+	L_##fn:																		\
+	fn( p_op->Op._u32 );														\
+	R4300_THREADED_NEXT();
+
+#define R4300_THREADED_COP1_OP( fn )											\
+	L_##fn:																		\
+	if( DAEDALUS_EXPECT_UNLIKELY( (gCPUState.CPUControl[C0_SR]._u32 & SR_CU1) == 0 ) )	\
+		R4300_CoPro1_Disabled( p_op->Op._u32 );									\
+	else																		\
+		fn( p_op->Op._u32 );													\
+	R4300_THREADED_NEXT();
+
+	// Cache instruction base pointer (used for SpeedHack() @ R4300.0)
+	gLastAddress = const_cast< u8 * >( p_code );
+	goto *p_op->Label;
+
+	R4300_THREADED_HANDLERS( R4300_THREADED_OP )
+	R4300_THREADED_COP1_HANDLERS( R4300_THREADED_COP1_OP )
+
+L_Dispatch:
+	R4300_ExecuteInstruction( p_op->Op );
+	R4300_THREADED_NEXT();
+
+#undef R4300_THREADED_COP1_OP
+#undef R4300_THREADED_OP
+#undef R4300_THREADED_NEXT
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+const void *	R4300_GetThreadedLabel( OpCode op_code )
+{
+	DAEDALUS_ASSERT( gThreadedLabels[ 0 ] != NULL, "R4300_Init() hasn't been called" );
+
+	return gThreadedLabels[ R4300_GetThreadedIndex( op_code ) ];
+}
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Utility/Preferences.h"
 #include "Utility/ROMFile.h"
 #include "Utility/ROMFileCache.h"
+#include "Utility/ROMFileMapping.h"
 #include "Utility/ROMFileMemory.h"
 #include "Utility/Stream.h"
 #include "Utility/IO.h"
@@ -49,6 +50,7 @@ namespace
 	u8 *			spRomData( NULL );
 	u32				sRomSize( 0 );
 	bool			sRomFixed( false );
+	bool			sRomMapped( false );
 	ROMFileCache *	spRomFileCache( NULL );
 
 #ifdef DAEDALUS_COMPRESSED_ROM_SUPPORT
@@ -204,7 +206,19 @@ bool RomBuffer::Open()
 
 	sRomSize = p_rom_file->GetRomSize();
 
-	if( ShouldLoadAsFixed( sRomSize ) )
+#ifdef DAEDALUS_ROM_MMAP
+	// Map the rom straight from disk rather than reading it all in up front
+	spRomData = ROMFileMapping_Open( p_rom_file, filename, sRomSize );
+	sRomMapped = spRomData != NULL;
+#endif
+
+	if( sRomMapped )
+	{
+		sRomFixed = true;
+
+		delete p_rom_file;
+	}
+	else if( ShouldLoadAsFixed( sRomSize ) )
 	{
 		// Now, allocate memory for rom - round up to a 4 byte boundry
 		u32		size_aligned( AlignPow2( sRomSize, 4 ) );
@@ -259,9 +273,10 @@ bool RomBuffer::Open()
 #ifdef DAEDALUS_COMPRESSED_ROM_SUPPORT
 		if(DECOMPRESS_ROMS)
 		{
+			// Zips that can be read through an index are streamed directly
 			bool	compressed( p_rom_file->IsCompressed() );
 			bool	byteswapped( p_rom_file->RequiresSwapping() );
-			if(compressed)// || byteswapped)
+			if(compressed && !p_rom_file->IsRandomAccess())// || byteswapped)
 			{
 				const char * temp_filename( "daedrom.tmp" );
                 #ifdef DAEDALUS_DEBUG_CONSOLE
@@ -322,7 +337,12 @@ void	RomBuffer::Close()
 {
 	if (spRomData)
 	{
-		CROMFileMemory::Get()->Free( spRomData );
+#ifdef DAEDALUS_ROM_MMAP
+		if (sRomMapped)
+			ROMFileMapping_Close( spRomData, sRomSize );
+		else
+#endif
+			CROMFileMemory::Get()->Free( spRomData );
 		spRomData = NULL;
 	}
 
@@ -336,6 +356,7 @@ void	RomBuffer::Close()
 	sRomSize   = 0;
 	sRomLoaded = false;
 	sRomFixed  = false;
+	sRomMapped = false;
 }
 
 //*****************************************************************************
@@ -416,12 +437,16 @@ void	RomBuffer::GetRomBytesRaw( void * p_dst, u32 rom_start, u32 length )
 //*****************************************************************************
 void	RomBuffer::PutRomBytesRaw( u32 rom_start, const void * p_src, u32 length )
 {
-#ifdef DAEDALUS_ENABLE_ASSERTS
-	DAEDALUS_ASSERT( IsRomAddressFixed(), "Cannot put rom bytes when the data isn't fixed" );
+	// Writes to a rom that's streamed from the file cache have nowhere to go
+	if( !sRomFixed || rom_start > sRomSize || length > sRomSize - rom_start )
+	{
+#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Ignoring write of %d bytes to rom offset 0x%08x", length, rom_start );
 #endif
+		return;
+	}
 
 	memcpy( (u8*)spRomData + rom_start, p_src, length );
-
 }
 
 //*****************************************************************************
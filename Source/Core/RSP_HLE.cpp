@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Debug/DBGConsole.h"
 #include "Debug/DebugLog.h"
 #include "Debug/Dump.h"			// For Dump_GetDumpDirectory()
+#include "Debug/GuestProfiler.h"
 #include "Math/MathUtil.h"
 #include "OSHLE/ultra_mbi.h"
 #include "OSHLE/ultra_rcp.h"
@@ -125,7 +126,7 @@ static void	RSP_HLE_DumpTaskInfo( const OSTask * pTask )
 void RSP_HLE_Finished(u32 setbits)
 {
 	// Need to point to last instr?
-	//Memory_DPC_SetRegister(DPC_CURRENT_REG, (u32)pTask->t.data_ptr);
+	//Memory_DPC_SetRegister(DPC_CURRENT_REG, pTask->t.data_ptr);
 
 	//
 	// Set the SP flags appropriately. The RSP is not running anyway, no need to stop it
@@ -210,7 +211,7 @@ void jpeg_decode_OB(OSTask *task);
 
 	// most ucode_boot procedure copy 0xf80 bytes of ucode whatever the ucode_size is.
 	// For practical purpose we use a ucode_size = min(0xf80, task->ucode_size)
-	u32 sum = sum_bytes(g_pu8RamBase + (u32)task->t.ucode , Min<u32>(task->t.ucode_size, 0xf80) >> 1);
+	u32 sum = sum_bytes(g_pu8RamBase + task->t.ucode , Min<u32>(task->t.ucode_size, 0xf80) >> 1);
 
 	//DBGConsole_Msg(0, "JPEG Task: Sum=0x%08x", sum);
 	switch(sum)
@@ -270,6 +271,8 @@ void RSP_HLE_ProcessTask()
 
 	EProcessResult	result( PR_NOT_STARTED );
 
+	GUEST_PROFILER_RSP_TASK( pTask->t.type );
+
 	// non task
 	if(pTask->t.ucode_boot_size > 0x1000)
 	{
@@ -310,8 +313,8 @@ void RSP_HLE_ProcessTask()
 			DBGConsole_Msg(0, "Unknown task: %08x", pTask->t.type );
 
 			//	RSP_HLE_DumpTaskInfo( pTask );
-			//	RDP_DumpRSPCode("boot",    0xDEAFF00D, (u32*)(g_pu8RamBase + (((u32)pTask->t.ucode_boot)&0x00FFFFFF)), 0x04001000, pTask->t.ucode_boot_size);
-			//	RDP_DumpRSPCode("unkcode", 0xDEAFF00D, (u32*)(g_pu8RamBase + (((u32)pTask->t.ucode)&0x00FFFFFF)),      0x04001080, 0x1000 - 0x80);//pTask->t.ucode_size);
+			//	RDP_DumpRSPCode("boot",    0xDEAFF00D, (u32*)(g_pu8RamBase + ((pTask->t.ucode_boot)&0x00FFFFFF)), 0x04001000, pTask->t.ucode_boot_size);
+			//	RDP_DumpRSPCode("unkcode", 0xDEAFF00D, (u32*)(g_pu8RamBase + ((pTask->t.ucode)&0x00FFFFFF)),      0x04001080, 0x1000 - 0x80);//pTask->t.ucode_size);
 			break;
             #endif
 	}
@@ -0,0 +1,133 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Core/Rewind.h"
+
+#include "Config/ConfigOptions.h"
+#include "Core/CPU.h"
+#include "Core/Dynamo.h"
+#include "Core/Interpret.h"
+#include "Core/RewindBuffer.h"
+#include "Core/SaveState.h"
+#include "Debug/DBGConsole.h"
+#include "Utility/Mutex.h"
+
+static CRewindBuffer *	gRewindBuffer = NULL;
+static u32				gRewindVbls = 0;
+static bool				gRewindStepBackRequested = false;		// Set from the UI thread
+static Mutex			gRewindMutex;
+
+static void RewindVblCallback( void * /*arg*/ )
+{
+	bool step_back( false );
+	if( gRewindStepBackRequested )
+	{
+		MutexLock lock( &gRewindMutex );
+		step_back = gRewindStepBackRequested;
+		gRewindStepBackRequested = false;
+	}
+
+	if( step_back )
+	{
+		gRewindVbls = 0;
+
+		const u8 *	state;
+		u32			length;
+		if( gRewindBuffer->StepBack( &state, &length ) && SaveState_LoadFromBuffer( state, length ) )
+		{
+			CPU_ResetFragmentCache();
+			Inter_Reset();
+		}
+		return;
+	}
+
+	if( ++gRewindVbls < gRewindInterval )
+		return;
+
+	gRewindVbls = 0;
+
+	gRewindBuffer->BeginCapture();
+	SaveState_SaveToSink( gRewindBuffer );
+	gRewindBuffer->EndCapture();
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool Rewind_Open()
+{
+	if( gRewindBufferSize == 0 )
+		return true;
+
+	gRewindBuffer = new CRewindBuffer( gRewindBufferSize, gRewindKeyframeInterval );
+	if( !gRewindBuffer->IsValid() )
+	{
+#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Couldn't allocate %dKB for rewinding", gRewindBufferSize / 1024 );
+#endif
+		delete gRewindBuffer;
+		gRewindBuffer = NULL;
+
+		// Carry on without
+		return true;
+	}
+
+	gRewindVbls = 0;
+	{
+		MutexLock lock( &gRewindMutex );
+		gRewindStepBackRequested = false;
+	}
+	CPU_RegisterVblCallback( &RewindVblCallback, NULL );
+	return true;
+}
+
+void Rewind_Close()
+{
+	if( gRewindBuffer == NULL )
+		return;
+
+	CPU_UnregisterVblCallback( &RewindVblCallback, NULL );
+
+	CRewindBuffer * buffer( gRewindBuffer );
+	{
+		MutexLock lock( &gRewindMutex );
+		gRewindBuffer = NULL;
+		gRewindStepBackRequested = false;
+	}
+	delete buffer;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void Rewind_RequestStepBack()
+{
+	MutexLock lock( &gRewindMutex );
+
+	if( gRewindBuffer != NULL )
+	{
+		gRewindStepBackRequested = true;
+	}
+}
+
+u32 Rewind_GetNumSnapshots()
+{
+	return gRewindBuffer != NULL ? gRewindBuffer->GetNumSnapshots() : 0;
+}
@@ -0,0 +1,35 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef CORE_REWIND_H_
+#define CORE_REWIND_H_
+
+//
+//	Rewinding. While a rom is running the state is captured into a
+//	CRewindBuffer every gRewindInterval vertical blanks, using up to
+//	gRewindBufferSize bytes (0 turns it off). Stepping back happens on the
+//	next vertical blank, on the CPU thread.
+//
+bool	Rewind_Open();
+void	Rewind_Close();
+
+void	Rewind_RequestStepBack();
+u32		Rewind_GetNumSnapshots();
+
+#endif // CORE_REWIND_H_
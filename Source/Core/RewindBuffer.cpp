@@ -0,0 +1,507 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Core/RewindBuffer.h"
+
+#include <string.h>
+
+#include <new>
+
+#include "Math/MathUtil.h"
+#include "Utility/Cond.h"
+#include "Utility/LZ.h"
+
+namespace
+{
+	const u32	kPageSize = 4096;
+	const u32	kPageEntrySize = sizeof( u32 ) + kPageSize;
+	const u32	kNoPage = ~0U;
+
+	inline u32 RoundUpToPage( u32 length )
+	{
+		return ( length + kPageSize - 1 ) & ~( kPageSize - 1 );
+	}
+
+	// dst = a ^ b, a word at a time
+	void Xor( u8 * dst, const u8 * a, const u8 * b, u32 length )
+	{
+		u32 i( 0 );
+		for( ; i + sizeof( u64 ) <= length; i += sizeof( u64 ) )
+		{
+			u64 x, y;
+			memcpy( &x, a + i, sizeof( u64 ) );
+			memcpy( &y, b + i, sizeof( u64 ) );
+			x ^= y;
+			memcpy( dst + i, &x, sizeof( u64 ) );
+		}
+		for( ; i < length; ++i )
+		{
+			dst[ i ] = a[ i ] ^ b[ i ];
+		}
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CRewindBuffer::CRewindBuffer( u32 budget, u32 keyframe_interval )
+	:	mArena( new (std::nothrow) u8[ budget ] )
+	,	mBudget( budget )
+	,	mKeyframeInterval( Max< u32 >( keyframe_interval, 1 ) )
+	,	mHead( 0 )
+	,	mBytesUsed( 0 )
+	,	mStateLength( 0 )
+	,	mSinceKeyframe( 0 )
+	,	mRestored( false )
+	,	mPayloadSize( 0 )
+	,	mWriteOffset( 0 )
+	,	mPayloadPage( kNoPage )
+	,	mCaptureKeyframe( false )
+	,	mLastStored( false )
+#ifdef DAEDALUS_REWIND
+	,	mMutex( "RewindBuffer" )
+	,	mWorkCond( CondCreate() )
+	,	mIdleCond( CondCreate() )
+	,	mJobPayloadSize( 0 )
+	,	mJobStateLength( 0 )
+	,	mJobKeyframe( false )
+	,	mJobPending( false )
+	,	mThread( kInvalidThreadHandle )
+	,	mQuit( false )
+#endif
+{
+}
+
+CRewindBuffer::~CRewindBuffer()
+{
+#ifdef DAEDALUS_REWIND
+	if( mThread != kInvalidThreadHandle )
+	{
+		{
+			MutexLock lock( &mMutex );
+			mQuit = true;
+			CondSignal( mWorkCond );
+		}
+		JoinThread( mThread, -1 );
+		ReleaseThreadHandle( mThread );
+	}
+
+	CondDestroy( mWorkCond );
+	CondDestroy( mIdleCond );
+#endif
+
+	delete [] mArena;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CRewindBuffer::Clear()
+{
+	WaitForIdle();
+	Reset();
+}
+
+void CRewindBuffer::Reset()
+{
+	mSnapshots.clear();
+	mHead = 0;
+	mBytesUsed = 0;
+	mSinceKeyframe = 0;
+	mRestored = false;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CRewindBuffer::BeginCapture()
+{
+	WaitForIdle();
+
+	mPayloadSize = 0;
+	mWriteOffset = 0;
+	mPayloadPage = kNoPage;
+	mCaptureKeyframe = mSnapshots.empty() || mSinceKeyframe >= mKeyframeInterval;
+}
+
+//*****************************************************************************
+//	Returns the page's entry in the payload, adding one if it's new. Unless
+//	the whole page is about to be written the new entry is zeroed.
+//*****************************************************************************
+u8 * CRewindBuffer::GetPage( u32 page, bool whole_page )
+{
+	if( mPayloadPage != page )
+	{
+		u32 entry( mPayloadSize );
+		mPayloadSize += kPageEntrySize;
+
+		// Only ever grows, so this stops allocating once it has held a keyframe
+		if( mPayloadSize > mPayload.size() )
+		{
+			mPayload.resize( Max< size_t >( mPayloadSize, mPayload.size() * 2 ) );
+		}
+
+		memcpy( &mPayload[ entry ], &page, sizeof( u32 ) );
+		if( !whole_page )
+		{
+			memset( &mPayload[ entry + sizeof( u32 ) ], 0, kPageSize );
+		}
+		mPayloadPage = page;
+	}
+
+	return &mPayload[ mPayloadSize - kPageSize ];
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CRewindBuffer::WriteData( const void * data, u32 length )
+{
+	const u8 * src( static_cast< const u8 * >( data ) );
+
+	if( mWriteOffset + length > mState.size() )
+	{
+		mState.resize( RoundUpToPage( mWriteOffset + length ) );
+	}
+
+	// Keyframes hold every page, so they're built from mState when stored
+	if( mCaptureKeyframe )
+	{
+		memcpy( &mState[ mWriteOffset ], src, length );
+		mWriteOffset += length;
+		return;
+	}
+
+	while( length > 0 )
+	{
+		u32		page( mWriteOffset / kPageSize );
+		u32		page_offset( mWriteOffset % kPageSize );
+		u32		count( Min( length, kPageSize - page_offset ) );
+		u8 *	state( &mState[ mWriteOffset ] );
+
+		// Once a page is in the payload the rest of it has to be added too,
+		// otherwise it's only added if something's changed
+		if( mPayloadPage == page || memcmp( state, src, count ) != 0 )
+		{
+			u8 * out( GetPage( page, count == kPageSize ) + page_offset );
+			Xor( out, state, src, count );
+			memcpy( state, src, count );
+		}
+
+		src += count;
+		length -= count;
+		mWriteOffset += count;
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool CRewindBuffer::EndCapture()
+{
+	mLastStored = false;
+
+	if( mArena == NULL )
+		return false;
+
+	// The deltas only make sense against a state of the same length
+	if( !mCaptureKeyframe && mWriteOffset != mStateLength )
+	{
+		Reset();
+		return false;
+	}
+	mStateLength = mWriteOffset;
+
+	if( mCaptureKeyframe )
+	{
+		memset( &mState[ 0 ] + mStateLength, 0, RoundUpToPage( mStateLength ) - mStateLength );
+	}
+
+#ifdef DAEDALUS_REWIND
+	if( mThread == kInvalidThreadHandle )
+	{
+		mQuit = false;
+		mThread = CreateThread( "RewindBuffer", StoreThread, this );
+	}
+
+	if( mThread != kInvalidThreadHandle )
+	{
+		// BeginCapture waited for the last job, so the worker is idle and its
+		// payload can be swapped for ours without copying
+		MutexLock lock( &mMutex );
+		mJobPayload.swap( mPayload );
+		mJobPayloadSize = mPayloadSize;
+		mJobStateLength = mStateLength;
+		mJobKeyframe = mCaptureKeyframe;
+		mJobPending = true;
+		CondSignal( mWorkCond );
+		return true;
+	}
+#endif
+
+	// No worker - store it right away
+	return Store( mPayload, mPayloadSize, mCaptureKeyframe, mStateLength );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool CRewindBuffer::WaitForCapture()
+{
+	WaitForIdle();
+	return mLastStored;
+}
+
+//*****************************************************************************
+//	Compresses a captured payload into the arena. Runs on the worker if there
+//	is one, which owns mCompressed and the snapshot list until it's done, and
+//	can read mState as nothing touches it before the next BeginCapture.
+//*****************************************************************************
+bool CRewindBuffer::Store( std::vector< u8 > & payload, u32 payload_size, bool keyframe, u32 state_length )
+{
+	if( keyframe )
+	{
+		payload_size = BuildKeyframe( payload, state_length );
+	}
+
+	if( LZ_CompressBound( payload_size ) > mCompressed.size() )
+	{
+		mCompressed.resize( LZ_CompressBound( payload_size ) );
+	}
+	u32 size( LZ_Compress( payload_size ? &payload[ 0 ] : NULL, payload_size, &mCompressed[ 0 ] ) );
+
+	// If this doesn't fit, or making room for it dropped the snapshot it's a
+	// delta from, what's left can't be built on, so start over with a keyframe
+	u8 * p_dst( Allocate( size ) );
+	if( p_dst == NULL || ( !keyframe && mSnapshots.empty() ) )
+	{
+		Reset();
+		return false;
+	}
+	memcpy( p_dst, &mCompressed[ 0 ], size );
+
+	SSnapshot snapshot;
+	snapshot.Offset = u32( p_dst - mArena );
+	snapshot.Size = size;
+	snapshot.PayloadSize = payload_size;
+	snapshot.StateLength = state_length;
+	snapshot.Keyframe = keyframe;
+	mSnapshots.push_back( snapshot );
+
+	mBytesUsed += size;
+	mSinceKeyframe = keyframe ? 1 : mSinceKeyframe + 1;
+	mRestored = false;
+	mLastStored = true;
+	return true;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 CRewindBuffer::BuildKeyframe( std::vector< u8 > & payload, u32 state_length ) const
+{
+	u32 num_pages( RoundUpToPage( state_length ) / kPageSize );
+	u32 size( num_pages * kPageEntrySize );
+	if( size > payload.size() )
+	{
+		payload.resize( size );
+	}
+
+	for( u32 page = 0; page < num_pages; ++page )
+	{
+		u8 * entry( &payload[ page * kPageEntrySize ] );
+		memcpy( entry, &page, sizeof( u32 ) );
+		memcpy( entry + sizeof( u32 ), &mState[ page * kPageSize ], kPageSize );
+	}
+	return size;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CRewindBuffer::WaitForIdle()
+{
+#ifdef DAEDALUS_REWIND
+	MutexLock lock( &mMutex );
+	while( mJobPending )
+	{
+		CondWait( mIdleCond, &mMutex, kTimeoutInfinity );
+	}
+#endif
+}
+
+#ifdef DAEDALUS_REWIND
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 DAEDALUS_THREAD_CALL_TYPE CRewindBuffer::StoreThread( void * arg )
+{
+	static_cast< CRewindBuffer * >( arg )->Run();
+	return 0;
+}
+
+void CRewindBuffer::Run()
+{
+	MutexLock lock( &mMutex );
+
+	while( !mQuit || mJobPending )
+	{
+		if( !mJobPending )
+		{
+			CondWait( mWorkCond, &mMutex, kTimeoutInfinity );
+			continue;
+		}
+
+		mMutex.Unlock();
+		Store( mJobPayload, mJobPayloadSize, mJobKeyframe, mJobStateLength );
+		mMutex.Lock();
+
+		mJobPending = false;
+		CondSignal( mIdleCond );
+	}
+}
+#endif
+
+//*****************************************************************************
+//	Snapshots are laid out one after another, going back to the start of the
+//	arena when they reach the end, so the ones in the way are always the oldest
+//*****************************************************************************
+u8 * CRewindBuffer::Allocate( u32 size )
+{
+	if( size > mBudget )
+		return NULL;
+
+	u32		start( mHead );
+	bool	wrap( start + size > mBudget );
+	if( wrap )
+	{
+		start = 0;
+	}
+
+	while( !mSnapshots.empty() )
+	{
+		const SSnapshot &	oldest( mSnapshots.front() );
+		bool				skipped( wrap && oldest.Offset >= mHead );
+		bool				overlaps( oldest.Offset < start + size && oldest.Offset + oldest.Size > start );
+
+		if( !skipped && !overlaps )
+			break;
+
+		DropOldest();
+	}
+
+	mHead = start + size;
+	return mArena + start;
+}
+
+//*****************************************************************************
+//	Deltas can't be rebuilt without their keyframe, so they go with it
+//*****************************************************************************
+void CRewindBuffer::DropOldest()
+{
+	do
+	{
+		mBytesUsed -= mSnapshots.front().Size;
+		mSnapshots.pop_front();
+	}
+	while( !mSnapshots.empty() && !mSnapshots.front().Keyframe );
+}
+
+void CRewindBuffer::DropNewest()
+{
+	mBytesUsed -= mSnapshots.back().Size;
+	mSnapshots.pop_back();
+
+	mHead = mSnapshots.empty() ? 0 : mSnapshots.back().Offset + mSnapshots.back().Size;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool CRewindBuffer::Apply( const SSnapshot & snapshot )
+{
+	if( snapshot.PayloadSize > mPayload.size() )
+	{
+		mPayload.resize( snapshot.PayloadSize );
+	}
+	if( !LZ_Decompress( mArena + snapshot.Offset, snapshot.Size, mPayload.empty() ? NULL : &mPayload[ 0 ], snapshot.PayloadSize ) )
+		return false;
+
+	for( u32 entry = 0; entry + kPageEntrySize <= snapshot.PayloadSize; entry += kPageEntrySize )
+	{
+		u32 page;
+		memcpy( &page, &mPayload[ entry ], sizeof( u32 ) );
+		if( ( page + 1 ) * kPageSize > mState.size() )
+			return false;
+
+		const u8 *	src( &mPayload[ entry + sizeof( u32 ) ] );
+		u8 *		dst( &mState[ page * kPageSize ] );
+		if( snapshot.Keyframe )
+		{
+			memcpy( dst, src, kPageSize );
+		}
+		else
+		{
+			Xor( dst, dst, src, kPageSize );
+		}
+	}
+	return true;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool CRewindBuffer::StepBack( const u8 ** p_state, u32 * p_length )
+{
+	WaitForIdle();
+
+	// We're already at the newest snapshot, so go to the one before
+	if( mRestored && mSnapshots.size() > 1 )
+	{
+		DropNewest();
+	}
+
+	if( mSnapshots.empty() )
+		return false;
+
+	u32 keyframe( u32( mSnapshots.size() ) - 1 );
+	while( !mSnapshots[ keyframe ].Keyframe )
+	{
+		--keyframe;
+	}
+
+	mState.resize( RoundUpToPage( mSnapshots.back().StateLength ) );
+	for( u32 i = keyframe; i < mSnapshots.size(); ++i )
+	{
+		if( !Apply( mSnapshots[ i ] ) )
+		{
+			Reset();
+			return false;
+		}
+	}
+
+	mStateLength = mSnapshots.back().StateLength;
+	mSinceKeyframe = u32( mSnapshots.size() ) - keyframe;
+	mRestored = true;
+
+	*p_state = &mState[ 0 ];
+	*p_length = mStateLength;
+	return true;
+}
@@ -0,0 +1,137 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef CORE_REWINDBUFFER_H_
+#define CORE_REWINDBUFFER_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <vector>
+
+#include "Core/SaveState.h"
+#include "Utility/Mutex.h"
+#include "Utility/Thread.h"
+
+struct Cond;
+
+//
+//	A ring of savestates kept in memory. The state is split into 4KB pages and
+//	each snapshot only holds the pages which changed since the one before,
+//	XORed with their previous contents (so unchanged parts of a page are zero)
+//	and then LZ compressed. Every keyframe_interval snapshots all the pages are
+//	stored as they are, so the snapshots can be rebuilt from the nearest
+//	keyframe, and the oldest keyframe and its deltas are dropped together when
+//	budget bytes have been used.
+//
+//	Besides the budget this keeps a copy of the latest state and a couple of
+//	working buffers of around the same size.
+//
+//	With DAEDALUS_REWIND the compression and storing happen on a worker thread,
+//	so the caller only pays for finding the changed pages. Everything apart
+//	from WriteData waits for the worker to finish the previous capture first.
+//
+class CRewindBuffer : public CSaveStateSink
+{
+public:
+	CRewindBuffer( u32 budget, u32 keyframe_interval );
+	~CRewindBuffer();
+
+	bool			IsValid() const				{ return mArena != NULL; }
+
+	// The state is passed to WriteData in between these. EndCapture returns
+	// false if the capture was rejected straight away, WaitForCapture whether
+	// it was actually stored.
+	void			BeginCapture();
+	virtual void	WriteData( const void * data, u32 length );
+	bool			EndCapture();
+	bool			WaitForCapture();
+
+	// Rebuilds the newest snapshot and discards the ones after it. If nothing
+	// has been captured since the last step back, goes back one further.
+	bool			StepBack( const u8 ** p_state, u32 * p_length );
+
+	void			Clear();
+
+	u32				GetNumSnapshots()			{ WaitForIdle(); return u32( mSnapshots.size() ); }
+	u32				GetBytesUsed()				{ WaitForIdle(); return mBytesUsed; }
+	u32				GetLastCaptureSize()		{ WaitForIdle(); return mSnapshots.empty() ? 0 : mSnapshots.back().Size; }
+	bool			WasLastCaptureKeyframe()	{ WaitForIdle(); return !mSnapshots.empty() && mSnapshots.back().Keyframe; }
+
+private:
+	struct SSnapshot
+	{
+		u32		Offset;				// In mArena
+		u32		Size;				// Compressed
+		u32		PayloadSize;		// Uncompressed page list
+		u32		StateLength;
+		bool	Keyframe;
+	};
+
+	u8 *			GetPage( u32 page, bool whole_page );
+	bool			Store( std::vector< u8 > & payload, u32 payload_size, bool keyframe, u32 state_length );
+	u32				BuildKeyframe( std::vector< u8 > & payload, u32 state_length ) const;
+	void			Reset();
+	void			WaitForIdle();
+	u8 *			Allocate( u32 size );
+	void			DropOldest();
+	void			DropNewest();
+	bool			Apply( const SSnapshot & snapshot );
+
+private:
+	u8 *					mArena;
+	u32						mBudget;
+	u32						mKeyframeInterval;
+	u32						mHead;				// End of the newest snapshot
+	u32						mBytesUsed;
+	std::deque< SSnapshot >	mSnapshots;
+
+	std::vector< u8 >		mState;				// The state as of the newest snapshot
+	u32						mStateLength;
+	u32						mSinceKeyframe;		// Snapshots since (and including) the last keyframe
+	bool					mRestored;			// Stepped back, and nothing captured since
+
+	// Capture in progress
+	std::vector< u8 >		mPayload;			// Page number followed by the page, for each page stored (deltas only)
+	u32						mPayloadSize;
+	std::vector< u8 >		mCompressed;
+	u32						mWriteOffset;
+	u32						mPayloadPage;		// Page last added to mPayload
+	bool					mCaptureKeyframe;
+	bool					mLastStored;
+
+#ifdef DAEDALUS_REWIND
+	static u32 DAEDALUS_THREAD_CALL_TYPE StoreThread( void * arg );
+	void					Run();
+
+	// Handed over to the worker by EndCapture
+	Mutex					mMutex;				// Protects everything below
+	Cond *					mWorkCond;
+	Cond *					mIdleCond;
+	std::vector< u8 >		mJobPayload;
+	u32						mJobPayloadSize;
+	u32						mJobStateLength;
+	bool					mJobKeyframe;
+	bool					mJobPending;
+	ThreadHandle			mThread;
+	bool					mQuit;
+#endif
+};
+
+#endif // CORE_REWINDBUFFER_H_
@@ -0,0 +1,311 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Benchmark for CRewindBuffer. Plays a minute of synthetic "gameplay" over
+//	an 8MB state laid out like a savestate (registers, RDRAM, SP memory):
+//	each vertical blank redraws a double buffered framebuffer, rewrites an
+//	audio buffer and the stack, and scatters writes over a heap. The state
+//	is captured every interval vblanks, and the capture cost per frame and
+//	the bytes stored per second of gameplay are reported. The capture cost is
+//	what the emulation thread pays; with a worker the compression is timed
+//	separately, by waiting for it after each capture. Stepping back is
+//	then checked against copies of the states that were captured.
+//
+//	Usage: RewindBuffer_bench [interval] [keyframe_interval] [budget_mb]
+//
+
+#include "stdafx.h"
+#include "Core/RewindBuffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "Utility/Timing.h"
+
+namespace
+{
+	const u32	kVblsPerSecond = 60;
+	const u32	kNumSeconds = 60;
+
+	const u32	kHeaderSize = 0x75c;			// Registers, TLB and PIF ram
+	const u32	kRamSize = 8 * 1024 * 1024;
+	const u32	kSpMemSize = 0x2000;
+
+	const u32	kCodeSize = 2 * 1024 * 1024;
+	const u32	kFrameBufferSize = 320 * 240 * 2;
+	const u32	kFrameBuffer0 = 0x100000 * 4;
+	const u32	kFrameBuffer1 = kFrameBuffer0 + 0x40000;
+	const u32	kHeapBase = 0x500000;
+	const u32	kHeapSize = 1024 * 1024;
+	const u32	kHeapWritesPerVbl = 2000;
+	const u32	kAudioBuffer = 0x700000;
+	const u32	kAudioBufferSize = 0x2000;
+	const u32	kStack = 0x7f0000;
+	const u32	kStackSize = 0x1000;
+
+	u32			gSeed( 1 );
+
+	inline u32 Random()
+	{
+		gSeed = gSeed * 1664525 + 1013904223;
+		return gSeed >> 8;
+	}
+
+	struct SState
+	{
+		std::vector< u8 >	Header;
+		std::vector< u8 >	Ram;
+		std::vector< u8 >	SpMem;
+
+		SState()
+			:	Header( kHeaderSize )
+			,	Ram( kRamSize )
+			,	SpMem( kSpMemSize )
+		{
+		}
+
+		void Write( CSaveStateSink * sink ) const
+		{
+			sink->WriteData( &Header[ 0 ], kHeaderSize );
+			sink->WriteData( &Ram[ 0 ], kRamSize );
+			sink->WriteData( &SpMem[ 0 ], kSpMemSize );
+		}
+
+		void Flatten( std::vector< u8 > * out ) const
+		{
+			out->assign( Header.begin(), Header.end() );
+			out->insert( out->end(), Ram.begin(), Ram.end() );
+			out->insert( out->end(), SpMem.begin(), SpMem.end() );
+		}
+	};
+
+	void FillCode( u8 * p, u32 length )
+	{
+		// Instruction-like words: few opcodes, registers and small immediates
+		for( u32 i = 0; i < length; i += 4 )
+		{
+			u32 r( Random() );
+			u32 op( ( r & 7 ) << 26 | ( ( r >> 3 ) & 0x3ff ) << 16 | ( ( r >> 13 ) & 0xff ) );
+			memcpy( p + i, &op, 4 );
+		}
+	}
+
+	void Init( SState & state )
+	{
+		FillCode( &state.Ram[ 0 ], kCodeSize );
+		for( u32 i = 0; i < kHeapSize; i += 4 )
+		{
+			u32 v( ( Random() & 3 ) == 0 ? Random() : 0 );
+			memcpy( &state.Ram[ kHeapBase + i ], &v, 4 );
+		}
+		FillCode( &state.SpMem[ 0 ], kSpMemSize );
+	}
+
+	void RunVbl( SState & state, u32 vbl )
+	{
+		// Registers
+		for( u32 i = 0; i < 64; ++i )
+		{
+			state.Header[ Random() % kHeaderSize ] = u8( Random() );
+		}
+
+		// Draw into the back buffer: a scrolling background with some sprites
+		u8 * fb( &state.Ram[ ( vbl & 1 ) ? kFrameBuffer1 : kFrameBuffer0 ] );
+		for( u32 y = 0; y < 240; ++y )
+		{
+			u16 * line( reinterpret_cast< u16 * >( fb + y * 640 ) );
+			for( u32 x = 0; x < 320; ++x )
+			{
+				line[ x ] = u16( ( ( x + vbl ) >> 3 ) * 0x0421 + ( y >> 4 ) );
+			}
+		}
+		for( u32 s = 0; s < 16; ++s )
+		{
+			u32 sx( Random() % 304 ), sy( Random() % 224 ), colour( Random() );
+			for( u32 y = 0; y < 16; ++y )
+			{
+				u16 * line( reinterpret_cast< u16 * >( fb + ( sy + y ) * 640 ) );
+				for( u32 x = 0; x < 16; ++x )
+				{
+					line[ sx + x ] = u16( colour + x * y );
+				}
+			}
+		}
+
+		for( u32 i = 0; i < kAudioBufferSize; i += 2 )
+		{
+			s16 sample( s16( ( Random() & 0xfff ) - 0x800 ) );
+			memcpy( &state.Ram[ kAudioBuffer + i ], &sample, 2 );
+		}
+
+		for( u32 i = 0; i < kStackSize; i += 4 )
+		{
+			if( Random() & 1 )
+			{
+				u32 v( Random() & 0x803fffff );
+				memcpy( &state.Ram[ kStack + i ], &v, 4 );
+			}
+		}
+
+		for( u32 i = 0; i < kHeapWritesPerVbl; ++i )
+		{
+			u32 v( Random() & 0xffff );
+			memcpy( &state.Ram[ kHeapBase + ( Random() % ( kHeapSize / 4 ) ) * 4 ], &v, 4 );
+		}
+
+		for( u32 i = 0; i < 256; ++i )
+		{
+			state.SpMem[ Random() % kSpMemSize ] = u8( Random() );
+		}
+	}
+
+	u64 Now()
+	{
+		u64 time;
+		NTiming::GetPreciseTime( &time );
+		return time;
+	}
+
+	double ToMs( u64 ticks )
+	{
+		u64 freq;
+		NTiming::GetPreciseFrequency( &freq );
+		return double( ticks ) * 1000.0 / double( freq );
+	}
+
+	bool Check( CRewindBuffer & buffer, const std::vector< u8 > & expected, const char * name )
+	{
+		const u8 *	state;
+		u32			length;
+
+		u64 start( Now() );
+		bool ok( buffer.StepBack( &state, &length ) );
+		u64 end( Now() );
+
+		ok = ok && length == expected.size() && memcmp( state, &expected[ 0 ], length ) == 0;
+		printf( "step back to %-16s %s  %6.2f ms\n", name, ok ? "ok    " : "FAILED", ToMs( end - start ) );
+		return ok;
+	}
+}
+
+int main( int argc, char * argv[] )
+{
+	u32 interval( argc > 1 ? atoi( argv[ 1 ] ) : 6 );
+	u32 keyframe_interval( argc > 2 ? atoi( argv[ 2 ] ) : 30 );
+	u32 budget_mb( argc > 3 ? atoi( argv[ 3 ] ) : 32 );
+
+	if( interval == 0 )
+	{
+		interval = 1;
+	}
+
+	CRewindBuffer	buffer( budget_mb * 1024 * 1024, keyframe_interval );
+	SState			state;
+	Init( state );
+
+	std::vector< u8 >	previous, latest;
+
+	u64		total_ticks( 0 ), keyframe_ticks( 0 ), delta_ticks( 0 ), first_ticks( 0 ), max_ticks( 0 ), max_store_ticks( 0 );
+	u64		total_bytes( 0 ), keyframe_bytes( 0 ), delta_bytes( 0 );
+	u32		num_keyframes( 0 ), num_deltas( 0 ), num_dropped( 0 );
+
+	const u32 num_vbls( kNumSeconds * kVblsPerSecond );
+	for( u32 vbl = 1; vbl <= num_vbls; ++vbl )
+	{
+		RunVbl( state, vbl );
+
+		if( vbl % interval != 0 )
+			continue;
+
+		u64 start( Now() );
+		buffer.BeginCapture();
+		state.Write( &buffer );
+		bool stored( buffer.EndCapture() );
+		u64 ticks( Now() - start );
+
+		stored = buffer.WaitForCapture() && stored;
+		u64 store_ticks( Now() - start );
+		if( store_ticks > max_store_ticks )
+			max_store_ticks = store_ticks;
+
+		u32 size( stored ? buffer.GetLastCaptureSize() : 0 );
+		total_ticks += ticks;
+		total_bytes += size;
+
+		// The first capture allocates everything, so is counted separately
+		if( vbl == interval )
+			first_ticks = ticks;
+		else if( ticks > max_ticks )
+			max_ticks = ticks;
+
+		if( !stored )
+		{
+			++num_dropped;
+		}
+		else if( buffer.WasLastCaptureKeyframe() )
+		{
+			keyframe_ticks += ticks;	keyframe_bytes += size;		++num_keyframes;
+		}
+		else
+		{
+			delta_ticks += ticks;		delta_bytes += size;		++num_deltas;
+		}
+
+		if( vbl + interval > num_vbls )
+		{
+			previous.swap( latest );
+			state.Flatten( &latest );
+		}
+		else if( vbl + 2 * interval > num_vbls )
+		{
+			state.Flatten( &latest );
+		}
+	}
+
+	u32 state_size( kHeaderSize + kRamSize + kSpMemSize );
+	printf( "%u KB state, a snapshot every %u vblanks, a keyframe every %u, %u MB budget\n",
+			state_size / 1024, interval, keyframe_interval, budget_mb );
+	printf( "keyframes  %5u  %8.3f ms  %8.1f KB\n", num_keyframes,
+			num_keyframes ? ToMs( keyframe_ticks ) / num_keyframes : 0.0, num_keyframes ? keyframe_bytes / 1024.0 / num_keyframes : 0.0 );
+	printf( "deltas     %5u  %8.3f ms  %8.1f KB\n", num_deltas,
+			num_deltas ? ToMs( delta_ticks ) / num_deltas : 0.0, num_deltas ? delta_bytes / 1024.0 / num_deltas : 0.0 );
+	if( num_dropped > 0 )
+	{
+		printf( "dropped    %5u (too big for the budget)\n", num_dropped );
+	}
+	printf( "first capture           %8.3f ms\n", ToMs( first_ticks ) );
+	printf( "slowest after that      %8.3f ms\n", ToMs( max_ticks ) );
+	printf( "slowest to store        %8.3f ms\n", ToMs( max_store_ticks ) );
+	printf( "capture cost per frame  %8.3f ms\n", ToMs( total_ticks ) / num_vbls );
+	printf( "stored per second       %8.1f KB\n", total_bytes / 1024.0 / kNumSeconds );
+	printf( "held %u snapshots (%.1f s) in %.1f MB\n", buffer.GetNumSnapshots(),
+			double( buffer.GetNumSnapshots() * interval ) / kVblsPerSecond, buffer.GetBytesUsed() / ( 1024.0 * 1024.0 ) );
+
+	bool can_go_back( buffer.GetNumSnapshots() > 1 );
+	bool ok( Check( buffer, latest, "latest" ) );
+	if( can_go_back )
+	{
+		ok = Check( buffer, previous, "the one before" ) && ok;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+#include <stdafx.h>
+#include "Core/RewindBuffer.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// Not a multiple of the page size, so the last page is partial
+static const u32 kStateLength = 256 * 1024 + 0x75c;
+
+class RewindBufferTest : public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		mSeed = 1;
+		mState.resize( kStateLength );
+		for (u32 i = 0; i < mState.size(); ++i)
+			mState[i] = (u8)(i / 3);
+	}
+
+	u32 Random()
+	{
+		mSeed = mSeed * 1664525 + 1013904223;
+		return mSeed >> 8;
+	}
+
+	// Changes a few scattered bytes, like a frame of emulation would
+	void Mutate( u32 num_changes )
+	{
+		for (u32 i = 0; i < num_changes; ++i)
+			mState[Random() % mState.size()] ^= (u8)(Random() | 1);
+	}
+
+	// Passes the state in uneven pieces, the way SaveState_WriteState does
+	bool Capture( CRewindBuffer & buffer )
+	{
+		buffer.BeginCapture();
+		u32 offset = 0;
+		while (offset < mState.size())
+		{
+			u32 length = 1 + Random() % 5000;
+			if (length > mState.size() - offset)
+				length = mState.size() - offset;
+			buffer.WriteData( &mState[offset], length );
+			offset += length;
+		}
+		return buffer.EndCapture() && buffer.WaitForCapture();
+	}
+
+	std::vector< u8 >	mState;
+	u32					mSeed;
+};
+
+TEST_F(RewindBufferTest, StepBackReproducesEachState)
+{
+	const u32 kNumStates = 20;
+
+	CRewindBuffer buffer( 16 * 1024 * 1024, 8 );
+	ASSERT_TRUE( buffer.IsValid() );
+
+	std::vector< std::vector< u8 > > states;
+	for (u32 i = 0; i < kNumStates; ++i)
+	{
+		// Include a capture where nothing changed
+		if (i != 5)
+			Mutate( 50 );
+		states.push_back( mState );
+		ASSERT_TRUE( Capture( buffer ) );
+	}
+	EXPECT_EQ( kNumStates, buffer.GetNumSnapshots() );
+
+	for (u32 i = kNumStates; i-- > 0;)
+	{
+		const u8 *	state;
+		u32			length;
+		ASSERT_TRUE( buffer.StepBack( &state, &length ) );
+		ASSERT_EQ( kStateLength, length );
+		EXPECT_EQ( 0, memcmp( state, &states[i][0], length ) ) << "State " << i << " differs";
+	}
+
+	// The oldest one stays put
+	const u8 *	state;
+	u32			length;
+	ASSERT_TRUE( buffer.StepBack( &state, &length ) );
+	EXPECT_EQ( 0, memcmp( state, &states[0][0], length ) );
+	EXPECT_EQ( 1u, buffer.GetNumSnapshots() );
+}
+
+TEST_F(RewindBufferTest, CapturesAfterStepBackContinueFromIt)
+{
+	CRewindBuffer buffer( 16 * 1024 * 1024, 4 );
+
+	std::vector< std::vector< u8 > > states;
+	for (u32 i = 0; i < 6; ++i)
+	{
+		Mutate( 50 );
+		states.push_back( mState );
+		ASSERT_TRUE( Capture( buffer ) );
+	}
+
+	const u8 *	state;
+	u32			length;
+	ASSERT_TRUE( buffer.StepBack( &state, &length ) );
+	ASSERT_TRUE( buffer.StepBack( &state, &length ) );
+	EXPECT_EQ( 0, memcmp( state, &states[4][0], length ) );
+
+	// Carry on from the restored state
+	memcpy( &mState[0], state, length );
+	states.resize( 5 );
+	for (u32 i = 0; i < 6; ++i)
+	{
+		Mutate( 50 );
+		states.push_back( mState );
+		ASSERT_TRUE( Capture( buffer ) );
+	}
+
+	for (u32 i = states.size(); i-- > 0;)
+	{
+		ASSERT_TRUE( buffer.StepBack( &state, &length ) );
+		EXPECT_EQ( 0, memcmp( state, &states[i][0], length ) ) << "State " << i << " differs";
+	}
+}
+
+TEST_F(RewindBufferTest, EvictsOldestStatesToStayWithinBudget)
+{
+	const u32 kBudget = 1024 * 1024;
+	const u32 kNumStates = 200;
+
+	// Make the keyframes incompressible, so only a few fit in the budget
+	for (u32 i = 0; i < mState.size(); ++i)
+		mState[i] = (u8)Random();
+
+	CRewindBuffer buffer( kBudget, 10 );
+
+	std::vector< std::vector< u8 > > states;
+	for (u32 i = 0; i < kNumStates; ++i)
+	{
+		Mutate( 200 );
+		states.push_back( mState );
+		Capture( buffer );
+		EXPECT_LE( buffer.GetBytesUsed(), kBudget );
+	}
+
+	u32 num_snapshots = buffer.GetNumSnapshots();
+	EXPECT_GT( num_snapshots, 0u );
+	EXPECT_LT( num_snapshots, kNumStates );
+
+	// Whatever is left is the newest states, in order
+	for (u32 i = 0; i < num_snapshots; ++i)
+	{
+		const u8 *	state;
+		u32			length;
+		ASSERT_TRUE( buffer.StepBack( &state, &length ) );
+		ASSERT_EQ( kStateLength, length );
+		EXPECT_EQ( 0, memcmp( state, &states[kNumStates - 1 - i][0], length ) ) << "Step " << i << " differs";
+	}
+}
+
+TEST_F(RewindBufferTest, StartsOverWhenTheLengthChanges)
+{
+	CRewindBuffer buffer( 16 * 1024 * 1024, 8 );
+
+	ASSERT_TRUE( Capture( buffer ) );
+	Mutate( 10 );
+	ASSERT_TRUE( Capture( buffer ) );
+
+	// A delta against a different length can't be stored
+	mState.resize( kStateLength + 4096 );
+	Capture( buffer );
+	EXPECT_EQ( 0u, buffer.GetNumSnapshots() );
+
+	// The next capture is a keyframe of the new length
+	ASSERT_TRUE( Capture( buffer ) );
+	EXPECT_TRUE( buffer.WasLastCaptureKeyframe() );
+
+	const u8 *	state;
+	u32			length;
+	ASSERT_TRUE( buffer.StepBack( &state, &length ) );
+	ASSERT_EQ( mState.size(), length );
+	EXPECT_EQ( 0, memcmp( state, &mState[0], length ) );
+}
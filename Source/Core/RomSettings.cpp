@@ -295,6 +295,22 @@ bool IRomSettingsDB::OpenSettingsFile( const char * filename )
 		{
 			settings.DynarecDoublesOptimisation = p_property->GetBooleanValue( false );
 		}
+		if( p_section->FindProperty( "IdleLoopSkipEnabled", &p_property ) )
+		{
+			settings.IdleLoopSkipEnabled = p_property->GetBooleanValue( true );
+		}
+		if( p_section->FindProperty( "DynarecConstantPropagation", &p_property ) )
+		{
+			settings.DynarecConstantPropagation = p_property->GetBooleanValue( true );
+		}
+		if( p_section->FindProperty( "DynarecMaxTraceLength", &p_property ) )
+		{
+			settings.DynarecMaxTraceLength = atoi( p_property->GetValue() );
+		}
+		if( p_section->FindProperty( "DynarecMaxInlineLength", &p_property ) )
+		{
+			settings.DynarecMaxInlineLength = atoi( p_property->GetValue() );
+		}
 		if( p_section->FindProperty( "DoubleDisplayEnabled", &p_property ) )
 		{
 			settings.DoubleDisplayEnabled = p_property->GetBooleanValue( true );
@@ -444,6 +460,10 @@ void IRomSettingsDB::OutputSectionDetails( const RomID & id, const RomSettings &
 	if( !settings.DynarecSupported )			fprintf(fh, "DynarecSupported=no\n");
 	if( !settings.DynarecLoopOptimisation )		fprintf(fh, "DynarecLoopOptimisation=yes\n");
 	if( !settings.DynarecDoublesOptimisation )	fprintf(fh, "DynarecDoublesOptimisation=yes\n");
+	if( !settings.IdleLoopSkipEnabled )			fprintf(fh, "IdleLoopSkipEnabled=no\n");
+	if( !settings.DynarecConstantPropagation )	fprintf(fh, "DynarecConstantPropagation=no\n");
+	if( settings.DynarecMaxTraceLength != 1500 )	fprintf(fh, "DynarecMaxTraceLength=%d\n", settings.DynarecMaxTraceLength);
+	if( settings.DynarecMaxInlineLength != 48 )	fprintf(fh, "DynarecMaxInlineLength=%d\n", settings.DynarecMaxInlineLength);
 	if( !settings.DoubleDisplayEnabled )		fprintf(fh, "DoubleDisplayEnabled=no\n");
 	if( settings.CleanSceneEnabled )			fprintf(fh, "CleanSceneEnabled=yes\n");
 	if( settings.ClearDepthFrameBuffer )		fprintf(fh, "ClearDepthFrameBuffer=yes\n");
@@ -506,6 +526,10 @@ RomSettings::RomSettings()
 ,	DynarecSupported( true )
 ,	DynarecLoopOptimisation( false )
 ,	DynarecDoublesOptimisation( false )
+,	IdleLoopSkipEnabled( true )
+,	DynarecConstantPropagation( true )
+,	DynarecMaxTraceLength( 1500 )
+,	DynarecMaxInlineLength( 48 )
 ,	DoubleDisplayEnabled( true )
 ,	CleanSceneEnabled( false )
 ,	ClearDepthFrameBuffer( false )
@@ -539,6 +563,10 @@ void	RomSettings::Reset()
 	DynarecSupported = true;
 	DynarecLoopOptimisation = false;
 	DynarecDoublesOptimisation = false;
+	IdleLoopSkipEnabled = true;
+	DynarecConstantPropagation = true;
+	DynarecMaxTraceLength = 1500;
+	DynarecMaxInlineLength = 48;
 	DoubleDisplayEnabled = true;
 	CleanSceneEnabled = false;
 	ClearDepthFrameBuffer = false;
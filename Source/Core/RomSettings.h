@@ -63,6 +63,10 @@ struct RomSettings
 	bool				DynarecSupported;
 	bool				DynarecLoopOptimisation;
 	bool				DynarecDoublesOptimisation;
+	bool				IdleLoopSkipEnabled;
+	bool				DynarecConstantPropagation;
+	u32					DynarecMaxTraceLength;
+	u32					DynarecMaxInlineLength;
 	bool				DoubleDisplayEnabled;
 	bool				CleanSceneEnabled;
 	bool				ClearDepthFrameBuffer;
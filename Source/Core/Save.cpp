@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Config/ConfigOptions.h"
 #include "Debug/DBGConsole.h"
 #include "Debug/Dump.h"
+#include "Utility/ByteSwap.h"
 #include "Utility/IO.h"
 
 static void InitMempackContent();
@@ -77,17 +78,14 @@ bool Save_Reset()
 #ifdef DAEDALUS_DEBUG_CONSOLE
 			DBGConsole_Msg(0, "Loading save from [C%s]", gSaveFileName);
 #endif
-			u8 buffer[2048];
+			u32 buffer[512];
 			u8 * dst = (u8*)g_pMemoryBuffers[MEM_SAVE];
 
 			for (u32 d = 0; d < gSaveSize; d += sizeof(buffer))
 			{
 				fread(buffer, sizeof(buffer), 1, fp);
 
-				for (u32 i = 0; i < sizeof(buffer); i++)
-				{
-					dst[d+i] = buffer[i^U8_TWIDDLE];
-				}
+				ByteSwap_CopyN64(dst + d, buffer, sizeof(buffer), 0);
 			}
 			fclose(fp);
 		}
@@ -151,15 +149,12 @@ void Save_Flush(bool force)
 		FILE * fp = fopen(gSaveFileName, "wb");
 		if (fp != NULL)
 		{
-			u8 buffer[2048];
+			u32 buffer[512];
 			u8 * src = (u8*)g_pMemoryBuffers[MEM_SAVE];
 
 			for (u32 d = 0; d < gSaveSize; d += sizeof(buffer))
 			{
-				for (u32 i = 0; i < sizeof(buffer); i++)
-				{
-					buffer[i^U8_TWIDDLE] = src[d+i];
-				}
+				ByteSwap_CopyN64(buffer, src + d, sizeof(buffer), 0);
 				fwrite(buffer, 1, sizeof(buffer), fp);
 			}
 			fclose(fp);
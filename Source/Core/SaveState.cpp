@@ -21,7 +21,12 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include <stdio.h>
 
+#include <deque>
+#include <string>
+#include <vector>
+
 #include "SaveState.h"
+#include "SaveStateFile.h"
 #include "Memory.h"
 #include "CPU.h"
 #include "ROM.h"
@@ -33,25 +38,160 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "OSHLE/patch.h"
 #include "OSHLE/ultra_R4300.h"
 #include "System/System.h"
+#include "Utility/ByteSwap.h"
 #include "Utility/ROMFile.h"
 #include "Utility/ZlibWrapper.h"
+
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+#include "Utility/Cond.h"
+#include "Utility/IO.h"
+#include "Utility/Mutex.h"
+#include "Utility/Thread.h"
+#endif
 //
 //	SaveState code written initially by Lkb. Seems to be based about Project 64's
 //	savestate format, which is partially documented here: http://www.hcs64.com/usf/usf.txt
+//	The state is still serialised in that layout, but saved in the format in
+//	SaveStateFile.h.
+//
+
+//
+//	Sink for SaveState_ostream which appends to a buffer in memory, so the state
+//	can be captured quickly and written out later. The buffer is only ever
+//	cleared, and is reserved to fit the state up front, so it never holds
+//	more than one state and once it has grown capturing doesn't allocate.
+//
+class SaveState_MemorySink
+{
+public:
+	explicit SaveState_MemorySink( std::vector< u8 > * buffer )
+		: mBuffer( *buffer )
+	{
+		mBuffer.clear();
+		mBuffer.reserve( SaveStateFile_GetStateLength( gRamSize ) );
+	}
+
+	bool IsOpen() const
+	{
+		return true;
+	}
+
+	bool WriteData( const void * data, u32 length )
+	{
+		const u8 * p( static_cast< const u8 * >( data ) );
+		mBuffer.insert( mBuffer.end(), p, p + length );
+		return true;
+	}
+
+private:
+	std::vector< u8 > &	mBuffer;
+};
+
+//
+//	Sink which forwards to a caller supplied CSaveStateSink.
+//
+class SaveState_SinkAdapter
+{
+public:
+	explicit SaveState_SinkAdapter( CSaveStateSink * sink )
+		: mSink( sink )
+	{
+	}
+
+	bool IsOpen() const
+	{
+		return true;
+	}
+
+	bool WriteData( const void * data, u32 length )
+	{
+		mSink->WriteData( data, length );
+		return true;
+	}
+
+private:
+	CSaveStateSink *	mSink;
+};
+
 //
+//	Source for SaveState_istream which reads from a buffer in memory.
+//
+class SaveState_MemorySource
+{
+public:
+	SaveState_MemorySource( const u8 * data, u32 length )
+		: mData( data )
+		, mRemaining( length )
+	{
+	}
+
+	bool IsOpen() const
+	{
+		return mData != NULL;
+	}
+
+	bool ReadData( void * data, u32 length )
+	{
+		if( length > mRemaining )
+			return false;
+
+		memcpy( data, mData, length );
+		mData += length;
+		mRemaining -= length;
+		return true;
+	}
+
+private:
+	const u8 *	mData;
+	u32			mRemaining;
+};
+
+//
+//	Source which reads a file in our format a piece at a time. It stops being
+//	open if a read fails, e.g. a section fails its checksum.
+//
+class SaveState_FileSource
+{
+public:
+	explicit SaveState_FileSource( CSaveStateFileReader * reader )
+		: mReader( reader )
+	{
+	}
+
+	bool IsOpen() const
+	{
+		return mReader != NULL;
+	}
 
-const u32 SAVESTATE_PROJECT64_MAGIC_NUMBER = 0x23D8A6C8;
+	bool ReadData( void * data, u32 length )
+	{
+		if( mReader == NULL )
+			return false;
+
+		if( !mReader->ReadData( data, length ) )
+		{
+			mReader = NULL;
+			return false;
+		}
+		return true;
+	}
+
+private:
+	CSaveStateFileReader *	mReader;
+};
 
-class SaveState_ostream_gzip
+template< typename Sink >
+class SaveState_ostream
 {
 public:
-	SaveState_ostream_gzip( const char * filename )
-		: mStream( filename )
+	template< typename Arg >
+	explicit SaveState_ostream( Arg arg )
+		: mStream( arg )
 	{
 	}
 
 	template<typename T>
-	inline SaveState_ostream_gzip& operator << (const T& data)
+	inline SaveState_ostream& operator << (const T& data)
 	{
 		write(&data, sizeof(T));
 		return *this;
@@ -106,14 +246,24 @@ public:
 	}
 
 private:
-	COutStream		mStream;
+	Sink			mStream;
 };
 
-class SaveState_istream_gzip
+typedef SaveState_ostream< SaveState_MemorySink >	SaveState_ostream_memory;
+typedef SaveState_ostream< SaveState_SinkAdapter >	SaveState_ostream_sink;
+
+template< typename Source >
+class SaveState_istream
 {
 public:
-	explicit SaveState_istream_gzip( const char * filename )
-		: mStream( filename )
+	template< typename Arg >
+	explicit SaveState_istream( Arg arg )
+		: mStream( arg )
+	{}
+
+	template< typename Arg0, typename Arg1 >
+	SaveState_istream( Arg0 arg0, Arg1 arg1 )
+		: mStream( arg0, arg1 )
 	{}
 
 	inline bool IsValid() const
@@ -122,7 +272,7 @@ public:
 	}
 
 	template<typename T>
-	inline SaveState_istream_gzip& operator >> (T& data)
+	inline SaveState_istream& operator >> (T& data)
 	{
 		if (read(&data, sizeof(data)) != sizeof(data))
 		{
@@ -184,17 +334,17 @@ public:
 	}
 
 private:
-	CInStream			mStream;
+	Source				mStream;
 };
 
+typedef SaveState_istream< CInStream >				SaveState_istream_gzip;
+typedef SaveState_istream< SaveState_MemorySource >	SaveState_istream_memory;
+typedef SaveState_istream< SaveState_FileSource >	SaveState_istream_file;
 
-bool SaveState_SaveToFile( const char * filename )
-{
-	SaveState_ostream_gzip stream( filename );
-
-	if( !stream.IsValid() )
-		return false;
 
+template< typename Stream >
+static void SaveState_WriteState( Stream & stream )
+{
 	stream << SAVESTATE_PROJECT64_MAGIC_NUMBER;
 	stream << gRamSize;
 	ROMHeader rom_header;
@@ -248,7 +398,255 @@ bool SaveState_SaveToFile( const char * filename )
 	stream.write( g_pMemoryBuffers[MEM_PIF_RAM], 0x40);
 	stream.write( g_pMemoryBuffers[MEM_RD_RAM], gRamSize);
 	stream.write_memory_buffer(MEM_SP_MEM);
+}
+
+bool SaveState_SaveToFile( const char * filename )
+{
+	CSaveStateFileWriter * writer( CSaveStateFileWriter::Create( filename, NULL, 0 ) );
+	if( writer == NULL )
+		return false;
+
+	SaveState_ostream_sink stream( writer );
+
+	SaveState_WriteState( stream );
+	bool ok( writer->Finish() );
+	delete writer;
+	return ok;
+}
+
+bool SaveState_SaveToSink( CSaveStateSink * sink )
+{
+	SaveState_ostream_sink stream( sink );
+
+	SaveState_WriteState( stream );
+	return true;
+}
+
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+//
+//	Writes captured states out on a worker thread. Each slot holds the
+//	uncompressed state, which is written to filename.tmp and then renamed
+//	over filename, so a crash mid-write never leaves a truncated savestate.
+//	Saves are written in the order they were captured.
+//
+class CSaveStateWriter
+{
+public:
+	CSaveStateWriter()
+		:	mMutex( "SaveStateWriter" )
+		,	mWorkCond( CondCreate() )
+		,	mIdleCond( CondCreate() )
+		,	mNumPending( 0 )
+		,	mThread( kInvalidThreadHandle )
+		,	mQuit( false )
+	{
+		for( u32 i = 0; i < SAVESTATE_MAX_PENDING; ++i )
+		{
+			mSlots[ i ].InUse = false;
+		}
+	}
+
+	~CSaveStateWriter()
+	{
+		// Let anything outstanding finish writing
+		if( mThread != kInvalidThreadHandle )
+		{
+			{
+				MutexLock lock( &mMutex );
+				mQuit = true;
+				CondSignal( mWorkCond );
+			}
+			JoinThread( mThread, -1 );
+			ReleaseThreadHandle( mThread );
+		}
+
+		CondDestroy( mWorkCond );
+		CondDestroy( mIdleCond );
+	}
+
+	bool Queue( const char * filename, SaveStateCallback callback, void * arg )
+	{
+		SSlot * slot( NULL );
+		bool	write_now( false );
+		{
+			MutexLock lock( &mMutex );
+			for( u32 i = 0; i < SAVESTATE_MAX_PENDING && slot == NULL; ++i )
+			{
+				if( !mSlots[ i ].InUse )
+				{
+					slot = &mSlots[ i ];
+				}
+			}
+			if( slot == NULL )
+				return false;
+
+			if( mThread == kInvalidThreadHandle )
+			{
+				mThread = CreateThread( "SaveStateWriter", WriterThread, this );
+				write_now = mThread == kInvalidThreadHandle;
+			}
+
+			if( !write_now )
+			{
+				slot->InUse = true;
+				++mNumPending;
+			}
+		}
+
+		// Without a worker the save still has to happen, so write it here.
+		// The next save tries to start the thread again.
+		if( write_now )
+		{
+#ifdef DAEDALUS_DEBUG_CONSOLE
+			DBGConsole_Msg( 0, "Couldn't start the savestate writer, saving '%s' synchronously", filename );
+#endif
+			bool success( SaveState_SaveToFile( filename ) );
+			if( callback != NULL )
+			{
+				callback( filename, success, arg );
+			}
+			return true;
+		}
+
+		// The worker doesn't look at the slot until it's queued, so this can be done unlocked
+		SaveState_ostream_memory stream( &slot->State );
+		SaveState_WriteState( stream );
+
+		slot->Filename = filename;
+		slot->Callback = callback;
+		slot->Arg = arg;
+
+		MutexLock lock( &mMutex );
+		mQueue.push_back( slot );
+		CondSignal( mWorkCond );
+		return true;
+	}
+
+	void WaitForPending()
+	{
+		MutexLock lock( &mMutex );
+		while( mNumPending > 0 )
+		{
+			CondWait( mIdleCond, &mMutex, kTimeoutInfinity );
+		}
+	}
+
+	u32 GetNumPending()
+	{
+		MutexLock lock( &mMutex );
+		return mNumPending;
+	}
+
+private:
+	struct SSlot
+	{
+		std::vector< u8 >	State;
+		std::string			Filename;
+		SaveStateCallback	Callback;
+		void *				Arg;
+		bool				InUse;
+	};
+
+	static u32 DAEDALUS_THREAD_CALL_TYPE WriterThread( void * arg )
+	{
+		static_cast< CSaveStateWriter * >( arg )->Run();
+		return 0;
+	}
+
+	void Run()
+	{
+		MutexLock lock( &mMutex );
+
+		while( !mQuit || !mQueue.empty() )
+		{
+			if( mQueue.empty() )
+			{
+				CondWait( mWorkCond, &mMutex, kTimeoutInfinity );
+				continue;
+			}
+
+			SSlot * slot( mQueue.front() );
+			mQueue.pop_front();
+
+			mMutex.Unlock();
+			bool success( Write( slot ) );
+			if( slot->Callback != NULL )
+			{
+				slot->Callback( slot->Filename.c_str(), success, slot->Arg );
+			}
+			mMutex.Lock();
+
+			slot->InUse = false;
+			--mNumPending;
+			CondSignal( mIdleCond );
+		}
+	}
+
+	static bool Write( const SSlot * slot )
+	{
+		IO::Filename	temp_filename;
+		snprintf( temp_filename, sizeof( temp_filename ), "%s.tmp", slot->Filename.c_str() );
+
+		bool	ok( SaveStateFile_Write( temp_filename, &slot->State[ 0 ], slot->State.size(), NULL, 0 ) );
+
+		if( ok && !IO::File::Move( temp_filename, slot->Filename.c_str() ) )
+		{
+			// Not every platform's rename replaces an existing file
+			IO::File::Delete( slot->Filename.c_str() );
+			ok = IO::File::Move( temp_filename, slot->Filename.c_str() );
+		}
+		if( !ok )
+		{
+#ifdef DAEDALUS_DEBUG_CONSOLE
+			DBGConsole_Msg( 0, "Failed to write savestate '%s'", slot->Filename.c_str() );
+#endif
+			IO::File::Delete( temp_filename );
+		}
+		return ok;
+	}
+
+private:
+	Mutex					mMutex;				// Protects everything below, and InUse in the slots
+	Cond *					mWorkCond;
+	Cond *					mIdleCond;
+	SSlot					mSlots[ SAVESTATE_MAX_PENDING ];
+	std::deque< SSlot * >	mQueue;
+	u32						mNumPending;		// Slots which are being captured, queued or written
+	ThreadHandle			mThread;
+	bool					mQuit;
+};
+
+static CSaveStateWriter		gSaveStateWriter;
+#endif // DAEDALUS_ASYNC_SAVESTATES
+
+bool SaveState_SaveToFileAsync( const char * filename, SaveStateCallback callback, void * arg )
+{
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+	return gSaveStateWriter.Queue( filename, callback, arg );
+#else
+	bool success( SaveState_SaveToFile( filename ) );
+	if( callback != NULL )
+	{
+		callback( filename, success, arg );
+	}
 	return true;
+#endif
+}
+
+void SaveState_WaitForPendingSaves()
+{
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+	gSaveStateWriter.WaitForPending();
+#endif
+}
+
+u32 SaveState_GetNumPendingSaves()
+{
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+	return gSaveStateWriter.GetNumPending();
+#else
+	return 0;
+#endif
 }
 
 // In revision >=715 we were byte swapping PIF RAM in a temp buffer, this broke compatibility with PJ64 saves
@@ -263,22 +661,15 @@ static void Swap_PIF()
 		return;
 	}
 
-	u8 temp[64];
+	u32 temp[16];
 	memcpy( temp, pPIFRam, 64 );
 
-	for (u32 i = 0; i < 64; i++)
-	{
-		pPIFRam[i] = temp[ i ^ U8_TWIDDLE ];
-	}
+	ByteSwap_CopyN64( pPIFRam, temp, 64, 0 );
 }
 
-bool SaveState_LoadFromFile( const char * filename )
+template< typename Stream >
+static bool SaveState_ReadState( Stream & stream )
 {
-	SaveState_istream_gzip stream( filename );
-
-	if( !stream.IsValid() )
-		return false;
-
 	u32 value;
 	stream >> value;
 	if(value != SAVESTATE_PROJECT64_MAGIC_NUMBER)
@@ -382,6 +773,7 @@ bool SaveState_LoadFromFile( const char * filename )
 			gCPUState.CPUControl[i]._u32 = g_dwNewCPR0[i];
 		}
 	}
+	TLB_InvalidatePageTable();		// ENTRYHI (and so the ASID) has changed
 	//stream.skip(0x40);
 
 	stream.read(g_pMemoryBuffers[MEM_PIF_RAM], 0x40);
@@ -397,48 +789,94 @@ bool SaveState_LoadFromFile( const char * filename )
 	return true;
 }
 
-RomID SaveState_GetRomID( const char * filename )
+bool SaveState_LoadFromFile( const char * filename )
 {
+	// Make sure we don't read a state that's still being written
+	SaveState_WaitForPendingSaves();
+
+	if( SaveStateFile_IsChunked( filename ) )
+	{
+		CSaveStateFileReader * reader( CSaveStateFileReader::Create( filename ) );
+		if( reader == NULL )
+			return false;
+
+		// The header and table of contents have been checked, but as with
+		// Project64's files a damaged section is only found once the state
+		// before it has been loaded
+		SaveState_istream_file stream( reader );
+
+		bool ok( SaveState_ReadState( stream ) && stream.IsValid() );
+		delete reader;
+		return ok;
+	}
+
+	// Project64 format
 	SaveState_istream_gzip stream( filename );
 
 	if( !stream.IsValid() )
-		return RomID();
+		return false;
 
-	u32 value;
-	stream >> value;
-	if(value != SAVESTATE_PROJECT64_MAGIC_NUMBER)
-		return RomID();
+	return SaveState_ReadState( stream );
+}
 
-	u32 ram_size;
-	stream >> ram_size;
+bool SaveState_LoadFromBuffer( const u8 * data, u32 length )
+{
+	SaveState_istream_memory stream( data, length );
 
-	ROMHeader rom_header;
-	stream >> rom_header;
-	ROMFile::ByteSwap_3210(&rom_header, 64);
+	if( !stream.IsValid() )
+		return false;
 
-	return RomID( rom_header.CRC1, rom_header.CRC2, rom_header.CountryID );
+	return SaveState_ReadState( stream );
 }
 
-const char* SaveState_GetRom( const char * filename )
+// Only reads the header, which isn't compressed in our own format
+template< typename Stream >
+static bool SaveState_ReadRomHeader( Stream & stream, ROMHeader * rom_header )
 {
-	SaveState_istream_gzip stream( filename );
-
 	if( !stream.IsValid() )
-		return NULL;
+		return false;
 
 	u32 value;
 	stream >> value;
 	if(value != SAVESTATE_PROJECT64_MAGIC_NUMBER)
-		return NULL;
+		return false;
 
 	u32 ram_size;
 	stream >> ram_size;
 
+	stream >> *rom_header;
+	ROMFile::ByteSwap_3210(rom_header, 64);
+	return true;
+}
+
+static bool SaveState_ReadRomHeader( const char * filename, ROMHeader * rom_header )
+{
+	u8 header[ SAVESTATE_PROJECT64_HEADER_SIZE ];
+	if( SaveStateFile_ReadHeader( filename, header ) )
+	{
+		SaveState_istream_memory stream( header, sizeof( header ) );
+		return SaveState_ReadRomHeader( stream, rom_header );
+	}
+
+	SaveState_istream_gzip stream( filename );
+	return SaveState_ReadRomHeader( stream, rom_header );
+}
+
+RomID SaveState_GetRomID( const char * filename )
+{
 	ROMHeader rom_header;
-	stream >> rom_header;
-	ROMFile::ByteSwap_3210(&rom_header, 64);
+	if( !SaveState_ReadRomHeader( filename, &rom_header ) )
+		return RomID();
+
+	return RomID( rom_header.CRC1, rom_header.CRC2, rom_header.CountryID );
+}
+
+const char* SaveState_GetRom( const char * filename )
+{
+	ROMHeader rom_header;
+	if( !SaveState_ReadRomHeader( filename, &rom_header ) )
+		return NULL;
 
 	return CRomDB::Get()->QueryFilenameFromID(
 		RomID( rom_header.CRC1, rom_header.CRC2, rom_header.CountryID ));
 }
-
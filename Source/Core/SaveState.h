@@ -27,6 +27,38 @@ class RomID;
 
 bool SaveState_LoadFromFile( const char * filename );
 bool SaveState_SaveToFile( const char * filename );
+
+//
+//	Save to, or load from, somewhere other than a file. The state is written
+//	to the sink in several pieces, in the same format as the files.
+//
+class CSaveStateSink
+{
+public:
+	virtual ~CSaveStateSink() {}
+
+	virtual void WriteData( const void * data, u32 length ) = 0;
+};
+
+bool SaveState_SaveToSink( CSaveStateSink * sink );
+bool SaveState_LoadFromBuffer( const u8 * data, u32 length );
+
+//
+//	Asynchronous saving. The state is captured into a buffer straight away
+//	(mostly a copy of RDRAM) and written out on a worker thread. The callback,
+//	if any, is called on that thread once the file is in place or has failed.
+//	Returns false without saving if SAVESTATE_MAX_PENDING saves are still
+//	in flight. Without DAEDALUS_ASYNC_SAVESTATES, or if the worker thread
+//	can't be started, this saves synchronously and calls the callback on
+//	the calling thread.
+//
+#define SAVESTATE_MAX_PENDING	2
+
+typedef void (*SaveStateCallback)( const char * filename, bool success, void * arg );
+
+bool SaveState_SaveToFileAsync( const char * filename, SaveStateCallback callback, void * arg );
+void SaveState_WaitForPendingSaves();
+u32  SaveState_GetNumPendingSaves();
 RomID SaveState_GetRomID( const char * filename );
 const char* SaveState_GetRom(const char * filename);
 
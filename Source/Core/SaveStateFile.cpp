@@ -0,0 +1,815 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Core/SaveStateFile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include "Core/Memory.h"
+#include "Debug/DBGConsole.h"
+#include "Math/MathUtil.h"
+#include "Utility/ZlibWrapper.h"
+
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+#include "Utility/Thread.h"
+#endif
+
+namespace
+{
+	const u32	kMagic = 0x46535344;				// 'DSSF'
+	const u32	kVersion = 1;
+	const u32	kRDRAMBlockSize = 256 * 1024;
+
+	enum ESection
+	{
+		SECTION_CPU = 1,				// PC and GPRs
+		SECTION_COP1,					// FPRs
+		SECTION_COP0,
+		SECTION_COP1_CONTROL,
+		SECTION_MULT,					// HI/LO
+		SECTION_RD_REG,
+		SECTION_SP_REG,
+		SECTION_DPC_REG,
+		SECTION_MI_REG,
+		SECTION_VI_REG,
+		SECTION_AI_REG,
+		SECTION_PI_REG,
+		SECTION_RI_REG,
+		SECTION_SI_REG,
+		SECTION_TLB,
+		SECTION_PIF_RAM,
+		SECTION_RDRAM,					// One per block
+		SECTION_SP_MEM,
+	};
+
+	const u32	SECTION_FLAG_DEFLATED = 1 << 0;
+
+	struct SFileHeader
+	{
+		u32		Magic;
+		u32		Version;
+		u32		HeaderCRC;				// Of the rest of the header and the table of contents
+		u32		StateLength;
+		u32		NumSections;
+		u32		ThumbnailOffset;
+		u32		ThumbnailLength;
+		u32		Reserved;
+		u8		Project64Header[ SAVESTATE_PROJECT64_HEADER_SIZE ];
+	};
+
+	struct SSection
+	{
+		u32		Id;
+		u32		StateOffset;
+		u32		Length;
+		u32		FileOffset;
+		u32		StoredLength;
+		u32		Flags;
+		u32		CRC;					// Of the uncompressed data
+	};
+
+	void AddSection( std::vector< SSection > & sections, u32 id, u32 * p_offset, u32 length )
+	{
+		SSection section;
+		memset( &section, 0, sizeof( section ) );
+		section.Id = id;
+		section.StateOffset = *p_offset;
+		section.Length = length;
+		sections.push_back( section );
+
+		*p_offset += length;
+	}
+
+	//
+	//	Where everything is in a state of Project64's layout, which is what
+	//	SaveState_WriteState produces. Returns the length of the whole state.
+	//
+	u32 GetLayout( u32 ram_size, std::vector< SSection > & sections )
+	{
+		u32 offset( SAVESTATE_PROJECT64_HEADER_SIZE );
+
+		sections.clear();
+		AddSection( sections, SECTION_CPU,			&offset, 4 + 32 * 8 );
+		AddSection( sections, SECTION_COP1,			&offset, 32 * 4 + 0x80 );
+		AddSection( sections, SECTION_COP0,			&offset, 32 * 4 );
+		AddSection( sections, SECTION_COP1_CONTROL,	&offset, 32 * 4 );
+		AddSection( sections, SECTION_MULT,			&offset, 2 * 8 );
+		AddSection( sections, SECTION_RD_REG,		&offset, 0x28 );
+		AddSection( sections, SECTION_SP_REG,		&offset, 0x28 );
+		AddSection( sections, SECTION_DPC_REG,		&offset, 0x28 );
+		AddSection( sections, SECTION_MI_REG,		&offset, MemoryRegionSizes[ MEM_MI_REG ] );
+		AddSection( sections, SECTION_VI_REG,		&offset, MemoryRegionSizes[ MEM_VI_REG ] );
+		AddSection( sections, SECTION_AI_REG,		&offset, MemoryRegionSizes[ MEM_AI_REG ] );
+		AddSection( sections, SECTION_PI_REG,		&offset, MemoryRegionSizes[ MEM_PI_REG ] );
+		AddSection( sections, SECTION_RI_REG,		&offset, MemoryRegionSizes[ MEM_RI_REG ] );
+		AddSection( sections, SECTION_SI_REG,		&offset, 4 * 4 );
+		AddSection( sections, SECTION_TLB,			&offset, 32 * 5 * 4 );
+		AddSection( sections, SECTION_PIF_RAM,		&offset, 0x40 );
+		for( u32 i = 0; i < ram_size; i += kRDRAMBlockSize )
+		{
+			AddSection( sections, SECTION_RDRAM,	&offset, Min( ram_size - i, kRDRAMBlockSize ) );
+		}
+		AddSection( sections, SECTION_SP_MEM,		&offset, MemoryRegionSizes[ MEM_SP_MEM ] );
+
+		return offset;
+	}
+
+	bool GetRamSize( const u8 * project64_header, u32 * p_ram_size )
+	{
+		u32 magic, ram_size;
+		memcpy( &magic, project64_header, sizeof( u32 ) );
+		memcpy( &ram_size, project64_header + sizeof( u32 ), sizeof( u32 ) );
+
+		if( magic != SAVESTATE_PROJECT64_MAGIC_NUMBER || ram_size == 0 || ram_size > MAX_RAM_ADDRESS )
+			return false;
+
+		*p_ram_size = ram_size;
+		return true;
+	}
+
+	u32 GetHeaderCRC( const SFileHeader & header, const std::vector< SSection > & sections )
+	{
+		SFileHeader	temp( header );
+		temp.HeaderCRC = 0;
+
+		uLong crc( crc32( 0, reinterpret_cast< const Bytef * >( &temp ), sizeof( temp ) ) );
+		if( !sections.empty() )
+		{
+			crc = crc32( crc, reinterpret_cast< const Bytef * >( &sections[ 0 ] ), sections.size() * sizeof( SSection ) );
+		}
+		return u32( crc );
+	}
+
+	bool ReadHeader( FILE * fh, SFileHeader * p_header, std::vector< SSection > * p_sections )
+	{
+		if( fread( p_header, sizeof( SFileHeader ), 1, fh ) != 1 ||
+			p_header->Magic != kMagic ||
+			p_header->Version != kVersion )
+		{
+			return false;
+		}
+
+		// Sanity check before allocating - even 1KB sections wouldn't need this many
+		if( p_header->NumSections > MAX_RAM_ADDRESS / 1024 )
+			return false;
+
+		p_sections->resize( p_header->NumSections );
+		if( p_header->NumSections > 0 &&
+			fread( &(*p_sections)[ 0 ], sizeof( SSection ), p_header->NumSections, fh ) != p_header->NumSections )
+		{
+			return false;
+		}
+
+		return GetHeaderCRC( *p_header, *p_sections ) == p_header->HeaderCRC;
+	}
+
+	//
+	//	stored holds the section's data as it is in the file and dst is where
+	//	it goes in the state, both already offset to this section
+	//
+	bool DecodeSection( const u8 * stored, const SSection & section, u8 * dst )
+	{
+		if( section.Flags & SECTION_FLAG_DEFLATED )
+		{
+			uLongf length( section.Length );
+			if( uncompress( dst, &length, stored, section.StoredLength ) != Z_OK || length != section.Length )
+				return false;
+		}
+		else
+		{
+			if( section.StoredLength != section.Length )
+				return false;
+
+			memcpy( dst, stored, section.Length );
+		}
+
+		return crc32( 0, dst, section.Length ) == section.CRC;
+	}
+
+	//
+	//	A run of sections which have been read in to Stored, one after the
+	//	other, and are inflated to State, also one after the other. Each job
+	//	inflates every Stride'th section, starting at First.
+	//
+	struct SDecodeJob
+	{
+		const u8 *				Stored;
+		const u32 *				StoredOffsets;
+		const SSection *		Sections;
+		u32						NumSections;
+		u8 *					State;
+		u32						First;
+		u32						Stride;
+		bool					Ok;
+	};
+
+	void RunDecodeJob( SDecodeJob * job )
+	{
+		for( u32 i = job->First; i < job->NumSections && job->Ok; i += job->Stride )
+		{
+			const SSection &	section( job->Sections[ i ] );
+			u32					state_offset( section.StateOffset - job->Sections[ 0 ].StateOffset );
+
+			job->Ok = DecodeSection( job->Stored + job->StoredOffsets[ i ], section, job->State + state_offset );
+		}
+	}
+
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+	u32 DAEDALUS_THREAD_CALL_TYPE DecodeThread( void * arg )
+	{
+		RunDecodeJob( static_cast< SDecodeJob * >( arg ) );
+		return 0;
+	}
+#endif
+
+	bool DecodeSections( const u8 * stored, const u32 * stored_offsets, const SSection * sections, u32 num_sections, u8 * p_state )
+	{
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+		const u32		kNumJobs = SAVESTATE_LOAD_THREADS;
+#else
+		const u32		kNumJobs = 1;
+#endif
+		SDecodeJob		jobs[ kNumJobs ];
+		for( u32 i = 0; i < kNumJobs; ++i )
+		{
+			SDecodeJob job = { stored, stored_offsets, sections, num_sections, p_state, i, kNumJobs, true };
+			jobs[ i ] = job;
+		}
+
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+		// The first job is run on this thread, as is any we can't start a thread
+		// for. There's no point starting threads with nothing to do
+		ThreadHandle	threads[ kNumJobs ];
+		for( u32 i = 1; i < kNumJobs; ++i )
+		{
+			threads[ i ] = kInvalidThreadHandle;
+			if( i < num_sections )
+			{
+				threads[ i ] = CreateThread( "SaveStateDecode", DecodeThread, &jobs[ i ] );
+				if( threads[ i ] == kInvalidThreadHandle )
+				{
+					RunDecodeJob( &jobs[ i ] );
+				}
+			}
+		}
+		RunDecodeJob( &jobs[ 0 ] );
+		for( u32 i = 1; i < kNumJobs; ++i )
+		{
+			if( threads[ i ] != kInvalidThreadHandle )
+			{
+				JoinThread( threads[ i ], -1 );
+				ReleaseThreadHandle( threads[ i ] );
+			}
+		}
+#else
+		RunDecodeJob( &jobs[ 0 ] );
+#endif
+
+		bool ok( true );
+		for( u32 i = 0; i < kNumJobs; ++i )
+		{
+			ok = ok && jobs[ i ].Ok;
+		}
+		return ok;
+	}
+
+	//
+	//	The state is taken a piece at a time, in whatever sizes it comes. Once
+	//	Project64's header is in the RAM size, and so the layout, is known. A
+	//	section is gathered in mPending unless it arrives whole.
+	//
+	class CChunkedStateWriter : public CSaveStateFileWriter
+	{
+	public:
+		CChunkedStateWriter( FILE * fh, const u8 * thumbnail, u32 thumbnail_length )
+			:	mFile( fh )
+			,	mHeaderLength( 0 )
+			,	mNextSection( 0 )
+			,	mDataOffset( 0 )
+			,	mOk( true )
+		{
+			memset( &mHeader, 0, sizeof( mHeader ) );
+			if( thumbnail != NULL )
+			{
+				mThumbnail.assign( thumbnail, thumbnail + thumbnail_length );
+			}
+		}
+
+		~CChunkedStateWriter()
+		{
+			if( mFile != NULL )
+			{
+				fclose( mFile );
+			}
+		}
+
+		virtual void WriteData( const void * data, u32 length )
+		{
+			const u8 *	src( static_cast< const u8 * >( data ) );
+
+			while( length > 0 && mOk )
+			{
+				if( mHeaderLength < SAVESTATE_PROJECT64_HEADER_SIZE )
+				{
+					u32 count( Min( length, SAVESTATE_PROJECT64_HEADER_SIZE - mHeaderLength ) );
+					memcpy( mHeader.Project64Header + mHeaderLength, src, count );
+					mHeaderLength += count;
+					src += count;
+					length -= count;
+
+					if( mHeaderLength == SAVESTATE_PROJECT64_HEADER_SIZE )
+					{
+						mOk = Begin();
+					}
+				}
+				else if( mNextSection >= mSections.size() )
+				{
+					// More than the layout allows for
+					mOk = false;
+				}
+				else
+				{
+					const SSection &	section( mSections[ mNextSection ] );
+
+					if( mPending.empty() && length >= section.Length )
+					{
+						mOk = WriteSection( src );
+						src += section.Length;
+						length -= section.Length;
+					}
+					else
+					{
+						u32 count( Min( length, u32( section.Length - mPending.size() ) ) );
+						mPending.insert( mPending.end(), src, src + count );
+						src += count;
+						length -= count;
+
+						if( mPending.size() == section.Length )
+						{
+							mOk = WriteSection( &mPending[ 0 ] );
+							mPending.clear();
+						}
+					}
+				}
+			}
+		}
+
+		virtual bool Finish()
+		{
+			bool ok( mOk && mHeaderLength == SAVESTATE_PROJECT64_HEADER_SIZE && mNextSection == mSections.size() );
+			if( ok )
+			{
+				mHeader.HeaderCRC = GetHeaderCRC( mHeader, mSections );
+
+				ok = fseek( mFile, 0, SEEK_SET ) == 0 &&
+					 fwrite( &mHeader, sizeof( mHeader ), 1, mFile ) == 1 &&
+					 fwrite( &mSections[ 0 ], sizeof( SSection ), mSections.size(), mFile ) == mSections.size();
+			}
+#ifdef DAEDALUS_DEBUG_CONSOLE
+			else if( mOk )
+			{
+				DBGConsole_Msg( 0, "Savestate isn't laid out as expected" );
+			}
+#endif
+
+			ok = fclose( mFile ) == 0 && ok;
+			mFile = NULL;
+			return ok;
+		}
+
+	private:
+		bool Begin()
+		{
+			u32 ram_size;
+			if( !GetRamSize( mHeader.Project64Header, &ram_size ) )
+				return false;
+
+			mHeader.Magic = kMagic;
+			mHeader.Version = kVersion;
+			mHeader.StateLength = GetLayout( ram_size, mSections );
+			mHeader.NumSections = u32( mSections.size() );
+			mHeader.ThumbnailOffset = sizeof( SFileHeader ) + mHeader.NumSections * sizeof( SSection );
+			mHeader.ThumbnailLength = u32( mThumbnail.size() );
+
+			mPending.reserve( kRDRAMBlockSize );
+			mDataOffset = mHeader.ThumbnailOffset + mHeader.ThumbnailLength;
+
+			// The header and table of contents are filled in once the sections have been written
+			return fseek( mFile, mHeader.ThumbnailOffset, SEEK_SET ) == 0 &&
+				   ( mThumbnail.empty() || fwrite( &mThumbnail[ 0 ], 1, mThumbnail.size(), mFile ) == mThumbnail.size() );
+		}
+
+		// Sections which don't get any smaller are stored as they are
+		bool WriteSection( const u8 * src )
+		{
+			SSection &	section( mSections[ mNextSection++ ] );
+
+			mBuffer.resize( compressBound( section.Length ) );
+			uLongf		stored_length( mBuffer.size() );
+			bool		deflated( compress2( &mBuffer[ 0 ], &stored_length, src, section.Length, Z_DEFAULT_COMPRESSION ) == Z_OK &&
+								  stored_length < section.Length );
+
+			if( !deflated )
+			{
+				stored_length = section.Length;
+			}
+
+			section.FileOffset = mDataOffset;
+			section.StoredLength = u32( stored_length );
+			section.Flags = deflated ? SECTION_FLAG_DEFLATED : 0;
+			section.CRC = crc32( 0, src, section.Length );
+
+			mDataOffset += u32( stored_length );
+
+			return fwrite( deflated ? &mBuffer[ 0 ] : src, 1, stored_length, mFile ) == stored_length;
+		}
+
+	private:
+		FILE *					mFile;
+		SFileHeader				mHeader;
+		u32						mHeaderLength;			// How much of Project64's header has been written
+		std::vector< SSection >	mSections;
+		u32						mNextSection;
+		std::vector< u8 >		mPending;
+		std::vector< u8 >		mBuffer;
+		std::vector< u8 >		mThumbnail;
+		u32						mDataOffset;
+		bool					mOk;
+	};
+
+	//
+	//	Sections are read from the file as they're needed. Runs of whole
+	//	sections are inflated straight into the caller's buffer (in parallel
+	//	with DAEDALUS_ASYNC_SAVESTATES, a few at a time to bound how much is
+	//	read in at once), anything else goes through mBuffer.
+	//
+	class CChunkedStateReader : public CSaveStateFileReader
+	{
+	public:
+		CChunkedStateReader( FILE * fh, const SFileHeader & header, const std::vector< SSection > & sections )
+			:	mFile( fh )
+			,	mHeader( header )
+			,	mSections( sections )
+			,	mHeaderOffset( 0 )
+			,	mNextSection( 0 )
+			,	mBufferOffset( 0 )
+			,	mOk( true )
+		{
+		}
+
+		~CChunkedStateReader()
+		{
+			fclose( mFile );
+		}
+
+		virtual u32 GetStateLength() const
+		{
+			return mHeader.StateLength;
+		}
+
+		virtual bool ReadData( void * data, u32 length )
+		{
+			u8 *	dst( static_cast< u8 * >( data ) );
+
+			while( length > 0 && mOk )
+			{
+				u32 count( 0 );
+				if( mHeaderOffset < SAVESTATE_PROJECT64_HEADER_SIZE )
+				{
+					count = Min( length, SAVESTATE_PROJECT64_HEADER_SIZE - mHeaderOffset );
+					memcpy( dst, mHeader.Project64Header + mHeaderOffset, count );
+					mHeaderOffset += count;
+				}
+				else if( mBufferOffset < mBuffer.size() )
+				{
+					count = Min( length, u32( mBuffer.size() - mBufferOffset ) );
+					memcpy( dst, &mBuffer[ mBufferOffset ], count );
+					mBufferOffset += count;
+				}
+				else if( mNextSection >= mSections.size() )
+				{
+					// Past the end of the state
+					mOk = false;
+				}
+				else
+				{
+					u32 num_sections( 0 );
+					while( mNextSection + num_sections < mSections.size() && num_sections < kMaxSectionsPerRead &&
+						   mSections[ mNextSection + num_sections ].Length <= length - count )
+					{
+						count += mSections[ mNextSection + num_sections ].Length;
+						++num_sections;
+					}
+
+					if( num_sections > 0 )
+					{
+						mOk = Decode( num_sections, dst );
+					}
+					else
+					{
+						mBuffer.resize( mSections[ mNextSection ].Length );
+						mBufferOffset = 0;
+						mOk = Decode( 1, &mBuffer[ 0 ] );
+					}
+				}
+
+				dst += count;
+				length -= count;
+			}
+
+			return mOk;
+		}
+
+	private:
+		bool Decode( u32 num_sections, u8 * dst )
+		{
+			const SSection *	sections( &mSections[ mNextSection ] );
+
+			mStoredOffsets.resize( num_sections );
+			u32 stored_length( 0 );
+			for( u32 i = 0; i < num_sections; ++i )
+			{
+				mStoredOffsets[ i ] = stored_length;
+				stored_length += sections[ i ].StoredLength;
+			}
+
+			mStored.resize( stored_length + 1 );		// + 1 so it's never empty
+			for( u32 i = 0; i < num_sections; ++i )
+			{
+				if( fseek( mFile, sections[ i ].FileOffset, SEEK_SET ) != 0 ||
+					fread( &mStored[ mStoredOffsets[ i ] ], 1, sections[ i ].StoredLength, mFile ) != sections[ i ].StoredLength )
+				{
+					return false;
+				}
+			}
+
+			mNextSection += num_sections;
+
+			if( !DecodeSections( &mStored[ 0 ], &mStoredOffsets[ 0 ], sections, num_sections, dst ) )
+			{
+#ifdef DAEDALUS_DEBUG_CONSOLE
+				DBGConsole_Msg( 0, "Savestate failed its checksums" );
+#endif
+				return false;
+			}
+			return true;
+		}
+
+	private:
+#ifdef DAEDALUS_ASYNC_SAVESTATES
+		static const u32		kMaxSectionsPerRead = SAVESTATE_LOAD_THREADS * 2;
+#else
+		static const u32		kMaxSectionsPerRead = 1;
+#endif
+
+		FILE *					mFile;
+		SFileHeader				mHeader;
+		std::vector< SSection >	mSections;
+		u32						mHeaderOffset;			// How much of Project64's header has been read
+		u32						mNextSection;
+		std::vector< u8 >		mBuffer;				// The part of a section which hasn't been read yet
+		u32						mBufferOffset;
+		std::vector< u8 >		mStored;
+		std::vector< u32 >		mStoredOffsets;
+		bool					mOk;
+	};
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 SaveStateFile_GetStateLength( u32 ram_size )
+{
+	std::vector< SSection >	sections;
+
+	return GetLayout( ram_size, sections );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool SaveStateFile_IsChunked( const char * filename )
+{
+	FILE * fh( fopen( filename, "rb" ) );
+	if( fh == NULL )
+		return false;
+
+	u32 magic( 0 );
+	bool ok( fread( &magic, sizeof( magic ), 1, fh ) == 1 && magic == kMagic );
+	fclose( fh );
+	return ok;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CSaveStateFileWriter * CSaveStateFileWriter::Create( const char * filename, const u8 * thumbnail, u32 thumbnail_length )
+{
+	FILE * fh( fopen( filename, "wb" ) );
+	if( fh == NULL )
+		return NULL;
+
+	return new CChunkedStateWriter( fh, thumbnail, thumbnail_length );
+}
+
+bool SaveStateFile_Write( const char * filename, const u8 * state, u32 length, const u8 * thumbnail, u32 thumbnail_length )
+{
+	CSaveStateFileWriter * writer( CSaveStateFileWriter::Create( filename, thumbnail, thumbnail_length ) );
+	if( writer == NULL )
+		return false;
+
+	writer->WriteData( state, length );
+	bool ok( writer->Finish() );
+	delete writer;
+	return ok;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CSaveStateFileReader * CSaveStateFileReader::Create( const char * filename )
+{
+	FILE * fh( fopen( filename, "rb" ) );
+	if( fh == NULL )
+		return NULL;
+
+	SFileHeader				header;
+	std::vector< SSection >	sections;
+	long					file_size( 0 );
+
+	bool ok( ReadHeader( fh, &header, &sections ) );
+	if( ok )
+	{
+		ok = fseek( fh, 0, SEEK_END ) == 0;
+		file_size = ftell( fh );
+		ok = ok && file_size > 0;
+	}
+
+	// The state has to be the length its RAM size implies, before anything
+	// is allocated from it
+	std::vector< SSection >	layout;
+	u32						ram_size;
+	ok = ok && GetRamSize( header.Project64Header, &ram_size ) &&
+		 header.StateLength == GetLayout( ram_size, layout );
+
+	// The sections have to cover the state in order, and be in the file
+	u32 state_offset( SAVESTATE_PROJECT64_HEADER_SIZE );
+	for( u32 i = 0; i < sections.size() && ok; ++i )
+	{
+		const SSection & section( sections[ i ] );
+
+		ok = section.StateOffset == state_offset &&
+			 section.Length <= header.StateLength - state_offset &&
+			 section.FileOffset <= u32( file_size ) &&
+			 section.StoredLength <= u32( file_size ) - section.FileOffset;
+
+		state_offset += section.Length;
+	}
+	ok = ok && state_offset == header.StateLength;
+
+	if( !ok )
+	{
+#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Savestate '%s' is damaged", filename );
+#endif
+		fclose( fh );
+		return NULL;
+	}
+
+	return new CChunkedStateReader( fh, header, sections );
+}
+
+bool SaveStateFile_Read( const char * filename, std::vector< u8 > * state )
+{
+	CSaveStateFileReader * reader( CSaveStateFileReader::Create( filename ) );
+	if( reader == NULL )
+		return false;
+
+	state->resize( reader->GetStateLength() );
+	bool ok( reader->ReadData( &(*state)[ 0 ], state->size() ) );
+	delete reader;
+	return ok;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool SaveStateFile_ReadHeader( const char * filename, u8 project64_header[ SAVESTATE_PROJECT64_HEADER_SIZE ] )
+{
+	FILE * fh( fopen( filename, "rb" ) );
+	if( fh == NULL )
+		return false;
+
+	SFileHeader				header;
+	std::vector< SSection >	sections;
+
+	bool ok( ReadHeader( fh, &header, &sections ) );
+	fclose( fh );
+
+	if( ok )
+	{
+		memcpy( project64_header, header.Project64Header, SAVESTATE_PROJECT64_HEADER_SIZE );
+	}
+	return ok;
+}
+
+bool SaveStateFile_ReadThumbnail( const char * filename, std::vector< u8 > * thumbnail )
+{
+	FILE * fh( fopen( filename, "rb" ) );
+	if( fh == NULL )
+		return false;
+
+	SFileHeader				header;
+	std::vector< SSection >	sections;
+
+	bool ok( ReadHeader( fh, &header, &sections ) && header.ThumbnailLength > 0 );
+	if( ok )
+	{
+		thumbnail->resize( header.ThumbnailLength );
+		ok = fseek( fh, header.ThumbnailOffset, SEEK_SET ) == 0 &&
+			 fread( &(*thumbnail)[ 0 ], 1, header.ThumbnailLength, fh ) == header.ThumbnailLength;
+	}
+	fclose( fh );
+	return ok;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool SaveStateFile_ImportProject64( const char * pj64_filename, const char * filename )
+{
+	CInStream stream( pj64_filename );
+	if( !stream.IsOpen() )
+		return false;
+
+	u8 project64_header[ SAVESTATE_PROJECT64_HEADER_SIZE ];
+	u32 ram_size;
+	if( !stream.ReadData( project64_header, sizeof( project64_header ) ) || !GetRamSize( project64_header, &ram_size ) )
+		return false;
+
+	CSaveStateFileWriter * writer( CSaveStateFileWriter::Create( filename, NULL, 0 ) );
+	if( writer == NULL )
+		return false;
+
+	writer->WriteData( project64_header, sizeof( project64_header ) );
+
+	std::vector< u8 >	buffer( kRDRAMBlockSize );
+	u32					remaining( SaveStateFile_GetStateLength( ram_size ) - SAVESTATE_PROJECT64_HEADER_SIZE );
+	bool				ok( true );
+	while( remaining > 0 && ok )
+	{
+		u32 count( Min( remaining, u32( buffer.size() ) ) );
+		ok = stream.ReadData( &buffer[ 0 ], count );
+		if( ok )
+		{
+			writer->WriteData( &buffer[ 0 ], count );
+		}
+		remaining -= count;
+	}
+
+	ok = writer->Finish() && ok;
+	delete writer;
+	return ok;
+}
+
+bool SaveStateFile_ExportProject64( const char * filename, const char * pj64_filename )
+{
+	CSaveStateFileReader * reader( CSaveStateFileReader::Create( filename ) );
+	if( reader == NULL )
+		return false;
+
+	COutStream stream( pj64_filename );
+
+	std::vector< u8 >	buffer( kRDRAMBlockSize );
+	u32					remaining( reader->GetStateLength() );
+	bool				ok( stream.IsOpen() );
+	while( remaining > 0 && ok )
+	{
+		u32 count( Min( remaining, u32( buffer.size() ) ) );
+		ok = reader->ReadData( &buffer[ 0 ], count ) && stream.WriteData( &buffer[ 0 ], count );
+		remaining -= count;
+	}
+	delete reader;
+
+	return ok && stream.Flush();
+}
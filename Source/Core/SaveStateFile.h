@@ -0,0 +1,96 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef CORE_SAVESTATEFILE_H_
+#define CORE_SAVESTATEFILE_H_
+
+#include <vector>
+
+#include "Core/SaveState.h"
+#include "Utility/DaedalusTypes.h"
+
+//
+//	The savestate file format. The state itself is serialised in Project64's
+//	layout (see SaveState.cpp); this splits that into sections (the CPU,
+//	COP0/COP1, TLB, each memory region and RDRAM in 256KB blocks) which are
+//	each deflated separately and checksummed. The file starts with an
+//	uncompressed header holding Project64's header (which rom the state is
+//	for), a table of contents and an optional thumbnail, so these can be read
+//	without inflating anything, and the sections can be inflated in parallel.
+//
+//	Project64 files (a single gzip stream) can be converted either way.
+//	Nothing in the emulator calls the conversions or ReadThumbnail yet (loading
+//	reads Project64 files directly), they're here for frontends and tools.
+//
+
+const u32	SAVESTATE_PROJECT64_MAGIC_NUMBER	= 0x23D8A6C8;
+const u32	SAVESTATE_PROJECT64_HEADER_SIZE		= 0x4C;			// Magic, RAM size, rom header and VI count
+
+#define SAVESTATE_LOAD_THREADS	4		// With DAEDALUS_ASYNC_SAVESTATES, otherwise loads on the calling thread
+
+// Whether filename is in this format, rather than Project64's
+bool	SaveStateFile_IsChunked( const char * filename );
+
+// The length of a state in Project64's layout for this much RDRAM
+u32		SaveStateFile_GetStateLength( u32 ram_size );
+
+// state is length bytes in Project64's layout. The thumbnail is optional.
+bool	SaveStateFile_Write( const char * filename, const u8 * state, u32 length, const u8 * thumbnail, u32 thumbnail_length );
+bool	SaveStateFile_Read( const char * filename, std::vector< u8 > * state );
+
+//
+//	Writes a file as the state is produced. Each section is deflated and
+//	written out as soon as it's complete, so only one section (at most 256KB)
+//	is held at a time. The header and table of contents are written last.
+//
+class CSaveStateFileWriter : public CSaveStateSink
+{
+public:
+	static CSaveStateFileWriter *	Create( const char * filename, const u8 * thumbnail, u32 thumbnail_length );
+
+	virtual ~CSaveStateFileWriter() {}
+
+	// False if the state wasn't laid out as expected or couldn't be written
+	virtual bool					Finish() = 0;
+};
+
+//
+//	Reads the state back from a file a piece at a time. The header and table
+//	of contents are checked when it's created (NULL if they're damaged), the
+//	sections' checksums only as they're read. Reads which cover whole sections
+//	are inflated straight into the caller's buffer.
+//
+class CSaveStateFileReader
+{
+public:
+	static CSaveStateFileReader *	Create( const char * filename );
+
+	virtual ~CSaveStateFileReader() {}
+
+	virtual u32						GetStateLength() const = 0;
+	virtual bool					ReadData( void * data, u32 length ) = 0;
+};
+
+bool	SaveStateFile_ReadHeader( const char * filename, u8 header[ SAVESTATE_PROJECT64_HEADER_SIZE ] );
+bool	SaveStateFile_ReadThumbnail( const char * filename, std::vector< u8 > * thumbnail );
+
+bool	SaveStateFile_ImportProject64( const char * pj64_filename, const char * filename );
+bool	SaveStateFile_ExportProject64( const char * filename, const char * pj64_filename );
+
+#endif // CORE_SAVESTATEFILE_H_
@@ -19,6 +19,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "stdafx.h"
 
+#include <string.h>
+
 #include "TLB.h"
 #include "CPU.h"
 #include "Debug/DebugLog.h"
@@ -28,6 +30,82 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 ALIGNED_GLOBAL(TLBEntry, g_TLBs[32], CACHE_ALIGN);
 
+TLBPage *	gTLBPageTable[ kTLBNumTables ];
+
+//*****************************************************************************
+// Second level tables are never freed, only cleared, so we keep track of
+// which ones exist to avoid walking all of the top level on a full flush.
+//*****************************************************************************
+static u16	gTLBAllocatedTables[ kTLBNumTables ];
+static u32	gTLBNumAllocatedTables = 0;
+
+void TLB_InvalidatePageTable()
+{
+	for( u32 i = 0; i < gTLBNumAllocatedTables; ++i )
+	{
+		memset( gTLBPageTable[ gTLBAllocatedTables[ i ] ], 0, kTLBPagesPerTable * sizeof( TLBPage ) );
+	}
+}
+
+void TLB_InvalidatePageTableRange( u32 address, u32 length )
+{
+	if( length == 0 )
+		return;
+
+	u32 first_page = address >> kTLBPageShift;
+	u32 num_pages  = ((length - 1) >> kTLBPageShift) + 1;
+
+	if( num_pages >= (kTLBPagesPerTable * kTLBNumTables) / 2 )
+	{
+		TLB_InvalidatePageTable();
+		return;
+	}
+
+	for( u32 i = 0; i < num_pages; ++i )
+	{
+		u32 page = (first_page + i) & ((kTLBPagesPerTable * kTLBNumTables) - 1);
+
+		TLBPage * table = gTLBPageTable[ page / kTLBPagesPerTable ];
+		if( table != NULL )
+		{
+			TLBPage & entry = table[ page & (kTLBPagesPerTable - 1) ];
+			entry.pRead = NULL;
+			entry.pWrite = NULL;
+		}
+	}
+}
+
+static TLBPage * TLB_GetPage( u32 address )
+{
+	u32 table_idx = address >> kTLBTableShift;
+	TLBPage * table = gTLBPageTable[ table_idx ];
+	if( table == NULL )
+	{
+		table = new TLBPage[ kTLBPagesPerTable ];
+		memset( table, 0, kTLBPagesPerTable * sizeof( TLBPage ) );
+
+		gTLBPageTable[ table_idx ] = table;
+		gTLBAllocatedTables[ gTLBNumAllocatedTables++ ] = u16( table_idx );
+	}
+
+	return &table[ (address >> kTLBPageShift) & (kTLBPagesPerTable - 1) ];
+}
+
+//*****************************************************************************
+// Cache a successful translation. Only the 4KB page containing address is
+// filled in; the remaining pages of large TLB entries are filled on demand.
+//*****************************************************************************
+static void TLB_CacheTranslation( u32 address, u32 physical_addr, bool dirty )
+{
+	const u32 page_mask = ~((1 << kTLBPageShift) - 1);
+
+	u8 * base = g_pu8RamBase + ((physical_addr & 0x007FFFFF) & page_mask) - (address & page_mask);
+
+	TLBPage * page = TLB_GetPage( address );
+	page->pRead  = base;
+	page->pWrite = dirty ? base : NULL;
+}
+
 void TLBEntry::UpdateValue(u32 _pagemask, u32 _hi, u32 _pfno, u32 _pfne)
 {
 	// From the R4300i Instruction manual:
@@ -38,6 +116,9 @@ void TLBEntry::UpdateValue(u32 _pagemask, u32 _hi, u32 _pfno, u32 _pfne)
 #ifdef DAEDALUS_ENABLE_PROFILING
     DPF( DEBUG_TLB, "PAGEMASK: 0x%08x ENTRYHI: 0x%08x. ENTRYLO1: 0x%08x. ENTRYLO0: 0x%08x", _pagemask, _hi, _pfno, _pfne);
 #endif
+	// Throw away any pages cached from the previous contents of this entry
+	TLB_InvalidatePageTableRange( addrcheck, mask + 1 );
+
 	pagemask = _pagemask;
 	hi = _hi;
 	pfne = _pfne;
@@ -91,6 +172,9 @@ void TLBEntry::UpdateValue(u32 _pagemask, u32 _hi, u32 _pfno, u32 _pfne)
 		checkbit = 0;
 		break;
 	}
+
+	// The new mapping may shadow pages cached from another entry
+	TLB_InvalidatePageTableRange( addrcheck, mask + 1 );
 }
 
 void TLBEntry::Reset()
@@ -136,6 +220,26 @@ inline bool	TLBEntry::FindTLBEntry( u32 address, u32 * p_idx )
 	return false;
 }
 
+//*****************************************************************************
+//
+//*****************************************************************************
+bool TLBEntry::Probe(u32 address, u32 * p_physical)
+{
+	u32 iMatched;
+
+	if (!FindTLBEntry( address, &iMatched ))
+		return false;
+
+	const TLBEntry & tlb = g_TLBs[iMatched];
+	const bool odd = (address & tlb.checkbit) != 0;
+
+	if (((odd ? tlb.pfno : tlb.pfne) & TLBLO_V) == 0)
+		return false;
+
+	*p_physical = (odd ? tlb.pfnohi : tlb.pfnehi) | (address & tlb.mask2);
+	return true;
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -152,12 +256,20 @@ u32 TLBEntry::Translate(u32 address, bool& missing)
 		if (address & tlb.checkbit)
 		{
 			if( (tlb.pfno & TLBLO_V) != 0 )
-				return  tlb.pfnohi | (address & tlb.mask2);
+			{
+				u32 physical_addr = tlb.pfnohi | (address & tlb.mask2);
+				TLB_CacheTranslation( address, physical_addr, (tlb.pfno & TLBLO_D) != 0 );
+				return physical_addr;
+			}
 		}
 		else
 		{
 			if( (tlb.pfne & TLBLO_V) != 0 )
-				return tlb.pfnehi | (address & tlb.mask2);
+			{
+				u32 physical_addr = tlb.pfnehi | (address & tlb.mask2);
+				TLB_CacheTranslation( address, physical_addr, (tlb.pfne & TLBLO_D) != 0 );
+				return physical_addr;
+			}
 		}
 
 		// Throw TLB Invalid exception
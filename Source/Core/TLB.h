@@ -19,6 +19,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #pragma once
 
+#include <stddef.h>
+
 #include "Utility/Alignment.h"
 #include "Utility/DaedalusTypes.h"
 
@@ -43,6 +45,51 @@ public:
 	void UpdateValue(u32 _pagemask, u32 _hi, u32 _pfne, u32 _pfno);
 	void Reset();
 	static u32 Translate(u32 address, bool& missing);
+
+	// Looks up a valid mapping without raising an exception or caching it
+	static bool Probe(u32 address, u32 * p_physical);
 };
 
 ALIGNED_EXTERN(TLBEntry, g_TLBs[32], CACHE_ALIGN);
+
+//*****************************************************************************
+// Software page table caching successful TLB translations at 4KB granularity.
+// The top level is indexed by address>>22 and points at lazily allocated
+// second level tables of 1024 pages. Each page holds a host base for reads
+// and one for writes (only set when the entry is dirty), so that
+// host = base + address, in the same way as g_MemoryLookupTableRead.
+// A NULL base means the slow path (TLBEntry::Translate) must be taken.
+//*****************************************************************************
+struct TLBPage
+{
+	u8 *	pRead;
+	u8 *	pWrite;
+};
+
+static const u32 kTLBPageShift		= 12;
+static const u32 kTLBTableShift		= 22;
+static const u32 kTLBPagesPerTable	= 1 << (kTLBTableShift - kTLBPageShift);
+static const u32 kTLBNumTables		= 1 << (32 - kTLBTableShift);
+
+extern TLBPage *	gTLBPageTable[ kTLBNumTables ];
+
+void	TLB_InvalidatePageTable();							// Called when the ASID changes, on reset and savestate load
+void	TLB_InvalidatePageTableRange( u32 address, u32 length );
+
+inline u8 * TLB_GetReadBase( u32 address )
+{
+	const TLBPage * table = gTLBPageTable[ address >> kTLBTableShift ];
+	if( table == NULL )
+		return NULL;
+
+	return table[ (address >> kTLBPageShift) & (kTLBPagesPerTable - 1) ].pRead;
+}
+
+inline u8 * TLB_GetWriteBase( u32 address )
+{
+	const TLBPage * table = gTLBPageTable[ address >> kTLBTableShift ];
+	if( table == NULL )
+		return NULL;
+
+	return table[ (address >> kTLBPageShift) & (kTLBPagesPerTable - 1) ].pWrite;
+}
@@ -27,7 +27,13 @@
 
 // Ideas for the ignored assert taken from Game Programming Gems I
 
-#if defined(__clang__) && __has_feature(cxx_static_assert)
+#if defined(__clang__)
+#if __has_feature(cxx_static_assert)
+#define DAEDALUS_HAS_STATIC_ASSERT
+#endif
+#endif
+
+#ifdef DAEDALUS_HAS_STATIC_ASSERT
 
 #define DAEDALUS_STATIC_ASSERT( x ) static_assert((x), "Static Assert")
 
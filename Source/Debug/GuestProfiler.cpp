@@ -0,0 +1,633 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "GuestProfiler.h"
+
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+
+#include "Core/CPU.h"
+#include "Core/Memory.h"
+#include "Core/N64Reg.h"
+#include "Core/ROM.h"
+#include "Debug/DBGConsole.h"
+#include "Debug/Dump.h"
+#include "DynaRec/IndirectExitMap.h"
+#include "OSHLE/patch.h"
+#include "OSHLE/ultra_mbi.h"
+#include "Utility/IO.h"
+#include "Utility/Mutex.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+
+// Older glibc headers only have the union member
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id	_sigev_un._tid
+#endif
+
+namespace GuestProfiler
+{
+
+namespace
+{
+	const u32			kSampleIntervalUs	= 1000;		// Of CPU thread time
+	const u32			kMaxSamples			= 4096;		// Drained every vbl
+	const u32			kMaxCallers			= 8;
+	const u32			kMaxPrologueScan	= 1024;		// Ops to search back for the start of a function
+	const u32			kNoTask				= 0;
+	const u32			kOtherTask			= 5;		// Unused by libultra
+	const u32			kNumTasks			= 8;
+
+	const char * const	kTaskNames[ kNumTasks ] =
+	{
+		"CPU", "Graphics task", "Audio task", "Video task", "JPEG task", "Other task", "Other task", "Framebuffer task"
+	};
+
+	struct SSample
+	{
+		const u8 *		HostPC;
+		u32				PC;
+		u32				RSPTask;
+		u32				NumCallers;
+		u32				Callers[ kMaxCallers ];		// Return addresses, innermost first
+	};
+
+	struct SFragmentRecord
+	{
+		const u8 *		Code;
+		u32				EntryAddress;
+		u32				CodeLength;
+		LocationList	Locations;
+	};
+	typedef std::map< const u8 *, SFragmentRecord >		FragmentMap;
+
+	// Guest addresses, outermost caller first and ending with the sampled pc
+	typedef std::vector< u32 >				CallStack;
+	typedef std::vector< std::string >		CallPath;
+
+	// Written by the signal handler and read by the vbl callback, both on the CPU thread
+	SSample					gSamples[ kMaxSamples ];
+	volatile u32			gSampleWrite( 0 );
+	volatile u32			gSampleRead( 0 );
+	volatile u32			gDroppedSamples( 0 );
+	volatile u32			gRSPTask( kNoTask );
+
+	bool					gOpen( false );
+	bool					gTimerStarted( false );
+	bool					gTimerValid( false );
+	timer_t					gTimer;
+
+	Mutex					gFragmentMutex;			// Fragments are assembled on the compile thread
+	FragmentMap				gFragments;
+	FILE *					gPerfMap( NULL );
+
+	// Accumulated as samples are drained
+	std::map< CallStack, u32 >	gStackSamples;
+	std::map< u32, u32 >		gFragmentSamples;		// By entry address
+	u32						gTaskSamples[ kNumTasks ];
+	u32						gHostSamples;			// CPU samples outside compiled code
+	u32						gTotalSamples;
+
+	std::map< u32, std::string >	gFunctionNames;		// Cache for GetFunctionName()
+}
+
+//*************************************************************************************
+//	Runs on the CPU thread, at any point. Must not take locks or allocate.
+//*************************************************************************************
+static void SampleHandler( int sig, siginfo_t * info, void * context )
+{
+	u32			write( gSampleWrite );
+	if( write - gSampleRead >= kMaxSamples )
+	{
+		gDroppedSamples = gDroppedSamples + 1;
+		return;
+	}
+
+	SSample &	sample( gSamples[ write & (kMaxSamples - 1) ] );
+#if defined( __x86_64__ )
+	sample.HostPC = reinterpret_cast< const u8 * >( static_cast< ucontext_t * >( context )->uc_mcontext.gregs[ REG_RIP ] );
+#else
+	sample.HostPC = NULL;
+#endif
+	sample.PC = gCPUState.CurrentPC;
+	sample.RSPTask = gRSPTask;
+	sample.NumCallers = 0;
+
+#ifdef DAEDALUS_ENABLE_DYNAREC
+	// Only a guess - pushes and pops don't have to balance, and inlined or
+	// interpreted calls aren't pushed at all. The entries belong to fragments,
+	// but the fragment cache resets the stack before deleting any, and that
+	// happens on this thread, so nothing here can have been freed.
+	const u32	top( gReturnStack.Top );
+	while( sample.NumCallers < kMaxCallers )
+	{
+		u32		address( gReturnStack.Entries[ (top - sample.NumCallers) & RETURN_STACK_MASK ]->Address );
+		if( address & 3 )
+			break;
+
+		sample.Callers[ sample.NumCallers++ ] = address;
+	}
+#endif
+
+	__sync_synchronize();
+	gSampleWrite = write + 1;
+}
+
+//*************************************************************************************
+//	Called with gFragmentMutex held
+//*************************************************************************************
+static const SFragmentRecord * FindFragment( const u8 * host_pc )
+{
+	FragmentMap::const_iterator	it( gFragments.upper_bound( host_pc ) );
+	if( it == gFragments.begin() )
+		return NULL;
+
+	--it;
+	if( host_pc >= it->first + it->second.CodeLength )
+		return NULL;
+
+	return &it->second;
+}
+
+static u32 GetGuestAddress( const SFragmentRecord & fragment, u32 host_offset )
+{
+	u32		address( fragment.EntryAddress );	// Prologue
+	for( u32 i = 0; i < fragment.Locations.size() && fragment.Locations[ i ].HostOffset <= host_offset; ++i )
+	{
+		address = fragment.Locations[ i ].Address;
+	}
+	return address;
+}
+
+static void AddSample( const SSample & sample )
+{
+	gTotalSamples++;
+
+	if( sample.RSPTask != kNoTask )
+	{
+		gTaskSamples[ sample.RSPTask < kNumTasks ? sample.RSPTask : kOtherTask ]++;
+		return;
+	}
+	gTaskSamples[ kNoTask ]++;
+
+	// The pc isn't kept up to date inside compiled code
+	u32							pc( sample.PC );
+	const SFragmentRecord *		p_fragment( FindFragment( sample.HostPC ) );
+	if( p_fragment != NULL )
+	{
+		pc = GetGuestAddress( *p_fragment, u32( sample.HostPC - p_fragment->Code ) );
+		gFragmentSamples[ p_fragment->EntryAddress ]++;
+	}
+	else
+	{
+		gHostSamples++;
+	}
+
+	CallStack	stack( sample.Callers, sample.Callers + sample.NumCallers );
+	std::reverse( stack.begin(), stack.end() );
+	stack.push_back( pc );
+	gStackSamples[ stack ]++;
+}
+
+static void DrainSamples()
+{
+	MutexLock	lock( &gFragmentMutex );
+
+	while( gSampleRead != gSampleWrite )
+	{
+		AddSample( gSamples[ gSampleRead & (kMaxSamples - 1) ] );
+		gSampleRead = gSampleRead + 1;
+	}
+}
+
+//*************************************************************************************
+//	The timer counts the CPU time of the thread that creates it, so this is
+//	deferred until the first vbl.
+//*************************************************************************************
+static void StartTimer()
+{
+	gTimerStarted = true;
+
+	struct sigevent		event;
+	memset( &event, 0, sizeof( event ) );
+	event.sigev_notify = SIGEV_THREAD_ID;
+	event.sigev_signo = SIGPROF;
+	event.sigev_notify_thread_id = syscall( SYS_gettid );
+
+	if( timer_create( CLOCK_THREAD_CPUTIME_ID, &event, &gTimer ) != 0 )
+	{
+		DBGConsole_Msg( 0, "Guest profiler: unable to create timer" );
+		return;
+	}
+
+	struct itimerspec	interval;
+	interval.it_interval.tv_sec = 0;
+	interval.it_interval.tv_nsec = kSampleIntervalUs * 1000;
+	interval.it_value = interval.it_interval;
+	timer_settime( gTimer, 0, &interval, NULL );
+
+	gTimerValid = true;
+}
+
+static void VblHandler( void * arg )
+{
+	if( !gTimerStarted )
+	{
+		StartTimer();
+	}
+	DrainSamples();
+}
+
+//*************************************************************************************
+//	Symbolisation
+//*************************************************************************************
+#ifdef DAEDALUS_ENABLE_OS_HOOKS
+static const PatchSymbol * FindPatchSymbol( u32 address )
+{
+	if( address < 0x80000000 || address >= 0xC0000000 )
+		return NULL;
+
+	const u32	physical( address & 0x1FFFFFFF );
+	for( u32 i = 0; g_PatchSymbols[ i ] != NULL; ++i )
+	{
+		const PatchSymbol *	ps( g_PatchSymbols[ i ] );
+		if( !ps->Found || physical < ps->Location )
+			continue;
+
+		// Use the length of the signature that was matched
+		u32		num_ops( ps->Signatures[ 0 ].NumOps );
+		for( u32 s = 0; ps->Signatures[ s ].NumOps != 0; ++s )
+		{
+			if( ps->Signatures[ s ].Function == ps->Function )
+			{
+				num_ops = ps->Signatures[ s ].NumOps;
+				break;
+			}
+		}
+
+		if( physical < ps->Location + num_ops * 4 )
+			return ps;
+	}
+	return NULL;
+}
+#endif
+
+//	Looks back for the stack frame being set up, or the end of the previous function
+static bool FindFunctionStart( u32 address, u32 * p_start )
+{
+	for( u32 i = 0; i < kMaxPrologueScan; ++i )
+	{
+		// Only look at memory that can be read without side effects (i.e. not ROM or TLB mapped)
+		const u32			pc( address - i * 4 );
+		const MemFuncRead &	m( g_MemoryLookupTableRead[ pc >> 18 ] );
+		if( m.pRead == NULL )
+			return false;
+
+		OpCode		op_code( *reinterpret_cast< const OpCode * >( m.pRead + pc ) );
+		if( op_code.op == OP_ADDIU && op_code.rs == N64Reg_SP && op_code.rt == N64Reg_SP && s16( op_code.immediate ) < 0 )
+		{
+			*p_start = pc;
+			return true;
+		}
+
+		// Skip the return at the end of our own function (and its delay slot)
+		if( i >= 2 && op_code.op == OP_SPECOP && op_code.spec_op == SpecOp_JR && op_code.rs == N64Reg_RA )
+		{
+			*p_start = pc + 8;
+			return true;
+		}
+	}
+	return false;
+}
+
+static const std::string & GetFunctionName( u32 address )
+{
+	std::map< u32, std::string >::iterator	it( gFunctionNames.find( address ) );
+	if( it != gFunctionNames.end() )
+		return it->second;
+
+	char		name[ 64 ];
+	u32			start;
+#ifdef DAEDALUS_ENABLE_OS_HOOKS
+	const PatchSymbol *	ps( FindPatchSymbol( address ) );
+	if( ps != NULL )
+	{
+		snprintf( name, sizeof( name ), "%s", ps->Name );
+	}
+	else
+#endif
+	if( FindFunctionStart( address, &start ) )
+	{
+		snprintf( name, sizeof( name ), "sub_%08x", start );
+	}
+	else
+	{
+		snprintf( name, sizeof( name ), "pc_%08x", address );
+	}
+
+	return gFunctionNames[ address ] = name;
+}
+
+//*************************************************************************************
+//	Report
+//*************************************************************************************
+namespace
+{
+	struct SFunctionCount
+	{
+		SFunctionCount() : Self( 0 ), Total( 0 ) {}
+
+		u32			Self;
+		u32			Total;
+	};
+
+	struct SNamedCount
+	{
+		SNamedCount( const std::string & name, u32 count, u32 total )
+			:	Name( name ), Count( count ), Total( total )
+		{
+		}
+
+		std::string	Name;
+		u32			Count;
+		u32			Total;
+	};
+
+	struct SortDecreasingCount
+	{
+		bool	operator()( const SNamedCount & a, const SNamedCount & b ) const
+		{
+			return a.Count > b.Count;
+		}
+	};
+}
+
+static float Percent( u32 count, u32 total )
+{
+	return total > 0 ? 100.0f * count / total : 0.0f;
+}
+
+static void WriteReport( FILE * fh )
+{
+	fprintf( fh, "Guest profile for %s\n", g_ROM.settings.GameName.c_str() );
+	fprintf( fh, "%d samples, %dus of CPU thread time apart (%d dropped)\n\n", gTotalSamples, kSampleIntervalUs, gDroppedSamples );
+
+	for( u32 i = 0; i < kNumTasks; ++i )
+	{
+		if( gTaskSamples[ i ] > 0 )
+		{
+			fprintf( fh, "%6.2f%%  %s\n", Percent( gTaskSamples[ i ], gTotalSamples ), kTaskNames[ i ] );
+		}
+	}
+
+	const u32	cpu_samples( gTaskSamples[ kNoTask ] );
+	if( cpu_samples == 0 )
+		return;
+
+	fprintf( fh, "%6.2f%%  of CPU samples outside compiled code\n", Percent( gHostSamples, cpu_samples ) );
+
+	//
+	//	Call paths, with consecutive repeats (recursion) collapsed
+	//
+	std::map< CallPath, u32 >				paths;
+	std::map< std::string, SFunctionCount >	functions;
+	for( std::map< CallStack, u32 >::const_iterator it = gStackSamples.begin(); it != gStackSamples.end(); ++it )
+	{
+		const CallStack &	stack( it->first );
+		const u32			count( it->second );
+
+		CallPath			path;
+		for( u32 i = 0; i < stack.size(); ++i )
+		{
+			// Callers are return addresses, so look up the call
+			const std::string &	name( GetFunctionName( i + 1 < stack.size() ? stack[ i ] - 8 : stack[ i ] ) );
+			if( path.empty() || path.back() != name )
+			{
+				path.push_back( name );
+			}
+		}
+
+		std::set< std::string >	seen;
+		for( u32 i = 0; i < path.size(); ++i )
+		{
+			if( seen.insert( path[ i ] ).second )
+			{
+				functions[ path[ i ] ].Total += count;
+			}
+		}
+		functions[ path.back() ].Self += count;
+
+		for( CallPath prefix; prefix.size() < path.size(); )
+		{
+			prefix.push_back( path[ prefix.size() ] );
+			paths[ prefix ] += count;
+		}
+	}
+
+	//
+	//	Flat profile
+	//
+	std::vector< SNamedCount >	flat;
+	for( std::map< std::string, SFunctionCount >::const_iterator it = functions.begin(); it != functions.end(); ++it )
+	{
+		flat.push_back( SNamedCount( it->first, it->second.Self, it->second.Total ) );
+	}
+	std::sort( flat.begin(), flat.end(), SortDecreasingCount() );
+
+	fprintf( fh, "\nFlat profile (CPU samples)\n\n  Self   Total  Samples  Function\n" );
+	for( u32 i = 0; i < flat.size() && flat[ i ].Count > 0; ++i )
+	{
+		fprintf( fh, "%6.2f%% %6.2f%% %8d  %s\n", Percent( flat[ i ].Count, cpu_samples ), Percent( flat[ i ].Total, cpu_samples ), flat[ i ].Count, flat[ i ].Name.c_str() );
+	}
+
+	//
+	//	Call tree. The map is ordered so that each path follows its parent.
+	//
+	fprintf( fh, "\nCall tree (CPU samples, callers are approximate)\n\n" );
+	for( std::map< CallPath, u32 >::const_iterator it = paths.begin(); it != paths.end(); ++it )
+	{
+		// Anything smaller is just noise
+		if( it->second * 200 < cpu_samples )
+			continue;
+
+		fprintf( fh, "%6.2f%% %*s%s\n", Percent( it->second, cpu_samples ), int( it->first.size() * 2 ), "", it->first.back().c_str() );
+	}
+
+	//
+	//	Fragments
+	//
+	std::vector< SNamedCount >	fragments;
+	for( std::map< u32, u32 >::const_iterator it = gFragmentSamples.begin(); it != gFragmentSamples.end(); ++it )
+	{
+		char	name[ 96 ];
+		snprintf( name, sizeof( name ), "%08x  %s", it->first, GetFunctionName( it->first ).c_str() );
+		fragments.push_back( SNamedCount( name, it->second, it->second ) );
+	}
+	std::sort( fragments.begin(), fragments.end(), SortDecreasingCount() );
+
+	fprintf( fh, "\nFragments (CPU samples)\n\n" );
+	for( u32 i = 0; i < fragments.size() && i < 50; ++i )
+	{
+		fprintf( fh, "%6.2f%% %8d  %s\n", Percent( fragments[ i ].Count, cpu_samples ), fragments[ i ].Count, fragments[ i ].Name.c_str() );
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool Open()
+{
+	DAEDALUS_ASSERT( !gOpen, "Guest profiler is already open" );
+
+	gSampleWrite = 0;
+	gSampleRead = 0;
+	gDroppedSamples = 0;
+	gRSPTask = kNoTask;
+	gTimerStarted = false;
+	gTimerValid = false;
+	memset( gTaskSamples, 0, sizeof( gTaskSamples ) );
+	gHostSamples = 0;
+	gTotalSamples = 0;
+
+	// perf reads this as a whole, so several roms in one run just keep appending
+	char	perf_map[ 64 ];
+	snprintf( perf_map, sizeof( perf_map ), "/tmp/perf-%d.map", int( getpid() ) );
+	gPerfMap = fopen( perf_map, "a" );
+
+	struct sigaction	action;
+	memset( &action, 0, sizeof( action ) );
+	action.sa_sigaction = SampleHandler;
+	action.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset( &action.sa_mask );
+	sigaction( SIGPROF, &action, NULL );
+
+	CPU_RegisterVblCallback( &VblHandler, NULL );
+
+	gOpen = true;
+	return true;
+}
+
+void Close()
+{
+	if( !gOpen )
+		return;
+
+	CPU_UnregisterVblCallback( &VblHandler, NULL );
+	if( gTimerValid )
+	{
+		timer_delete( gTimer );
+	}
+
+	// Leave SIGPROF ignored rather than restoring the default action, a sample may still be pending
+	signal( SIGPROF, SIG_IGN );
+
+	DrainSamples();
+
+	if( gTotalSamples > 0 )
+	{
+		IO::Filename	path;
+		Dump_GetDumpDirectory( path, "" );
+		IO::Path::Append( path, "guest_profile.txt" );
+
+		FILE *	fh( fopen( path, "w" ) );
+		if( fh != NULL )
+		{
+			WriteReport( fh );
+			fclose( fh );
+			DBGConsole_Msg( 0, "Guest profile written to [C%s]", path );
+		}
+	}
+
+	MutexLock	lock( &gFragmentMutex );
+	if( gPerfMap != NULL )
+	{
+		fclose( gPerfMap );
+		gPerfMap = NULL;
+	}
+	gFragments.clear();
+	gStackSamples.clear();
+	gFragmentSamples.clear();
+	gFunctionNames.clear();
+	gOpen = false;
+}
+
+void AddFragment( u32 entry_address, const u8 * p_code, u32 code_length, const LocationList & locations )
+{
+	MutexLock	lock( &gFragmentMutex );
+
+	if( !gOpen )
+		return;
+
+	// Code buffers are reused, so forget anything this overwrites
+	FragmentMap::iterator	it( gFragments.lower_bound( p_code ) );
+	if( it != gFragments.begin() )
+	{
+		FragmentMap::iterator	previous( it );
+		--previous;
+		if( previous->first + previous->second.CodeLength > p_code )
+		{
+			it = previous;
+		}
+	}
+	while( it != gFragments.end() && it->first < p_code + code_length )
+	{
+		gFragments.erase( it++ );
+	}
+
+	SFragmentRecord &	record( gFragments[ p_code ] );
+	record.Code = p_code;
+	record.EntryAddress = entry_address;
+	record.CodeLength = code_length;
+	record.Locations = locations;
+
+	if( gPerfMap != NULL )
+	{
+		fprintf( gPerfMap, "%lx %x n64_%08x\n", (unsigned long)p_code, code_length, entry_address );
+		fflush( gPerfMap );
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CRSPTaskScope::CRSPTaskScope( u32 task_type )
+:	mPreviousTask( gRSPTask )
+{
+	gRSPTask = task_type;
+}
+
+CRSPTaskScope::~CRSPTaskScope()
+{
+	gRSPTask = mPreviousTask;
+}
+
+}
+
+#endif // DAEDALUS_ENABLE_GUEST_PROFILER
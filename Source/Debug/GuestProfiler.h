@@ -0,0 +1,75 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef DEBUG_GUESTPROFILER_H_
+#define DEBUG_GUESTPROFILER_H_
+
+#include "Utility/DaedalusTypes.h"
+
+#include <vector>
+
+//	Sampling profiler for guest code. Needs POSIX per-thread CPU timers, so Linux only.
+//#define DAEDALUS_ENABLE_GUEST_PROFILER
+
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+
+//
+//	Samples the CPU thread on a timer, attributing each sample to the guest pc
+//	(mapped back from the host pc inside compiled fragments), the fragment and
+//	any RSP task being processed. The flat and call tree report is written to
+//	the dump directory when the rom is closed, and compiled fragments are listed
+//	in /tmp/perf-<pid>.map so that perf can name them.
+//
+namespace GuestProfiler
+{
+	// The host code generated for a guest op
+	struct SLocation
+	{
+		u32		HostOffset;		// From the start of the fragment's code
+		u32		Address;
+	};
+	typedef std::vector< SLocation >	LocationList;
+
+	bool	Open();
+	void	Close();
+
+	// Called for each fragment once it has been assembled. Locations must be in HostOffset order.
+	void	AddFragment( u32 entry_address, const u8 * p_code, u32 code_length, const LocationList & locations );
+
+	// RSP tasks are processed on the CPU thread, so samples taken meanwhile are charged to the task
+	class CRSPTaskScope
+	{
+	public:
+		explicit CRSPTaskScope( u32 task_type );
+		~CRSPTaskScope();
+
+	private:
+		u32		mPreviousTask;
+	};
+}
+
+#define GUEST_PROFILER_RSP_TASK( type )			GuestProfiler::CRSPTaskScope guest_profiler_task( type )
+
+#else
+
+#define GUEST_PROFILER_RSP_TASK( type )
+
+#endif
+
+#endif // DEBUG_GUESTPROFILER_H_
@@ -38,7 +38,7 @@ public:
 	bool			IsSet() const				{ return mpLocation != NULL; }
 	const void *	GetTarget() const			{ return mpLocation; }
 	const u8 *		GetTargetU8P() const		{ return reinterpret_cast< const u8 * >( mpLocation ); }
-	u32				GetTargetU32() const		{ return reinterpret_cast< u32 >( mpLocation ); }
+	u32				GetTargetU32() const		{ return u32( reinterpret_cast< uintptr_t >( mpLocation ) ); }
 
 
 
@@ -79,6 +79,9 @@ namespace AssemblyUtils
 	bool		PatchJumpLong( CJumpLocation jump, CCodeLabel target );
 	bool		PatchJumpLongAndFlush( CJumpLocation jump, CCodeLabel target );
 	void		ReplaceBranchWithJump( CJumpLocation branch, CCodeLabel target );
+
+	// Returns the location the long jump currently branches to
+	CCodeLabel	GetJumpLongTarget( CJumpLocation jump );
 }
 
 #endif // DYNAREC_ASSEMBLYUTILS_H_
@@ -35,6 +35,16 @@ public:
 	virtual	CCodeGenerator *		StartNewBlock() = 0;
 	virtual	u32						FinaliseCurrentBlock() = 0;
 
+	// Managers can split the buffer into regions, which the fragment cache
+	// evicts one at a time. Those which don't have a single region and the
+	// fragment cache is flushed completely when it gets too big.
+	virtual u32						GetNumRegions() const						{ return 1; }
+	virtual u32						GetCurrentRegion() const					{ return 0; }
+	virtual bool					IsRegionInUse( u32 /*region*/ ) const		{ return true; }
+	virtual u32						GetNumFreeBlocks() const					{ return u32(~0); }	// Worst case blocks that can still be started
+	virtual void					FreeRegion( u32 /*region*/ )				{ }
+	virtual bool					IsInRegion( u32 /*region*/, const void * /*p*/ ) const	{ return true; }
+
 public:
 	static	CCodeBufferManager *	Create();
 };
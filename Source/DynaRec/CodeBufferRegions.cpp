@@ -0,0 +1,194 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "CodeBufferRegions.h"
+
+#include <string.h>
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CCodeBufferRegions::CCodeBufferRegions()
+:	mNumRegions( 0 )
+,	mCurrentRegion( 0 )
+,	mAlignment( 1 )
+,	mMaxBlockSize( 0 )
+{
+	memset( mRegions, 0, sizeof( mRegions ) );
+}
+
+//*************************************************************************************
+//	The first region starts at primary_start/secondary_start, which lets the
+//	manager keep things like entry thunks at the start of the buffer.
+//*************************************************************************************
+void CCodeBufferRegions::Initialise( u32 num_regions, u32 primary_start, u32 primary_region_size,
+									 u32 secondary_start, u32 secondary_region_size,
+									 u32 alignment, u32 max_block_size )
+{
+	DAEDALUS_ASSERT( num_regions > 0 && num_regions <= kMaxRegions, "Invalid number of code buffer regions" );
+	DAEDALUS_ASSERT( primary_region_size >= max_block_size && secondary_region_size >= max_block_size, "Code buffer regions are too small" );
+
+	mNumRegions = num_regions;
+	mAlignment = alignment;
+	mMaxBlockSize = max_block_size;
+
+	for( u32 i = 0; i < mNumRegions; ++i )
+	{
+		SRegion &	region( mRegions[ i ] );
+		region.PrimaryStart = ( i == 0 ) ? primary_start : mRegions[ i - 1 ].PrimaryEnd;
+		region.PrimaryEnd = ( i + 1 ) * primary_region_size;
+		region.SecondaryStart = ( i == 0 ) ? secondary_start : mRegions[ i - 1 ].SecondaryEnd;
+		region.SecondaryEnd = ( i + 1 ) * secondary_region_size;
+	}
+
+	Reset();
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CCodeBufferRegions::Reset()
+{
+	for( u32 i = 0; i < mNumRegions; ++i )
+	{
+		SRegion &	region( mRegions[ i ] );
+		region.PrimaryPtr = region.PrimaryStart;
+		region.SecondaryPtr = region.SecondaryStart;
+		region.InUse = false;
+	}
+
+	mCurrentRegion = 0;
+	mRegions[ 0 ].InUse = true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 CCodeBufferRegions::GetNumBlocks( const SRegion & region ) const
+{
+	u32		primary_ptr( ( region.PrimaryPtr + mAlignment - 1 ) & ~( mAlignment - 1 ) );
+	u32		secondary_ptr( ( region.SecondaryPtr + mAlignment - 1 ) & ~( mAlignment - 1 ) );
+
+	u32		primary_blocks( primary_ptr < region.PrimaryEnd ? ( region.PrimaryEnd - primary_ptr ) / mMaxBlockSize : 0 );
+	u32		secondary_blocks( secondary_ptr < region.SecondaryEnd ? ( region.SecondaryEnd - secondary_ptr ) / mMaxBlockSize : 0 );
+
+	return primary_blocks < secondary_blocks ? primary_blocks : secondary_blocks;
+}
+
+//*************************************************************************************
+//	Aligns the pointers of the current region, moving on to the next free
+//	region if there isn't space for a maximum sized block.
+//*************************************************************************************
+bool CCodeBufferRegions::StartNewBlock()
+{
+	if( GetNumBlocks( mRegions[ mCurrentRegion ] ) == 0 )
+	{
+		u32		next( mCurrentRegion );
+		for( u32 i = 1; i < mNumRegions; ++i )
+		{
+			u32	candidate( ( mCurrentRegion + i ) % mNumRegions );
+			if( !mRegions[ candidate ].InUse )
+			{
+				next = candidate;
+				break;
+			}
+		}
+
+		if( next == mCurrentRegion )
+			return false;
+
+		mCurrentRegion = next;
+		mRegions[ next ].InUse = true;
+	}
+
+	SRegion &	region( mRegions[ mCurrentRegion ] );
+	region.PrimaryPtr = ( region.PrimaryPtr + mAlignment - 1 ) & ~( mAlignment - 1 );
+	region.SecondaryPtr = ( region.SecondaryPtr + mAlignment - 1 ) & ~( mAlignment - 1 );
+	return true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CCodeBufferRegions::FinaliseBlock( u32 primary_size, u32 secondary_size )
+{
+	SRegion &	region( mRegions[ mCurrentRegion ] );
+	region.PrimaryPtr += primary_size;
+	region.SecondaryPtr += secondary_size;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 CCodeBufferRegions::GetNumFreeRegions() const
+{
+	u32		count( 0 );
+	for( u32 i = 0; i < mNumRegions; ++i )
+	{
+		if( !mRegions[ i ].InUse )
+			++count;
+	}
+	return count;
+}
+
+//*************************************************************************************
+//	The number of maximum sized blocks that can be started before a region
+//	needs to be freed.
+//*************************************************************************************
+u32 CCodeBufferRegions::GetNumFreeBlocks() const
+{
+	u32		count( GetNumBlocks( mRegions[ mCurrentRegion ] ) );
+	for( u32 i = 0; i < mNumRegions; ++i )
+	{
+		if( !mRegions[ i ].InUse )
+			count += GetNumBlocks( mRegions[ i ] );
+	}
+	return count;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CCodeBufferRegions::FreeRegion( u32 region_idx )
+{
+	DAEDALUS_ASSERT( region_idx < mNumRegions, "Invalid region %d", region_idx );
+	DAEDALUS_ASSERT( region_idx != mCurrentRegion, "Can't free the region being written to" );
+
+	SRegion &	region( mRegions[ region_idx ] );
+	region.PrimaryPtr = region.PrimaryStart;
+	region.SecondaryPtr = region.SecondaryStart;
+	region.InUse = false;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CCodeBufferRegions::IsPrimaryInRegion( u32 region, u32 offset ) const
+{
+	return offset >= mRegions[ region ].PrimaryStart && offset < mRegions[ region ].PrimaryEnd;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CCodeBufferRegions::IsSecondaryInRegion( u32 region, u32 offset ) const
+{
+	return offset >= mRegions[ region ].SecondaryStart && offset < mRegions[ region ].SecondaryEnd;
+}
@@ -0,0 +1,86 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef DYNAREC_CODEBUFFERREGIONS_H_
+#define DYNAREC_CODEBUFFERREGIONS_H_
+
+#include "Utility/DaedalusTypes.h"
+
+//*************************************************************************************
+// Book keeping shared by the code buffer managers which split their primary and
+// secondary buffers into regions. Blocks are allocated from the current region
+// until it can't hold another maximum sized block, at which point the next free
+// region is taken. Regions are only handed out again once the fragment cache has
+// evicted everything in them and called FreeRegion().
+//
+// Everything is stored as byte offsets into the two buffers, so this doesn't
+// care how the buffers are allocated.
+//*************************************************************************************
+class CCodeBufferRegions
+{
+public:
+	static const u32		kMaxRegions = 8;
+
+	CCodeBufferRegions();
+
+	void					Initialise( u32 num_regions, u32 primary_start, u32 primary_region_size,
+										u32 secondary_start, u32 secondary_region_size,
+										u32 alignment, u32 max_block_size );
+	void					Reset();
+
+	// Returns false if there is no room left in any region
+	bool					StartNewBlock();
+	void					FinaliseBlock( u32 primary_size, u32 secondary_size );
+
+	u32						GetPrimaryPtr() const					{ return mRegions[ mCurrentRegion ].PrimaryPtr; }
+	u32						GetSecondaryPtr() const					{ return mRegions[ mCurrentRegion ].SecondaryPtr; }
+
+	u32						GetNumRegions() const					{ return mNumRegions; }
+	u32						GetCurrentRegion() const				{ return mCurrentRegion; }
+	bool					IsRegionInUse( u32 region ) const		{ return mRegions[ region ].InUse; }
+	u32						GetNumFreeRegions() const;
+	u32						GetNumFreeBlocks() const;
+	void					FreeRegion( u32 region );
+
+	bool					IsPrimaryInRegion( u32 region, u32 offset ) const;
+	bool					IsSecondaryInRegion( u32 region, u32 offset ) const;
+
+private:
+	struct SRegion
+	{
+		u32		PrimaryStart;
+		u32		PrimaryPtr;
+		u32		PrimaryEnd;
+		u32		SecondaryStart;
+		u32		SecondaryPtr;
+		u32		SecondaryEnd;
+		bool	InUse;
+	};
+
+	u32						GetNumBlocks( const SRegion & region ) const;
+
+private:
+	SRegion					mRegions[ kMaxRegions ];
+	u32						mNumRegions;
+	u32						mCurrentRegion;
+	u32						mAlignment;
+	u32						mMaxBlockSize;
+};
+
+#endif // DYNAREC_CODEBUFFERREGIONS_H_
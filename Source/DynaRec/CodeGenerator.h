@@ -24,11 +24,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 struct	OpCode;
 struct	SBranchDetails;
+struct	SIndirectExitEntry;
 class	CIndirectExitMap;
 
 #include "Core/R4300Instruction.h"
 #include "AssemblyUtils.h"
 #include "RegisterSpan.h"
+#include "RegisterContract.h"
 #include "DynaRec/TraceRecorder.h"
 
 //
@@ -58,12 +60,15 @@ class CCodeGenerator
 		virtual RegisterSnapshotHandle	GetRegisterSnapshot() = 0;
 
 		virtual CCodeLabel			GetEntryPoint() const = 0;
+		virtual CCodeLabel			GetLinkedEntryPoint() const = 0;		// Past the loads covered by GetEntryContract()
+		virtual const SRegisterContract &	GetEntryContract() const = 0;
 		virtual CCodeLabel			GetCurrentLocation() const = 0;
 //		virtual u32					GetCompiledCodeSize() const = 0;
 
 		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment ) = 0;
 		virtual void				GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * p_map ) = 0;
 		virtual void				GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map ) = 0;
+		virtual void				GeneratePushReturnAddress( SIndirectExitEntry * p_return_site ) = 0;	// Called before a JAL/JALR RA
 
 		virtual void				GenerateBranchHandler( CJumpLocation branch_handler_jump, RegisterSnapshotHandle snapshot ) = 0;
 
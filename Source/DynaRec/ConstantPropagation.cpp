@@ -0,0 +1,187 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+#include "stdafx.h"
+#include "ConstantPropagation.h"
+#include "StaticAnalysis.h"
+
+#include <algorithm>
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CConstantPropagation::CConstantPropagation()
+:	mEnabled( true )
+{
+	Reset();
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CConstantPropagation::Reset()
+{
+	std::fill( mValues, mValues + NUM_N64_REGS, 0 );
+	mKnown = mEnabled ? (1 << N64Reg_R0) : 0;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CConstantPropagation::SetKnown( EN64Reg reg, s32 value )
+{
+	if( reg == N64Reg_R0 )
+		return;
+
+	mValues[ reg ] = value;
+	mKnown |= 1 << reg;
+}
+
+//*************************************************************************************
+//	All the arithmetic is done on u32s, so overflow wraps as it does on the N64
+//*************************************************************************************
+void CConstantPropagation::Update( u32 address, OpCode op_code )
+{
+	if( !mEnabled )
+		return;
+
+	const EN64Reg	rs( EN64Reg( op_code.rs ) );
+	const EN64Reg	rt( EN64Reg( op_code.rt ) );
+	const EN64Reg	rd( EN64Reg( op_code.rd ) );
+	const u32		a( mValues[ rs ] );
+	const u32		b( mValues[ rt ] );
+	const bool		known_rs( IsKnown( rs ) );
+	const bool		known_both( known_rs && IsKnown( rt ) );
+	const u32		simm( u32( s32( s16( op_code.immediate ) ) ) );
+	const u32		uimm( op_code.immediate );
+
+	// Assume the worst, then put back what we can work out
+	mKnown &= ~StaticAnalysis::GetGPRWriteMask( op_code );
+	mKnown |= 1 << N64Reg_R0;
+
+	switch( op_code.op )
+	{
+	case OP_LUI:							SetKnown( rt, s32( uimm << 16 ) ); break;
+	case OP_ADDI:	case OP_ADDIU:	if( known_rs ) SetKnown( rt, s32( a + simm ) ); break;
+	case OP_ANDI:					if( known_rs ) SetKnown( rt, s32( a & uimm ) ); break;
+	case OP_ORI:					if( known_rs ) SetKnown( rt, s32( a | uimm ) ); break;
+	case OP_XORI:					if( known_rs ) SetKnown( rt, s32( a ^ uimm ) ); break;
+	case OP_SLTI:					if( known_rs ) SetKnown( rt, s32( a ) < s32( simm ) ? 1 : 0 ); break;
+	case OP_SLTIU:					if( known_rs ) SetKnown( rt, a < simm ? 1 : 0 ); break;
+	case OP_JAL:							SetKnown( N64Reg_RA, s32( address + 8 ) ); break;
+
+	case OP_SPECOP:
+		switch( op_code.spec_op )
+		{
+		case SpecOp_SLL:	if( IsKnown( rt ) ) SetKnown( rd, s32( b << op_code.sa ) ); break;
+		case SpecOp_SRL:	if( IsKnown( rt ) ) SetKnown( rd, s32( b >> op_code.sa ) ); break;
+		case SpecOp_SRA:	if( IsKnown( rt ) ) SetKnown( rd, s32( b ) >> op_code.sa ); break;
+		case SpecOp_ADD:
+		case SpecOp_ADDU:	if( known_both ) SetKnown( rd, s32( a + b ) ); break;
+		case SpecOp_SUB:
+		case SpecOp_SUBU:	if( known_both ) SetKnown( rd, s32( a - b ) ); break;
+		case SpecOp_AND:	if( known_both ) SetKnown( rd, s32( a & b ) ); break;
+		case SpecOp_OR:		if( known_both ) SetKnown( rd, s32( a | b ) ); break;
+		case SpecOp_XOR:	if( known_both ) SetKnown( rd, s32( a ^ b ) ); break;
+		case SpecOp_NOR:	if( known_both ) SetKnown( rd, s32( ~(a | b) ) ); break;
+		case SpecOp_SLT:	if( known_both ) SetKnown( rd, s32( a ) < s32( b ) ? 1 : 0 ); break;
+		case SpecOp_SLTU:	if( known_both ) SetKnown( rd, a < b ? 1 : 0 ); break;
+		default:
+			break;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CConstantPropagation::GetAccessAddress( OpCode op_code, u32 * p_address ) const
+{
+	const EN64Reg	base( EN64Reg( op_code.base ) );
+
+	if( !IsKnown( base ) )
+		return false;
+
+	*p_address = u32( mValues[ base ] ) + u32( s32( s16( op_code.offset ) ) );
+	return true;
+}
+
+//*************************************************************************************
+//	The values are sign extended, so 32 bit compares give the same answers as
+//	the 64 bit ones the branches really do.
+//*************************************************************************************
+bool CConstantPropagation::GetBranchTaken( OpCode op_code, bool * p_taken ) const
+{
+	const EN64Reg	rs( EN64Reg( op_code.rs ) );
+	const EN64Reg	rt( EN64Reg( op_code.rt ) );
+	const s32		a( mValues[ rs ] );
+	const s32		b( mValues[ rt ] );
+
+	switch( op_code.op )
+	{
+	case OP_BEQ:	case OP_BEQL:
+		if( !IsKnown( rs ) || !IsKnown( rt ) )
+			return false;
+		*p_taken = a == b;
+		return true;
+
+	case OP_BNE:	case OP_BNEL:
+		if( !IsKnown( rs ) || !IsKnown( rt ) )
+			return false;
+		*p_taken = a != b;
+		return true;
+
+	case OP_BLEZ:	case OP_BLEZL:
+		if( !IsKnown( rs ) )
+			return false;
+		*p_taken = a <= 0;
+		return true;
+
+	case OP_BGTZ:	case OP_BGTZL:
+		if( !IsKnown( rs ) )
+			return false;
+		*p_taken = a > 0;
+		return true;
+
+	case OP_REGIMM:
+		switch( op_code.regimm_op )
+		{
+		case RegImmOp_BLTZ:	case RegImmOp_BLTZL:
+			if( !IsKnown( rs ) )
+				return false;
+			*p_taken = a < 0;
+			return true;
+
+		case RegImmOp_BGEZ:	case RegImmOp_BGEZL:
+			if( !IsKnown( rs ) )
+				return false;
+			*p_taken = a >= 0;
+			return true;
+
+		default:
+			return false;
+		}
+
+	default:
+		return false;
+	}
+}
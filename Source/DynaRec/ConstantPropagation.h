@@ -0,0 +1,66 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+#ifndef DYNAREC_CONSTANTPROPAGATION_H_
+#define DYNAREC_CONSTANTPROPAGATION_H_
+
+#include "Core/N64Reg.h"
+#include "Core/R4300OpCode.h"
+
+//*************************************************************************************
+// Tracks which GPRs hold values known at compile time as a trace is walked,
+// so that LUI/ADDIU and LUI/ORI address pairs can be followed through to the
+// loads, stores and branches that use them. Only values which are the sign
+// extension of their low 32 bits are tracked, which covers everything the
+// 32 bit ops produce. Anything the tracker doesn't understand just makes the
+// registers it writes unknown again.
+//
+// Traces are straight line code, so the state is only valid for the path the
+// trace took - it has to be reset before generating code for anything off
+// that path (branch handlers etc).
+//*************************************************************************************
+class CConstantPropagation
+{
+public:
+	CConstantPropagation();
+
+	void		SetEnabled( bool enabled )				{ mEnabled = enabled; Reset(); }
+	void		Reset();								// Nothing known but r0
+
+	// Steps past op_code, which is at address
+	void		Update( u32 address, OpCode op_code );
+
+	bool		IsKnown( EN64Reg reg ) const			{ return (mKnown >> reg) & 1; }
+	s32			GetValue( EN64Reg reg ) const			{ return mValues[ reg ]; }
+
+	// Effective address of a load or store, if its base is known
+	bool		GetAccessAddress( OpCode op_code, u32 * p_address ) const;
+
+	// Outcome of a conditional branch, if both its operands are known
+	bool		GetBranchTaken( OpCode op_code, bool * p_taken ) const;
+
+private:
+	void		SetKnown( EN64Reg reg, s32 value );
+
+private:
+	bool		mEnabled;
+	u32			mKnown;
+	s32			mValues[ NUM_N64_REGS ];
+};
+
+#endif // DYNAREC_CONSTANTPROPAGATION_H_
@@ -0,0 +1,197 @@
+#include <stdafx.h>
+#include "DynaRec/ConstantPropagation.h"
+
+#include <gtest/gtest.h>
+
+static OpCode MakeImm( u32 op, EN64Reg rs, EN64Reg rt, u16 immediate )
+{
+	OpCode op_code;
+	op_code._u32 = (op << 26) | (rs << 21) | (rt << 16) | immediate;
+	return op_code;
+}
+
+static OpCode MakeSpecial( u32 spec_op, EN64Reg rs, EN64Reg rt, EN64Reg rd, u32 sa )
+{
+	OpCode op_code;
+	op_code._u32 = (OP_SPECOP << 26) | (rs << 21) | (rt << 16) | (rd << 11) | (sa << 6) | spec_op;
+	return op_code;
+}
+
+static OpCode MakeJump( u32 op, u32 target )
+{
+	OpCode op_code;
+	op_code._u32 = (op << 26) | ((target >> 2) & 0x03ffffff);
+	return op_code;
+}
+
+static OpCode MakeMFC0( EN64Reg rt, u32 rd )
+{
+	OpCode op_code;
+	op_code._u32 = (OP_COPRO0 << 26) | (Cop0Op_MFC0 << 21) | (rt << 16) | (rd << 11);
+	return op_code;
+}
+
+static const u32 kAddress = 0x80001000;
+
+TEST(ConstantPropagation, OnlyR0IsKnownAfterReset)
+{
+	CConstantPropagation cp;
+	EXPECT_TRUE(cp.IsKnown(N64Reg_R0));
+	EXPECT_EQ(0, cp.GetValue(N64Reg_R0));
+	for (u32 i = 1; i < NUM_N64_REGS; ++i)
+		EXPECT_FALSE(cp.IsKnown(EN64Reg(i)));
+}
+
+TEST(ConstantPropagation, FollowsLuiAddiuPair)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress + 0, MakeImm(OP_LUI, N64Reg_R0, N64Reg_A0, 0x8033));
+	cp.Update(kAddress + 4, MakeImm(OP_ADDIU, N64Reg_A0, N64Reg_A0, 0xfff0));		// -16
+
+	ASSERT_TRUE(cp.IsKnown(N64Reg_A0));
+	EXPECT_EQ(s32(0x8032fff0), cp.GetValue(N64Reg_A0));
+
+	u32 address = 0;
+	ASSERT_TRUE(cp.GetAccessAddress(MakeImm(OP_LW, N64Reg_A0, N64Reg_T0, 0x0020), &address));
+	EXPECT_EQ(0x80330010u, address);
+}
+
+TEST(ConstantPropagation, FollowsLuiOriPair)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress + 0, MakeImm(OP_LUI, N64Reg_R0, N64Reg_T1, 0xa460));
+	cp.Update(kAddress + 4, MakeImm(OP_ORI, N64Reg_T1, N64Reg_T2, 0x8010));
+
+	ASSERT_TRUE(cp.IsKnown(N64Reg_T2));
+	EXPECT_EQ(s32(0xa4608010), cp.GetValue(N64Reg_T2));
+	EXPECT_EQ(s32(0xa4600000), cp.GetValue(N64Reg_T1));		// The source is untouched
+
+	u32 address = 0;
+	ASSERT_TRUE(cp.GetAccessAddress(MakeImm(OP_SW, N64Reg_T2, N64Reg_T0, 0xfffc), &address));
+	EXPECT_EQ(0xa460800cu, address);
+}
+
+TEST(ConstantPropagation, SltiuComparesSignExtendedImmediateUnsigned)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress + 0, MakeImm(OP_ADDIU, N64Reg_R0, N64Reg_A1, 5));
+	cp.Update(kAddress + 4, MakeImm(OP_SLTIU, N64Reg_A1, N64Reg_V0, 10));
+	cp.Update(kAddress + 8, MakeImm(OP_SLTIU, N64Reg_A1, N64Reg_V1, 5));
+	cp.Update(kAddress + 12, MakeImm(OP_SLTIU, N64Reg_A1, N64Reg_T0, 0xffff));		// 0xffffffff unsigned
+
+	ASSERT_TRUE(cp.IsKnown(N64Reg_V0));
+	ASSERT_TRUE(cp.IsKnown(N64Reg_V1));
+	ASSERT_TRUE(cp.IsKnown(N64Reg_T0));
+	EXPECT_EQ(1, cp.GetValue(N64Reg_V0));
+	EXPECT_EQ(0, cp.GetValue(N64Reg_V1));
+	EXPECT_EQ(1, cp.GetValue(N64Reg_T0));
+}
+
+TEST(ConstantPropagation, SllShiftsKnownValues)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress + 0, MakeImm(OP_ORI, N64Reg_R0, N64Reg_T3, 0x0003));
+	cp.Update(kAddress + 4, MakeSpecial(SpecOp_SLL, N64Reg_R0, N64Reg_T3, N64Reg_T4, 4));
+	cp.Update(kAddress + 8, MakeSpecial(SpecOp_SLL, N64Reg_R0, N64Reg_T3, N64Reg_T5, 31));
+
+	ASSERT_TRUE(cp.IsKnown(N64Reg_T4));
+	ASSERT_TRUE(cp.IsKnown(N64Reg_T5));
+	EXPECT_EQ(48, cp.GetValue(N64Reg_T4));
+	EXPECT_EQ(s32(0x80000000), cp.GetValue(N64Reg_T5));
+}
+
+TEST(ConstantPropagation, WritesToR0AreIgnored)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress, MakeImm(OP_LUI, N64Reg_R0, N64Reg_R0, 0x1234));
+
+	EXPECT_TRUE(cp.IsKnown(N64Reg_R0));
+	EXPECT_EQ(0, cp.GetValue(N64Reg_R0));
+}
+
+TEST(ConstantPropagation, LoadsInvalidateTheirDestination)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress + 0, MakeImm(OP_LUI, N64Reg_R0, N64Reg_A0, 0x8000));
+	cp.Update(kAddress + 4, MakeImm(OP_LW, N64Reg_A0, N64Reg_A0, 0x0100));
+
+	EXPECT_FALSE(cp.IsKnown(N64Reg_A0));
+
+	u32 address = 0;
+	EXPECT_FALSE(cp.GetAccessAddress(MakeImm(OP_LW, N64Reg_A0, N64Reg_T0, 0), &address));
+}
+
+TEST(ConstantPropagation, StoresLeaveRegistersKnown)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress + 0, MakeImm(OP_LUI, N64Reg_R0, N64Reg_A0, 0x8000));
+	cp.Update(kAddress + 4, MakeImm(OP_ADDIU, N64Reg_R0, N64Reg_T0, 7));
+	cp.Update(kAddress + 8, MakeImm(OP_SW, N64Reg_A0, N64Reg_T0, 0x0010));
+
+	EXPECT_TRUE(cp.IsKnown(N64Reg_A0));
+	EXPECT_TRUE(cp.IsKnown(N64Reg_T0));
+	EXPECT_EQ(7, cp.GetValue(N64Reg_T0));
+}
+
+TEST(ConstantPropagation, UnhandledOpsInvalidateTheirWriteMask)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress + 0, MakeImm(OP_ADDIU, N64Reg_R0, N64Reg_T0, 1));
+	cp.Update(kAddress + 4, MakeImm(OP_ADDIU, N64Reg_R0, N64Reg_T1, 2));
+	cp.Update(kAddress + 8, MakeImm(OP_ADDIU, N64Reg_R0, N64Reg_T2, 3));
+
+	// MFHI is a special op the tracker doesn't model - only rd is lost
+	cp.Update(kAddress + 12, MakeSpecial(SpecOp_MFHI, N64Reg_R0, N64Reg_R0, N64Reg_T0, 0));
+	EXPECT_FALSE(cp.IsKnown(N64Reg_T0));
+	EXPECT_TRUE(cp.IsKnown(N64Reg_T1));
+
+	// MFC0 writes rt
+	cp.Update(kAddress + 16, MakeMFC0(N64Reg_T1, 9));
+	EXPECT_FALSE(cp.IsKnown(N64Reg_T1));
+	EXPECT_TRUE(cp.IsKnown(N64Reg_T2));
+	EXPECT_EQ(3, cp.GetValue(N64Reg_T2));
+}
+
+TEST(ConstantPropagation, UnknownOperandMakesResultUnknown)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress + 0, MakeImm(OP_ADDIU, N64Reg_R0, N64Reg_T0, 1));
+	cp.Update(kAddress + 4, MakeSpecial(SpecOp_ADDU, N64Reg_T0, N64Reg_S0, N64Reg_T0, 0));
+
+	EXPECT_FALSE(cp.IsKnown(N64Reg_T0));
+}
+
+TEST(ConstantPropagation, JalSetsReturnAddress)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress, MakeJump(OP_JAL, 0x80002000));
+
+	ASSERT_TRUE(cp.IsKnown(N64Reg_RA));
+	EXPECT_EQ(s32(kAddress + 8), cp.GetValue(N64Reg_RA));
+}
+
+TEST(ConstantPropagation, ResolvesBranchesOnKnownOperands)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress, MakeImm(OP_ADDIU, N64Reg_R0, N64Reg_T0, 0xffff));		// -1
+
+	bool taken = false;
+	ASSERT_TRUE(cp.GetBranchTaken(MakeImm(OP_BNE, N64Reg_T0, N64Reg_R0, 0x0010), &taken));
+	EXPECT_TRUE(taken);
+	ASSERT_TRUE(cp.GetBranchTaken(MakeImm(OP_BGTZ, N64Reg_T0, N64Reg_R0, 0x0010), &taken));
+	EXPECT_FALSE(taken);
+	EXPECT_FALSE(cp.GetBranchTaken(MakeImm(OP_BEQ, N64Reg_T0, N64Reg_S0, 0x0010), &taken));
+}
+
+TEST(ConstantPropagation, DisablingForgetsEverything)
+{
+	CConstantPropagation cp;
+	cp.Update(kAddress, MakeImm(OP_LUI, N64Reg_R0, N64Reg_A0, 0x8000));
+	cp.SetEnabled(false);
+
+	EXPECT_FALSE(cp.IsKnown(N64Reg_A0));
+	EXPECT_FALSE(cp.IsKnown(N64Reg_R0));
+
+	cp.Update(kAddress + 4, MakeImm(OP_LUI, N64Reg_R0, N64Reg_A0, 0x8000));
+	EXPECT_FALSE(cp.IsKnown(N64Reg_A0));
+}
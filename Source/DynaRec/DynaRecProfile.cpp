@@ -24,6 +24,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Core/ROM.h"
 
+#include <string.h>
+
 #include <map>
 #include <vector>
 #include <algorithm>
@@ -37,10 +39,10 @@ namespace DynarecProfile
 //
 //*************************************************************************************
 static std::map<u32,u32>		gFrameLookups;
+static u32						gFrameCompileEvents[ NUM_COMPILE_EVENTS ];
+static std::map<u32,std::pair<u32,u32> >	gFrameIndirectExits;		// Hits, lookups
 static u32						gLastFrame;
 
-extern std::map< u32, u32 >		gHotTraceCountMap;
-
 
 namespace
 {
@@ -84,6 +86,20 @@ void	CheckForNewFrame()
 				DAED_LOG( DEBUG_DYNAREC_PROF, "%08x: %d lookups", LookupList[ i ].Address, LookupList[ i ].Count );
 		}
 		gFrameLookups.clear();
+
+		DAED_LOG( DEBUG_DYNAREC_PROF, "Compiles: %d queued, %d dropped, %d published, %d cancelled",
+			gFrameCompileEvents[ COMPILE_QUEUED ], gFrameCompileEvents[ COMPILE_DROPPED ],
+			gFrameCompileEvents[ COMPILE_PUBLISHED ], gFrameCompileEvents[ COMPILE_CANCELLED ] );
+		memset( gFrameCompileEvents, 0, sizeof( gFrameCompileEvents ) );
+
+		for(std::map<u32, std::pair<u32,u32> >::const_iterator it = gFrameIndirectExits.begin(); it != gFrameIndirectExits.end(); ++it)
+		{
+			u32		hits( it->second.first );
+			u32		lookups( it->second.second );
+			DAED_LOG( DEBUG_DYNAREC_PROF, "%08x: indirect exit %d/%d hits (%d%%)", it->first, hits, lookups, hits * 100 / lookups );
+		}
+		gFrameIndirectExits.clear();
+
 		gLastFrame = g_dwNumFrames;
 	}
 
@@ -106,6 +122,25 @@ void	LogEnterExit( u32 enter_address, u32 exit_address, u32 instruction_count )
 	DAED_LOG( DEBUG_DYNAREC_CACHE, "Enter/Exit: %08x -> %08x (executed %d instructions)", enter_address, exit_address, instruction_count );
 }
 
+void	LogCompile( ECompileEvent event )
+{
+	CheckForNewFrame();
+
+	gFrameCompileEvents[ event ]++;
+}
+
+void	LogIndirectExit( u32 site_address, bool hit )
+{
+	CheckForNewFrame();
+
+	std::pair<u32,u32> &	counts( gFrameIndirectExits[ site_address ] );
+	if( hit )
+	{
+		counts.first++;
+	}
+	counts.second++;
+}
+
 
 
 }
@@ -27,17 +27,33 @@ class CFragment;
 #ifdef DAEDALUS_ENABLE_DYNAREC_PROFILE
 namespace DynarecProfile
 {
+	enum ECompileEvent
+	{
+		COMPILE_QUEUED,			// Handed to the fragment compiler
+		COMPILE_DROPPED,		// Compile queue was full
+		COMPILE_PUBLISHED,		// Inserted into the fragment cache
+		COMPILE_CANCELLED,		// Source was overwritten whilst compiling
+
+		NUM_COMPILE_EVENTS
+	};
+
 	void LogLookup( u32 address, CFragment * fragment );
 	void LogEnterExit( u32 enter_address, u32 exit_address, u32 instruction_count );
+	void LogCompile( ECompileEvent event );
+	void LogIndirectExit( u32 site_address, bool hit );		// Only sees hits on generators which don't check inline
 }
 
 #define DYNAREC_PROFILE_LOGLOOKUP( a, f )					DynarecProfile::LogLookup( a, f )
 #define DYNAREC_PROFILE_ENTEREXIT( enter, exit, cnt )		DynarecProfile::LogEnterExit( enter, exit, cnt )
+#define DYNAREC_PROFILE_LOGCOMPILE( e )						DynarecProfile::LogCompile( e )
+#define DYNAREC_PROFILE_LOGINDIRECTEXIT( a, h )				DynarecProfile::LogIndirectExit( a, h )
 
 #else
 
 #define DYNAREC_PROFILE_LOGLOOKUP( a, f )
 #define DYNAREC_PROFILE_ENTEREXIT( enter, exit, cnt )
+#define DYNAREC_PROFILE_LOGCOMPILE( e )
+#define DYNAREC_PROFILE_LOGINDIRECTEXIT( a, h )
 
 #endif
 
@@ -28,13 +28,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "BranchType.h"
 #include "StaticAnalysis.h"
 #include "IndirectExitMap.h"
+#include "TraceRecorder.h"
 
+#include "Config/ConfigOptions.h"
 #include "Core/Registers.h"
 #include "Core/CPU.h"			// Try to remove this cyclic dependency
 #include "Core/R4300.h"
 #include "Core/Interrupt.h"
 
 #include "Debug/DBGConsole.h"
+#include "Debug/GuestProfiler.h"
 
 #include "DynaRec/CodeBufferManager.h"
 #include "DynaRec/CodeGenerator.h"
@@ -85,9 +88,15 @@ CFragment::CFragment( CCodeBufferManager * p_manager,
 					  bool need_indirect_exit_map )
 :	mEntryAddress( entry_address )
 ,	mEntryPoint( NULL )
+,	mLinkedEntryPoint( NULL )
 ,	mInputLength( trace.size() * sizeof( OpCode ) )
 ,	mOutputLength( 0 )
 ,	mFragmentFunctionLength( 0 )
+,	mSpanStart( entry_address )
+,	mSpanEnd( entry_address )
+,	mCodeRegion( 0 )
+,	mEntryCount( 0 )
+,	mSourceHash( 0 )
 ,	mpIndirectExitMap( need_indirect_exit_map ? new CIndirectExitMap : NULL )
 #ifdef FRAGMENT_RETAIN_ADDITIONAL_INFO
 ,	mHitCount( 0 )
@@ -103,6 +112,12 @@ CFragment::CFragment( CCodeBufferManager * p_manager,
 	mRegisterUsage = register_usage;
 #endif
 
+	for( TraceBuffer::const_iterator it = trace.begin(); it != trace.end(); ++it )
+	{
+		mSpanStart = std::min( mSpanStart, it->Address );
+		mSpanEnd = std::max( mSpanEnd, it->Address + u32( sizeof( OpCode ) ) );
+	}
+
 	Assemble( p_manager, exit_address, trace, branch_details, register_usage );
 }
 
@@ -116,6 +131,11 @@ CFragment::CFragment(CCodeBufferManager * p_manager, u32 entry_address,
 	,	mInputLength(function_length  * sizeof( OpCode ) )
 	,	mOutputLength( 0 )
 	,	mFragmentFunctionLength( 0 )
+	,	mSpanStart( entry_address )
+	,	mSpanEnd( entry_address + mInputLength )
+	,	mCodeRegion( 0 )
+	,	mEntryCount( 0 )
+	,	mSourceHash( 0 )
 	,	mpIndirectExitMap( new CIndirectExitMap )
 #ifdef FRAGMENT_RETAIN_ADDITIONAL_INFO
 	,	mHitCount( 0 )
@@ -153,6 +173,22 @@ void	CFragment::SetCache( const CFragmentCache * p_cache )
 	}
 }
 
+//*************************************************************************************
+//
+//*************************************************************************************
+void	CFragment::FlushIndirectExits()
+{
+	if( mpIndirectExitMap != NULL )
+	{
+		mpIndirectExitMap->Flush();
+	}
+
+	for( std::vector< SIndirectExitEntry >::iterator it = mReturnSites.begin(); it != mReturnSites.end(); ++it )
+	{
+		it->Target = NULL;
+	}
+}
+
 //*************************************************************************************
 //
 //*************************************************************************************
@@ -171,6 +207,8 @@ void CFragment::Execute()
 	#ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( gCPUState.Delay == NO_DELAY, "Why are we entering with a delay slot active?" );
 #endif
+	++mEntryCount;
+
 #ifdef FRAGMENT_SIMULATE_EXECUTION
 
 	CFragment * p_fragment( this );
@@ -525,7 +563,8 @@ u32	CFragment::GetMemoryUsage() const
 	// Ignore the 'additional info' when computing this
 
 	return sizeof( CFragment ) +
-		   mPatchList.size() * sizeof( SFragmentPatchDetails );
+		   mPatchList.size() * sizeof( SFragmentPatchDetails ) +
+		   mReturnSites.size() * sizeof( SIndirectExitEntry );
 }
 
 //*************************************************************************************
@@ -546,6 +585,48 @@ namespace
 		CJumpLocation			Jump;
 		RegisterSnapshotHandle	RegisterSnapshot;
 	};
+
+	// Calls which leave a return address in RA, to be predicted by gReturnStack
+	bool IsCall( OpCode op_code )
+	{
+		return op_code.op == OP_JAL ||
+			 ( op_code.op == OP_SPECOP && op_code.spec_op == SpecOp_JALR && op_code.rd == N64Reg_RA );
+	}
+
+	bool IsReturn( OpCode op_code )
+	{
+		return op_code.op == OP_SPECOP && op_code.spec_op == SpecOp_JR && op_code.rs == N64Reg_RA;
+	}
+
+	// The recorder follows small leaf calls back into the caller. Their return only
+	// reaches the indirect exit on a mismatch, so the call doesn't push a return site.
+	bool IsInlinedCall( const std::vector< STraceEntry > & trace, const std::vector< SBranchDetails > & branch_details, u32 call_idx )
+	{
+		u32		return_address( trace[ call_idx ].Address + 8 );
+
+		for( u32 i = call_idx + 1; i < trace.size(); ++i )
+		{
+			const STraceEntry &	ti( trace[ i ] );
+
+			if( IsCall( ti.OpCode ) )
+				return false;
+
+			if( IsReturn( ti.OpCode ) )
+				return ti.BranchIdx != INVALID_IDX && branch_details[ ti.BranchIdx ].TargetAddress == return_address;
+		}
+		return false;
+	}
+
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+	// Records that the code generated from here on is for the op at address
+	void AddProfilerLocation( GuestProfiler::LocationList & locations, CCodeGenerator * p_generator, CCodeLabel entry_point, u32 address )
+	{
+		GuestProfiler::SLocation	location;
+		location.HostOffset = u32( p_generator->GetCurrentLocation().GetTargetU8P() - entry_point.GetTargetU8P() );
+		location.Address = address;
+		locations.push_back( location );
+	}
+#endif
 }
 
 //*************************************************************************************
@@ -581,12 +662,25 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 	CCodeGenerator *		p_generator( p_manager->StartNewBlock() );
 
 	mEntryPoint = p_generator->GetEntryPoint();
+	mCodeRegion = p_manager->GetCurrentRegion();
 
 #ifdef FRAGMENT_RETAIN_ADDITIONAL_INFO
 	p_generator->Initialise( mEntryAddress, exit_address, &mHitCount, &gCPUState, register_usage );
 #else
 	p_generator->Initialise( mEntryAddress, exit_address, NULL, &gCPUState, register_usage );
 #endif
+	mLinkedEntryPoint = p_generator->GetLinkedEntryPoint();
+	mEntryContract = p_generator->GetEntryContract();
+
+	// Loops which spin on memory until an interrupt arrives skip straight to the
+	// next event on each pass. This supersedes the branch speedhack probes below.
+	const bool	idle_loop( gIdleLoopSkipEnabled && exit_address == mEntryAddress && CTraceRecorder::IsIdleLoop( trace ) );
+#ifdef DAEDALUS_DEBUG_DYNAREC
+	if( idle_loop )
+	{
+		printf("Idle loop at %08x (%d ops)\n", mEntryAddress, u32( trace.size() ) );
+	}
+#endif
 
 	//Trace: (3 ops, 13 hits)
 	//80317934:  SLT       at = (t7<a0)
@@ -614,6 +708,22 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 	std::vector< SBranchHandlerInfo >	branch_handler_info( branch_details.size() );
 //	bool								checked_cop1_usable( false );
 
+	// Sized up front, the generated code holds pointers to the entries
+	u32		num_calls( 0 );
+	for( u32 i = 0; i < trace.size(); ++i )
+	{
+		if( IsCall( trace[ i ].OpCode ) && !IsInlinedCall( trace, branch_details, i ) )
+		{
+			++num_calls;
+		}
+	}
+	mReturnSites.resize( num_calls );
+	u32		return_site_idx( 0 );
+
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+	GuestProfiler::LocationList		profiler_locations;
+#endif
+
 	for( u32 i = 0; i < trace.size(); ++i )
 	{
 		const STraceEntry & ti( trace[ i ] );
@@ -622,6 +732,9 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 #ifdef FRAGMENT_RETAIN_ADDITIONAL_INFO
 		mInstructionStartLocations.push_back( p_generator->GetCurrentLocation().GetTargetU8P() );
 #endif
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+		AddProfilerLocation( profiler_locations, p_generator, mEntryPoint, ti.Address );
+#endif
 
 		p_generator->UpdateRegisterCaching( i );
 
@@ -646,7 +759,7 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 			p_branch = &branch_details[ branch_idx ];
 
 #ifndef DAEDALUS_SILENT
-			switch(p_branch->SpeedHack)
+			switch(idle_loop ? SHACK_NONE : p_branch->SpeedHack)
 			{
 				case SHACK_SKIPTOEVENT:
 					{
@@ -695,13 +808,22 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 					break;
 			}
 #else
-			if(p_branch->SpeedHack == SHACK_SKIPTOEVENT)
+			if(!idle_loop && p_branch->SpeedHack == SHACK_SKIPTOEVENT)
 			{
 				p_generator->ExecuteNativeFunction( CCodeLabel( reinterpret_cast< const void * >( CPU_SkipToNextEvent ) ) );
 			}
 #endif
 		}
 
+		if( IsCall( ti.OpCode ) && !IsInlinedCall( trace, branch_details, i ) )
+		{
+			SIndirectExitEntry &	return_site( mReturnSites[ return_site_idx++ ] );
+			return_site.Address = ti.Address + 8;
+			return_site.Target = NULL;
+
+			p_generator->GeneratePushReturnAddress( &return_site );
+		}
+
 		CJumpLocation	branch_jump( NULL );
  //PSP, We handle exceptions directly with _ReturnFromDynaRecIfStuffToDo
 #ifdef DAEDALUS_PSP
@@ -727,6 +849,12 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 		mInstructionStartLocations.push_back( p_generator->GetCurrentLocation().GetTargetU8P() );
 #endif
 
+	// Only the path that goes round again is idle - the loop's exit branch runs normally
+	if( idle_loop )
+	{
+		p_generator->ExecuteNativeFunction( CCodeLabel( reinterpret_cast< const void * >( CPU_SkipToNextEvent ) ) );
+	}
+
 	CCodeLabel		no_next_fragment( NULL );
 	CJumpLocation	exit_jump( p_generator->GenerateExitCode( exit_address, NO_JUMP_ADDRESS, trace.size(), no_next_fragment ) );
 
@@ -751,6 +879,9 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 		u32					branch_instruction_address( trace[ instruction_idx ].Address );
 		u32					num_instructions_executed( instruction_idx + 1 );
 
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+		AddProfilerLocation( profiler_locations, p_generator, mEntryPoint, branch_instruction_address );
+#endif
 		p_generator->GenerateBranchHandler( branch_handler_info[ i ].Jump, branch_handler_info[ i ].RegisterSnapshot );
 
 		//
@@ -759,6 +890,9 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 		if( !details.Likely && details.DelaySlotTraceIndex != -1 )
 		{
 			const STraceEntry & ti( trace[ details.DelaySlotTraceIndex ] );
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+			AddProfilerLocation( profiler_locations, p_generator, mEntryPoint, ti.Address );
+#endif
 #ifdef FRAGMENT_SIMULATE_EXECUTION
 			u32			delay_address( ti.Address );
 #endif
@@ -828,6 +962,11 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 			}
 			else
 			{
+				// All the indirect exits share the map, so it only tracks the last site for profiling
+				const STraceEntry &	branch_entry( trace[ instruction_idx ] );
+				mpIndirectExitMap->SetSiteAddress( branch_entry.Address );
+				mpIndirectExitMap->SetIsReturn( mpIndirectExitMap->IsReturn() || IsReturn( branch_entry.OpCode ) );
+
 				p_generator->GenerateIndirectExitCode( num_instructions_executed, mpIndirectExitMap );
 			}
 		}
@@ -838,6 +977,10 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 	mFragmentFunctionLength = p_manager->FinaliseCurrentBlock();
 	mOutputLength = mFragmentFunctionLength - ADDITIONAL_OUTPUT_BYTES;
 
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+	GuestProfiler::AddFragment( mEntryAddress, mEntryPoint.GetTargetU8P(), mFragmentFunctionLength, profiler_locations );
+#endif
+
 	delete p_generator;
 }
 
@@ -852,6 +995,7 @@ void CFragment::Assemble( CCodeBufferManager * p_manager, CCodeLabel function_pt
 
 	CCodeGenerator *p_generator = p_manager->StartNewBlock();
 	mEntryPoint = p_generator->GetEntryPoint();
+	mCodeRegion = p_manager->GetCurrentRegion();
 
 
 #ifdef FRAGMENT_RETAIN_ADDITIONAL_INFO
@@ -859,6 +1003,12 @@ void CFragment::Assemble( CCodeBufferManager * p_manager, CCodeLabel function_pt
 #else
 		p_generator->Initialise( mEntryAddress, 0, NULL, &gCPUState, register_usage );
 #endif
+	mLinkedEntryPoint = p_generator->GetLinkedEntryPoint();
+	mEntryContract = p_generator->GetEntryContract();
+
+	// Patched functions return to their caller
+	mpIndirectExitMap->SetSiteAddress( mEntryAddress );
+	mpIndirectExitMap->SetIsReturn( true );
 
 	CJumpLocation jump = p_generator->ExecuteNativeFunction(function_ptr, true);
 	p_generator->GenerateIndirectExitCode(100, mpIndirectExitMap);
@@ -869,6 +1019,10 @@ void CFragment::Assemble( CCodeBufferManager * p_manager, CCodeLabel function_pt
 	mFragmentFunctionLength = p_manager->FinaliseCurrentBlock();
 	mOutputLength = mFragmentFunctionLength - ADDITIONAL_OUTPUT_BYTES;
 
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+	GuestProfiler::AddFragment( mEntryAddress, mEntryPoint.GetTargetU8P(), mFragmentFunctionLength, GuestProfiler::LocationList() );
+#endif
+
 	delete p_generator;
 }
 #endif
@@ -1018,6 +1172,13 @@ void CFragment::DumpFragmentInfoHtml( FILE * fh, u64 total_cycles ) const
 		if(mRegisterUsage.RegistersAsBases&(1<<i)) { fprintf( fh, "%s ", RegNames[i] ); }
 	}
 	fputs( "</td></tr>\n", fh );
+
+	fputs( "<tr><td>Live In</td><td>", fh );
+	for(u32 i = 1; i < NUM_N64_REGS; ++i)
+	{
+		if(mRegisterUsage.RegistersLiveIn&(1<<i)) { fprintf( fh, "%s ", RegNames[i] ); }
+	}
+	fputs( "</td></tr>\n", fh );
 	fputs( "</table></div>\n", fh );
 
 	fputs( "<h2>Spans</h2>\n", fh );
@@ -22,6 +22,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Trace.h"
 #include "RegisterSpan.h"
+#include "IndirectExitMap.h"
+#include "RegisterContract.h"
 
 #include "Core/R4300Instruction.h"
 
@@ -47,7 +49,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 class CFragmentCache;
 class CCodeGenerator;
 class CCodeBufferManager;
-class CIndirectExitMap;
 
 struct SFragmentPatchDetails
 {
@@ -80,13 +81,32 @@ public:
 
 		u32			GetEntryAddress() const						{ return mEntryAddress; }
 		CCodeLabel	GetEntryTarget() const						{ return mEntryPoint; }
+		CCodeLabel	GetLinkedEntryTarget() const				{ return mLinkedEntryPoint; }
+		const SRegisterContract &	GetEntryContract() const	{ return mEntryContract; }
 
 		u32			GetMemoryUsage() const;
 		u32			GetInputLength() const						{ return mInputLength; }
 		u32			GetOutputLength() const						{ return mOutputLength; }
 
+		// Range of guest addresses the fragment was built from
+		u32			GetSpanStart() const						{ return mSpanStart; }
+		u32			GetSpanEnd() const							{ return mSpanEnd; }
+		bool		Overlaps( u32 address, u32 length ) const	{ return address < mSpanEnd && address + length > mSpanStart; }
+
+		// Used by the fragment cache to decide what to evict
+		u32			GetCodeRegion() const						{ return mCodeRegion; }
+		u32			GetEntryCount() const						{ return mEntryCount; }
+		void		DecayEntryCount()							{ mEntryCount /= 2; }
+
+		// Hash of the source span, set by the fragment cache (0 if it couldn't be read)
+		u32			GetSourceHash() const						{ return mSourceHash; }
+		void		SetSourceHash( u32 hash )					{ mSourceHash = hash; }
+
 		void		SetCache( const CFragmentCache * p_cache );
 
+		// Forget cached indirect exit and return targets, they may have been deleted
+		void		FlushIndirectExits();
+
 		const FragmentPatchList &	GetPatchList() const		{ return mPatchList; }
 		void		DiscardPatchList()							{ mPatchList.clear(); }
 
@@ -113,11 +133,20 @@ private:
 		std::vector< SFragmentPatchDetails >	mPatchList;
 
 		CCodeLabel						mEntryPoint;
+		CCodeLabel						mLinkedEntryPoint;	// For linked exits which satisfy mEntryContract
+		SRegisterContract				mEntryContract;		// Also held at every exit
 		u32								mInputLength;
 		u32								mOutputLength;		// Essentially the same as mFragmentFunctionLength, but takes into account additional debugging instructions etc
 		u32								mFragmentFunctionLength;
 
+		u32								mSpanStart;
+		u32								mSpanEnd;
+		u32								mCodeRegion;
+		u32								mEntryCount;		// Entries through Execute(), i.e. not via linked exits
+		u32								mSourceHash;
+
 		CIndirectExitMap *				mpIndirectExitMap;
+		std::vector< SIndirectExitEntry >	mReturnSites;		// Pushed on gReturnStack by the calls in the trace
 
 #ifdef FRAGMENT_RETAIN_ADDITIONAL_INFO
 		u32								mHitCount;
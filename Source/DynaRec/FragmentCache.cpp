@@ -27,9 +27,12 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Fragment.h"
 #include "CodeBufferManager.h"
 #include "DynaRecProfile.h"
+#include "IndirectExitMap.h"
 
+#include "Core/Memory.h"
 #include "Debug/DBGConsole.h"
 
+#include "Utility/Hash.h"
 #include "Utility/Profiler.h"
 #include "Utility/IO.h"
 
@@ -41,6 +44,88 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 using namespace AssemblyUtils;
 
+namespace
+{
+	// Fragments spanning more than this aren't hashed, and so don't survive InvalidateStale()
+	const u32	MAX_HASHED_SPAN = 64 * 1024;
+
+	// Forget which addresses were removed once there are this many (they're only used for stats)
+	const u32	MAX_REMOVED_ADDRESSES = 16384;
+
+//*************************************************************************************
+//	Returns 0 if the source isn't directly mapped
+//*************************************************************************************
+u32 HashFragmentSource( const CFragment * p_fragment )
+{
+	u32		start( p_fragment->GetSpanStart() );
+	u32		end( p_fragment->GetSpanEnd() );
+
+	if( end <= start || end - start > MAX_HASHED_SPAN || ( start >> 18 ) != ( ( end - 1 ) >> 18 ) )
+		return 0;
+
+	const MemFuncRead & m( g_MemoryLookupTableRead[ start >> 18 ] );
+	if( m.pRead == NULL )
+		return 0;
+
+	u32		hash( murmur2_neutral_hash( m.pRead + start, end - start, 0 ) );
+	return hash != 0 ? hash : 1;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+struct SOverlapsRange
+{
+	SOverlapsRange( u32 address, u32 length ) : Address( address ), Length( length ) {}
+
+	bool operator()( const CFragment * p_fragment ) const
+	{
+		return p_fragment->Overlaps( Address, Length );
+	}
+
+	u32		Address;
+	u32		Length;
+};
+
+//*************************************************************************************
+//
+//*************************************************************************************
+struct SSourceChanged
+{
+	bool operator()( const CFragment * p_fragment ) const
+	{
+		return p_fragment->GetSourceHash() == 0 || p_fragment->GetSourceHash() != HashFragmentSource( p_fragment );
+	}
+};
+
+//*************************************************************************************
+//
+//*************************************************************************************
+struct SInCodeRegion
+{
+	explicit SInCodeRegion( u32 region ) : Region( region ) {}
+
+	bool operator()( const CFragment * p_fragment ) const
+	{
+		return p_fragment->GetCodeRegion() == Region;
+	}
+
+	u32		Region;
+};
+
+//*************************************************************************************
+//	Exits which already hold the registers the target loads on entry skip the loads
+//*************************************************************************************
+CCodeLabel GetLinkTarget( const SRegisterContract & held, const CFragment * p_target )
+{
+	if( p_target->GetEntryContract().IsSatisfiedBy( held ) )
+	{
+		return p_target->GetLinkedEntryTarget();
+	}
+	return p_target->GetEntryTarget();
+}
+}
+
 //*************************************************************************************
 //
 //*************************************************************************************
@@ -103,7 +188,7 @@ CFragment * CFragmentCache::LookupFragment( u32 address ) const
 
 			// put in hash table
 			mpCacheHashTable[ix].addr = address;
-			mpCacheHashTable[ix].ptr = reinterpret_cast< u32 >( mpCachedFragment );
+			mpCacheHashTable[ix].ptr = reinterpret_cast< uintptr_t >( mpCachedFragment );
 		}
 		else
 		{
@@ -154,7 +239,7 @@ CFragment * CFragmentCache::LookupFragmentQ( u32 address ) const
 
 			// put in hash table
 			mpCacheHashTable[ix].addr = address;
-			mpCacheHashTable[ix].ptr = reinterpret_cast< u32 >( mpCachedFragment );
+			mpCacheHashTable[ix].ptr = reinterpret_cast< uintptr_t >( mpCachedFragment );
 		}
 		else
 		{
@@ -183,7 +268,13 @@ void CFragmentCache::InsertFragment( CFragment * p_fragment )
 {
 	u32		fragment_address( p_fragment->GetEntryAddress() );
 
-	mCacheCoverage.ExtendCoverage( fragment_address, p_fragment->GetInputLength() );
+	mCacheCoverage.ExtendCoverage( p_fragment->GetSpanStart(), p_fragment->GetSpanEnd() - p_fragment->GetSpanStart() );
+	p_fragment->SetSourceHash( HashFragmentSource( p_fragment ) );
+
+	if( mRemovedAddresses.erase( fragment_address ) != 0 )
+	{
+		mStats.Recompilations++;
+	}
 
 	SFragmentEntry				entry( fragment_address, NULL );
 	FragmentVec::iterator		it( std::lower_bound( mFragments.begin(), mFragments.end(), entry ) );
@@ -196,21 +287,19 @@ void CFragmentCache::InsertFragment( CFragment * p_fragment )
 	// Update the hash table (it stores failed lookups now, so we need to be sure to purge any stale entries in there
 	u32 ix = MakeHashIdx( fragment_address );
 	mpCacheHashTable[ix].addr = fragment_address;
-	mpCacheHashTable[ix].ptr = reinterpret_cast< u32 >( p_fragment );
+	mpCacheHashTable[ix].ptr = reinterpret_cast< uintptr_t >( p_fragment );
 
-	// Process any jumps for this before inserting new ones
+	// Process any jumps for this before inserting new ones. They're kept so
+	// they can be unlinked if this fragment is removed.
 	JumpMap::iterator	jump_it( mJumpMap.find( fragment_address ) );
 	if( jump_it != mJumpMap.end() )
 	{
 		const JumpList &		jumps( jump_it->second );
 		for( JumpList::const_iterator it = jumps.begin(); it != jumps.end(); ++it )
 		{
-			//DBGConsole_Msg( 0, "Inserting [R%08x], patching jump at %08x ", address, (*it) );
-			PatchJumpLongAndFlush( (*it), p_fragment->GetEntryTarget() );
+			//DBGConsole_Msg( 0, "Inserting [R%08x], patching jump at %08x ", address, it->Jump );
+			PatchJumpLongAndFlush( it->Jump, GetLinkTarget( it->Held, p_fragment ) );
 		}
-
-		// All patched - clear
-		mJumpMap.erase( jump_it );
 	}
 
 	// Finally register any links that this fragment may have
@@ -222,24 +311,26 @@ void CFragmentCache::InsertFragment( CFragment * p_fragment )
 #ifdef DAEDALUS_ENABLE_ASSERTS
 		DAEDALUS_ASSERT( jump.IsSet(), "No exit jump?" );
 #endif
+		if( target_address == u32(~0) )
+			continue;
+
+		SJumpLink		link;
+		link.Jump = jump;
+		link.Unlinked = GetJumpLongTarget( jump );
+		link.Held = p_fragment->GetEntryContract();
+
 #ifdef DAEDALUS_DEBUG_DYNAREC
-		CFragment * p_fragment( LookupFragment( target_address ) );
+		CFragment * p_target( LookupFragment( target_address ) );
 #else
-		CFragment * p_fragment( LookupFragmentQ( target_address ) );
+		CFragment * p_target( LookupFragmentQ( target_address ) );
 #endif
-		if( p_fragment != NULL )
-		{
-			PatchJumpLongAndFlush( jump, p_fragment->GetEntryTarget() );
-
-#ifdef DAEDALUS_ENABLE_ASSERTS
-			DAEDALUS_ASSERT( mJumpMap.find( target_address ) == mJumpMap.end(), "Jump map still contains an entry for this" );
-			#endif
-		}
-		else if( target_address != u32(~0) )
+		if( p_target != NULL )
 		{
-			// Store the address for later processing
-			mJumpMap[ target_address ].push_back( jump );
+			PatchJumpLongAndFlush( jump, GetLinkTarget( link.Held, p_target ) );
 		}
+
+		// Store the address for later processing
+		mJumpMap[ target_address ].push_back( link );
 	}
 
 	// Free memoire
@@ -278,6 +369,9 @@ void CFragmentCache::Clear()
 		DBGConsole_Msg( 0, "Clearing fragment cache of %d fragments", mFragments.size() );
 	}
 #endif
+	// The return stack points into the fragments, so forget it before they go
+	IndirectExitMap_ResetReturnStack();
+
 	// Clear out all the framents
 	for(FragmentVec::iterator it = mFragments.begin(); it != mFragments.end(); ++it)
 	{
@@ -292,12 +386,222 @@ void CFragmentCache::Clear()
 	mpCachedFragment = NULL;
 	memset( mpCacheHashTable, 0, sizeof(mpCacheHashTable) );
 	mJumpMap.clear();
+	mRemovedAddresses.clear();
 
 	mCacheCoverage.Reset();
 
 	mpCodeBufferManager->Reset();
 }
 
+//*************************************************************************************
+//	Undoes InsertFragment() for a fragment which has already been taken out of
+//	mFragments. Exits linked to it go back to the dispatcher.
+//*************************************************************************************
+void CFragmentCache::DiscardFragment( CFragment * p_fragment )
+{
+	u32		fragment_address( p_fragment->GetEntryAddress() );
+
+	JumpMap::const_iterator	jump_it( mJumpMap.find( fragment_address ) );
+	if( jump_it != mJumpMap.end() )
+	{
+		const JumpList &		jumps( jump_it->second );
+		for( JumpList::const_iterator it = jumps.begin(); it != jumps.end(); ++it )
+		{
+			PatchJumpLongAndFlush( it->Jump, it->Unlinked );
+		}
+	}
+
+	// The hash table holds failed lookups too, so just mark it as missing
+	u32 ix = MakeHashIdx( fragment_address );
+	if( mpCacheHashTable[ix].addr == fragment_address )
+	{
+		mpCacheHashTable[ix].ptr = 0;
+	}
+	if( mCachedFragmentAddress == fragment_address )
+	{
+		mpCachedFragment = NULL;
+	}
+
+	mCacheCoverage.ReduceCoverage( p_fragment->GetSpanStart(), p_fragment->GetSpanEnd() - p_fragment->GetSpanStart() );
+
+	mMemoryUsage -= p_fragment->GetMemoryUsage();
+	mInputLength -= p_fragment->GetInputLength();
+	mOutputLength -= p_fragment->GetOutputLength();
+
+	if( mRemovedAddresses.size() >= MAX_REMOVED_ADDRESSES )
+	{
+		mRemovedAddresses.clear();
+	}
+	mRemovedAddresses.insert( fragment_address );
+
+	// Never leave the return stack pointing at a deleted fragment, even briefly,
+	// as the guest profiler's signal handler walks it at any time
+	IndirectExitMap_ResetReturnStack();
+
+	delete p_fragment;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+template< typename Pred >
+u32 CFragmentCache::RemoveFragments( Pred pred )
+{
+	FragmentVec::iterator	out( mFragments.begin() );
+	for( FragmentVec::iterator it = mFragments.begin(); it != mFragments.end(); ++it )
+	{
+		if( pred( it->Fragment ) )
+		{
+			DiscardFragment( it->Fragment );
+		}
+		else
+		{
+			*out++ = *it;
+		}
+	}
+
+	u32		num_removed( mFragments.end() - out );
+	mFragments.erase( out, mFragments.end() );
+
+	if( num_removed > 0 )
+	{
+		FlushIndirectExits();
+	}
+	return num_removed;
+}
+
+//*************************************************************************************
+//	The inline caches and return stack don't know which fragments they point
+//	at, so they're all forgotten whenever any fragment goes.
+//*************************************************************************************
+void CFragmentCache::FlushIndirectExits()
+{
+	for( FragmentVec::iterator it = mFragments.begin(); it != mFragments.end(); ++it )
+	{
+		it->Fragment->FlushIndirectExits();
+	}
+
+	IndirectExitMap_ResetReturnStack();
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 CFragmentCache::InvalidateRange( u32 address, u32 length )
+{
+	if( !mCacheCoverage.IsCovered( address, length ) )
+		return 0;
+
+	u32		num_removed( RemoveFragments( SOverlapsRange( address, length ) ) );
+	mStats.InvalidatedFragments += num_removed;
+	return num_removed;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 CFragmentCache::InvalidateStale()
+{
+	u32		num_removed( RemoveFragments( SSourceChanged() ) );
+	mStats.InvalidatedFragments += num_removed;
+	return num_removed;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CFragmentCache::NeedsEviction( u32 num_blocks ) const
+{
+	return mpCodeBufferManager->GetNumFreeBlocks() < num_blocks;
+}
+
+//*************************************************************************************
+//	A region's heat is the number of times its fragments have been entered
+//	from the dispatcher, plus the number of exits linked to them. The coldest
+//	region other than the one being written to is thrown away.
+//*************************************************************************************
+bool CFragmentCache::EvictColdRegion()
+{
+	const u32		num_regions( mpCodeBufferManager->GetNumRegions() );
+	const u32		current_region( mpCodeBufferManager->GetCurrentRegion() );
+
+	if( num_regions <= 1 )
+		return false;
+
+	std::vector< u32 >	heat( num_regions, 0 );
+	for( FragmentVec::const_iterator it = mFragments.begin(); it != mFragments.end(); ++it )
+	{
+		u32		references( 0 );
+		JumpMap::const_iterator	jump_it( mJumpMap.find( it->Address ) );
+		if( jump_it != mJumpMap.end() )
+		{
+			references = jump_it->second.size();
+		}
+
+		heat[ it->Fragment->GetCodeRegion() ] += it->Fragment->GetEntryCount() + references;
+	}
+
+	u32		coldest( num_regions );
+	for( u32 i = 0; i < num_regions; ++i )
+	{
+		if( i == current_region || !mpCodeBufferManager->IsRegionInUse( i ) )
+			continue;
+
+		if( coldest == num_regions || heat[ i ] < heat[ coldest ] )
+		{
+			coldest = i;
+		}
+	}
+
+	if( coldest == num_regions )
+		return false;
+
+	u32		num_removed( RemoveFragments( SInCodeRegion( coldest ) ) );
+
+	// Forget about the exits in the evicted code, it's about to be reused
+	for( JumpMap::iterator it = mJumpMap.begin(); it != mJumpMap.end(); )
+	{
+		JumpList &				jumps( it->second );
+		JumpList::iterator		out( jumps.begin() );
+		for( JumpList::iterator jump_it = jumps.begin(); jump_it != jumps.end(); ++jump_it )
+		{
+			if( !mpCodeBufferManager->IsInRegion( coldest, jump_it->Jump.GetTargetU8P() ) )
+			{
+				*out++ = *jump_it;
+			}
+		}
+		jumps.erase( out, jumps.end() );
+
+		if( jumps.empty() )
+		{
+			mJumpMap.erase( it++ );
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	mpCodeBufferManager->FreeRegion( coldest );
+
+	// Age the survivors so that old activity doesn't protect a region forever
+	for( FragmentVec::iterator it = mFragments.begin(); it != mFragments.end(); ++it )
+	{
+		it->Fragment->DecayEntryCount();
+	}
+
+	mStats.Evictions++;
+	mStats.EvictedFragments += num_removed;
+
+#ifdef DAEDALUS_DEBUG_CONSOLE
+	if(CDebugConsole::IsAvailable())
+	{
+		DBGConsole_Msg( 0, "Evicted code region %d (%d fragments, heat %d), %d fragments left", coldest, num_removed, heat[ coldest ], mFragments.size() );
+	}
+#endif
+	return true;
+}
+
 //*************************************************************************************
 //
 //*************************************************************************************
@@ -416,10 +720,30 @@ void CFragmentCacheCoverage::ExtendCoverage( u32 address, u32 len )
 	u32 first_entry( AddressToIndex( address ) );
 	u32 last_entry( AddressToIndex( address + len ) );
 
-	// Mark all entries as true
 	for( u32 i = first_entry; i <= last_entry && i < NUM_MEM_USAGE_ENTRIES; ++i )
 	{
-		mCacheCoverage[ i ] = true;
+		if( mCacheCoverage[ i ] != u16(~0) )
+		{
+			mCacheCoverage[ i ]++;
+		}
+	}
+}
+
+//*************************************************************************************
+//	Must be called with the same range as ExtendCoverage()
+//*************************************************************************************
+void CFragmentCacheCoverage::ReduceCoverage( u32 address, u32 len )
+{
+	u32 first_entry( AddressToIndex( address ) );
+	u32 last_entry( AddressToIndex( address + len ) );
+
+	for( u32 i = first_entry; i <= last_entry && i < NUM_MEM_USAGE_ENTRIES; ++i )
+	{
+		// Saturated counts stay put
+		if( mCacheCoverage[ i ] != 0 && mCacheCoverage[ i ] != u16(~0) )
+		{
+			mCacheCoverage[ i ]--;
+		}
 	}
 }
 
@@ -439,10 +763,9 @@ bool CFragmentCacheCoverage::IsCovered( u32 address, u32 len ) const
 	u32 first_entry( AddressToIndex( address ) );
 	u32 last_entry( AddressToIndex( address + len ) );
 
-	// Mark all entries as true
 	for( u32 i = first_entry; i <= last_entry && i < NUM_MEM_USAGE_ENTRIES; ++i )
 	{
-		if( mCacheCoverage[ i ] )
+		if( mCacheCoverage[ i ] != 0 )
 			return true;
 	}
 
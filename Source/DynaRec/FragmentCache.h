@@ -22,21 +22,25 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Utility/DaedalusTypes.h"
 
+#include "AssemblyUtils.h"
+#include "RegisterContract.h"
+
 class	CFragment;
-class	CJumpLocation;
 class	CCodeBufferManager;
 
 #include <map>
+#include <set>
 #include <vector>
 
 struct FHashT
 {
-	u32	addr;
-	u32 ptr;
+	u32			addr;
+	uintptr_t	ptr;
 };
 
 //*************************************************************************************
-//
+// Counts the fragments built from each 4k page of RAM, so writes to pages
+// with no fragments can be ignored cheaply.
 //*************************************************************************************
 class CFragmentCacheCoverage
 {
@@ -44,6 +48,7 @@ public:
 	CFragmentCacheCoverage() { Reset(); }
 
 	void			ExtendCoverage( u32 address, u32 len );
+	void			ReduceCoverage( u32 address, u32 len );
 	bool			IsCovered( u32 address, u32 len ) const;
 
 	void			Reset();
@@ -58,11 +63,15 @@ private:
 	static const u32 MEM_USAGE_SHIFT = 12;		// 4k
 	static const u32 NUM_MEM_USAGE_ENTRIES = MEMORY_8_MEG >> MEM_USAGE_SHIFT;
 
-	bool			mCacheCoverage[ NUM_MEM_USAGE_ENTRIES ];
+	u16				mCacheCoverage[ NUM_MEM_USAGE_ENTRIES ];
 };
 
 //*************************************************************************************
-//
+// Rather than throwing everything away when the code buffer fills up, the cache
+// can evict the fragments in the least used region of the code buffer (see
+// CCodeBufferManager::GetNumRegions()). Every exit which was linked to another
+// fragment is remembered, so removing a fragment can point the exits back at
+// the dispatcher. Writes to code only remove the fragments built from it.
 //*************************************************************************************
 class CFragmentCache
 {
@@ -70,6 +79,16 @@ public:
 	CFragmentCache();
 	~CFragmentCache();
 
+	struct SStats
+	{
+		SStats() : Evictions( 0 ), EvictedFragments( 0 ), InvalidatedFragments( 0 ), Recompilations( 0 ) {}
+
+		u32					Evictions;					// Regions evicted
+		u32					EvictedFragments;
+		u32					InvalidatedFragments;		// Removed because their code was overwritten
+		u32					Recompilations;				// Fragments inserted again after being removed
+	};
+
 #ifdef DAEDALUS_DEBUG_DYNAREC
 	CFragment *				LookupFragment( u32 address ) const;
 #endif
@@ -79,6 +98,19 @@ public:
 	u32						GetCacheSize() const					{ return mFragments.size(); }
 	void					Clear();
 
+	// Remove the fragments built from code in this range. Returns the number removed.
+	u32						InvalidateRange( u32 address, u32 length );
+	// Remove the fragments whose code has changed since they were built, or can't be checked.
+	u32						InvalidateStale();
+
+	// True if there isn't room to start this many blocks without evicting something
+	bool					NeedsEviction( u32 num_blocks ) const;
+	// Returns false if the code buffer isn't split into regions, in which case Clear() instead
+	bool					EvictColdRegion();
+
+	const SStats &			GetStats() const						{ return mStats; }
+	u32						GetOutputLength() const					{ return mOutputLength; }
+
 #ifdef DAEDALUS_DEBUG_DYNAREC
 	void					DumpStats( const char * outputdir ) const;
 #endif
@@ -110,14 +142,31 @@ private:
 	typedef std::vector< SFragmentEntry >	FragmentVec;
 	FragmentVec				mFragments;			// Sorted on Address
 
+	template< typename Pred >
+	u32						RemoveFragments( Pred pred );
+	void					DiscardFragment( CFragment * p_fragment );
+	void					FlushIndirectExits();
+
 	u32						mMemoryUsage;
 	u32						mInputLength;
 	u32						mOutputLength;
 
-	typedef std::vector< CJumpLocation >	JumpList;
+	// Every exit targetting an address, linked or not, along with where it
+	// jumped to before it was linked.
+	struct SJumpLink
+	{
+		CJumpLocation		Jump;
+		CCodeLabel			Unlinked;
+		SRegisterContract	Held;			// By the fragment owning the jump
+	};
+
+	typedef std::vector< SJumpLink >		JumpList;
 	typedef std::map< u32, JumpList >		JumpMap;
 	JumpMap					mJumpMap;
 
+	std::set< u32 >			mRemovedAddresses;	// For counting recompilations
+	SStats					mStats;
+
 	mutable u32				mCachedFragmentAddress;
 	mutable CFragment *		mpCachedFragment;
 
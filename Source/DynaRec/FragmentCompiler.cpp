@@ -0,0 +1,301 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "FragmentCompiler.h"
+#include "Fragment.h"
+
+#include <string.h>
+
+#include "Math/MathUtil.h"
+#include "Utility/AtomicPrimitives.h"
+#include "Utility/Cond.h"
+
+CFragmentCompiler					gFragmentCompiler;
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void SFragmentCompileJob::UpdateSpan()
+{
+	SpanStart = u32( ~0 );
+	SpanEnd = 0;
+	for( std::vector< STraceEntry >::const_iterator it = Trace.begin(); it != Trace.end(); ++it )
+	{
+		SpanStart = Min( SpanStart, it->Address );
+		SpanEnd = Max( SpanEnd, it->Address + 4 );
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CFragmentCompiler::CFragmentCompiler()
+:	mCodeBufferLock( "CodeBufferLock" )
+,	mNumOutstandingJobs( 0 )
+,	mCompletedHead( 0 )
+,	mCompletedTail( 0 )
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+,	mMutex( "FragmentCompiler" )
+,	mWorkCond( CondCreate() )
+,	mIdleCond( CondCreate() )
+,	mActiveJob( NULL )
+,	mpCodeBufferManager( NULL )
+,	mThread( kInvalidThreadHandle )
+,	mQuit( false )
+#endif
+{
+	memset( mCompletedJobs, 0, sizeof( mCompletedJobs ) );
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CFragmentCompiler::~CFragmentCompiler()
+{
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	if( mThread != kInvalidThreadHandle )
+	{
+		{
+			MutexLock lock( &mMutex );
+			mQuit = true;
+			CondSignal( mWorkCond );
+		}
+		JoinThread( mThread, -1 );
+		ReleaseThreadHandle( mThread );
+		mThread = kInvalidThreadHandle;
+	}
+#endif
+
+	CancelAll();
+
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	CondDestroy( mWorkCond );
+	CondDestroy( mIdleCond );
+#endif
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CFragmentCompiler::Assemble( CCodeBufferManager * p_manager, SFragmentCompileJob * job )
+{
+	MutexLock lock( &mCodeBufferLock );
+
+	job->Fragment = new CFragment( p_manager, job->EntryAddress, job->ExitAddress,
+		job->Trace, job->RegisterUsage, job->BranchDetails, job->NeedIndirectExitMap );
+}
+
+//*************************************************************************************
+//	The completed ring only ever has a single producer at a time (the worker,
+//	or the emulation thread when there is no worker or whilst holding mMutex).
+//	It can't overflow as every job in it is still counted in mNumOutstandingJobs.
+//*************************************************************************************
+void CFragmentCompiler::PushCompletedJob( SFragmentCompileJob * job )
+{
+	u32 head( mCompletedHead );
+#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( head - mCompletedTail < kMaxJobs, "Completed job ring overflow" );
+#endif
+	mCompletedJobs[ head % kMaxJobs ] = job;
+
+	AtomicMemoryBarrier();		// Make sure the slot is visible before the new head
+	mCompletedHead = head + 1;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+SFragmentCompileJob * CFragmentCompiler::PopCompletedJob()
+{
+	u32 tail( mCompletedTail );
+	if( tail == mCompletedHead )
+		return NULL;
+
+	AtomicMemoryBarrier();		// Don't read the slot before we've seen the new head
+
+	SFragmentCompileJob * job( mCompletedJobs[ tail % kMaxJobs ] );
+	mCompletedTail = tail + 1;
+
+	--mNumOutstandingJobs;
+	return job;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CFragmentCompiler::QueueJob( CCodeBufferManager * p_manager, SFragmentCompileJob * job )
+{
+	if( mNumOutstandingJobs >= kMaxJobs )
+		return false;
+
+	++mNumOutstandingJobs;
+
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	if( mThread != kInvalidThreadHandle || StartThread() )
+	{
+		MutexLock lock( &mMutex );
+		mpCodeBufferManager = p_manager;
+		mPendingJobs.push_back( job );
+		CondSignal( mWorkCond );
+		return true;
+	}
+#endif
+
+	// No worker - assemble it right away
+	Assemble( p_manager, job );
+	PushCompletedJob( job );
+	return true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CFragmentCompiler::CancelRange( u32 address, u32 length )
+{
+	if( mNumOutstandingJobs == 0 )
+		return;
+
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	MutexLock lock( &mMutex );
+
+	for( std::deque< SFragmentCompileJob * >::iterator it = mPendingJobs.begin(); it != mPendingJobs.end(); ++it )
+	{
+		if( (*it)->Overlaps( address, length ) )
+		{
+			(*it)->Cancelled = true;
+		}
+	}
+
+	if( mActiveJob != NULL && mActiveJob->Overlaps( address, length ) )
+	{
+		mActiveJob->Cancelled = true;
+	}
+#endif
+
+	// Jobs which are finished but haven't been picked up yet
+	u32 head( mCompletedHead );
+	AtomicMemoryBarrier();
+
+	for( u32 i = mCompletedTail; i != head; ++i )
+	{
+		SFragmentCompileJob * job( mCompletedJobs[ i % kMaxJobs ] );
+		if( job->Overlaps( address, length ) )
+		{
+			job->Cancelled = true;
+		}
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CFragmentCompiler::CancelAll()
+{
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	{
+		MutexLock lock( &mMutex );
+
+		while( !mPendingJobs.empty() )
+		{
+			SFragmentCompileJob * job( mPendingJobs.front() );
+			mPendingJobs.pop_front();
+
+			job->Cancelled = true;
+			PushCompletedJob( job );
+		}
+
+		// Wait for the worker to finish with the code buffer
+		if( mActiveJob != NULL )
+		{
+			mActiveJob->Cancelled = true;
+			while( mActiveJob != NULL )
+			{
+				CondWait( mIdleCond, &mMutex, kTimeoutInfinity );
+			}
+		}
+	}
+#endif
+
+	while( SFragmentCompileJob * job = PopCompletedJob() )
+	{
+		delete job->Fragment;
+		delete job;
+	}
+
+#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( mNumOutstandingJobs == 0, "Lost track of %d jobs", mNumOutstandingJobs );
+#endif
+}
+
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CFragmentCompiler::StartThread()
+{
+	mQuit = false;
+	mThread = CreateThread( "FragmentCompiler", CompileThread, this );
+	return mThread != kInvalidThreadHandle;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 DAEDALUS_THREAD_CALL_TYPE CFragmentCompiler::CompileThread( void * arg )
+{
+	CFragmentCompiler * compiler( static_cast< CFragmentCompiler * >( arg ) );
+	compiler->Run();
+	return 0;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CFragmentCompiler::Run()
+{
+	MutexLock lock( &mMutex );
+
+	while( !mQuit )
+	{
+		if( mPendingJobs.empty() )
+		{
+			CondWait( mWorkCond, &mMutex, kTimeoutInfinity );
+			continue;
+		}
+
+		SFragmentCompileJob * job( mPendingJobs.front() );
+		mPendingJobs.pop_front();
+		mActiveJob = job;
+
+		if( !job->Cancelled )
+		{
+			CCodeBufferManager * p_manager( mpCodeBufferManager );
+
+			mMutex.Unlock();
+			Assemble( p_manager, job );
+			mMutex.Lock();
+		}
+
+		mActiveJob = NULL;
+		PushCompletedJob( job );
+		CondSignal( mIdleCond );
+	}
+}
+#endif // DAEDALUS_ENABLE_BACKGROUND_COMPILE
@@ -0,0 +1,140 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef DYNAREC_FRAGMENTCOMPILER_H_
+#define DYNAREC_FRAGMENTCOMPILER_H_
+
+#include <deque>
+#include <vector>
+
+#include "Trace.h"
+#include "RegisterSpan.h"
+
+#include "Utility/Mutex.h"
+#include "Utility/Thread.h"
+
+class CFragment;
+class CCodeBufferManager;
+struct Cond;
+
+//*************************************************************************************
+// Everything needed to assemble a fragment, copied out of the trace recorder
+// so that it stays immutable while the fragment is being built.
+//*************************************************************************************
+struct SFragmentCompileJob
+{
+	SFragmentCompileJob()
+		:	EntryAddress( 0 )
+		,	ExitAddress( 0 )
+		,	NeedIndirectExitMap( false )
+		,	SpanStart( 0 )
+		,	SpanEnd( 0 )
+		,	Cancelled( false )
+		,	Fragment( NULL )
+	{
+	}
+
+	void					UpdateSpan();
+	bool					Overlaps( u32 address, u32 length ) const	{ return address < SpanEnd && address + length > SpanStart; }
+
+	u32								EntryAddress;
+	u32								ExitAddress;
+	std::vector< STraceEntry >		Trace;
+	std::vector< SBranchDetails >	BranchDetails;
+	SRegisterUsageInfo				RegisterUsage;
+	bool							NeedIndirectExitMap;
+
+	u32								SpanStart;			// Lowest/highest (exclusive) address of the ops in the trace
+	u32								SpanEnd;
+
+	volatile bool					Cancelled;			// Set by the emulation thread, the result is thrown away
+	CFragment *						Fragment;			// Set once assembled
+};
+
+//*************************************************************************************
+// Assembles fragments for the dynarec.
+//
+// When DAEDALUS_ENABLE_BACKGROUND_COMPILE is defined, jobs are assembled on a
+// worker thread while the emulation thread keeps interpreting. Finished jobs
+// are handed back through a single-producer/single-consumer ring and are
+// collected by the emulation thread with PopCompletedJob(). Otherwise jobs are
+// assembled immediately in QueueJob().
+//
+// Everything other than the worker itself must be called from the emulation
+// thread.
+//*************************************************************************************
+class CFragmentCompiler
+{
+public:
+	CFragmentCompiler();
+	~CFragmentCompiler();
+
+	static const u32		kMaxJobs = 64;			// Queued, in flight or waiting to be published
+
+	// Returns false if the queue is full, in which case the caller keeps ownership of the job
+	bool					QueueJob( CCodeBufferManager * p_manager, SFragmentCompileJob * job );
+
+	// Returns the next assembled (or cancelled) job, or NULL. The caller takes ownership.
+	SFragmentCompileJob *	PopCompletedJob();
+
+	// Mark any outstanding jobs covering this range as cancelled
+	void					CancelRange( u32 address, u32 length );
+
+	// Discard all outstanding jobs. On return the worker is no longer touching the code buffer.
+	void					CancelAll();
+
+	// Held whilst writing to the code buffer. Anything assembling fragments
+	// outside the compiler (e.g. the OS patches) must take this too.
+	Mutex &					GetCodeBufferLock()						{ return mCodeBufferLock; }
+
+	u32						GetNumOutstandingJobs() const			{ return mNumOutstandingJobs; }
+
+private:
+	void					Assemble( CCodeBufferManager * p_manager, SFragmentCompileJob * job );
+	void					PushCompletedJob( SFragmentCompileJob * job );
+
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	bool					StartThread();
+	static u32 DAEDALUS_THREAD_CALL_TYPE CompileThread( void * arg );
+	void					Run();
+#endif
+
+private:
+	Mutex							mCodeBufferLock;
+	u32								mNumOutstandingJobs;	// Only touched by the emulation thread
+
+	SFragmentCompileJob *			mCompletedJobs[ kMaxJobs ];
+	volatile u32					mCompletedHead;			// Written by the producer
+	volatile u32					mCompletedTail;			// Written by the emulation thread
+
+#ifdef DAEDALUS_ENABLE_BACKGROUND_COMPILE
+	Mutex							mMutex;					// Protects everything below
+	Cond *							mWorkCond;
+	Cond *							mIdleCond;
+	std::deque< SFragmentCompileJob * >	mPendingJobs;
+	SFragmentCompileJob *			mActiveJob;
+	CCodeBufferManager *			mpCodeBufferManager;
+	ThreadHandle					mThread;
+	bool							mQuit;
+#endif
+};
+
+extern CFragmentCompiler			gFragmentCompiler;
+
+#endif // DYNAREC_FRAGMENTCOMPILER_H_
@@ -0,0 +1,177 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "HotTraceTable.h"
+
+#include <string.h>
+
+// HashAddress() produces 12 bits
+DAEDALUS_STATIC_ASSERT( CHotTraceTable::kNumEntries == (1 << 12) );
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CHotTraceTable::CHotTraceTable( u32 sample_shift )
+:	mSize( 0 )
+,	mSampleShift( sample_shift )
+,	mSampleMask( ( 1 << sample_shift ) - 1 )
+,	mSampleSeed( 1 )
+{
+	memset( mEntries, 0, sizeof( mEntries ) );
+}
+
+//*************************************************************************************
+// Returns the slot holding address, or kNumEntries if it isn't in the table
+//*************************************************************************************
+u32 CHotTraceTable::FindSlot( u32 address ) const
+{
+	u32 slot( HashAddress( address ) );
+	while( mEntries[ slot ].Value != 0 )
+	{
+		if( mEntries[ slot ].Address == address )
+			return slot;
+
+		slot = ( slot + 1 ) & ( kNumEntries - 1 );
+	}
+
+	return kNumEntries;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 CHotTraceTable::Find( u32 address ) const
+{
+	u32 slot( FindSlot( address ) );
+	return slot < kNumEntries ? mEntries[ slot ].Value : 0;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CHotTraceTable::Set( u32 address, u32 value )
+{
+	if( value == 0 )
+	{
+		Remove( address );
+		return true;
+	}
+
+	u32 slot( HashAddress( address ) );
+	while( mEntries[ slot ].Value != 0 )
+	{
+		if( mEntries[ slot ].Address == address )
+		{
+			mEntries[ slot ].Value = value;
+			return true;
+		}
+
+		slot = ( slot + 1 ) & ( kNumEntries - 1 );
+	}
+
+	if( mSize >= kMaxSize )
+		return false;
+
+	mEntries[ slot ].Address = address;
+	mEntries[ slot ].Value = value;
+	++mSize;
+	return true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CHotTraceTable::Remove( u32 address )
+{
+	u32 slot( FindSlot( address ) );
+	if( slot < kNumEntries )
+	{
+		RemoveSlot( slot );
+	}
+}
+
+//*************************************************************************************
+// Backward shift deletion - pull later entries of the probe sequence into the
+// hole so that lookups never need tombstones.
+//*************************************************************************************
+void CHotTraceTable::RemoveSlot( u32 slot )
+{
+	u32 hole( slot );
+	u32 next( ( hole + 1 ) & ( kNumEntries - 1 ) );
+
+	while( mEntries[ next ].Value != 0 )
+	{
+		u32 home( HashAddress( mEntries[ next ].Address ) );
+
+		// Move the entry if the hole lies between its home slot and where it is now
+		if( ( ( next - home ) & ( kNumEntries - 1 ) ) >= ( ( next - hole ) & ( kNumEntries - 1 ) ) )
+		{
+			mEntries[ hole ] = mEntries[ next ];
+			hole = next;
+		}
+
+		next = ( next + 1 ) & ( kNumEntries - 1 );
+	}
+
+	mEntries[ hole ].Value = 0;
+	--mSize;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CHotTraceTable::Clear()
+{
+	memset( mEntries, 0, sizeof( mEntries ) );
+	mSize = 0;
+}
+
+//*************************************************************************************
+// Halve every counter, dropping those that reach zero
+//*************************************************************************************
+void CHotTraceTable::Decay()
+{
+	// Mark the entries to drop first. Removing an entry can shift later
+	// entries around, so halving and removing in one sweep could halve some
+	// entries twice.
+	const u32 DEAD_VALUE = u32( ~0 );
+
+	for( u32 i = 0; i < kNumEntries; ++i )
+	{
+		SEntry & entry( mEntries[ i ] );
+		if( entry.Value != 0 )
+		{
+			entry.Value >>= 1;
+			if( entry.Value == 0 )
+			{
+				entry.Value = DEAD_VALUE;
+			}
+		}
+	}
+
+	for( u32 i = 0; i < kNumEntries; ++i )
+	{
+		// An entry shifted into the hole may need dropping too
+		while( mEntries[ i ].Value == DEAD_VALUE )
+		{
+			RemoveSlot( i );
+		}
+	}
+}
@@ -0,0 +1,114 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef DYNAREC_HOTTRACETABLE_H_
+#define DYNAREC_HOTTRACETABLE_H_
+
+#include "Utility/Alignment.h"
+#include "Utility/DaedalusTypes.h"
+
+//*************************************************************************************
+// Fixed size table of per address counters, used to spot hot traces. The
+// interpreter bumps a counter on every taken backwards branch, so this is a
+// flat, linearly probed table rather than a std::map - no allocation when a
+// new address turns up and a lookup usually touches a single cache line.
+//
+// Rather than throwing every counter away when the table fills up, Decay()
+// halves them all and drops the ones that reach zero, so addresses that were
+// warming up keep some of their history.
+//
+// Optionally only a pseudo-random one in 1<<sample_shift calls to Increment()
+// is counted, which takes the table off the path for most branches. Callers
+// should scale their thresholds down to match.
+//*************************************************************************************
+class CHotTraceTable
+{
+public:
+	static const u32		kNumEntries = 4096;					// Must be a power of two
+	static const u32		kMaxSize = kNumEntries * 3 / 4;		// Keep probe sequences short
+
+	struct SEntry
+	{
+		u32		Address;
+		u32		Value;				// Zero for unused entries
+	};
+
+	explicit CHotTraceTable( u32 sample_shift = 0 );
+
+	// Returns the new count, or 0 if the call wasn't sampled (or the table is full)
+	inline u32				Increment( u32 address );
+
+	u32						Find( u32 address ) const;
+	bool					Set( u32 address, u32 value );		// Returns false if the table is full
+	void					Remove( u32 address );
+	void					Clear();
+	void					Decay();
+
+	u32						GetSize() const						{ return mSize; }
+	u32						GetSampleShift() const				{ return mSampleShift; }
+
+	// For walking the table. Unused entries have a Value of zero.
+	static u32				GetNumEntries()						{ return kNumEntries; }
+	const SEntry &			GetEntry( u32 i ) const				{ return mEntries[ i ]; }
+
+private:
+	static inline u32		HashAddress( u32 address )			{ return ( address * 0x9E3779B1 ) >> ( 32 - 12 ); }
+
+	u32						FindSlot( u32 address ) const;
+	void					RemoveSlot( u32 slot );
+
+private:
+	ALIGNED_MEMBER(SEntry, mEntries[ kNumEntries ], CACHE_ALIGN);
+	u32						mSize;
+	u32						mSampleShift;
+	u32						mSampleMask;
+	u32						mSampleSeed;
+};
+
+//*************************************************************************************
+//
+//*************************************************************************************
+inline u32 CHotTraceTable::Increment( u32 address )
+{
+	if( mSampleMask != 0 )
+	{
+		mSampleSeed = mSampleSeed * 1664525 + 1013904223;
+		if( ( mSampleSeed >> 16 ) & mSampleMask )
+			return 0;
+	}
+
+	u32 slot( HashAddress( address ) );
+	while( mEntries[ slot ].Value != 0 )
+	{
+		if( mEntries[ slot ].Address == address )
+			return ++mEntries[ slot ].Value;
+
+		slot = ( slot + 1 ) & ( kNumEntries - 1 );
+	}
+
+	if( mSize >= kMaxSize )
+		return 0;
+
+	mEntries[ slot ].Address = address;
+	mEntries[ slot ].Value = 1;
+	++mSize;
+	return 1;
+}
+
+#endif // DYNAREC_HOTTRACETABLE_H_
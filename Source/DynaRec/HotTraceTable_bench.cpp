@@ -0,0 +1,192 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Micro-benchmark for the hot trace counters looked up on every taken
+//	backwards branch while interpreting. Compares the std::map that Dynamo
+//	used to keep (cleared when it got too big) against CHotTraceTable, with
+//	and without sampling.
+//
+//	Usage: HotTraceTable_bench [hot_trace_lookups.bin]
+//
+//	The input is a stream of u32 branch target addresses, as written to
+//	DynarecDump/ when RECORD_HOT_TRACE_LOOKUPS is defined in Core/Dynamo.cpp.
+//	Without one, a synthetic stream of a few hot loops mixed in with colder
+//	code is used instead. Nothing is compiled here, so unlike in Dynamo the
+//	addresses that go hot are left in the counters.
+//
+
+#include "stdafx.h"
+#include "DynaRec/HotTraceTable.h"
+
+#include <stdio.h>
+
+#include <map>
+#include <vector>
+
+#include "Utility/Timing.h"
+
+namespace
+{
+	const u32	kMaxMapSize = 2048 + 1024;		// gMaxHotTraceMapSize
+	const u32	kThreshold = 10;				// gHotTraceThreshold
+	const u32	kNumRepeats = 20;
+
+	bool LoadStream( const char * filename, std::vector< u32 > & stream )
+	{
+		FILE * fp( fopen( filename, "rb" ) );
+		if( fp == NULL )
+			return false;
+
+		u32 address;
+		while( fread( &address, sizeof( address ), 1, fp ) == 1 )
+		{
+			stream.push_back( address );
+		}
+		fclose( fp );
+		return !stream.empty();
+	}
+
+	void MakeStream( std::vector< u32 > & stream )
+	{
+		u32 seed( 1 );
+		for( u32 i = 0; i < 4 * 1024 * 1024; ++i )
+		{
+			seed = seed * 1664525 + 1013904223;
+			u32 r( seed >> 8 );
+
+			if( ( r & 7 ) != 0 )
+			{
+				// Mostly a handful of tight loops
+				stream.push_back( 0x80000400 + ( ( r >> 3 ) & 63 ) * 0x40 );
+			}
+			else
+			{
+				// ...and the odd branch somewhere colder
+				stream.push_back( 0x80010000 + ( ( r >> 3 ) & 0xffff ) * 4 );
+			}
+		}
+	}
+
+	u64 Now()
+	{
+		u64 time;
+		NTiming::GetPreciseTime( &time );
+		return time;
+	}
+
+	u32 RunMap( const std::vector< u32 > & stream )
+	{
+		std::map< u32, u32 >	counts;
+		u32						hot( 0 );
+
+		for( std::vector< u32 >::const_iterator it = stream.begin(); it != stream.end(); ++it )
+		{
+			u32 count( ++counts[ *it ] );
+			if( counts.size() >= kMaxMapSize )
+			{
+				counts.clear();
+			}
+			else if( count == kThreshold )
+			{
+				++hot;
+			}
+		}
+		return hot;
+	}
+
+	u32 RunTable( CHotTraceTable & counts, const std::vector< u32 > & stream )
+	{
+		const u32	threshold( kThreshold >> counts.GetSampleShift() );
+		u32			hot( 0 );
+
+		counts.Clear();
+		for( std::vector< u32 >::const_iterator it = stream.begin(); it != stream.end(); ++it )
+		{
+			u32 count( counts.Increment( *it ) );
+			if( counts.GetSize() >= kMaxMapSize )
+			{
+				counts.Decay();
+			}
+			else if( count == threshold )
+			{
+				++hot;
+			}
+		}
+		return hot;
+	}
+
+	// Avoid putting 32KB on the stack
+	CHotTraceTable		gTable( 0 );
+	CHotTraceTable		gSampledTable( 2 );
+
+	void Report( const char * name, u64 ticks, u32 hot, u32 num_lookups )
+	{
+		u64 freq;
+		NTiming::GetPreciseFrequency( &freq );
+
+		double ns( double( ticks ) * 1000000000.0 / double( freq ) / double( num_lookups ) );
+		printf( "%-24s %8.2f ns/branch   %u traces went hot\n", name, ns, hot );
+	}
+}
+
+int main( int argc, char * argv[] )
+{
+	std::vector< u32 >	stream;
+	if( argc > 1 )
+	{
+		if( !LoadStream( argv[ 1 ], stream ) )
+		{
+			printf( "Couldn't read %s\n", argv[ 1 ] );
+			return 1;
+		}
+	}
+	else
+	{
+		MakeStream( stream );
+	}
+
+	printf( "%u branches, best of %u runs\n", u32( stream.size() ), kNumRepeats );
+
+	u64	best_map( ~0ULL ), best_table( ~0ULL ), best_sampled( ~0ULL );
+	u32	hot_map( 0 ), hot_table( 0 ), hot_sampled( 0 );
+
+	for( u32 i = 0; i < kNumRepeats; ++i )
+	{
+		u64 start( Now() );
+		hot_map = RunMap( stream );
+		u64 end( Now() );
+		if( end - start < best_map )		best_map = end - start;
+
+		start = Now();
+		hot_table = RunTable( gTable, stream );
+		end = Now();
+		if( end - start < best_table )		best_table = end - start;
+
+		start = Now();
+		hot_sampled = RunTable( gSampledTable, stream );
+		end = Now();
+		if( end - start < best_sampled )	best_sampled = end - start;
+	}
+
+	Report( "std::map", best_map, hot_map, stream.size() );
+	Report( "CHotTraceTable", best_table, hot_table, stream.size() );
+	Report( "CHotTraceTable (1 in 4)", best_sampled, hot_sampled, stream.size() );
+	return 0;
+}
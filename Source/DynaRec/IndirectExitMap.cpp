@@ -26,12 +26,44 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Debug/DBGConsole.h"
 
+SReturnStack		gReturnStack;
+
+namespace
+{
+	// Never word aligned, so it can't match an exit address
+	const u32			EMPTY_ADDRESS = 1;
+
+	SIndirectExitEntry	gNoReturn = { EMPTY_ADDRESS, NULL };
+
+	struct SResetReturnStack
+	{
+		SResetReturnStack()		{ IndirectExitMap_ResetReturnStack(); }
+	};
+	SResetReturnStack	gResetReturnStack;
+}
+
+//*************************************************************************************
+//	Must be called whenever fragments are deleted, as the stack points into them
+//*************************************************************************************
+void IndirectExitMap_ResetReturnStack()
+{
+	gReturnStack.Top = 0;
+	for( u32 i = 0; i < RETURN_STACK_SIZE; ++i )
+	{
+		gReturnStack.Entries[ i ] = &gNoReturn;
+	}
+}
+
 //*************************************************************************************
 //
 //*************************************************************************************
 CIndirectExitMap::CIndirectExitMap()
-:	mpCache( NULL )
+:	mIsReturn( 0 )
+,	mNextEntry( 0 )
+,	mSiteAddress( 0 )
+,	mpCache( NULL )
 {
+	Flush();
 }
 
 //*************************************************************************************
@@ -54,6 +86,74 @@ CFragment *	CIndirectExitMap::LookupIndirectExit( u32 exit_address )
 	return p;
 }
 
+//*************************************************************************************
+//	Mirrors the checks the code generators emit inline. Pops the return stack.
+//*************************************************************************************
+const void * CIndirectExitMap::LookupCached( u32 exit_address )
+{
+	if( mIsReturn )
+	{
+		const SIndirectExitEntry *	p_return( gReturnStack.Entries[ gReturnStack.Top & RETURN_STACK_MASK ] );
+		gReturnStack.Top--;
+		if( p_return->Address == exit_address && p_return->Target != NULL )
+		{
+			return p_return->Target;
+		}
+	}
+
+	for( u32 i = 0; i < NUM_ENTRIES; ++i )
+	{
+		if( mEntries[ i ].Address == exit_address )
+		{
+			return mEntries[ i ].Target;
+		}
+	}
+
+	return NULL;
+}
+
+//*************************************************************************************
+//	Called once the inline checks have failed. Also fills in the return stack
+//	entry which was just popped, if it was for this address.
+//*************************************************************************************
+const void * CIndirectExitMap::LookupAndCache( u32 exit_address )
+{
+	CFragment *	p_fragment( LookupIndirectExit( exit_address ) );
+	if( p_fragment == NULL )
+		return NULL;
+
+	const void *	target( p_fragment->GetEntryTarget().GetTarget() );
+
+	SIndirectExitEntry &	entry( mEntries[ mNextEntry ] );
+	entry.Address = exit_address;
+	entry.Target = target;
+	mNextEntry = ( mNextEntry + 1 ) % NUM_ENTRIES;
+
+	if( mIsReturn )
+	{
+		SIndirectExitEntry *	p_return( gReturnStack.Entries[ ( gReturnStack.Top + 1 ) & RETURN_STACK_MASK ] );
+		if( p_return->Address == exit_address )
+		{
+			p_return->Target = target;
+		}
+	}
+
+	return target;
+}
+
+//*************************************************************************************
+//	The targets may have been deleted
+//*************************************************************************************
+void CIndirectExitMap::Flush()
+{
+	for( u32 i = 0; i < NUM_ENTRIES; ++i )
+	{
+		mEntries[ i ].Address = EMPTY_ADDRESS;
+		mEntries[ i ].Target = NULL;
+	}
+	mNextEntry = 0;
+}
+
 //*************************************************************************************
 //
 //*************************************************************************************
@@ -62,13 +162,23 @@ extern "C"
 
 const void *	R4300_CALL_TYPE IndirectExitMap_Lookup( CIndirectExitMap * p_map, u32 exit_address )
 {
-	CFragment *	p_fragment( p_map->LookupIndirectExit( exit_address ) );
-	if( p_fragment != NULL )
+	const void *	target( p_map->LookupCached( exit_address ) );
+
+	DYNAREC_PROFILE_LOGINDIRECTEXIT( p_map->GetSiteAddress(), target != NULL );
+
+	if( target != NULL )
 	{
-		return p_fragment->GetEntryTarget().GetTarget();
+		return target;
 	}
 
-	return NULL;
+	return p_map->LookupAndCache( exit_address );
+}
+
+const void *	R4300_CALL_TYPE IndirectExitMap_LookupAndCache( CIndirectExitMap * p_map, u32 exit_address )
+{
+	DYNAREC_PROFILE_LOGINDIRECTEXIT( p_map->GetSiteAddress(), false );
+
+	return p_map->LookupAndCache( exit_address );
 }
 
 }
@@ -25,22 +25,82 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 class CFragment;
 class CFragmentCache;
 
+//
+//	A guest address and the host code compiled for it. Address is never
+//	word aligned while the entry is empty, so it can't match an exit pc.
+//
+struct SIndirectExitEntry
+{
+	u32					Address;
+	const void *		Target;
+};
+
+//
+//	Return address prediction. JAL pushes a pointer to an entry owned by the
+//	calling fragment (++Top, then store), JR RA pops it (load, then Top--).
+//	The entry is only used if its address matches, so pushes and pops don't
+//	have to balance.
+//
+#define RETURN_STACK_SIZE	16
+#define RETURN_STACK_MASK	(RETURN_STACK_SIZE - 1)
+
+struct SReturnStack
+{
+	u32						Top;
+	SIndirectExitEntry *	Entries[ RETURN_STACK_SIZE ];
+};
+extern SReturnStack			gReturnStack;
+
+void	IndirectExitMap_ResetReturnStack();
+
+//
+//	Each fragment with indirect exits (JR/JALR/ERET) owns one of these. The
+//	entries are checked inline by the generated code before falling back on a
+//	fragment cache lookup, which then refills them round robin.
+//
+//	Generated code relies on the layout: mEntries is at offset 0, followed by mIsReturn.
+//
 class CIndirectExitMap
 {
 	public:
+		enum { NUM_ENTRIES = 4 };
+
 		CIndirectExitMap();
 		~CIndirectExitMap();
 
 		CFragment *				LookupIndirectExit( u32 exit_address );
 		void					SetCache( const CFragmentCache * p_cache )				{ mpCache = p_cache; }
 
+		const void *			LookupCached( u32 exit_address );
+		const void *			LookupAndCache( u32 exit_address );
+		void					Flush();
+
+		// The exit is a JR RA, so consult gReturnStack first
+		void					SetIsReturn( bool is_return )							{ mIsReturn = is_return; }
+		bool					IsReturn() const										{ return mIsReturn != 0; }
+
+		void					SetSiteAddress( u32 address )							{ mSiteAddress = address; }
+		u32						GetSiteAddress() const									{ return mSiteAddress; }
+
+		const SIndirectExitEntry *	GetEntries() const									{ return mEntries; }
+		const u32 *				GetIsReturnPtr() const									{ return &mIsReturn; }
+
 	private:
+		SIndirectExitEntry		mEntries[ NUM_ENTRIES ];
+		u32						mIsReturn;
+		u32						mNextEntry;
+		u32						mSiteAddress;
 		const CFragmentCache *	mpCache;
 };
 
 //
-//	C-stub to allow easy access from dynarec code
+//	C-stubs to allow easy access from dynarec code. IndirectExitMap_Lookup checks
+//	the return stack and inline cache itself, for generators which don't inline them.
 //
-extern "C" { const void *	R4300_CALL_TYPE IndirectExitMap_Lookup( CIndirectExitMap * p_map, u32 exit_address ); }
+extern "C"
+{
+	const void *	R4300_CALL_TYPE IndirectExitMap_Lookup( CIndirectExitMap * p_map, u32 exit_address );
+	const void *	R4300_CALL_TYPE IndirectExitMap_LookupAndCache( CIndirectExitMap * p_map, u32 exit_address );
+}
 
 #endif // DYNAREC_INDIRECTEXITMAP_H_
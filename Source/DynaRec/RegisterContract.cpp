@@ -0,0 +1,141 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+#include "stdafx.h"
+#include "RegisterContract.h"
+
+#include "Core/R4300OpCode.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Partial loads merge into rt, but StaticAnalysis only records them as writing it
+	bool IsMergingLoad( OpCode op_code )
+	{
+		switch( op_code.op )
+		{
+		case OP_LWL:	case OP_LWR:
+		case OP_LDL:	case OP_LDR:
+			return true;
+		default:
+			return false;
+		}
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void SRegisterContract::Clear()
+{
+	std::fill( Slots, Slots + MAX_SLOTS, u8( N64Reg_R0 ) );
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool SRegisterContract::IsEmpty() const
+{
+	for( u32 i = 0; i < MAX_SLOTS; ++i )
+	{
+		if( Slots[ i ] != N64Reg_R0 )
+			return false;
+	}
+	return true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool SRegisterContract::IsSatisfiedBy( const SRegisterContract & held ) const
+{
+	for( u32 i = 0; i < MAX_SLOTS; ++i )
+	{
+		if( Slots[ i ] != N64Reg_R0 && Slots[ i ] != held.Slots[ i ] )
+			return false;
+	}
+	return true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 RegisterContract_GetLiveIn( const std::vector< STraceEntry > & trace )
+{
+	u32		live_in( 0 );
+	u32		written( 0 );
+
+	for( u32 i = 0; i < trace.size(); ++i )
+	{
+		const STraceEntry &						ti( trace[ i ] );
+		const StaticAnalysis::RegisterUsage &	usage( ti.Usage );
+
+		u32		reads( usage.RegReads | usage.RegBase );
+		if( IsMergingLoad( ti.OpCode ) )
+		{
+			reads |= 1 << ti.OpCode.rt;
+		}
+
+		live_in |= reads & ~written;
+		written |= usage.RegWrites;
+	}
+
+	return live_in & ~(1 << N64Reg_R0);
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void RegisterContract_AssignSlots( const u32 * scores, u32 num_slots, EN64Reg * slot_regs )
+{
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( num_slots <= SRegisterContract::MAX_SLOTS, "Too many slots" );
+	#endif
+
+	std::fill( slot_regs, slot_regs + num_slots, N64Reg_R0 );
+
+	u32		remaining[ NUM_N64_REGS ];
+	std::copy( scores, scores + NUM_N64_REGS, remaining );
+	remaining[ N64Reg_R0 ] = 0;
+
+	// Highest scores pick first, so they're the ones which get their preferred slot
+	for( u32 i = 0; i < num_slots; ++i )
+	{
+		u32		best( 0 );
+		for( u32 reg = 1; reg < NUM_N64_REGS; ++reg )
+		{
+			if( remaining[ reg ] > remaining[ best ] )
+			{
+				best = reg;
+			}
+		}
+
+		if( remaining[ best ] == 0 )
+			break;
+
+		remaining[ best ] = 0;
+
+		u32		slot( best % num_slots );
+		while( slot_regs[ slot ] != N64Reg_R0 )
+		{
+			slot = ( slot + 1 ) % num_slots;
+		}
+		slot_regs[ slot ] = EN64Reg( best );
+	}
+}
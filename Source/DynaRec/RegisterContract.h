@@ -0,0 +1,69 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+#ifndef DYNAREC_REGISTERCONTRACT_H_
+#define DYNAREC_REGISTERCONTRACT_H_
+
+#include "Core/N64Reg.h"
+#include "Trace.h"
+
+#include <vector>
+
+//*************************************************************************************
+// Which N64 register each host cache slot must hold when a fragment is
+// entered. A backend which keeps cached registers in the same host registers
+// across fragments publishes the contract for the registers it loads on
+// entry, along with a second entry point just past those loads. An exit from
+// a fragment which already holds everything the target needs, in the same
+// slots, can then be linked straight to that point with no spill or fill.
+//
+// Backends which flush their cache on exit publish an empty contract, and
+// their linked entry point is just the normal entry point. Only the x64
+// generator publishes a non empty contract at the moment. The PSP and PS2
+// generators invalidate cached registers around calls out of the fragment,
+// so what they hold at an exit isn't known when the fragment is linked.
+//*************************************************************************************
+struct SRegisterContract
+{
+	enum { MAX_SLOTS = 8 };
+
+	u8		Slots[ MAX_SLOTS ];		// N64Reg_R0 if the slot holds nothing
+
+	SRegisterContract()												{ Clear(); }
+
+	void	Clear();
+	bool	IsEmpty() const;
+
+	// True if every slot this contract needs is held the same way by 'held'
+	bool	IsSatisfiedBy( const SRegisterContract & held ) const;
+};
+
+//*************************************************************************************
+//
+//*************************************************************************************
+// Registers which are read by the trace before they are written, i.e. the
+// ones which have to be valid in the cache on entry
+u32		RegisterContract_GetLiveIn( const std::vector< STraceEntry > & trace );
+
+// Hands out up to num_slots host slots to the registers with the highest
+// (non zero) scores. Each register prefers slot (reg % num_slots), so
+// fragments caching the same registers tend to agree on where they live.
+// Fills slot_regs with the register given each slot, N64Reg_R0 if unused.
+void	RegisterContract_AssignSlots( const u32 * scores, u32 num_slots, EN64Reg * slot_regs );
+
+#endif // DYNAREC_REGISTERCONTRACT_H_
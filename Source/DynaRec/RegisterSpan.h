@@ -75,17 +75,20 @@ struct SRegisterUsageInfo
 	u32						RegistersRead;			// Bitmask of registers which are read from.
 	u32						RegistersWritten;
 	u32						RegistersAsBases;
+	u32						RegistersLiveIn;		// Read before being written, i.e. needed on entry
 
 	SRegisterUsageInfo()
 		:	RegistersRead( 0 )
 		,	RegistersWritten( 0 )
 		,	RegistersAsBases( 0 )
+		,	RegistersLiveIn( 0 )
 	{
 	}
 
 	inline bool IsRead( EN64Reg reg ) const			{ return (RegistersRead >> reg) & 1; }
 	inline bool IsModified( EN64Reg reg ) const		{ return (RegistersWritten >> reg) & 1; }
 	inline bool IsBase( EN64Reg reg ) const			{ return (RegistersAsBases >> reg) & 1; }
+	inline bool IsLiveIn( EN64Reg reg ) const		{ return (RegistersLiveIn >> reg) & 1; }
 };
 
 
@@ -1162,4 +1162,110 @@ void Analyse( OpCode op_code, RegisterUsage & reg_usage )
 	gStaticAnalysisInstruction[ op_code.op ]( op_code, reg_usage );
 }
 
+//*************************************************************************************
+// Used to spot idle loops. The unaligned loads are left out as they merge
+// with the old value of their destination, which RegisterUsage doesn't record.
+//*************************************************************************************
+bool IsSideEffectFree( OpCode op_code )
+{
+	switch( op_code.op )
+	{
+	case OP_SPECOP:
+		switch( op_code.spec_op )
+		{
+		case SpecOp_SLL:	case SpecOp_SRL:	case SpecOp_SRA:
+		case SpecOp_SLLV:	case SpecOp_SRLV:	case SpecOp_SRAV:
+		case SpecOp_MFHI:	case SpecOp_MFLO:
+		case SpecOp_DSLLV:	case SpecOp_DSRLV:	case SpecOp_DSRAV:
+		case SpecOp_ADDU:	case SpecOp_SUBU:
+		case SpecOp_AND:	case SpecOp_OR:		case SpecOp_XOR:	case SpecOp_NOR:
+		case SpecOp_SLT:	case SpecOp_SLTU:
+		case SpecOp_DADDU:	case SpecOp_DSUBU:
+		case SpecOp_DSLL:	case SpecOp_DSRL:	case SpecOp_DSRA:
+		case SpecOp_DSLL32:	case SpecOp_DSRL32:	case SpecOp_DSRA32:
+			return true;
+		default:
+			return false;
+		}
+
+	case OP_REGIMM:
+		switch( op_code.regimm_op )
+		{
+		case RegImmOp_BLTZ:	case RegImmOp_BGEZ:	case RegImmOp_BLTZL:	case RegImmOp_BGEZL:
+			return true;
+		default:
+			return false;
+		}
+
+	case OP_J:
+	case OP_BEQ:	case OP_BNE:	case OP_BLEZ:	case OP_BGTZ:
+	case OP_BEQL:	case OP_BNEL:	case OP_BLEZL:	case OP_BGTZL:
+	case OP_ADDIU:	case OP_DADDIU:
+	case OP_SLTI:	case OP_SLTIU:
+	case OP_ANDI:	case OP_ORI:	case OP_XORI:	case OP_LUI:
+	case OP_LB:		case OP_LBU:	case OP_LH:		case OP_LHU:
+	case OP_LW:		case OP_LWU:	case OP_LD:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+//*************************************************************************************
+// Conservative set of GPRs an interpreter handler may write. Analyse() doesn't
+// record usage for every op (LL/SC, traps etc), so RegWrites can't be relied
+// on for that.
+//*************************************************************************************
+u32 GetGPRWriteMask( OpCode op_code )
+{
+	switch( op_code.op )
+	{
+	case OP_SPECOP:
+		return 1 << op_code.rd;
+
+	case OP_REGIMM:
+		return 1 << N64Reg_RA;		// BLTZAL etc
+
+	case OP_J:
+	case OP_BEQ:	case OP_BNE:	case OP_BLEZ:	case OP_BGTZ:
+	case OP_BEQL:	case OP_BNEL:	case OP_BLEZL:	case OP_BGTZL:
+	case OP_SB:		case OP_SH:		case OP_SWL:	case OP_SW:
+	case OP_SDL:	case OP_SDR:	case OP_SWR:	case OP_SD:
+	case OP_CACHE:
+	case OP_LWC1:	case OP_LDC1:	case OP_SWC1:	case OP_SDC1:
+		return 0;
+
+	case OP_JAL:
+		return 1 << N64Reg_RA;
+
+	case OP_ADDI:	case OP_ADDIU:	case OP_SLTI:	case OP_SLTIU:
+	case OP_ANDI:	case OP_ORI:	case OP_XORI:	case OP_LUI:
+	case OP_DADDI:	case OP_DADDIU:	case OP_LDL:	case OP_LDR:
+	case OP_LB:		case OP_LH:		case OP_LWL:	case OP_LW:
+	case OP_LBU:	case OP_LHU:	case OP_LWR:	case OP_LWU:
+	case OP_LL:		case OP_LLD:	case OP_LD:
+	case OP_SC:		case OP_SCD:
+		return 1 << op_code.rt;
+
+	case OP_COPRO0:
+		return op_code.cop0_op == Cop0Op_MFC0 ? 1 << op_code.rt : 0;
+
+	case OP_COPRO1:
+		switch( op_code.cop1_op )
+		{
+		case Cop1Op_MFC1:
+		case Cop1Op_DMFC1:
+		case Cop1Op_CFC1:
+			return 1 << op_code.rt;
+		default:
+			return 0;
+		}
+
+	default:
+		// Patches and the various hack ops can do anything
+		return ~0;
+	}
+}
+
 }
@@ -127,6 +127,13 @@ namespace StaticAnalysis
 	};
 
 	void		Analyse( OpCode op_code, RegisterUsage & reg_usage );
+
+	// True for ops which only read memory or registers, compute or branch -
+	// no stores, no coprocessor, HI/LO or exception side effects.
+	bool		IsSideEffectFree( OpCode op_code );
+
+	// Every GPR an interpreter handler for the op might write. Over-reports rather than under.
+	u32			GetGPRWriteMask( OpCode op_code );
 }
 
 #endif // DYNAREC_STATICANALYSIS_H_
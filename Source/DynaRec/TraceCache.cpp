@@ -0,0 +1,435 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "TraceCache.h"
+#include "FragmentCompiler.h"
+#include "StaticAnalysis.h"
+#include "TraceRecorder.h"
+
+#include <stdio.h>
+
+#include "Config/ConfigOptions.h"
+#include "Core/Memory.h"
+#include "Core/ROM.h"
+#include "Debug/DBGConsole.h"
+#include "Debug/Dump.h"
+#include "Utility/Hash.h"
+#include "Utility/IO.h"
+
+CTraceCache							gTraceCache;
+
+namespace
+{
+	const u32 MAGIC_HEADER		= 0x43525444;		// 'DTRC'
+	const u32 FILE_VERSION		= 1;
+
+	const u32 MAX_STORED_TRACES	= 16384;
+	const u32 MAX_TRACE_OPS		= 4096;
+	const u32 INVALID_IDX		= u32( ~0 );
+
+	//
+	//	The file is a header followed by NumTraces records, each followed by
+	//	its ops and branches. Everything is stored in host byte order, as with
+	//	the OS HLE cache.
+	//
+	struct STraceCacheHeader
+	{
+		u32		Magic;
+		u32		Version;
+		u32		CRC[2];
+		u32		CountryID;
+		u32		OSHooksEnabled;
+		u32		NumTraces;
+	};
+
+	struct STraceRecord
+	{
+		u32		EntryAddress;
+		u32		ExitAddress;
+		u32		NumOps;
+		u32		NumBranches;
+		u32		NeedIndirectExitMap;
+		u32		SourceHash;
+	};
+
+	enum
+	{
+		OPF_BRANCH_DELAY_SLOT	= 1<<0,
+		OPF_ACCESS_8000			= 1<<1,		// Depends on register contents when the trace was recorded
+	};
+
+	struct STraceOpRecord
+	{
+		u32		Address;
+		u32		OpCode;
+		u32		BranchIdx;
+		u32		Flags;
+	};
+
+	enum
+	{
+		BRF_CONDITIONAL_TAKEN	= 1<<0,
+		BRF_LIKELY				= 1<<1,
+		BRF_DIRECT				= 1<<2,
+		BRF_ERET				= 1<<3,
+	};
+
+	struct SBranchRecord
+	{
+		u32		TargetAddress;
+		s32		DelaySlotTraceIndex;
+		u32		Flags;
+		u32		SpeedHack;
+	};
+
+	void MakeHeader( STraceCacheHeader * header, u32 num_traces )
+	{
+		header->Magic = MAGIC_HEADER;
+		header->Version = FILE_VERSION;
+		header->CRC[0] = g_ROM.mRomID.CRC[0];
+		header->CRC[1] = g_ROM.mRomID.CRC[1];
+		header->CountryID = g_ROM.mRomID.CountryID;
+		header->OSHooksEnabled = gOSHooksEnabled;
+		header->NumTraces = num_traces;
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CTraceCache::CTraceCache()
+:	mNumUnrestored( 0 )
+,	mDirty( false )
+{
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::GetFilename( char * filename ) const
+{
+	Dump_GetSaveDirectory( filename, g_ROM.mFileName, ".dyn" );
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 CTraceCache::HashTrace( const std::vector< STraceEntry > & trace )
+{
+	u32 hash( 0 );
+	for( std::vector< STraceEntry >::const_iterator it = trace.begin(); it != trace.end(); ++it )
+	{
+		u32 words[2] = { it->Address, it->OpCode._u32 };
+		hash = murmur2_neutral_hash( words, sizeof( words ), hash );
+	}
+	return hash;
+}
+
+//*************************************************************************************
+// Only traces in directly mapped memory are restored - anything going through
+// the TLB may be mapped differently this time around.
+//*************************************************************************************
+bool CTraceCache::MatchesMemory( const std::vector< STraceEntry > & trace )
+{
+	for( std::vector< STraceEntry >::const_iterator it = trace.begin(); it != trace.end(); ++it )
+	{
+		const MemFuncRead & m( g_MemoryLookupTableRead[ it->Address >> 18 ] );
+		if( m.pRead == NULL )
+			return false;
+
+		if( *(const u32 *)( m.pRead + it->Address ) != it->OpCode._u32 )
+			return false;
+	}
+
+	return true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::Open()
+{
+	mTraces.clear();
+	mNumUnrestored = 0;
+	mDirty = false;
+
+	if( Load() )
+	{
+		mNumUnrestored = mTraces.size();
+#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Loaded %d stored dynarec traces", mNumUnrestored );
+#endif
+	}
+	else
+	{
+		mTraces.clear();
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::Close()
+{
+	if( mDirty )
+	{
+		Save();
+	}
+
+	mTraces.clear();
+	mNumUnrestored = 0;
+	mDirty = false;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CTraceCache::Load()
+{
+	IO::Filename name;
+	GetFilename( name );
+
+	FILE * fp( fopen( name, "rb" ) );
+	if( fp == NULL )
+		return false;
+
+	STraceCacheHeader	header;
+	STraceCacheHeader	expected;
+	MakeHeader( &expected, 0 );
+
+	if( fread( &header, sizeof( header ), 1, fp ) != 1 ||
+		header.Magic != expected.Magic || header.Version != expected.Version ||
+		header.CRC[0] != expected.CRC[0] || header.CRC[1] != expected.CRC[1] ||
+		header.CountryID != expected.CountryID || header.OSHooksEnabled != expected.OSHooksEnabled ||
+		header.NumTraces > MAX_STORED_TRACES )
+	{
+		fclose( fp );
+		return false;
+	}
+
+	for( u32 i = 0; i < header.NumTraces; ++i )
+	{
+		STraceRecord	record;
+		if( fread( &record, sizeof( record ), 1, fp ) != 1 ||
+			record.NumOps == 0 || record.NumOps > MAX_TRACE_OPS || record.NumBranches > record.NumOps )
+		{
+			fclose( fp );
+			return false;
+		}
+
+		SStoredTrace &	stored( mTraces[ record.EntryAddress ] );
+		stored.ExitAddress = record.ExitAddress;
+		stored.NeedIndirectExitMap = record.NeedIndirectExitMap != 0;
+		stored.Trace.resize( record.NumOps );
+		stored.BranchDetails.resize( record.NumBranches );
+
+		for( u32 j = 0; j < record.NumOps; ++j )
+		{
+			STraceOpRecord	op;
+			if( fread( &op, sizeof( op ), 1, fp ) != 1 ||
+				(op.BranchIdx != INVALID_IDX && op.BranchIdx >= record.NumBranches) )
+			{
+				fclose( fp );
+				return false;
+			}
+
+			STraceEntry &	entry( stored.Trace[ j ] );
+			entry.Address = op.Address;
+			entry.OpCode._u32 = op.OpCode;
+			entry.BranchIdx = op.BranchIdx;
+			entry.BranchDelaySlot = (op.Flags & OPF_BRANCH_DELAY_SLOT) != 0;
+
+			StaticAnalysis::Analyse( entry.OpCode, entry.Usage );
+			entry.Usage.Access8000 = (op.Flags & OPF_ACCESS_8000) != 0;
+		}
+
+		for( u32 j = 0; j < record.NumBranches; ++j )
+		{
+			SBranchRecord	branch;
+			if( fread( &branch, sizeof( branch ), 1, fp ) != 1 ||
+				(branch.DelaySlotTraceIndex != -1 && (branch.DelaySlotTraceIndex < 0 || u32( branch.DelaySlotTraceIndex ) >= record.NumOps)) )
+			{
+				fclose( fp );
+				return false;
+			}
+
+			SBranchDetails &	details( stored.BranchDetails[ j ] );
+			details.TargetAddress = branch.TargetAddress;
+			details.DelaySlotTraceIndex = branch.DelaySlotTraceIndex;
+			details.ConditionalBranchTaken = (branch.Flags & BRF_CONDITIONAL_TAKEN) != 0;
+			details.Likely = (branch.Flags & BRF_LIKELY) != 0;
+			details.Direct = (branch.Flags & BRF_DIRECT) != 0;
+			details.Eret = (branch.Flags & BRF_ERET) != 0;
+			details.SpeedHack = SpeedHackProbe( branch.SpeedHack );
+		}
+
+		if( HashTrace( stored.Trace ) != record.SourceHash )
+		{
+			fclose( fp );
+			return false;
+		}
+	}
+
+	fclose( fp );
+	return true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::Save() const
+{
+	IO::Filename name;
+	GetFilename( name );
+
+#ifdef DAEDALUS_DEBUG_CONSOLE
+	DBGConsole_Msg( 0, "Writing %d dynarec traces to %s", u32( mTraces.size() ), name );
+#endif
+	// Write to a temporary file and rename it into place, so that a crash or a
+	// full disk never leaves a truncated cache behind
+	IO::Filename temp_name;
+	snprintf( temp_name, sizeof( temp_name ), "%s.tmp", name );
+
+	FILE * fp( fopen( temp_name, "wb" ) );
+	if( fp == NULL )
+		return;
+
+	bool	ok( true );
+
+	STraceCacheHeader	header;
+	MakeHeader( &header, mTraces.size() );
+	ok = ok && fwrite( &header, sizeof( header ), 1, fp ) == 1;
+
+	for( TraceMap::const_iterator it = mTraces.begin(); it != mTraces.end(); ++it )
+	{
+		const SStoredTrace &	stored( it->second );
+
+		STraceRecord	record;
+		record.EntryAddress = it->first;
+		record.ExitAddress = stored.ExitAddress;
+		record.NumOps = stored.Trace.size();
+		record.NumBranches = stored.BranchDetails.size();
+		record.NeedIndirectExitMap = stored.NeedIndirectExitMap;
+		record.SourceHash = HashTrace( stored.Trace );
+		ok = ok && fwrite( &record, sizeof( record ), 1, fp ) == 1;
+
+		for( std::vector< STraceEntry >::const_iterator op_it = stored.Trace.begin(); op_it != stored.Trace.end(); ++op_it )
+		{
+			STraceOpRecord	op;
+			op.Address = op_it->Address;
+			op.OpCode = op_it->OpCode._u32;
+			op.BranchIdx = op_it->BranchIdx;
+			op.Flags = (op_it->BranchDelaySlot ? OPF_BRANCH_DELAY_SLOT : 0) |
+					   (op_it->Usage.Access8000 ? OPF_ACCESS_8000 : 0);
+			ok = ok && fwrite( &op, sizeof( op ), 1, fp ) == 1;
+		}
+
+		for( std::vector< SBranchDetails >::const_iterator br_it = stored.BranchDetails.begin(); br_it != stored.BranchDetails.end(); ++br_it )
+		{
+			SBranchRecord	branch;
+			branch.TargetAddress = br_it->TargetAddress;
+			branch.DelaySlotTraceIndex = br_it->DelaySlotTraceIndex;
+			branch.Flags = (br_it->ConditionalBranchTaken ? BRF_CONDITIONAL_TAKEN : 0) |
+						   (br_it->Likely ? BRF_LIKELY : 0) |
+						   (br_it->Direct ? BRF_DIRECT : 0) |
+						   (br_it->Eret ? BRF_ERET : 0);
+			branch.SpeedHack = br_it->SpeedHack;
+			ok = ok && fwrite( &branch, sizeof( branch ), 1, fp ) == 1;
+		}
+	}
+
+	ok = (fclose( fp ) == 0) && ok;
+
+	if( ok && !IO::File::Move( temp_name, name ) )
+	{
+		// Not every platform's rename replaces an existing file
+		IO::File::Delete( name );
+		ok = IO::File::Move( temp_name, name );
+	}
+	if( !ok )
+	{
+#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Failed to write dynarec traces to %s", name );
+#endif
+		IO::File::Delete( temp_name );
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::Record( const SFragmentCompileJob & job )
+{
+	TraceMap::iterator	it( mTraces.find( job.EntryAddress ) );
+	if( it == mTraces.end() )
+	{
+		if( mTraces.size() >= MAX_STORED_TRACES || job.Trace.size() > MAX_TRACE_OPS )
+			return;
+
+		it = mTraces.insert( TraceMap::value_type( job.EntryAddress, SStoredTrace() ) ).first;
+	}
+	else if( !it->second.Restored )
+	{
+		--mNumUnrestored;
+	}
+
+	SStoredTrace &	stored( it->second );
+	stored.ExitAddress = job.ExitAddress;
+	stored.NeedIndirectExitMap = job.NeedIndirectExitMap;
+	stored.Restored = true;
+	stored.Trace = job.Trace;
+	stored.BranchDetails = job.BranchDetails;
+
+	mDirty = true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+SFragmentCompileJob * CTraceCache::Restore( u32 address )
+{
+	TraceMap::iterator	it( mTraces.find( address ) );
+	if( it == mTraces.end() || it->second.Restored )
+		return NULL;
+
+	SStoredTrace &	stored( it->second );
+	stored.Restored = true;
+	--mNumUnrestored;
+
+	if( !MatchesMemory( stored.Trace ) )
+	{
+		// The code has changed (or moved) since this was recorded
+		mTraces.erase( it );
+		mDirty = true;
+		return NULL;
+	}
+
+	SFragmentCompileJob *	job( new SFragmentCompileJob );
+	job->EntryAddress = address;
+	job->ExitAddress = stored.ExitAddress;
+	job->NeedIndirectExitMap = stored.NeedIndirectExitMap;
+	job->Trace = stored.Trace;
+	job->BranchDetails = stored.BranchDetails;
+	job->UpdateSpan();
+
+	CTraceRecorder::Analyse( job->Trace, job->RegisterUsage );
+
+	return job;
+}
@@ -0,0 +1,86 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef DYNAREC_TRACECACHE_H_
+#define DYNAREC_TRACECACHE_H_
+
+#include <map>
+#include <vector>
+
+#include "Trace.h"
+
+struct SFragmentCompileJob;
+
+//*************************************************************************************
+// Keeps the traces behind every fragment that made it into the fragment cache,
+// and saves them to a per-ROM file when the ROM is closed. On the next boot a
+// stored trace is handed straight to the compiler the first time its entry
+// address is reached, provided the code in memory still matches it. This
+// skips the hot trace warm up and the trace recording.
+//
+// The native code itself isn't stored - it's full of absolute addresses - so
+// fragments are still assembled on each boot, just without the interpreter
+// having to find them first.
+//*************************************************************************************
+class CTraceCache
+{
+public:
+	CTraceCache();
+
+	void					Open();						// Load the stored traces for the current ROM
+	void					Close();					// Write them back out and forget them
+
+	void					Record( const SFragmentCompileJob & job );
+
+	// Returns a job for the stored trace starting at address, or NULL if there isn't one
+	// or the code has changed since it was recorded. The caller takes ownership.
+	SFragmentCompileJob *	Restore( u32 address );
+
+	bool					HasStoredTraces() const			{ return mNumUnrestored > 0; }
+
+private:
+	struct SStoredTrace
+	{
+		SStoredTrace() : ExitAddress( 0 ), NeedIndirectExitMap( false ), Restored( false ) {}
+
+		u32								ExitAddress;
+		bool							NeedIndirectExitMap;
+		bool							Restored;			// Already handed back (or recorded) this session
+		std::vector< STraceEntry >		Trace;
+		std::vector< SBranchDetails >	BranchDetails;
+	};
+
+	typedef std::map< u32, SStoredTrace >	TraceMap;
+
+	static u32				HashTrace( const std::vector< STraceEntry > & trace );
+	static bool				MatchesMemory( const std::vector< STraceEntry > & trace );
+
+	void					GetFilename( char * filename ) const;
+	bool					Load();
+	void					Save() const;
+
+private:
+	TraceMap				mTraces;					// Keyed on entry address
+	u32						mNumUnrestored;
+	bool					mDirty;
+};
+
+extern CTraceCache			gTraceCache;
+
+#endif // DYNAREC_TRACECACHE_H_
@@ -19,9 +19,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "stdafx.h"
 #include "TraceRecorder.h"
+
+#include <string.h>
+
 #include "Fragment.h"
 #include "BranchType.h"
+#include "FragmentCompiler.h"
+#include "RegisterContract.h"
 
+#include "Config/ConfigOptions.h"
 #include "Core/CPU.h"			// For dubious use of PC/NewPC
 #include "Core/Registers.h"
 
@@ -36,8 +42,9 @@ namespace
 {
 	const u32 INVALID_IDX = u32( ~0 );
 	const u32 INDIRECT_EXIT_ADDRESS = u32( ~0 );
+	const u32 NO_INLINE_CALL = u32( ~0 );
 
-	const u32 MAX_TRACE_LENGTH = 1500;
+	const s32 BRANCH_BIAS_THRESHOLD = 4;		// How far one direction has to be ahead before a branch counts as biased
 }
 CTraceRecorder				gTraceRecorder;
 
@@ -51,7 +58,25 @@ CTraceRecorder::CTraceRecorder()
 ,	mActiveBranchIdx( INVALID_IDX )
 ,	mStopTraceAfterDelaySlot( false )
 ,	mNeedIndirectExitMap( false )
+,	mInlineReturnAddress( NO_INLINE_CALL )
+,	mInlineStartLength( 0 )
+{
+	memset( mBranchCounters, 0, sizeof( mBranchCounters ) );
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CTraceRecorder::EBranchBias	CTraceRecorder::GetBranchBias( u32 address ) const
 {
+	s32		count( mBranchCounters[ GetBranchCounterIdx( address ) ] );
+
+	if( count >= BRANCH_BIAS_THRESHOLD )
+		return BB_TAKEN;
+	if( count <= -BRANCH_BIAS_THRESHOLD )
+		return BB_NOT_TAKEN;
+
+	return BB_UNKNOWN;
 }
 
 //*************************************************************************************
@@ -73,6 +98,7 @@ void	CTraceRecorder::StartTrace( u32 address )
 	mActiveBranchIdx = INVALID_IDX;
 	mStopTraceAfterDelaySlot = false;
 	mExpectedExitTraceAddress = address + 4;
+	mInlineReturnAddress = NO_INLINE_CALL;
 }
 
 //*************************************************************************************
@@ -90,7 +116,7 @@ CTraceRecorder::EUpdateTraceStatus	CTraceRecorder::UpdateTrace( u32 address,
 
 	bool				want_to_stop( p_fragment != NULL );
 
-	if( mTraceBuffer.size() > MAX_TRACE_LENGTH )
+	if( mTraceBuffer.size() > gDynarecMaxTraceLength )
 	{
 		#ifdef DAEDALUS_DEBUG_CONSOLE
 		DBGConsole_Msg(0, "Hit max trace size!");
@@ -151,6 +177,12 @@ CTraceRecorder::EUpdateTraceStatus	CTraceRecorder::UpdateTrace( u32 address,
 		stop_trace_on_exit = true;
 	}
 
+	// Only small callees are followed all the way back to the caller
+	if( mInlineReturnAddress != NO_INLINE_CALL && mTraceBuffer.size() - mInlineStartLength > gDynarecMaxInlineLength )
+	{
+		mInlineReturnAddress = NO_INLINE_CALL;
+	}
+
 	//
 	//	Update the expected trace exit address
 	//	We assume that if we'll exit on the next instruction (assuming this isn't a branch)
@@ -195,9 +227,33 @@ CTraceRecorder::EUpdateTraceStatus	CTraceRecorder::UpdateTrace( u32 address,
 
 			mExpectedExitTraceAddress = details.TargetAddress;
 
-			if (!details.Direct || gCPUState.TargetPC <= gCPUState.CurrentPC)
+			bool	follow( details.Direct && gCPUState.TargetPC > gCPUState.CurrentPC );
+
+			if( branch_type == BT_JAL || branch_type == BT_JALR )
+			{
+				if( branch_type == BT_JAL && mInlineReturnAddress == NO_INLINE_CALL && gDynarecMaxInlineLength > 0 )
+				{
+					// Follow the call wherever it is, hoping it's a small leaf we can return from
+					mInlineReturnAddress = address + 8;
+					mInlineStartLength = mTraceBuffer.size();
+					follow = true;
+				}
+				else
+				{
+					// The callee makes calls of its own, so it isn't a leaf
+					mInlineReturnAddress = NO_INLINE_CALL;
+				}
+			}
+			else if( branch_type == BT_JR && op_code.rs == N64Reg_RA && gCPUState.TargetPC == mInlineReturnAddress )
+			{
+				// Back in the caller. The JR still checks its target and leaves through the indirect exit if it differs.
+				mInlineReturnAddress = NO_INLINE_CALL;
+				follow = true;
+			}
+
+			if( !follow )
 			{
-				// all indirect call will stop the trace
+				// all other indirect and backwards jumps stop the trace
 				mStopTraceAfterDelaySlot = true;
 			}
 
@@ -230,6 +286,15 @@ CTraceRecorder::EUpdateTraceStatus	CTraceRecorder::UpdateTrace( u32 address,
 				}
 			}
 
+			// If this run went the rarely used way, stop rather than fill the trace with cold code.
+			// The usual direction becomes a side exit which links up with its own fragment.
+			EBranchBias		bias( GetBranchBias( address ) );
+			if( !details.Likely && bias != BB_UNKNOWN && ( bias == BB_TAKEN ) != branch_taken )
+			{
+				mStopTraceAfterDelaySlot = true;
+			}
+			RecordBranchDirection( address, branch_taken );
+
 			u32		branch_target_address( GetBranchTarget( address, op_code, branch_type ) );
 			u32		fallthrough_address( address + 8 );
 
@@ -295,19 +360,24 @@ void	CTraceRecorder::StopTrace( u32 exit_address )
 //*************************************************************************************
 //
 //*************************************************************************************
-CFragment *		CTraceRecorder::CreateFragment( CCodeBufferManager * p_manager )
+void	CTraceRecorder::CreateCompileJob( SFragmentCompileJob * job )
 {
 	#ifdef DAEDALUS_ENABLE_PROFILING
-	DAEDALUS_PROFILE( "CTraceRecorder::CreateFragment" );
+	DAEDALUS_PROFILE( "CTraceRecorder::CreateCompileJob" );
 #endif
 #ifdef DAEDLAUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( !mTraceBuffer.empty(), "No trace ready for creation?" );
 #endif
-	SRegisterUsageInfo	register_usage;
-	Analyse( register_usage );
+	Analyse( mTraceBuffer, job->RegisterUsage );
 
-	CFragment *	p_frament( new CFragment( p_manager, mStartTraceAddress, mExpectedExitTraceAddress,
-		mTraceBuffer, register_usage, mBranchDetails, mNeedIndirectExitMap ) );
+	job->EntryAddress = mStartTraceAddress;
+	job->ExitAddress = mExpectedExitTraceAddress;
+	job->NeedIndirectExitMap = mNeedIndirectExitMap;
+
+	// The buffers are cleared below, so just take them
+	job->Trace.swap( mTraceBuffer );
+	job->BranchDetails.swap( mBranchDetails );
+	job->UpdateSpan();
 
 	//DBGConsole_Msg( 0, "Inserting hot trace for [R%08x]!", mStartTraceAddress );
 
@@ -319,8 +389,7 @@ CFragment *		CTraceRecorder::CreateFragment( CCodeBufferManager * p_manager )
 	mActiveBranchIdx = INVALID_IDX;
 	mStopTraceAfterDelaySlot = false;
 	mNeedIndirectExitMap = false;
-
-	return p_frament;
+	mInlineReturnAddress = NO_INLINE_CALL;
 }
 
 //*************************************************************************************
@@ -381,26 +450,80 @@ void	CTraceRecorder::AbortTrace()
 		mActiveBranchIdx = INVALID_IDX;
 		mStopTraceAfterDelaySlot = false;
 		mNeedIndirectExitMap = false;
+		mInlineReturnAddress = NO_INLINE_CALL;
+	}
+
+}
+
+//*************************************************************************************
+// A trace which loops back to its own entry is idle if it's short, has no side
+// effects and carries no register state from one iteration to the next - every
+// pass then reads the same registers and so can only leave the loop once
+// something external (an interrupt, DMA, another processor) changes memory.
+// Loads must hit RDRAM: polling a hardware register (0xA4xxxxxx) has side
+// effects and its value can change without an interrupt.
+//*************************************************************************************
+bool CTraceRecorder::IsIdleLoop( const std::vector< STraceEntry > & trace )
+{
+	const u32	MAX_IDLE_LOOP_OPS = 16;
+
+	if( trace.empty() || trace.size() > MAX_IDLE_LOOP_OPS )
+		return false;
+
+	u32		all_writes( 0 );
+	for( u32 i = 0; i < trace.size(); ++i )
+	{
+		if( !StaticAnalysis::IsSideEffectFree( trace[ i ].OpCode ) )
+			return false;
+
+		all_writes |= trace[ i ].Usage.RegWrites;
+	}
+	all_writes &= ~1u;		// r0 is never carried
+
+	// Any register read before this iteration writes it must come from the last iteration.
+	// Registers derived from loaded values are tracked too, as a load through one of
+	// those could go anywhere once memory changes.
+	u32		written( 0 );
+	u32		from_memory( 0 );
+	for( u32 i = 0; i < trace.size(); ++i )
+	{
+		const StaticAnalysis::RegisterUsage &	usage( trace[ i ].Usage );
+
+		if( ( usage.RegReads | usage.RegBase ) & all_writes & ~written )
+			return false;
+
+		// Of the side effect free ops, only the loads have a base register
+		bool	is_load( usage.RegBase != 0 );
+		if( is_load && ( !usage.Access8000 || ( usage.RegBase & from_memory ) ) )
+			return false;
+
+		if( is_load || ( usage.RegReads & from_memory ) )
+			from_memory |= usage.RegWrites;
+		else
+			from_memory &= ~usage.RegWrites;
+
+		written |= usage.RegWrites;
 	}
 
+	return true;
 }
 
 //*************************************************************************************
 //
 //*************************************************************************************
-void CTraceRecorder::Analyse( SRegisterUsageInfo & register_usage )
+void CTraceRecorder::Analyse( const std::vector< STraceEntry > & trace, SRegisterUsageInfo & register_usage )
 {
 	#ifdef DAEDALUS_ENABLE_PROFILING
 	DAEDALUS_PROFILE( "CTraceRecorder::Analyse" );
 #endif
 	std::pair< s32, s32 >		reg_spans[ NUM_N64_REGS ];
-	std::pair< s32, s32 >		invalid_span( std::pair< s32, s32 >( mTraceBuffer.size(), -1 ) );
+	std::pair< s32, s32 >		invalid_span( std::pair< s32, s32 >( trace.size(), -1 ) );
 
 	std::fill( reg_spans, reg_spans + NUM_N64_REGS, invalid_span );		// Set the interval to an invalid range
 
-	for( u32 i = 0; i < mTraceBuffer.size(); ++i )
+	for( u32 i = 0; i < trace.size(); ++i )
 	{
-		const STraceEntry & ti( mTraceBuffer[ i ] );
+		const STraceEntry & ti( trace[ i ] );
 		const StaticAnalysis::RegisterUsage&	usage = ti.Usage;
 
 		register_usage.RegistersRead |= usage.RegReads;
@@ -420,6 +543,8 @@ void CTraceRecorder::Analyse( SRegisterUsageInfo & register_usage )
 		}
 	}
 
+	register_usage.RegistersLiveIn = RegisterContract_GetLiveIn( trace );
+
 	register_usage.SpanList.clear();
 	register_usage.SpanList.reserve( NUM_N64_REGS );
 
@@ -29,7 +29,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 
 class CFragment;
-class CCodeBufferManager;
+struct SFragmentCompileJob;
 
 class CTraceRecorder
 {
@@ -47,13 +47,34 @@ public:
 
 	EUpdateTraceStatus	UpdateTrace( u32 address, bool branch_delay_slot, bool branch_taken, OpCode op_code, CFragment * p_fragment );
 	void				StopTrace( u32 exit_address );
-	CFragment *			CreateFragment( CCodeBufferManager * p_manager );
+	void				CreateCompileJob( SFragmentCompileJob * job );
 	void				AbortTrace();
 
 	bool				IsTraceActive() const						{ return mTracing; }
 
+	// The interpreter reports which way each conditional branch goes, so that
+	// traces aren't extended down the rarely used side of a biased branch
+	inline void			RecordBranchDirection( u32 address, bool taken );
+
 	u32					GetStartTraceAddress() const				{ DAEDALUS_ASSERT_Q( mTracing ); return mStartTraceAddress; }
 
+	static void			Analyse( const std::vector< STraceEntry > & trace, SRegisterUsageInfo & register_usage );
+	static bool			IsIdleLoop( const std::vector< STraceEntry > & trace );
+
+private:
+	enum EBranchBias
+	{
+		BB_UNKNOWN,
+		BB_TAKEN,
+		BB_NOT_TAKEN,
+	};
+
+	EBranchBias			GetBranchBias( u32 address ) const;
+
+	static const u32	kNumBranchCounters = 4096;			// Must be a power of two
+	static const s32	kMaxBranchCount = 32;				// Saturate so that the bias can change
+	static inline u32	GetBranchCounterIdx( u32 address )	{ return ( address >> 2 ) & ( kNumBranchCounters - 1 ); }
+
 private:
 	bool							mTracing;
 	u32								mStartTraceAddress;
@@ -66,8 +87,31 @@ private:
 	bool							mStopTraceAfterDelaySlot;
 	bool							mNeedIndirectExitMap;
 
-	void	Analyse(SRegisterUsageInfo & register_usage );
+	u32								mInlineReturnAddress;			// Where the leaf call being followed returns to
+	u32								mInlineStartLength;				// Trace length when the call was followed
+
+	// Direct mapped, so unrelated branches can share a counter. Positive counts are taken branches.
+	s8								mBranchCounters[ kNumBranchCounters ];
 };
 extern CTraceRecorder				gTraceRecorder;
 
+//*************************************************************************************
+//
+//*************************************************************************************
+inline void CTraceRecorder::RecordBranchDirection( u32 address, bool taken )
+{
+	s8 &	count( mBranchCounters[ GetBranchCounterIdx( address ) ] );
+
+	if( taken )
+	{
+		if( count < kMaxBranchCount )
+			++count;
+	}
+	else
+	{
+		if( count > -kMaxBranchCount )
+			--count;
+	}
+}
+
 #endif // DYNAREC_TRACERECORDER_H_
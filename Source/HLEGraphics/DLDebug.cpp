@@ -422,22 +422,22 @@ void DLDebug_DumpTaskInfo( const OSTask * pTask )
 {
 	DL_PF( "Task:         %08x",      pTask->t.type  );
 	DL_PF( "Flags:        %08x",      pTask->t.flags  );
-	DL_PF( "BootCode:     %08x", (u32)pTask->t.ucode_boot  );
+	DL_PF( "BootCode:     %08x", pTask->t.ucode_boot  );
 	DL_PF( "BootCodeSize: %08x",      pTask->t.ucode_boot_size  );
 
-	DL_PF( "uCode:        %08x", (u32)pTask->t.ucode );
+	DL_PF( "uCode:        %08x", pTask->t.ucode );
 	DL_PF( "uCodeSize:    %08x",      pTask->t.ucode_size );
-	DL_PF( "uCodeData:    %08x", (u32)pTask->t.ucode_data );
+	DL_PF( "uCodeData:    %08x", pTask->t.ucode_data );
 	DL_PF( "uCodeDataSize:%08x",      pTask->t.ucode_data_size );
 
-	DL_PF( "Stack:        %08x", (u32)pTask->t.dram_stack );
+	DL_PF( "Stack:        %08x", pTask->t.dram_stack );
 	DL_PF( "StackS:       %08x",      pTask->t.dram_stack_size );
-	DL_PF( "Output:       %08x", (u32)pTask->t.output_buff );
-	DL_PF( "OutputS:      %08x", (u32)pTask->t.output_buff_size );
+	DL_PF( "Output:       %08x", pTask->t.output_buff );
+	DL_PF( "OutputS:      %08x", pTask->t.output_buff_size );
 
-	DL_PF( "Data( PC ):   %08x", (u32)pTask->t.data_ptr );
+	DL_PF( "Data( PC ):   %08x", pTask->t.data_ptr );
 	DL_PF( "DataSize:     %08x",      pTask->t.data_size );
-	DL_PF( "YieldData:    %08x", (u32)pTask->t.yield_data_ptr );
+	DL_PF( "YieldData:    %08x", pTask->t.yield_data_ptr );
 	DL_PF( "YieldDataSize:%08x",      pTask->t.yield_data_size );
 }
 
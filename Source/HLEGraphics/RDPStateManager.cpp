@@ -28,6 +28,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Math/MathUtil.h"
 #include "OSHLE/ultra_gbi.h"
 #include "Utility/Alignment.h"
+#include "Utility/ByteSwap.h"
 #include "Utility/Endian.h"
 #include "Utility/FastMemcpy.h"
 #include "Utility/Macros.h"
@@ -60,146 +61,39 @@ ALIGNED_GLOBAL(u8, gTMEM[ MAX_TMEM_ADDRESS ], 16);	// 4Kb
 // It should be safe to assume copies will always be in qwords
 #define FAST_TMEM_COPY
 
+// Odd lines have alternate words swapped (or alternate dwords for 32bpp),
+// which ByteSwap_CopyN64 applies as a twiddle on the TMEM address
 static inline void CopyLineQwords(void * dst, const void * src, u32 qwords)
 {
-#ifdef FAST_TMEM_COPY
-	u32* src32 = (u32*)src;
-	u32* dst32 = (u32*)dst;
 #ifdef DAEDALUS_ENABLE_ASSERTS
-	DAEDALUS_ASSERT( ((uintptr_t)src32&0x3)==0, "src is not aligned!");
-#endif
-	while(qwords--)
-	{
-		dst32[0] = BSWAP32(src32[0]);
-		dst32[1] = BSWAP32(src32[1]);
-		dst32 += 2;
-		src32 += 2;
-	}
-#else
-	u8* src8 = (u8*)src;
-	u8* dst8 = (u8*)dst;
-	u32 bytes = qwords * 8;
-	while(bytes--)
-	{
-		*dst8++ = *(u8*)((uintptr_t)src8++ ^ U8_TWIDDLE);
-	}
+	DAEDALUS_ASSERT( ((uintptr_t)src&0x3)==0, "src is not aligned!");
 #endif
+	ByteSwap_CopyN64(dst, src, qwords * 8, 0);
 }
 
 static void CopyLineQwordsSwap(void * dst, const void * src, u32 qwords)
 {
-#ifdef FAST_TMEM_COPY
-	u32* src32 = (u32*)src;
-	u32* dst32 = (u32*)dst;
 #ifdef DAEDALUS_ENABLE_ASSERTS
-	DAEDALUS_ASSERT( ((uintptr_t)src32&0x3 )==0, "src is not aligned!");
-#endif
-	while(qwords--)
-	{
-		dst32[1]  = BSWAP32(src32[0]);
-		dst32[0]  = BSWAP32(src32[1]);
-		dst32 += 2;
-		src32 += 2;
-	}
-#else
-	u8* src8 = (u8*)src;
-	u8* dst8 = (u8*)dst;
-	u32 bytes = qwords * 8;
-	while(bytes--)
-	{
-		*(u8*)((uintptr_t)dst8++ ^ 0x4)  = *(u8*)((uintptr_t)src8++ ^ U8_TWIDDLE);
-	}
+	DAEDALUS_ASSERT( ((uintptr_t)src&0x3 )==0, "src is not aligned!");
 #endif
+	ByteSwap_CopyN64(dst, src, qwords * 8, 0x4);
 }
 
 static void CopyLineQwordsSwap32(void * dst, const void * src, u32 qwords)
 {
-#ifdef FAST_TMEM_COPY
-	u32* src32 = (u32*)src;
-	u32* dst32 = (u32*)dst;
 #ifdef DAEDALUS_ENABLE_ASSERTS
-	DAEDALUS_ASSERT( ((uintptr_t)src32&0x3 )==0, "src is not aligned!");
-#endif
-	u32 size128 = qwords >>1;
-
-	while(size128--)
-	{
-		dst32[2]  = BSWAP32(src32[0]);
-		dst32[3]  = BSWAP32(src32[1]);
-		dst32[0]  = BSWAP32(src32[2]);
-		dst32[1]  = BSWAP32(src32[3]);
-		dst32 += 4;
-		src32 += 4;
-	}
-
-	// Copy any remaining quadword
-	qwords&=0x1;
-	while(qwords--)
-	{
-		*(u32*)((uintptr_t)dst32++ ^ 0x8) = BSWAP32(src32[0]);
-		*(u32*)((uintptr_t)dst32++ ^ 0x8) = BSWAP32(src32[1]);
-		src32+=2;
-	}
-#else
-
-	u8* src8 = (u8*)src;
-	u8* dst8 = (u8*)dst;
-	u32 bytes = qwords * 8;
-	while(bytes--)
-	{
-		*(u8*)((uintptr_t)dst8++ ^ 0x8)  = *(u8*)((uintptr_t)src8++ ^ U8_TWIDDLE);
-	}
+	DAEDALUS_ASSERT( ((uintptr_t)src&0x3 )==0, "src is not aligned!");
 #endif
+	ByteSwap_CopyN64(dst, src, qwords * 8, 0x8);
 }
 
+// Zelda and DK64 have unaligned copies, which the kernels handle too
 static inline void CopyLine(void * dst, const void * src, u32 bytes)
 {
-#ifdef FAST_TMEM_COPY
-	u32* src32 = (u32*)src;
-	u32* dst32 = (u32*)dst;
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT((bytes&0x3)==0, "CopyLine: Remaning bytes! (%d)",bytes);
 #endif
-	u32 size32 = bytes >> 2;
-	u32 src_alignment = (uintptr_t)src32&0x3;
-
-	if(src_alignment == 0)
-	{
-		while (size32--)
-		{
-			*dst32++ = BSWAP32(src32[0]);
-			src32++;
-		}
-	}
-	else
-	{
-		// Zelda and DK64 have unaligned copies. so let's optimize 'em
-		src32 = (u32*)((uintptr_t)src & ~0x3);
-		u32 src_tmp = *src32++;
-		u32 dst_tmp = 0;
-
-		// calculate offset 3..1..2
-		u32 offset = 4-src_alignment;
-		u32 lshift = src_alignment<<3;
-		u32 rshift = offset<<3;
-
-		while(size32--)
-		{
-			dst_tmp = src_tmp << lshift;
-			src_tmp = *src32++;
-			dst_tmp|= src_tmp >> rshift;
-			*dst32++ = BSWAP32(dst_tmp);
-		}
-		src32 -= offset;
-	}
-#else
-	u8* src8 = (u8*)src;
-	u8* dst8 = (u8*)dst;
-	while(bytes--)
-	{
-		*dst8++ = *(u8*)((uintptr_t)src8++ ^ U8_TWIDDLE);
-	}
-#endif
+	ByteSwap_CopyN64(dst, src, bytes, 0);
 }
 
 static inline void CopyLine16(u16 * dst16, const u16 * src16, u32 words)
@@ -227,89 +121,23 @@ static inline void CopyLine16(u16 * dst16, const u16 * src16, u32 words)
 	}
 }
 
+// Bomberman, Zelda, and Quest 64 have unaligned copies here
 static inline void CopyLineSwap(void * dst, const void * src, u32 bytes)
 {
-	u32* src32 = (u32*)src;
-	u32* dst32 = (u32*)dst;
-
-#ifdef FAST_TMEM_COPY
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT((bytes&0x7)==0, "CopyLineSwap: Remaning bytes! (%d)",bytes);
 #endif
-	if( ((uintptr_t)src32&0x3 )==0)
-	{
-		u32 size64 = bytes >> 3;
-
-		while (size64--)
-		{
-			dst32[0] = BSWAP32(src32[1]);
-			dst32[1] = BSWAP32(src32[0]);
-			dst32 += 2;
-			src32 += 2;
-		}
-	}
-	else
-#endif
-	{
-		// Optimize me: Bomberman, Zelda, and Quest 64 have unaligned copies here
-		//DBGConsole_Msg(0, "[WWarning CopyLineSwap: Performing slow copy]" );
-
-		u8* src8 = (u8*)src32;
-		u8* dst8 = (u8*)dst32;
-		while(bytes--)
-		{
-			// Alternate 32 bit words are swapped
-			*(u8*)((uintptr_t)dst8++ ^ 0x4) = *(u8*)((uintptr_t)src8++ ^ U8_TWIDDLE);
-		}
-	}
+	// Alternate 32 bit words are swapped
+	ByteSwap_CopyN64(dst, src, bytes, 0x4);
 }
 
 static inline void CopyLineSwap32(void * dst, const void * src, u32 bytes)
 {
-	u32* src32 = (u32*)(src);
-	u32* dst32 = (u32*)(dst);
-
-#ifdef FAST_TMEM_COPY
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT((bytes&0x7)==0, "CopyLineSwap32: Remaning bytes! (%d)",bytes);
 #endif
-	if( ((uintptr_t)src32&0x3 )==0)
-	{
-		u32 size128 = bytes >> 4;
-
-		while (size128--)
-		{
-			dst32[0] = BSWAP32(src32[2]);
-			dst32[1] = BSWAP32(src32[3]);
-			dst32[2] = BSWAP32(src32[0]);
-			dst32[3] = BSWAP32(src32[1]);
-			dst32 += 4;
-			src32 += 4;
-		}
-
-		// Copy any remaining quadword
-		bytes&=0xF;
-		while(bytes--)
-		{
-			*(u32*)((uintptr_t)dst32++ ^ 0x8) = BSWAP32(src32[0]);
-			*(u32*)((uintptr_t)dst32++ ^ 0x8) = BSWAP32(src32[1]);
-			src32+=2;
-		}
-	}
-	else
-#endif
-	{
-		// Have yet to see game with unaligned copies here
-		//DBGConsole_Msg(0, "[WWarning CopyLineSwap32: Performing slow copy]" );
-
-		u8* src8 = (u8*)src32;
-		u8* dst8 = (u8*)dst32;
-		while(bytes--)
-		{
-			// Alternate 64 bit words are swapped
-			*(u8*)((uintptr_t)dst8++ ^ 0x8) = *(u8*)((uintptr_t)src8++ ^ U8_TWIDDLE);
-		}
-	}
+	// Alternate 64 bit words are swapped
+	ByteSwap_CopyN64(dst, src, bytes, 0x8);
 }
 #endif
 
@@ -666,11 +494,11 @@ const TextureInfo & CRDPStateManager::GetUpdatedTextureDescriptor( u32 idx )
 		//TMEM address 0x100 (gTlutLoadAddresses[ 0 ]) and calculate offset from there with TLutIndex(palette index)
 		//This trick saves us from the need to copy the real palette to TMEM and we just pass the pointer //Corn
 		//
-		u32	tlut= TLUT_BASE;
+		uintptr_t tlut= TLUT_BASE;
 		if(rdp_tile.size == G_IM_SIZ_4b)
 		{
 			u32 tlut_idx0 = g_ROM.TLUT_HACK << 1;
-			u32 tlut_idx1 = (u32)gTlutLoadAddresses[ rdp_tile.palette << tlut_idx0 ];
+			uintptr_t tlut_idx1 = reinterpret_cast< uintptr_t >(gTlutLoadAddresses[ rdp_tile.palette << tlut_idx0 ]);
 
 			//If pointer == NULL(=invalid entry) add offset to base address (TMEM[0] + offset)
 			if(tlut_idx1 == 0)
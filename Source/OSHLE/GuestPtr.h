@@ -0,0 +1,124 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef OSHLE_GUESTPTR_H_
+#define OSHLE_GUESTPTR_H_
+
+#include "Core/Memory.h"
+#include "Core/TLB.h"
+#include "Utility/Endian.h"
+
+//*****************************************************************************
+//	Resolve length bytes of guest memory at address to a host pointer into
+//	RDRAM. KSEG0/KSEG1 go straight through the lookup table, TLB mapped
+//	addresses are translated once and must not cross a page. Nothing here
+//	raises an exception or touches hardware registers.
+//	Returns NULL if any part of the range lies outside RDRAM.
+//*****************************************************************************
+inline u8 * GuestMemory_Resolve( u32 address, u32 length )
+{
+	const MemFuncRead & m( g_MemoryLookupTableRead[ address >> 18 ] );
+	const u32 last( address + ( length ? length - 1 : 0 ) );
+
+	u8 * p_host;
+	if( m.pRead )
+	{
+		p_host = m.pRead + address;
+	}
+	else if( address < 0x80000000 || address >= 0xC0000000 )
+	{
+		if( ( address ^ last ) & ~0xFFF )
+			return NULL;
+
+		// Same as the memory handlers: the page table first, then the TLB itself
+		u8 * p_base( TLB_GetReadBase( address ) );
+		if( p_base != NULL )
+		{
+			p_host = p_base + address;
+		}
+		else
+		{
+			u32 physical;
+			if( !TLBEntry::Probe( address, &physical ) || physical >= gRamSize )
+				return NULL;
+
+			p_host = g_pu8RamBase + physical;
+		}
+	}
+	else
+	{
+		// KSEG0/KSEG1 outside RDRAM, i.e. hardware registers or cartridge space
+		return NULL;
+	}
+
+	const uintptr_t offset( reinterpret_cast< uintptr_t >( p_host ) - reinterpret_cast< uintptr_t >( g_pu8RamBase ) );
+	if( offset >= gRamSize || length > gRamSize - offset )
+		return NULL;
+
+	return p_host;
+}
+
+//*****************************************************************************
+//	A guest structure of type T, resolved once on construction.
+//	Field offsets are in the N64 layout, i.e. offsetof( T, field ) on the
+//	structures in ultra_os.h, and the accessors take care of byte order.
+//*****************************************************************************
+template< typename T >
+class GuestPtr
+{
+public:
+	explicit GuestPtr( u32 address )
+		:	mAddress( address )
+		,	mpBase( GuestMemory_Resolve( address, sizeof( T ) ) )
+	{
+	}
+
+	bool	IsValid() const				{ return mpBase != NULL; }
+	u32		GetAddress() const			{ return mAddress; }
+
+	u8 Read8( u32 offset ) const
+	{
+		CheckAccess( offset, 1 );
+		return *(u8 *)( reinterpret_cast< uintptr_t >( mpBase + offset ) ^ U8_TWIDDLE );
+	}
+
+	u16		Read16( u32 offset ) const				{ CheckAccess( offset, 2 ); return QuickRead16Bits( mpBase, offset ); }
+	u32		Read32( u32 offset ) const				{ CheckAccess( offset, 4 ); return QuickRead32Bits( mpBase, offset ); }
+	u64		Read64( u32 offset ) const				{ CheckAccess( offset, 8 ); return QuickRead64Bits( mpBase, offset ); }
+
+	void	Write16( u32 offset, u16 value ) const	{ CheckAccess( offset, 2 ); QuickWrite16Bits( mpBase, offset, value ); }
+	void	Write32( u32 offset, u32 value ) const	{ CheckAccess( offset, 4 ); QuickWrite32Bits( mpBase, offset, value ); }
+	void	Write64( u32 offset, u64 value ) const	{ CheckAccess( offset, 8 ); QuickWrite64Bits( mpBase, offset, value ); }
+
+private:
+	inline void CheckAccess( u32 offset, u32 size ) const
+	{
+#ifdef DAEDALUS_ENABLE_ASSERTS
+		DAEDALUS_ASSERT( mpBase != NULL, "Guest pointer 0x%08x is not in RDRAM", mAddress );
+		DAEDALUS_ASSERT( offset + size <= sizeof( T ), "Offset 0x%x is outside the structure", offset );
+		DAEDALUS_ASSERT( ( offset & ( size - 1 ) ) == 0, "Offset 0x%x is misaligned", offset );
+#endif
+	}
+
+private:
+	u32		mAddress;
+	u8 *	mpBase;
+};
+
+#endif // OSHLE_GUESTPTR_H_
@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "patch_symbols.h"
 #include "OS.h"
+#include "GuestPtr.h"
 #include "OSMesgQueue.h"
 
 #include "Config/ConfigOptions.h"
@@ -40,6 +41,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Debug/Dump.h"
 #include "DynaRec/Fragment.h"
 #include "DynaRec/FragmentCache.h"
+#include "DynaRec/FragmentCompiler.h"
 #include "Math/Math.h"	// VFPU Math
 #include "OSHLE/ultra_os.h"
 #include "OSHLE/ultra_R4300.h"
@@ -209,10 +211,20 @@ void Patch_ApplyPatch(u32 i)
 #ifdef DAEDALUS_ENABLE_DYNAREC
 	u32 pc = g_PatchSymbols[i]->Location;
 
-	CFragment *frag = new CFragment(gFragmentCache.GetCodeBufferManager(),
-									PHYS_TO_K0(pc),
-									g_PatchSymbols[i]->Signatures->NumOps,
-									(void*)g_PatchSymbols[i]->Function);
+	// Still there from last time (the fragment cache only evicts some of its fragments)
+	if (gFragmentCache.LookupFragmentQ(PHYS_TO_K0(pc)) != NULL)
+		return;
+
+	CFragment *frag;
+	{
+		// The compile thread may be writing to the code buffer
+		AUTO_CRIT_SECT( gFragmentCompiler.GetCodeBufferLock() );
+
+		frag = new CFragment(gFragmentCache.GetCodeBufferManager(),
+							 PHYS_TO_K0(pc),
+							 g_PatchSymbols[i]->Signatures->NumOps,
+							 (void*)g_PatchSymbols[i]->Function);
+	}
 
 	gFragmentCache.InsertFragment(frag);
 #endif
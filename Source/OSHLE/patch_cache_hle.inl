@@ -5,7 +5,7 @@
 u32 Patch_osInvalICache_Mario()
 {
 TEST_DISABLE_CACHE_FUNCS
-#ifdef DAEDALUS_ENABLE_DYNAREC
+	// Without the dynarec this still drops the cached interpreter blocks
 	u32 p = gGPR[REG_a0]._u32_0;
 	u32 len = gGPR[REG_a1]._u32_0;
 
@@ -13,7 +13,6 @@ TEST_DISABLE_CACHE_FUNCS
 		CPU_InvalidateICacheRange(p, len);
 	else
 		CPU_InvalidateICache();
-#endif
 
 	return PATCH_RET_JR_RA;
 }
@@ -109,10 +109,12 @@ TEST_DISABLE_MESG_FUNCS
 	u32 msg       = gGPR[REG_a1]._u32_0;
 	u32 BlockFlag = gGPR[REG_a2]._u32_0;
 
-	u8 * pBase	  = (u8 *)ReadAddress(queue);
+	GuestPtr< OSMesgQueue > mq(queue);
+	if (!mq.IsValid())
+		return PATCH_RET_NOT_PROCESSED0(osRecvMesg);
 
-	u32 ValidCount= QuickRead32Bits(pBase, 0x8);
-	u32 MsgCount  = QuickRead32Bits(pBase, 0x10);
+	u32 ValidCount= mq.Read32(offsetof(OSMesgQueue, validCount));
+	u32 MsgCount  = mq.Read32(offsetof(OSMesgQueue, msgCount));
 
 	/*if (queue == 0x80007d40)
 	{
@@ -141,19 +143,22 @@ TEST_DISABLE_MESG_FUNCS
 
 	//DBGConsole_Msg(0, "  Processing Pending");
 
-	u32 first = QuickRead32Bits(pBase, 0x0c);
+	u32 first = mq.Read32(offsetof(OSMesgQueue, first));
 
 	//Store message in pointer
 	if (msg != 0)
 	{
 		//DBGConsole_Msg(0, "  Retrieving message");
 
-		u32 MsgBase = QuickRead32Bits(pBase, 0x14);
+		u32 MsgBase = mq.Read32(offsetof(OSMesgQueue, msg));
 
 		// Offset to first valid message
-		MsgBase += first * 4;
+		GuestPtr< OSMesg > src(MsgBase + first * 4);
+		GuestPtr< OSMesg > dst(msg);
+		if (!src.IsValid() || !dst.IsValid())
+			return PATCH_RET_NOT_PROCESSED0(osRecvMesg);
 
-		Write32Bits(msg, Read32Bits(MsgBase));
+		dst.Write32(0, src.Read32(0));
 
 	}
 	first = (first + 1) % MsgCount;
@@ -178,17 +183,17 @@ TEST_DISABLE_MESG_FUNCS
 	//{
 	//DBGConsole_Msg(0, "  Generating next valid message number");
 
-	QuickWrite32Bits(pBase, 0x0c, first);
+	mq.Write32(offsetof(OSMesgQueue, first), first);
 	//}
 
 	// Decrease the number of valid messages
 	ValidCount--;
 
-	QuickWrite32Bits(pBase, 0x8, ValidCount);
+	mq.Write32(offsetof(OSMesgQueue, validCount), ValidCount);
 
 	// Start thread pending on the fullqueue
-	u32 FullQueueThread = QuickRead32Bits(pBase, 0x04);
-	u32 NextThread = Read32Bits(FullQueueThread + 0x00);
+	u32 FullQueueThread = mq.Read32(offsetof(OSMesgQueue, fullqueue));
+	u32 NextThread = Read32Bits(FullQueueThread + offsetof(OSThread, next));
 
 
 	// If the first thread is not the idle thread, start it
@@ -197,7 +202,7 @@ TEST_DISABLE_MESG_FUNCS
 		//DBGConsole_Msg(0, "  Activating sleeping thread");
 
 		// From Patch___osPopThread():
-		QuickWrite32Bits(pBase, 0x04, NextThread);
+		mq.Write32(offsetof(OSMesgQueue, fullqueue), NextThread);
 
 		gGPR[REG_a0]._u32_0 = FullQueueThread;
 
@@ -230,10 +235,12 @@ TEST_DISABLE_MESG_FUNCS
 	u32 msg       = gGPR[REG_a1]._u32_0;
 	u32 BlockFlag = gGPR[REG_a2]._u32_0;
 
-	u8 * pBase	  = (u8 *)ReadAddress(queue);
+	GuestPtr< OSMesgQueue > mq(queue);
+	if (!mq.IsValid())
+		return PATCH_RET_NOT_PROCESSED0(osSendMesg);
 
-	u32 ValidCount= QuickRead32Bits(pBase, 0x8);
-	u32 MsgCount  = QuickRead32Bits(pBase, 0x10);
+	u32 ValidCount= mq.Read32(offsetof(OSMesgQueue, validCount));
+	u32 MsgCount  = mq.Read32(offsetof(OSMesgQueue, msgCount));
 
 	/*if (queue == 0x80007d40)
 	{
@@ -260,7 +267,7 @@ TEST_DISABLE_MESG_FUNCS
 		}
 	}
 
-	u32 first = QuickRead32Bits(pBase, 0x0c);
+	u32 first = mq.Read32(offsetof(OSMesgQueue, first));
 
 	//DBGConsole_Msg(0, "  Processing Pending");
 	#ifdef DAEDALUS_ENABLE_ASSERTS
@@ -282,23 +289,25 @@ TEST_DISABLE_MESG_FUNCS
 	//{
 	u32 slot = (first + ValidCount) % MsgCount;
 
-	u32 MsgBase = QuickRead32Bits(pBase, 0x14);
+	u32 MsgBase = mq.Read32(offsetof(OSMesgQueue, msg));
 
 	// Offset to first valid message
-	MsgBase += slot * 4;
+	GuestPtr< OSMesg > dst(MsgBase + slot * 4);
+	if (!dst.IsValid())
+		return PATCH_RET_NOT_PROCESSED0(osSendMesg);
 
-	Write32Bits(MsgBase, msg);
+	dst.Write32(0, msg);
 
 	//}
 
 	// Increase the number of valid messages
 	ValidCount++;
 
-	QuickWrite32Bits(pBase, 0x8, ValidCount);
+	mq.Write32(offsetof(OSMesgQueue, validCount), ValidCount);
 
 	// Start thread pending on the fullqueue
-	u32 EmptyQueueThread = QuickRead32Bits(pBase, 0x00);
-	u32 NextThread = Read32Bits(EmptyQueueThread + 0x00);
+	u32 EmptyQueueThread = mq.Read32(offsetof(OSMesgQueue, mtqueue));
+	u32 NextThread = Read32Bits(EmptyQueueThread + offsetof(OSThread, next));
 
 
 	// If the first thread is not the idle thread, start it
@@ -307,7 +316,7 @@ TEST_DISABLE_MESG_FUNCS
 		//DBGConsole_Msg(0, "  Activating sleeping thread");
 
 		// From Patch___osPopThread():
-		QuickWrite32Bits(pBase, 0x00, NextThread);
+		mq.Write32(offsetof(OSMesgQueue, mtqueue), NextThread);
 
 		gGPR[REG_a0]._u32_0 = EmptyQueueThread;
 
@@ -212,25 +212,25 @@ TEST_DISABLE_SP_FUNCS
 	fast_memcpy(pDstTask, pSrcTask, sizeof(OSTask));
 
 	if (pDstTask->t.ucode != 0)
-		pDstTask->t.ucode = (u64 *)ConvertToPhysics((u32)pDstTask->t.ucode);
+		pDstTask->t.ucode = ConvertToPhysics(pDstTask->t.ucode);
 
 	if (pDstTask->t.ucode_data != 0)
-		pDstTask->t.ucode_data = (u64 *)ConvertToPhysics((u32)pDstTask->t.ucode_data);
+		pDstTask->t.ucode_data = ConvertToPhysics(pDstTask->t.ucode_data);
 
 	if (pDstTask->t.dram_stack != 0)
-		pDstTask->t.dram_stack = (u64 *)ConvertToPhysics((u32)pDstTask->t.dram_stack);
+		pDstTask->t.dram_stack = ConvertToPhysics(pDstTask->t.dram_stack);
 
 	if (pDstTask->t.output_buff != 0)
-		pDstTask->t.output_buff = (u64 *)ConvertToPhysics((u32)pDstTask->t.output_buff);
+		pDstTask->t.output_buff = ConvertToPhysics(pDstTask->t.output_buff);
 
 	if (pDstTask->t.output_buff_size != 0)
-		pDstTask->t.output_buff_size = (u64 *)ConvertToPhysics((u32)pDstTask->t.output_buff_size);
+		pDstTask->t.output_buff_size = ConvertToPhysics(pDstTask->t.output_buff_size);
 
 	if (pDstTask->t.data_ptr != 0)
-		pDstTask->t.data_ptr = (u64 *)ConvertToPhysics((u32)pDstTask->t.data_ptr);
+		pDstTask->t.data_ptr = ConvertToPhysics(pDstTask->t.data_ptr);
 
 	if (pDstTask->t.yield_data_ptr != 0)
-		pDstTask->t.yield_data_ptr = (u64 *)ConvertToPhysics((u32)pDstTask->t.yield_data_ptr);
+		pDstTask->t.yield_data_ptr = ConvertToPhysics(pDstTask->t.yield_data_ptr);
 
 	// If yielded, use the yield data info
 	if (pSrcTask->t.flags & OS_TASK_YIELDED)
@@ -267,7 +267,7 @@ TEST_DISABLE_SP_FUNCS
 
 	// We know that we're not busy!
 	Memory_SP_SetRegister(SP_MEM_ADDR_REG, 0x04001000);
-	Memory_SP_SetRegister(SP_DRAM_ADDR_REG, (u32)pDstTask->t.ucode_boot);//	-> Translate boot ucode to physical address!
+	Memory_SP_SetRegister(SP_DRAM_ADDR_REG, pDstTask->t.ucode_boot);//	-> Translate boot ucode to physical address!
 	Memory_SP_SetRegister(SP_RD_LEN_REG, pDstTask->t.ucode_boot_size - 1);
 	DMA_SP_CopyFromRDRAM();
 
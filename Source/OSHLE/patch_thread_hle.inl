@@ -155,98 +155,100 @@ TEST_DISABLE_THREAD_FUNCS
 	// First pop the first thread off the stack (copy of osPopThread code):
 	u32 thread = Read32Bits(VAR_ADDRESS(osThreadQueue));
 
-	u8 * pThreadBase = (u8 *)ReadAddress(thread);
+	GuestPtr< OSThread > pThread(thread);
+	if (!pThread.IsValid())
+		return PATCH_RET_NOT_PROCESSED0(__osDispatchThread);
 
 	// Update queue to point to next thread:
-	Write32Bits(VAR_ADDRESS(osThreadQueue), QuickRead32Bits(pThreadBase, offsetof(OSThread, next)));
+	Write32Bits(VAR_ADDRESS(osThreadQueue), pThread.Read32(offsetof(OSThread, next)));
 
 	// Set the current active thread:
 	Write32Bits(VAR_ADDRESS(osActiveThread), thread);
 
 	// Set the current thread's status to OS_STATE_RUNNING:
-	QuickWrite16Bits(pThreadBase, offsetof(OSThread, state), OS_STATE_RUNNING);
+	pThread.Write16(offsetof(OSThread, state), OS_STATE_RUNNING);
 
 #if 1	//1->better cache efficiency //Corn
 	// CPU regs
 	for(u32 Reg = 1; Reg < 26; Reg++)	//AT -> T9
 	{
-		gGPR[Reg]._u64 = QuickRead64Bits(pThreadBase, 0x0018 + (Reg << 3));
+		gGPR[Reg]._u64 = pThread.Read64(0x0018 + (Reg << 3));
 	}
-	gGPR[REG_gp]._u64 = QuickRead64Bits(pThreadBase, 0x00e8);
-	gGPR[REG_sp]._u64 = QuickRead64Bits(pThreadBase, 0x00f0);
-	gGPR[REG_s8]._u64 = QuickRead64Bits(pThreadBase, 0x00f8);
-	gGPR[REG_ra]._u64 = QuickRead64Bits(pThreadBase, 0x0100);
+	gGPR[REG_gp]._u64 = pThread.Read64(0x00e8);
+	gGPR[REG_sp]._u64 = pThread.Read64(0x00f0);
+	gGPR[REG_s8]._u64 = pThread.Read64(0x00f8);
+	gGPR[REG_ra]._u64 = pThread.Read64(0x0100);
 
 #else
 	// Restore all registers:
 	// For speed, we cache the base pointer!!!
-	gGPR[REG_at]._u64 = QuickRead64Bits(pThreadBase, 0x0020);
-	gGPR[REG_v0]._u64 = QuickRead64Bits(pThreadBase, 0x0028);
-	gGPR[REG_v1]._u64 = QuickRead64Bits(pThreadBase, 0x0030);
-	gGPR[REG_a0]._u64 = QuickRead64Bits(pThreadBase, 0x0038);
-	gGPR[REG_a1]._u64 = QuickRead64Bits(pThreadBase, 0x0040);
-	gGPR[REG_a2]._u64 = QuickRead64Bits(pThreadBase, 0x0048);
-	gGPR[REG_a3]._u64 = QuickRead64Bits(pThreadBase, 0x0050);
-	gGPR[REG_t0]._u64 = QuickRead64Bits(pThreadBase, 0x0058);
-	gGPR[REG_t1]._u64 = QuickRead64Bits(pThreadBase, 0x0060);
-	gGPR[REG_t2]._u64 = QuickRead64Bits(pThreadBase, 0x0068);
-	gGPR[REG_t3]._u64 = QuickRead64Bits(pThreadBase, 0x0070);
-	gGPR[REG_t4]._u64 = QuickRead64Bits(pThreadBase, 0x0078);
-	gGPR[REG_t5]._u64 = QuickRead64Bits(pThreadBase, 0x0080);
-	gGPR[REG_t6]._u64 = QuickRead64Bits(pThreadBase, 0x0088);
-	gGPR[REG_t7]._u64 = QuickRead64Bits(pThreadBase, 0x0090);
-	gGPR[REG_s0]._u64 = QuickRead64Bits(pThreadBase, 0x0098);
-	gGPR[REG_s1]._u64 = QuickRead64Bits(pThreadBase, 0x00a0);
-	gGPR[REG_s2]._u64 = QuickRead64Bits(pThreadBase, 0x00a8);
-	gGPR[REG_s3]._u64 = QuickRead64Bits(pThreadBase, 0x00b0);
-	gGPR[REG_s4]._u64 = QuickRead64Bits(pThreadBase, 0x00b8);
-	gGPR[REG_s5]._u64 = QuickRead64Bits(pThreadBase, 0x00c0);
-	gGPR[REG_s6]._u64 = QuickRead64Bits(pThreadBase, 0x00c8);
-	gGPR[REG_s7]._u64 = QuickRead64Bits(pThreadBase, 0x00d0);
-	gGPR[REG_t8]._u64 = QuickRead64Bits(pThreadBase, 0x00d8);
-	gGPR[REG_t9]._u64 = QuickRead64Bits(pThreadBase, 0x00e0);
-	gGPR[REG_gp]._u64 = QuickRead64Bits(pThreadBase, 0x00e8);
-	gGPR[REG_sp]._u64 = QuickRead64Bits(pThreadBase, 0x00f0);
-	gGPR[REG_s8]._u64 = QuickRead64Bits(pThreadBase, 0x00f8);
-	gGPR[REG_ra]._u64 = QuickRead64Bits(pThreadBase, 0x0100);
+	gGPR[REG_at]._u64 = pThread.Read64(0x0020);
+	gGPR[REG_v0]._u64 = pThread.Read64(0x0028);
+	gGPR[REG_v1]._u64 = pThread.Read64(0x0030);
+	gGPR[REG_a0]._u64 = pThread.Read64(0x0038);
+	gGPR[REG_a1]._u64 = pThread.Read64(0x0040);
+	gGPR[REG_a2]._u64 = pThread.Read64(0x0048);
+	gGPR[REG_a3]._u64 = pThread.Read64(0x0050);
+	gGPR[REG_t0]._u64 = pThread.Read64(0x0058);
+	gGPR[REG_t1]._u64 = pThread.Read64(0x0060);
+	gGPR[REG_t2]._u64 = pThread.Read64(0x0068);
+	gGPR[REG_t3]._u64 = pThread.Read64(0x0070);
+	gGPR[REG_t4]._u64 = pThread.Read64(0x0078);
+	gGPR[REG_t5]._u64 = pThread.Read64(0x0080);
+	gGPR[REG_t6]._u64 = pThread.Read64(0x0088);
+	gGPR[REG_t7]._u64 = pThread.Read64(0x0090);
+	gGPR[REG_s0]._u64 = pThread.Read64(0x0098);
+	gGPR[REG_s1]._u64 = pThread.Read64(0x00a0);
+	gGPR[REG_s2]._u64 = pThread.Read64(0x00a8);
+	gGPR[REG_s3]._u64 = pThread.Read64(0x00b0);
+	gGPR[REG_s4]._u64 = pThread.Read64(0x00b8);
+	gGPR[REG_s5]._u64 = pThread.Read64(0x00c0);
+	gGPR[REG_s6]._u64 = pThread.Read64(0x00c8);
+	gGPR[REG_s7]._u64 = pThread.Read64(0x00d0);
+	gGPR[REG_t8]._u64 = pThread.Read64(0x00d8);
+	gGPR[REG_t9]._u64 = pThread.Read64(0x00e0);
+	gGPR[REG_gp]._u64 = pThread.Read64(0x00e8);
+	gGPR[REG_sp]._u64 = pThread.Read64(0x00f0);
+	gGPR[REG_s8]._u64 = pThread.Read64(0x00f8);
+	gGPR[REG_ra]._u64 = pThread.Read64(0x0100);
 #endif
 
-	gCPUState.MultLo._u64 = QuickRead64Bits(pThreadBase, offsetof(OSThread, context.lo));
-	gCPUState.MultHi._u64 = QuickRead64Bits(pThreadBase, offsetof(OSThread, context.hi));
+	gCPUState.MultLo._u64 = pThread.Read64(offsetof(OSThread, context.lo));
+	gCPUState.MultHi._u64 = pThread.Read64(offsetof(OSThread, context.hi));
 
 	// Set the EPC
-	gCPUState.CPUControl[C0_EPC]._u32 = QuickRead32Bits(pThreadBase, offsetof(OSThread, context.pc));
+	gCPUState.CPUControl[C0_EPC]._u32 = pThread.Read32(offsetof(OSThread, context.pc));
 
 	// Set the STATUS register. Normally this would trigger a
 	// Check for pending interrupts, but we're running in kernel mode
 	// So SR_ERL or SR_EXL is probably set. Don't think that a check is
 	// necessary
 
-	u32 NewSR = QuickRead32Bits(pThreadBase, offsetof(OSThread, context.sr));
+	u32 NewSR = pThread.Read32(offsetof(OSThread, context.sr));
 
 	R4300_SetSR(NewSR);
 
 	// Don't restore CAUSE
 
 	// Check if the FP unit was used
-	u32 RestoreFP = QuickRead32Bits(pThreadBase, offsetof(OSThread, fp));
+	u32 RestoreFP = pThread.Read32(offsetof(OSThread, fp));
 	if (RestoreFP != 0)
 	{
 		// Restore control reg
-		gCPUState.FPUControl[31]._u32 = QuickRead32Bits(pThreadBase, offsetof(OSThread, context.fpcsr));
+		gCPUState.FPUControl[31]._u32 = pThread.Read32(offsetof(OSThread, context.fpcsr));
 
 		// Floats - can probably optimise this to eliminate 64 bits reads...
 		for (u32 FPReg = 0; FPReg < 16; FPReg++)
 		{
-			gCPUState.FPU[(FPReg*2)+1]._u32 = QuickRead32Bits(pThreadBase, 0x0130 + (FPReg << 3));
-			gCPUState.FPU[(FPReg*2)+0]._u32 = QuickRead32Bits(pThreadBase, 0x0134 + (FPReg << 3));
+			gCPUState.FPU[(FPReg*2)+1]._u32 = pThread.Read32(0x0130 + (FPReg << 3));
+			gCPUState.FPU[(FPReg*2)+0]._u32 = pThread.Read32(0x0134 + (FPReg << 3));
 		}
 	}
 
 
 
 	// Set interrupt mask...does this do anything???
-	u32 rcp = QuickRead32Bits(pThreadBase, 0x0128);
+	u32 rcp = pThread.Read32(0x0128);
 
 	u16 TempVal = Read16Bits(VAR_ADDRESS(osDispatchThreadRCPThingamy) + (rcp*2));
 	MemoryUpdateMI( (u32)TempVal ); // MI_INTR_MASK_REG
@@ -274,20 +276,22 @@ TEST_DISABLE_THREAD_FUNCS
 
 	u32 thread = Read32Bits(VAR_ADDRESS(osThreadQueue));
 
-	u8 * pThreadBase = (u8 *)ReadAddress(thread);
+	GuestPtr< OSThread > pThread(thread);
+	if (!pThread.IsValid())
+		return PATCH_RET_NOT_PROCESSED0(__osDispatchThread);
 
 	// Update queue to point to next thread:
-	Write32Bits(VAR_ADDRESS(osThreadQueue), QuickRead32Bits(pThreadBase, offsetof(OSThread, next)));
+	Write32Bits(VAR_ADDRESS(osThreadQueue), pThread.Read32(offsetof(OSThread, next)));
 
 	// Set the current active thread:
 	Write32Bits(VAR_ADDRESS(osActiveThread), thread);
 
 	// Set the current thread's status to OS_STATE_RUNNING:
-	QuickWrite16Bits(pThreadBase, offsetof(OSThread, state), OS_STATE_RUNNING);
+	pThread.Write16(offsetof(OSThread, state), OS_STATE_RUNNING);
 /*
 0x80051ad0: <0x0040d021> ADDU      k0 = v0 + r0
 0x80051ad4: <0x8f5b0118> LW        k1 <- 0x0118(k0)*/
-	u32 k1 = QuickRead32Bits(pThreadBase, offsetof(OSThread, context.sr));
+	u32 k1 = pThread.Read32(offsetof(OSThread, context.sr));
 
 /*
 0x80051ad8: <0x3c088006> LUI       t0 = 0x80060000
@@ -317,67 +321,67 @@ TEST_DISABLE_THREAD_FUNCS
 	// CPU regs
 	for(u32 Reg = 1; Reg < 26; Reg++)	//AT -> T9
 	{
-		gGPR[Reg]._u64 = QuickRead64Bits(pThreadBase, 0x0018 + (Reg << 3));
+		gGPR[Reg]._u64 = pThread.Read64(0x0018 + (Reg << 3));
 	}
-	gGPR[REG_gp]._u64 = QuickRead64Bits(pThreadBase, 0x00e8);
-	gGPR[REG_sp]._u64 = QuickRead64Bits(pThreadBase, 0x00f0);
-	gGPR[REG_s8]._u64 = QuickRead64Bits(pThreadBase, 0x00f8);
-	gGPR[REG_ra]._u64 = QuickRead64Bits(pThreadBase, 0x0100);
+	gGPR[REG_gp]._u64 = pThread.Read64(0x00e8);
+	gGPR[REG_sp]._u64 = pThread.Read64(0x00f0);
+	gGPR[REG_s8]._u64 = pThread.Read64(0x00f8);
+	gGPR[REG_ra]._u64 = pThread.Read64(0x0100);
 
 #else
 	// Restore all registers:
 	// For speed, we cache the base pointer!!!
-	gGPR[REG_at]._u64 = QuickRead64Bits(pThreadBase, 0x0020);
-	gGPR[REG_v0]._u64 = QuickRead64Bits(pThreadBase, 0x0028);
-	gGPR[REG_v1]._u64 = QuickRead64Bits(pThreadBase, 0x0030);
-	gGPR[REG_a0]._u64 = QuickRead64Bits(pThreadBase, 0x0038);
-	gGPR[REG_a1]._u64 = QuickRead64Bits(pThreadBase, 0x0040);
-	gGPR[REG_a2]._u64 = QuickRead64Bits(pThreadBase, 0x0048);
-	gGPR[REG_a3]._u64 = QuickRead64Bits(pThreadBase, 0x0050);
-	gGPR[REG_t0]._u64 = QuickRead64Bits(pThreadBase, 0x0058);
-	gGPR[REG_t1]._u64 = QuickRead64Bits(pThreadBase, 0x0060);
-	gGPR[REG_t2]._u64 = QuickRead64Bits(pThreadBase, 0x0068);
-	gGPR[REG_t3]._u64 = QuickRead64Bits(pThreadBase, 0x0070);
-	gGPR[REG_t4]._u64 = QuickRead64Bits(pThreadBase, 0x0078);
-	gGPR[REG_t5]._u64 = QuickRead64Bits(pThreadBase, 0x0080);
-	gGPR[REG_t6]._u64 = QuickRead64Bits(pThreadBase, 0x0088);
-	gGPR[REG_t7]._u64 = QuickRead64Bits(pThreadBase, 0x0090);
-	gGPR[REG_s0]._u64 = QuickRead64Bits(pThreadBase, 0x0098);
-	gGPR[REG_s1]._u64 = QuickRead64Bits(pThreadBase, 0x00a0);
-	gGPR[REG_s2]._u64 = QuickRead64Bits(pThreadBase, 0x00a8);
-	gGPR[REG_s3]._u64 = QuickRead64Bits(pThreadBase, 0x00b0);
-	gGPR[REG_s4]._u64 = QuickRead64Bits(pThreadBase, 0x00b8);
-	gGPR[REG_s5]._u64 = QuickRead64Bits(pThreadBase, 0x00c0);
-	gGPR[REG_s6]._u64 = QuickRead64Bits(pThreadBase, 0x00c8);
-	gGPR[REG_s7]._u64 = QuickRead64Bits(pThreadBase, 0x00d0);
-	gGPR[REG_t8]._u64 = QuickRead64Bits(pThreadBase, 0x00d8);
-	gGPR[REG_t9]._u64 = QuickRead64Bits(pThreadBase, 0x00e0);
-	gGPR[REG_gp]._u64 = QuickRead64Bits(pThreadBase, 0x00e8);
-	gGPR[REG_sp]._u64 = QuickRead64Bits(pThreadBase, 0x00f0);
-	gGPR[REG_s8]._u64 = QuickRead64Bits(pThreadBase, 0x00f8);
-	gGPR[REG_ra]._u64 = QuickRead64Bits(pThreadBase, 0x0100);
+	gGPR[REG_at]._u64 = pThread.Read64(0x0020);
+	gGPR[REG_v0]._u64 = pThread.Read64(0x0028);
+	gGPR[REG_v1]._u64 = pThread.Read64(0x0030);
+	gGPR[REG_a0]._u64 = pThread.Read64(0x0038);
+	gGPR[REG_a1]._u64 = pThread.Read64(0x0040);
+	gGPR[REG_a2]._u64 = pThread.Read64(0x0048);
+	gGPR[REG_a3]._u64 = pThread.Read64(0x0050);
+	gGPR[REG_t0]._u64 = pThread.Read64(0x0058);
+	gGPR[REG_t1]._u64 = pThread.Read64(0x0060);
+	gGPR[REG_t2]._u64 = pThread.Read64(0x0068);
+	gGPR[REG_t3]._u64 = pThread.Read64(0x0070);
+	gGPR[REG_t4]._u64 = pThread.Read64(0x0078);
+	gGPR[REG_t5]._u64 = pThread.Read64(0x0080);
+	gGPR[REG_t6]._u64 = pThread.Read64(0x0088);
+	gGPR[REG_t7]._u64 = pThread.Read64(0x0090);
+	gGPR[REG_s0]._u64 = pThread.Read64(0x0098);
+	gGPR[REG_s1]._u64 = pThread.Read64(0x00a0);
+	gGPR[REG_s2]._u64 = pThread.Read64(0x00a8);
+	gGPR[REG_s3]._u64 = pThread.Read64(0x00b0);
+	gGPR[REG_s4]._u64 = pThread.Read64(0x00b8);
+	gGPR[REG_s5]._u64 = pThread.Read64(0x00c0);
+	gGPR[REG_s6]._u64 = pThread.Read64(0x00c8);
+	gGPR[REG_s7]._u64 = pThread.Read64(0x00d0);
+	gGPR[REG_t8]._u64 = pThread.Read64(0x00d8);
+	gGPR[REG_t9]._u64 = pThread.Read64(0x00e0);
+	gGPR[REG_gp]._u64 = pThread.Read64(0x00e8);
+	gGPR[REG_sp]._u64 = pThread.Read64(0x00f0);
+	gGPR[REG_s8]._u64 = pThread.Read64(0x00f8);
+	gGPR[REG_ra]._u64 = pThread.Read64(0x0100);
 #endif
 
 
-	gCPUState.MultLo._u64 = QuickRead64Bits(pThreadBase, offsetof(OSThread, context.lo));
-	gCPUState.MultHi._u64 = QuickRead64Bits(pThreadBase, offsetof(OSThread, context.hi));
+	gCPUState.MultLo._u64 = pThread.Read64(offsetof(OSThread, context.lo));
+	gCPUState.MultHi._u64 = pThread.Read64(offsetof(OSThread, context.hi));
 
 	// Set the EPC
-	gCPUState.CPUControl[C0_EPC]._u32 = QuickRead32Bits(pThreadBase, offsetof(OSThread, context.pc));
+	gCPUState.CPUControl[C0_EPC]._u32 = pThread.Read32(offsetof(OSThread, context.pc));
 
 
 	// Check if the FP unit was used
-	u32 RestoreFP = QuickRead32Bits(pThreadBase, offsetof(OSThread, fp));
+	u32 RestoreFP = pThread.Read32(offsetof(OSThread, fp));
 	if (RestoreFP != 0)
 	{
 		// Restore control reg
-		gCPUState.FPUControl[31]._u32 = QuickRead32Bits(pThreadBase, offsetof(OSThread, context.fpcsr));
+		gCPUState.FPUControl[31]._u32 = pThread.Read32(offsetof(OSThread, context.fpcsr));
 
 		// Floats - can probably optimise this to eliminate 64 bits reads...
 		for (u32 FPReg = 0; FPReg < 16; FPReg++)
 		{
-			gCPUState.FPU[(FPReg*2)+1]._u32 = QuickRead32Bits(pThreadBase, 0x0130 + (FPReg << 3));
-			gCPUState.FPU[(FPReg*2)+0]._u32 = QuickRead32Bits(pThreadBase, 0x0134 + (FPReg << 3));
+			gCPUState.FPU[(FPReg*2)+1]._u32 = pThread.Read32(0x0130 + (FPReg << 3));
+			gCPUState.FPU[(FPReg*2)+0]._u32 = pThread.Read32(0x0134 + (FPReg << 3));
 		}
 	}
 /*
@@ -387,7 +391,7 @@ TEST_DISABLE_THREAD_FUNCS
 0x80051bf0: <0x8f5a0000> LW        k0 <- 0x0000(k0)
 */
 	// Set interrupt mask...does this do anything???
-	u32 rcp = QuickRead32Bits(pThreadBase, 0x0128);
+	u32 rcp = pThread.Read32(0x0128);
 
 	u32 IntMask = Read32Bits(VAR_ADDRESS(osInterruptMaskThingy));
 
@@ -40,12 +40,15 @@ TEST_DISABLE_UTIL_FUNCS
 	if (len == 0)
 		return PATCH_RET_JR_RA;
 
+	u8 *pdst = GuestMemory_Resolve(dst, len);
+	u8 *psrc = GuestMemory_Resolve(src, len);
+	if (pdst == NULL || psrc == NULL)
+		return PATCH_RET_NOT_PROCESSED0(memcpy);
+
 #if 1	//1->Fast, 0->Old way
-	fast_memcpy_swizzle( (void *)ReadAddress(dst), (void *)ReadAddress(src), len);
+	fast_memcpy_swizzle( (void *)pdst, (const void *)psrc, len);
 #else
 	//DBGConsole_Msg(0, "memcpy(0x%08x, 0x%08x, %d)", dst, src, len);
-	u8 *pdst = (u8*)ReadAddress(dst);
-	u8 *psrc = (u8*)ReadAddress(src);
 	while(len--)
 	{
 		*(u8*)((u32)pdst++ ^ U8_TWIDDLE) = *(u8*)((u32)psrc++ ^ U8_TWIDDLE);
@@ -157,8 +160,10 @@ TEST_DISABLE_UTIL_FUNCS
 
 
 	//DBGConsole_Msg(0, "bcopy(0x%08x,0x%08x,%d)", src, dst, len);
-	u8 *pdst = (u8*)ReadAddress(dst);
-	u8 *psrc = (u8*)ReadAddress(src);
+	u8 *pdst = GuestMemory_Resolve(dst, len);
+	u8 *psrc = GuestMemory_Resolve(src, len);
+	if (pdst == NULL || psrc == NULL)
+		return PATCH_RET_NOT_PROCESSED0(bcopy);
 
 	if (dst > src && dst < src + len)
 	{
@@ -166,7 +171,7 @@ TEST_DISABLE_UTIL_FUNCS
 		psrc += len;
 		while(len--)
 		{
-			*(u8*)((u32)pdst-- ^ U8_TWIDDLE) = *(u8*)((u32)psrc-- ^ U8_TWIDDLE);
+			*(u8*)((uintptr_t)--pdst ^ U8_TWIDDLE) = *(u8*)((uintptr_t)--psrc ^ U8_TWIDDLE);
 		}
 	}
 	else
@@ -196,7 +201,9 @@ u32 Patch_bzero()
 	u32 dst = gGPR[REG_a0]._u32_0;
 	u32 len = gGPR[REG_a1]._u32_0;
 
-	u8* dst8 = (u8*)ReadAddress(dst);
+	u8* dst8 = GuestMemory_Resolve(dst, len);
+	if (dst8 == NULL)
+		return PATCH_RET_NOT_PROCESSED0(bzero);
 
 #if (DAEDALUS_ENDIAN_MODE == DAEDALUS_ENDIAN_BIG)
 	memset( dst8, 0, len);
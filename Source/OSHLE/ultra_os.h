@@ -22,6 +22,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Utility/DaedalusTypes.h"
 
+#include <stddef.h>		// offsetof
+
 // Definitions for N64 Operating System structures
 
 /////////////////////////////////////////////////////
@@ -57,18 +59,27 @@ typedef struct {
 	__OSfp	fp16, fp18, fp20, fp22, fp24, fp26, fp28, fp30;
 } __OSThreadContext;
 
+//
+// Pointers into guest memory are stored as u32 so that offsetof() gives the
+// N64 layout on 64 bit hosts too
+//
+typedef u32 OSGuestPtr;
+
 typedef struct OSThread_s
 {
-	struct		OSThread_s	*next;		// run/mesg queue link
+	OSGuestPtr	next;					// run/mesg queue link (OSThread *)
 	OSPri		priority;				// run/mesg queue priority
-	struct		OSThread_s	**queue;	// queue thread is on
-	struct		OSThread_s	*tlnext;	// all threads queue link
+	OSGuestPtr	queue;					// queue thread is on (OSThread **)
+	OSGuestPtr	tlnext;					// all threads queue link (OSThread *)
 	u16			state;					// OS_STATE_*
 	u16			flags;					// flags for rmon
 	OSId		id;						// id for debugging
 	int			fp;						// thread has used fp unit
 	__OSThreadContext	context;		// register/interrupt mask
 } OSThread;
+DAEDALUS_STATIC_ASSERT( offsetof( OSThread, context ) == 0x20 );
+DAEDALUS_STATIC_ASSERT( offsetof( OSThread, context.sr ) == 0x118 );
+DAEDALUS_STATIC_ASSERT( offsetof( OSThread, context.fp0 ) == 0x130 );
 
 typedef u32 OSEvent;
 typedef u32 OSIntMask;
@@ -79,22 +90,23 @@ typedef u32 OSHWIntr;
 //
 // Structure for message
 //
-typedef void *	OSMesg;
+typedef u32		OSMesg;
 
 //
 // Structure for message queue
 //
 typedef struct OSMesgQueue_s
 {
-	OSThread	*mtqueue;		// Queue to store threads blocked
+	OSGuestPtr	mtqueue;		// Queue to store threads blocked
 								//   on empty mailboxes (receive)
-	OSThread	*fullqueue;		// Queue to store threads blocked
+	OSGuestPtr	fullqueue;		// Queue to store threads blocked
 								//   on full mailboxes (send)
 	s32			validCount;		// Contains number of valid message
 	s32			first;			// Points to first valid message
 	s32			msgCount;		// Contains total # of messages
-	OSMesg		*msg;			// Points to message buffer array
+	OSGuestPtr	msg;			// Points to message buffer array (OSMesg *)
 } OSMesgQueue;
+DAEDALUS_STATIC_ASSERT( sizeof( OSMesgQueue ) == 0x18 );
 
 
 typedef struct {
@@ -165,13 +177,14 @@ typedef u64	OSTime;
 // Structure for interval timer
 //
 typedef struct OSTimer_s {
-	struct OSTimer_s *	next;		// point to next timer in list
-	struct OSTimer_s *	prev;		// point to previous timer in list
+	OSGuestPtr			next;		// point to next timer in list (OSTimer *)
+	OSGuestPtr			prev;		// point to previous timer in list (OSTimer *)
 	OSTime				interval;	// duration set by user
 	OSTime				value;		// time remaining before timer fires
-	OSMesgQueue *		mq;			// Message Queue
+	OSGuestPtr			mq;			// Message Queue (OSMesgQueue *)
 	OSMesg				msg;		// Message to send
 } OSTimer;
+DAEDALUS_STATIC_ASSERT( sizeof( OSTimer ) == 0x20 );
 
 
 /////////////////////////////////////////////////////
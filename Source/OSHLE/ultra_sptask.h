@@ -21,33 +21,39 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define OSHLE_ULTRA_SPTASK_H_
 
 #include "Utility/DaedalusTypes.h"
+#include "Debug/DaedalusAssert.h"
 
+//
+// The task is copied from guest memory into SP DMEM, so its pointers are
+// guest addresses stored as u32 to keep the N64 layout on 64 bit hosts
+//
 typedef struct {
 	u32	type;
 	u32	flags;
 
-	u64	*ucode_boot;
+	u32	ucode_boot;				// u64 *
 	u32	ucode_boot_size;
 
-	u64	*ucode;
+	u32	ucode;					// u64 *
 	u32	ucode_size;
 
-	u64	*ucode_data;
+	u32	ucode_data;				// u64 *
 	u32	ucode_data_size;
 
-	u64	*dram_stack;
+	u32	dram_stack;				// u64 *
 	u32	dram_stack_size;
 
-	u64	*output_buff;
-	u64	*output_buff_size;
+	u32	output_buff;			// u64 *
+	u32	output_buff_size;		// u64 *
 
-	u64	*data_ptr;
+	u32	data_ptr;				// u64 *
 	u32	data_size;
 
-	u64	*yield_data_ptr;
+	u32	yield_data_ptr;			// u64 *
 	u32	yield_data_size;
 
 } OSTask_t;
+DAEDALUS_STATIC_ASSERT( sizeof( OSTask_t ) == 0x40 );
 
 typedef union {
     OSTask_t		t;
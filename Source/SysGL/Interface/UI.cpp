@@ -5,6 +5,7 @@
 
 #include "Core/CPU.h"
 #include "Core/ROM.h"
+#include "Core/Rewind.h"
 
 #include "SysGL/GL.h"
 #include "System/Paths.h"
@@ -15,6 +16,15 @@
 
 static void HandleKeys(GLFWwindow * window, int key, int scancode, int action, int mods)
 {
+#ifdef DAEDALUS_REWIND
+	// Keeps stepping back while held
+	if (key == GLFW_KEY_BACKSPACE && action != GLFW_RELEASE)
+	{
+		Rewind_RequestStepBack();
+		return;
+	}
+#endif
+
 	if (action == GLFW_PRESS)
 	{
 		if (key >= '0' && key <= '9')
@@ -0,0 +1,99 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "DynaRec/AssemblyUtils.h"
+
+namespace AssemblyUtils
+{
+
+//*****************************************************************************
+//	Patch a long jump to target the specified location.
+//	Return true if the patching succeeded (i.e. within range), false otherwise
+//*****************************************************************************
+bool	PatchJumpLong( CJumpLocation jump, CCodeLabel target )
+{
+	const u32	JUMP_DIRECT_LONG_LENGTH = 5;
+	const u32	JUMP_LONG_LENGTH = 6;
+
+	u8 *	p_jump_addr( jump.GetWritableU8P() );
+	u32		instruction_length;
+	u32 *	p_jump_instr_offset;
+
+	if( *p_jump_addr == 0xe8 || *p_jump_addr == 0xe9 )
+	{
+		// call/jmp
+		instruction_length = JUMP_DIRECT_LONG_LENGTH;
+		p_jump_instr_offset = reinterpret_cast< u32 * >( p_jump_addr + 1 );
+	}
+	else if( *p_jump_addr == 0x0f )
+	{
+		// jne etc
+		instruction_length = JUMP_LONG_LENGTH;
+		p_jump_instr_offset = reinterpret_cast< u32 * >( p_jump_addr + 2 );
+	}
+	else
+	{
+		DAEDALUS_ERROR( "Unhandled jump type" );
+		return false;
+	}
+
+	// Both buffers live in the same reservation, so this only fails if something is badly wrong
+	s64		offset( target.GetTargetU8P() - jump.GetTargetU8P() - s64( instruction_length ) );
+	if( offset != s64( s32( offset ) ) )
+	{
+		DAEDALUS_ERROR( "Jump target is out of range" );
+		return false;
+	}
+
+	*p_jump_instr_offset = u32( s32( offset ) );
+	return true;
+}
+
+//*****************************************************************************
+//	As above no (need to flush on intel)
+//*****************************************************************************
+bool	PatchJumpLongAndFlush( CJumpLocation jump, CCodeLabel target )
+{
+	return PatchJumpLong( jump, target );
+}
+
+//*****************************************************************************
+//	Decode the target of a jump written by PatchJumpLong
+//*****************************************************************************
+CCodeLabel	GetJumpLongTarget( CJumpLocation jump )
+{
+	const u8 *	p_jump_addr( jump.GetTargetU8P() );
+
+	if( *p_jump_addr == 0xe8 || *p_jump_addr == 0xe9 )
+	{
+		s32		offset( *reinterpret_cast< const s32 * >( p_jump_addr + 1 ) );
+		return CCodeLabel( p_jump_addr + 5 + offset );
+	}
+	else if( *p_jump_addr == 0x0f )
+	{
+		s32		offset( *reinterpret_cast< const s32 * >( p_jump_addr + 2 ) );
+		return CCodeLabel( p_jump_addr + 6 + offset );
+	}
+
+	DAEDALUS_ERROR( "Unhandled jump type" );
+	return CCodeLabel();
+}
+
+}
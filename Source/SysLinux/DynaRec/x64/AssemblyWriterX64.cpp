@@ -0,0 +1,488 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "AssemblyWriterX64.h"
+
+namespace
+{
+	inline bool IsS8( s32 value )	{ return value >= -128 && value <= 127; }
+	inline bool IsS32( s64 value )	{ return value >= s64(-0x7fffffff - 1) && value <= s64(0x7fffffff); }
+
+	// ModRM /digit opcode extensions
+	const u32	ALU_ADD = 0;
+	const u32	ALU_OR  = 1;
+	const u32	ALU_AND = 4;
+	const u32	ALU_SUB = 5;
+	const u32	ALU_XOR = 6;
+	const u32	ALU_CMP = 7;
+
+	const u32	SHIFT_SHL = 4;
+	const u32	SHIFT_SHR = 5;
+	const u32	SHIFT_SAR = 7;
+}
+
+//*****************************************************************************
+//	The REX prefix supplies the 64 bit operand size and the top bit of each
+//	register field. It is needed to access spl/bpl/sil/dil as byte registers.
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitREX( bool is64, u32 reg, u32 index, u32 base, bool force )
+{
+	u8	rex( 0x40 );
+
+	if( is64 )						rex |= 0x08;
+	if( reg & 0x8 )					rex |= 0x04;
+	if( index != INVALID_CODE && (index & 0x8) )	rex |= 0x02;
+	if( base & 0x8 )				rex |= 0x01;
+
+	if( rex != 0x40 || force )
+	{
+		EmitBYTE( rex );
+	}
+}
+
+//*****************************************************************************
+//	Opcodes are emitted most significant byte first (e.g. 0x0fb6 -> 0f b6)
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitOpcode( u32 opcode )
+{
+	if( opcode > 0xffff )	EmitBYTE( u8( opcode >> 16 ) );
+	if( opcode > 0xff )		EmitBYTE( u8( opcode >> 8 ) );
+	EmitBYTE( u8( opcode ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitRegReg( u32 opcode, u32 reg, u32 rm, bool is64, bool byte_reg )
+{
+	EmitREX( is64, reg, INVALID_CODE, rm, byte_reg && ( (reg & 0x7) >= 4 || (rm & 0x7) >= 4 ) );
+	EmitOpcode( opcode );
+	EmitBYTE( 0xc0 | ((reg & 0x7) << 3) | (rm & 0x7) );
+}
+
+//*****************************************************************************
+//	[base + index + offset]
+//	rsp/r12 as a base need a SIB byte, rbp/r13 can't be encoded without a displacement
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitModRMMem( u32 reg, EX64Reg base, EX64Reg index, s32 offset )
+{
+	DAEDALUS_ASSERT( index != RSP_CODE, "rsp can't be used as an index register" );
+
+	u32		mod;
+	if( offset == 0 && (base & 0x7) != RBP_CODE )	mod = 0;
+	else if( IsS8( offset ) )						mod = 1;
+	else											mod = 2;
+
+	if( index == INVALID_CODE && (base & 0x7) != RSP_CODE )
+	{
+		EmitBYTE( u8( (mod << 6) | ((reg & 0x7) << 3) | (base & 0x7) ) );
+	}
+	else
+	{
+		u32	idx( index == INVALID_CODE ? RSP_CODE : (index & 0x7) );		// 100b means 'no index'
+
+		EmitBYTE( u8( (mod << 6) | ((reg & 0x7) << 3) | 0x4 ) );
+		EmitBYTE( u8( (idx << 3) | (base & 0x7) ) );
+	}
+
+	if( mod == 1 )		EmitBYTE( u8( offset ) );
+	else if( mod == 2 )	EmitDWORD( u32( offset ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitMem( u32 opcode, u32 reg, EX64Reg base, EX64Reg index, s32 offset, bool is64, bool byte_reg )
+{
+	EmitREX( is64, reg, index, base, byte_reg && (reg & 0x7) >= 4 );
+	EmitOpcode( opcode );
+	EmitModRMMem( reg, base, index, offset );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitALUImm( u32 ext, EX64Reg reg, s32 data, bool is64 )
+{
+	if( IsS8( data ) )
+	{
+		EmitRegReg( 0x83, ext, reg, is64 );
+		EmitBYTE( u8( data ) );
+	}
+	else
+	{
+		EmitRegReg( 0x81, ext, reg, is64 );
+		EmitDWORD( u32( data ) );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitShift( u32 ext, EX64Reg reg, u8 sa, bool is64 )
+{
+	EmitRegReg( 0xc1, ext, reg, is64 );
+	EmitBYTE( sa );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::PUSH( EX64Reg reg )
+{
+	EmitREX( false, 0, INVALID_CODE, reg, false );
+	EmitBYTE( 0x50 | (reg & 0x7) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::POP( EX64Reg reg )
+{
+	EmitREX( false, 0, INVALID_CODE, reg, false );
+	EmitBYTE( 0x58 | (reg & 0x7) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::ADD( EX64Reg dst, EX64Reg src, bool is64 )		{ EmitRegReg( 0x03, dst, src, is64 ); }
+void	CAssemblyWriterX64::SUB( EX64Reg dst, EX64Reg src, bool is64 )		{ EmitRegReg( 0x2b, dst, src, is64 ); }
+void	CAssemblyWriterX64::AND( EX64Reg dst, EX64Reg src, bool is64 )		{ EmitRegReg( 0x23, dst, src, is64 ); }
+void	CAssemblyWriterX64::OR( EX64Reg dst, EX64Reg src, bool is64 )		{ EmitRegReg( 0x0b, dst, src, is64 ); }
+void	CAssemblyWriterX64::XOR( EX64Reg dst, EX64Reg src, bool is64 )		{ EmitRegReg( 0x33, dst, src, is64 ); }
+void	CAssemblyWriterX64::CMP( EX64Reg a, EX64Reg b, bool is64 )			{ EmitRegReg( 0x3b, a, b, is64 ); }
+void	CAssemblyWriterX64::TEST( EX64Reg a, EX64Reg b, bool is64 )			{ EmitRegReg( 0x85, b, a, is64 ); }
+void	CAssemblyWriterX64::NOT( EX64Reg reg, bool is64 )					{ EmitRegReg( 0xf7, 2, reg, is64 ); }
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::ADDI( EX64Reg reg, s32 data, bool is64 )
+{
+	if( data != 0 )
+	{
+		EmitALUImm( ALU_ADD, reg, data, is64 );
+	}
+	else if( !is64 )
+	{
+		// Still need the upper half cleared
+		MOV( reg, reg, false );
+	}
+}
+
+void	CAssemblyWriterX64::ANDI( EX64Reg reg, s32 data, bool is64 )		{ EmitALUImm( ALU_AND, reg, data, is64 ); }
+void	CAssemblyWriterX64::ORI( EX64Reg reg, s32 data, bool is64 )			{ EmitALUImm( ALU_OR, reg, data, is64 ); }
+void	CAssemblyWriterX64::XORI( EX64Reg reg, s32 data, bool is64 )		{ EmitALUImm( ALU_XOR, reg, data, is64 ); }
+void	CAssemblyWriterX64::CMPI( EX64Reg reg, s32 data, bool is64 )		{ EmitALUImm( ALU_CMP, reg, data, is64 ); }
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::SHLI( EX64Reg reg, u8 sa, bool is64 )			{ EmitShift( SHIFT_SHL, reg, sa, is64 ); }
+void	CAssemblyWriterX64::SHRI( EX64Reg reg, u8 sa, bool is64 )			{ EmitShift( SHIFT_SHR, reg, sa, is64 ); }
+void	CAssemblyWriterX64::SARI( EX64Reg reg, u8 sa, bool is64 )			{ EmitShift( SHIFT_SAR, reg, sa, is64 ); }
+void	CAssemblyWriterX64::SHL_CL( EX64Reg reg, bool is64 )				{ EmitRegReg( 0xd3, SHIFT_SHL, reg, is64 ); }
+void	CAssemblyWriterX64::SHR_CL( EX64Reg reg, bool is64 )				{ EmitRegReg( 0xd3, SHIFT_SHR, reg, is64 ); }
+void	CAssemblyWriterX64::SAR_CL( EX64Reg reg, bool is64 )				{ EmitRegReg( 0xd3, SHIFT_SAR, reg, is64 ); }
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::SETCC( EX64Cond cond, EX64Reg reg )				{ EmitRegReg( 0x0f90 | cond, 0, reg, false, true ); }
+void	CAssemblyWriterX64::MOVZX8( EX64Reg dst, EX64Reg src )				{ EmitRegReg( 0x0fb6, dst, src, false, true ); }
+void	CAssemblyWriterX64::MOVSXD( EX64Reg dst, EX64Reg src )				{ EmitRegReg( 0x63, dst, src, true ); }
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::MOV( EX64Reg dst, EX64Reg src, bool is64 )
+{
+	// A 32 bit self-move is not a nop - it clears the upper half
+	if( dst != src || !is64 )
+	{
+		EmitRegReg( 0x8b, dst, src, is64 );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::MOVI( EX64Reg reg, u32 data )
+{
+	if( data == 0 )
+	{
+		XOR( reg, reg, false );
+	}
+	else
+	{
+		EmitREX( false, 0, INVALID_CODE, reg, false );
+		EmitBYTE( 0xb8 | (reg & 0x7) );
+		EmitDWORD( data );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::MOVI_S64( EX64Reg reg, s32 data )
+{
+	if( data >= 0 )
+	{
+		MOVI( reg, u32( data ) );
+	}
+	else
+	{
+		EmitRegReg( 0xc7, 0, reg, true );
+		EmitDWORD( u32( data ) );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::MOVI_64( EX64Reg reg, u64 data )
+{
+	if( (data >> 32) == 0 )
+	{
+		MOVI( reg, u32( data ) );
+	}
+	else if( IsS32( s64( data ) ) )
+	{
+		MOVI_S64( reg, s32( data ) );
+	}
+	else
+	{
+		EmitREX( true, 0, INVALID_CODE, reg, false );
+		EmitBYTE( 0xb8 | (reg & 0x7) );
+		EmitQWORD( data );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::MOV_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset, bool is64 )
+{
+	EmitMem( 0x8b, dst, base, index, offset, is64 );
+}
+
+void	CAssemblyWriterX64::MOV_MEM_REG( EX64Reg base, EX64Reg index, s32 offset, EX64Reg src, bool is64 )
+{
+	EmitMem( 0x89, src, base, index, offset, is64 );
+}
+
+void	CAssemblyWriterX64::MOV16_MEM_REG( EX64Reg base, EX64Reg index, s32 offset, EX64Reg src )
+{
+	EmitBYTE( 0x66 );
+	EmitMem( 0x89, src, base, index, offset, false );
+}
+
+void	CAssemblyWriterX64::MOV8_MEM_REG( EX64Reg base, EX64Reg index, s32 offset, EX64Reg src )
+{
+	EmitMem( 0x88, src, base, index, offset, false, true );
+}
+
+void	CAssemblyWriterX64::MOVZX8_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset )
+{
+	EmitMem( 0x0fb6, dst, base, index, offset, false );
+}
+
+void	CAssemblyWriterX64::MOVSX8_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset )
+{
+	EmitMem( 0x0fbe, dst, base, index, offset, false );
+}
+
+void	CAssemblyWriterX64::MOVZX16_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset )
+{
+	EmitMem( 0x0fb7, dst, base, index, offset, false );
+}
+
+void	CAssemblyWriterX64::MOVSX16_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset )
+{
+	EmitMem( 0x0fbf, dst, base, index, offset, false );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::MOVI_MEM( EX64Reg base, s32 offset, u32 data )
+{
+	EmitMem( 0xc7, 0, base, INVALID_CODE, offset, false );
+	EmitDWORD( data );
+}
+
+void	CAssemblyWriterX64::MOVI_MEM64( EX64Reg base, s32 offset, s32 data )
+{
+	EmitMem( 0xc7, 0, base, INVALID_CODE, offset, true );
+	EmitDWORD( u32( data ) );
+}
+
+void	CAssemblyWriterX64::ADDI_MEM( EX64Reg base, s32 offset, s32 data )
+{
+	if( IsS8( data ) )
+	{
+		EmitMem( 0x83, ALU_ADD, base, INVALID_CODE, offset, false );
+		EmitBYTE( u8( data ) );
+	}
+	else
+	{
+		EmitMem( 0x81, ALU_ADD, base, INVALID_CODE, offset, false );
+		EmitDWORD( u32( data ) );
+	}
+}
+
+void	CAssemblyWriterX64::CMPI_MEM( EX64Reg base, s32 offset, s32 data )
+{
+	if( IsS8( data ) )
+	{
+		EmitMem( 0x83, ALU_CMP, base, INVALID_CODE, offset, false );
+		EmitBYTE( u8( data ) );
+	}
+	else
+	{
+		EmitMem( 0x81, ALU_CMP, base, INVALID_CODE, offset, false );
+		EmitDWORD( u32( data ) );
+	}
+}
+
+//*****************************************************************************
+//	The mandatory prefix has to come before any REX prefix
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitSSE( u32 opcode, u32 reg, u32 rm, bool is_double, bool is64 )
+{
+	EmitBYTE( is_double ? 0xf2 : 0xf3 );
+	EmitRegReg( opcode, reg, rm, is64 );
+}
+
+void	CAssemblyWriterX64::MOVS_REG_MEM( EX64XmmReg dst, EX64Reg base, s32 offset, bool is_double )
+{
+	EmitBYTE( is_double ? 0xf2 : 0xf3 );
+	EmitMem( 0x0f10, dst, base, INVALID_CODE, offset, false );
+}
+
+void	CAssemblyWriterX64::MOVS_MEM_REG( EX64Reg base, s32 offset, EX64XmmReg src, bool is_double )
+{
+	EmitBYTE( is_double ? 0xf2 : 0xf3 );
+	EmitMem( 0x0f11, src, base, INVALID_CODE, offset, false );
+}
+
+void	CAssemblyWriterX64::ADDS( EX64XmmReg dst, EX64XmmReg src, bool is_double )		{ EmitSSE( 0x0f58, dst, src, is_double ); }
+void	CAssemblyWriterX64::SUBS( EX64XmmReg dst, EX64XmmReg src, bool is_double )		{ EmitSSE( 0x0f5c, dst, src, is_double ); }
+void	CAssemblyWriterX64::MULS( EX64XmmReg dst, EX64XmmReg src, bool is_double )		{ EmitSSE( 0x0f59, dst, src, is_double ); }
+void	CAssemblyWriterX64::DIVS( EX64XmmReg dst, EX64XmmReg src, bool is_double )		{ EmitSSE( 0x0f5e, dst, src, is_double ); }
+void	CAssemblyWriterX64::SQRTS( EX64XmmReg dst, EX64XmmReg src, bool is_double )	{ EmitSSE( 0x0f51, dst, src, is_double ); }
+void	CAssemblyWriterX64::CVTS2S( EX64XmmReg dst, EX64XmmReg src, bool from_double )	{ EmitSSE( 0x0f5a, dst, src, from_double ); }
+
+void	CAssemblyWriterX64::CVTSI2S( EX64XmmReg dst, EX64Reg src, bool is_double, bool is64 )		{ EmitSSE( 0x0f2a, dst, src, is_double, is64 ); }
+void	CAssemblyWriterX64::CVTS2SI( EX64Reg dst, EX64XmmReg src, bool is_double, bool is64 )		{ EmitSSE( 0x0f2d, dst, src, is_double, is64 ); }
+void	CAssemblyWriterX64::CVTTS2SI( EX64Reg dst, EX64XmmReg src, bool is_double, bool is64 )		{ EmitSSE( 0x0f2c, dst, src, is_double, is64 ); }
+
+void	CAssemblyWriterX64::UCOMIS( EX64XmmReg a, EX64XmmReg b, bool is_double )
+{
+	if( is_double )
+	{
+		EmitBYTE( 0x66 );
+	}
+	EmitRegReg( 0x0f2e, a, b, false );
+}
+
+void	CAssemblyWriterX64::LDMXCSR( EX64Reg base, EX64Reg index, s32 offset )
+{
+	EmitMem( 0x0fae, 2, base, index, offset, false );
+}
+
+//*****************************************************************************
+//	Long jumps always use a rel32 so they can be patched later.
+//	If the target isn't set yet we emit a zero offset.
+//*****************************************************************************
+CJumpLocation	CAssemblyWriterX64::JMPLong( CCodeLabel target )
+{
+	const u32		JUMP_LONG_LENGTH = 5;
+
+	CJumpLocation	jump_location( mpAssemblyBuffer->GetJumpLocation() );
+	s32				offset( target.IsSet() ? jump_location.GetOffset( target ) - JUMP_LONG_LENGTH : 0 );
+
+	EmitBYTE( 0xe9 );
+	EmitDWORD( u32( offset ) );
+
+	return jump_location;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation	CAssemblyWriterX64::JCCLong( EX64Cond cond, CCodeLabel target )
+{
+	const u32		JUMP_LONG_LENGTH = 6;
+
+	CJumpLocation	jump_location( mpAssemblyBuffer->GetJumpLocation() );
+	s32				offset( target.IsSet() ? jump_location.GetOffset( target ) - JUMP_LONG_LENGTH : 0 );
+
+	EmitBYTE( 0x0f );
+	EmitBYTE( 0x80 | cond );
+	EmitDWORD( u32( offset ) );
+
+	return jump_location;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::JMP_REG( EX64Reg reg )
+{
+	EmitRegReg( 0xff, 4, reg, false );
+}
+
+void	CAssemblyWriterX64::CALL_REG( EX64Reg reg )
+{
+	EmitRegReg( 0xff, 2, reg, false );
+}
+
+//*****************************************************************************
+//	The code buffer is allocated close to the executable where possible so
+//	most calls are direct. Otherwise go through rax (never an argument register)
+//*****************************************************************************
+void	CAssemblyWriterX64::CALL( CCodeLabel target )
+{
+	const u32	CALL_LONG_LENGTH = 5;
+
+	const u8 *	p_next( mpAssemblyBuffer->GetLabel().GetTargetU8P() + CALL_LONG_LENGTH );
+	s64			offset( target.GetTargetU8P() - p_next );
+
+	if( IsS32( offset ) )
+	{
+		EmitBYTE( 0xe8 );
+		EmitDWORD( u32( s32( offset ) ) );
+	}
+	else
+	{
+		MOVI_PTR( RAX_CODE, target.GetTarget() );
+		CALL_REG( RAX_CODE );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CAssemblyWriterX64::RET()
+{
+	EmitBYTE( 0xc3 );
+}
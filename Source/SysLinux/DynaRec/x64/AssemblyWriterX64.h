@@ -0,0 +1,161 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef SYSLINUX_DYNAREC_X64_ASSEMBLYWRITERX64_H_
+#define SYSLINUX_DYNAREC_X64_ASSEMBLYWRITERX64_H_
+
+#include "DynaRec/AssemblyBuffer.h"
+#include "DynarecTargetX64.h"
+
+class CAssemblyWriterX64
+{
+	public:
+		CAssemblyWriterX64( CAssemblyBuffer * p_buffer )
+			:	mpAssemblyBuffer( p_buffer )
+		{
+		}
+
+	public:
+		CAssemblyBuffer *	GetAssemblyBuffer() const									{ return mpAssemblyBuffer; }
+		void				SetAssemblyBuffer( CAssemblyBuffer * p_buffer )				{ mpAssemblyBuffer = p_buffer; }
+
+	public:
+				inline void NOP()
+				{
+					EmitBYTE(0x90);
+				}
+
+				inline void INT3()
+				{
+					EmitBYTE(0xcc);
+				}
+
+				void				PUSH( EX64Reg reg );
+				void				POP( EX64Reg reg );
+
+				// Register/register ALU ops. The 32 bit forms zero the upper half of the destination
+				void				ADD( EX64Reg dst, EX64Reg src, bool is64 );				// add	dst, src
+				void				SUB( EX64Reg dst, EX64Reg src, bool is64 );
+				void				AND( EX64Reg dst, EX64Reg src, bool is64 );
+				void				OR( EX64Reg dst, EX64Reg src, bool is64 );
+				void				XOR( EX64Reg dst, EX64Reg src, bool is64 );
+				void				CMP( EX64Reg a, EX64Reg b, bool is64 );
+				void				TEST( EX64Reg a, EX64Reg b, bool is64 );
+				void				NOT( EX64Reg reg, bool is64 );
+
+				void				ADDI( EX64Reg reg, s32 data, bool is64 );				// add	reg, imm (sign extended)
+				void				ANDI( EX64Reg reg, s32 data, bool is64 );
+				void				ORI( EX64Reg reg, s32 data, bool is64 );
+				void				XORI( EX64Reg reg, s32 data, bool is64 );
+				void				CMPI( EX64Reg reg, s32 data, bool is64 );
+
+				void				SHLI( EX64Reg reg, u8 sa, bool is64 );
+				void				SHRI( EX64Reg reg, u8 sa, bool is64 );
+				void				SARI( EX64Reg reg, u8 sa, bool is64 );
+				void				SHL_CL( EX64Reg reg, bool is64 );						// shl	reg, cl
+				void				SHR_CL( EX64Reg reg, bool is64 );
+				void				SAR_CL( EX64Reg reg, bool is64 );
+
+				void				SETCC( EX64Cond cond, EX64Reg reg );					// setcc	reg8
+				void				MOVZX8( EX64Reg dst, EX64Reg src );						// movzx	dst32, src8
+				void				MOVSXD( EX64Reg dst, EX64Reg src );						// movsxd	dst64, src32
+
+				void				MOV( EX64Reg dst, EX64Reg src, bool is64 );				// mov	dst, src
+				void				MOVI( EX64Reg reg, u32 data );							// mov	reg32, imm32 (zero extended)
+				void				MOVI_S64( EX64Reg reg, s32 data );						// mov	reg64, imm32 (sign extended)
+				void				MOVI_64( EX64Reg reg, u64 data );						// mov	reg64, imm64
+				void				MOVI_PTR( EX64Reg reg, const void * p )					{ MOVI_64( reg, reinterpret_cast< uintptr_t >( p ) ); }
+
+				// Memory operands are [base + index + offset], index may be INVALID_CODE
+				void				MOV_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset, bool is64 );		// mov	dst, [mem]
+				void				MOV_MEM_REG( EX64Reg base, EX64Reg index, s32 offset, EX64Reg src, bool is64 );		// mov	[mem], src
+				void				MOV16_MEM_REG( EX64Reg base, EX64Reg index, s32 offset, EX64Reg src );				// mov	word ptr [mem], src
+				void				MOV8_MEM_REG( EX64Reg base, EX64Reg index, s32 offset, EX64Reg src );				// mov	byte ptr [mem], src
+				void				MOVZX8_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset );			// movzx	dst32, byte ptr [mem]
+				void				MOVSX8_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset );			// movsx	dst32, byte ptr [mem]
+				void				MOVZX16_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset );			// movzx	dst32, word ptr [mem]
+				void				MOVSX16_REG_MEM( EX64Reg dst, EX64Reg base, EX64Reg index, s32 offset );			// movsx	dst32, word ptr [mem]
+				void				MOVI_MEM( EX64Reg base, s32 offset, u32 data );										// mov	dword ptr [base + offset], data
+				void				MOVI_MEM64( EX64Reg base, s32 offset, s32 data );									// mov	qword ptr [base + offset], data (sign extended)
+				void				ADDI_MEM( EX64Reg base, s32 offset, s32 data );										// add	dword ptr [base + offset], data
+				void				CMPI_MEM( EX64Reg base, s32 offset, s32 data );										// cmp	dword ptr [base + offset], data
+
+				// Scalar SSE ops. is_double picks the sd form (f2 prefix) rather than ss (f3 prefix)
+				void				MOVS_REG_MEM( EX64XmmReg dst, EX64Reg base, s32 offset, bool is_double );			// movsd	dst, [base + offset]
+				void				MOVS_MEM_REG( EX64Reg base, s32 offset, EX64XmmReg src, bool is_double );			// movsd	[base + offset], src
+				void				ADDS( EX64XmmReg dst, EX64XmmReg src, bool is_double );								// addsd	dst, src
+				void				SUBS( EX64XmmReg dst, EX64XmmReg src, bool is_double );
+				void				MULS( EX64XmmReg dst, EX64XmmReg src, bool is_double );
+				void				DIVS( EX64XmmReg dst, EX64XmmReg src, bool is_double );
+				void				SQRTS( EX64XmmReg dst, EX64XmmReg src, bool is_double );
+				void				CVTS2S( EX64XmmReg dst, EX64XmmReg src, bool from_double );							// cvtsd2ss/cvtss2sd	dst, src
+				void				CVTSI2S( EX64XmmReg dst, EX64Reg src, bool is_double, bool is64 );					// cvtsi2sd	dst, src
+				void				CVTS2SI( EX64Reg dst, EX64XmmReg src, bool is_double, bool is64 );					// cvtsd2si	dst, src	(rounds as mxcsr says)
+				void				CVTTS2SI( EX64Reg dst, EX64XmmReg src, bool is_double, bool is64 );					// cvttsd2si	dst, src	(truncates)
+				void				UCOMIS( EX64XmmReg a, EX64XmmReg b, bool is_double );								// ucomisd	a, b
+				void				LDMXCSR( EX64Reg base, EX64Reg index, s32 offset );									// ldmxcsr	[mem]
+
+				CJumpLocation		JMPLong( CCodeLabel target );
+				CJumpLocation		JCCLong( EX64Cond cond, CCodeLabel target );
+				CJumpLocation		JNELong( CCodeLabel target )						{ return JCCLong( X64Cond_NE, target ); }
+				CJumpLocation		JELong( CCodeLabel target )							{ return JCCLong( X64Cond_E, target ); }
+
+				void				JMP_REG( EX64Reg reg );
+				void				CALL_REG( EX64Reg reg );
+				void				CALL( CCodeLabel target );								// Uses rax if the target is out of rel32 range
+				void				RET();
+
+	private:
+				void				EmitREX( bool is64, u32 reg, u32 index, u32 base, bool force );
+				void				EmitRegReg( u32 opcode, u32 reg, u32 rm, bool is64, bool byte_reg = false );
+				void				EmitMem( u32 opcode, u32 reg, EX64Reg base, EX64Reg index, s32 offset, bool is64, bool byte_reg = false );
+				void				EmitOpcode( u32 opcode );
+				void				EmitModRMMem( u32 reg, EX64Reg base, EX64Reg index, s32 offset );
+				void				EmitALUImm( u32 ext, EX64Reg reg, s32 data, bool is64 );
+				void				EmitShift( u32 ext, EX64Reg reg, u8 sa, bool is64 );
+				void				EmitSSE( u32 opcode, u32 reg, u32 rm, bool is_double, bool is64 = false );
+
+		inline void EmitBYTE(u8 byte)
+		{
+			mpAssemblyBuffer->EmitBYTE( byte );
+		}
+
+		inline void EmitWORD(u16 word)
+		{
+			mpAssemblyBuffer->EmitWORD( word );
+		}
+
+		inline void EmitDWORD(u32 dword)
+		{
+			mpAssemblyBuffer->EmitDWORD( dword );
+		}
+
+		inline void EmitQWORD(u64 qword)
+		{
+			mpAssemblyBuffer->EmitDWORD( u32( qword ) );
+			mpAssemblyBuffer->EmitDWORD( u32( qword >> 32 ) );
+		}
+
+	private:
+		CAssemblyBuffer *				mpAssemblyBuffer;
+};
+
+#endif // SYSLINUX_DYNAREC_X64_ASSEMBLYWRITERX64_H_
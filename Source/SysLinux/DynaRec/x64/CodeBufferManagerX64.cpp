@@ -0,0 +1,237 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "DynaRec/CodeBufferManager.h"
+#include "DynaRec/CodeBufferRegions.h"
+
+#include <sys/mman.h>
+
+#include "Core/CPU.h"
+#include "Debug/DBGConsole.h"
+
+#include "CodeGeneratorX64.h"
+
+//
+//	As with the x86 version, the second buffer holds the code which is usually
+//	not executed (slow paths for memory accesses) and comes after the first.
+//
+//	The start of the primary buffer holds the entry thunk which sets up the
+//	callee saved registers used by the fragments (see _EnterDynaRec()).
+//	It's preserved across Reset().
+//
+//	Only the first part of each buffer is used, split into regions which the
+//	fragment cache evicts one at a time (see CCodeBufferRegions).
+//
+static const u32	CODE_BUFFER_SIZE		= 256 * 1024 * 1024;
+static const u32	SECOND_BUFFER_OFFSET	= 192 * 1024 * 1024;
+static const u32	MAX_BLOCK_SIZE			= 32768;
+static const u32	NUM_REGIONS				= 8;
+static const u32	PRIMARY_REGION_SIZE		= 4 * 1024 * 1024;
+static const u32	SECONDARY_REGION_SIZE	= 2 * 1024 * 1024;
+
+DAEDALUS_STATIC_ASSERT( NUM_REGIONS * PRIMARY_REGION_SIZE <= SECOND_BUFFER_OFFSET );
+DAEDALUS_STATIC_ASSERT( NUM_REGIONS * SECONDARY_REGION_SIZE <= CODE_BUFFER_SIZE - SECOND_BUFFER_OFFSET );
+
+class CCodeBufferManagerX64 : public CCodeBufferManager
+{
+public:
+	CCodeBufferManagerX64()
+		:	mpBuffer( NULL )
+		,	mThunkSize( 0 )
+		,	mpSecondBuffer( NULL )
+	{
+	}
+
+	virtual bool			Initialise();
+	virtual void			Reset();
+	virtual void			Finalise();
+
+	virtual CCodeGenerator *StartNewBlock();
+	virtual u32				FinaliseCurrentBlock();
+
+	virtual u32				GetNumRegions() const						{ return mRegions.GetNumRegions(); }
+	virtual u32				GetCurrentRegion() const					{ return mRegions.GetCurrentRegion(); }
+	virtual bool			IsRegionInUse( u32 region ) const			{ return mRegions.IsRegionInUse( region ); }
+	virtual u32				GetNumFreeBlocks() const					{ return mRegions.GetNumFreeBlocks(); }
+	virtual void			FreeRegion( u32 region )					{ mRegions.FreeRegion( region ); }
+	virtual bool			IsInRegion( u32 region, const void * p ) const;
+
+private:
+	static	u8 *			AllocateBuffer();
+
+private:
+
+	u8	*					mpBuffer;
+	u32						mThunkSize;
+
+	u8 *					mpSecondBuffer;
+
+	CCodeBufferRegions		mRegions;
+
+private:
+	CAssemblyBuffer			mPrimaryBuffer;
+	CAssemblyBuffer			mSecondaryBuffer;
+};
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeBufferManager *	CCodeBufferManager::Create()
+{
+	return new CCodeBufferManagerX64;
+}
+
+//*****************************************************************************
+//	Try to place the buffer within rel32 range of the executable so calls to
+//	the R4300 handlers can be direct. If that fails anywhere will do, the code
+//	generator falls back to calling through a register.
+//*****************************************************************************
+u8 *	CCodeBufferManagerX64::AllocateBuffer()
+{
+	const int		prot( PROT_READ | PROT_WRITE | PROT_EXEC );
+	const int		flags( MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE );
+	const uintptr_t	text( reinterpret_cast< uintptr_t >( &CPU_UpdateCounter ) & ~uintptr_t( 0xfffff ) );
+	const uintptr_t	max_distance( 0x60000000 );
+
+	for( u32 i = 1; i <= 4; ++i )
+	{
+		uintptr_t	hint( text - i * uintptr_t( CODE_BUFFER_SIZE ) );
+		if( hint > text )
+			break;
+
+		void *	p( mmap( reinterpret_cast< void * >( hint ), CODE_BUFFER_SIZE, prot, flags, -1, 0 ) );
+		if( p == MAP_FAILED )
+			continue;
+
+		uintptr_t	addr( reinterpret_cast< uintptr_t >( p ) );
+		uintptr_t	distance( addr < text ? text - addr : addr - text );
+		if( distance < max_distance )
+			return reinterpret_cast< u8 * >( p );
+
+		munmap( p, CODE_BUFFER_SIZE );
+	}
+
+	void *	p( mmap( NULL, CODE_BUFFER_SIZE, prot, flags, -1, 0 ) );
+	if( p == MAP_FAILED )
+		return NULL;
+
+	DBGConsole_Msg( 0, "Dynarec buffer is not near the executable - calls will be indirect" );
+	return reinterpret_cast< u8 * >( p );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool	CCodeBufferManagerX64::Initialise()
+{
+	// Reserve a huge range of memory. We can't grow the buffer by copying
+	// (this would mess up all the existing jumps), but MAP_NORESERVE means
+	// pages are only committed as they are touched.
+	mpBuffer = AllocateBuffer();
+	if (mpBuffer == NULL)
+		return false;
+
+	mpSecondBuffer = mpBuffer + SECOND_BUFFER_OFFSET;
+
+	mPrimaryBuffer.SetBuffer( mpBuffer );
+	gEnterDynaRecThunk = CCodeGeneratorX64::GenerateEntryThunk( &mPrimaryBuffer );
+
+	mThunkSize = (mPrimaryBuffer.GetSize() + 15) & (~15);
+
+	mRegions.Initialise( NUM_REGIONS, mThunkSize, PRIMARY_REGION_SIZE, 0, SECONDARY_REGION_SIZE, 16, MAX_BLOCK_SIZE );
+
+	return true;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeBufferManagerX64::Reset()
+{
+	mRegions.Reset();
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeBufferManagerX64::Finalise()
+{
+	if (mpBuffer != NULL)
+	{
+		munmap( mpBuffer, CODE_BUFFER_SIZE );
+		mpBuffer = NULL;
+	}
+
+	mpSecondBuffer = NULL;
+	gEnterDynaRecThunk = NULL;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeGenerator * CCodeBufferManagerX64::StartNewBlock()
+{
+	u32		region( mRegions.GetCurrentRegion() );
+	u32		buffer_ptr( mRegions.GetPrimaryPtr() );
+
+	// We assume that no single entry will generate more than 32k of storage.
+	// The fragment cache evicts a region before they all fill up.
+	bool	ok( mRegions.StartNewBlock() );
+	DAEDALUS_ASSERT( ok, "Dynarec buffer overflow" );
+
+	// Pad up to the 16 byte boundry
+	u32		aligned_ptr( mRegions.GetPrimaryPtr() );
+	if( mRegions.GetCurrentRegion() == region && aligned_ptr > buffer_ptr )
+	{
+		memset( mpBuffer + buffer_ptr, 0xcc, aligned_ptr - buffer_ptr );		// 0xcc is 'int 3'
+	}
+
+	mPrimaryBuffer.SetBuffer( mpBuffer + aligned_ptr );
+	mSecondaryBuffer.SetBuffer( mpSecondBuffer + mRegions.GetSecondaryPtr() );
+
+	return new CCodeGeneratorX64( &mPrimaryBuffer, &mSecondaryBuffer );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 CCodeBufferManagerX64::FinaliseCurrentBlock()
+{
+	u32		main_block_size( mPrimaryBuffer.GetSize() );
+
+	mRegions.FinaliseBlock( main_block_size, mSecondaryBuffer.GetSize() );
+
+	return main_block_size;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool CCodeBufferManagerX64::IsInRegion( u32 region, const void * p ) const
+{
+	const u8 *	p_u8( reinterpret_cast< const u8 * >( p ) );
+
+	if( p_u8 >= mpSecondBuffer )
+	{
+		return mRegions.IsSecondaryInRegion( region, u32( p_u8 - mpSecondBuffer ) );
+	}
+
+	return mRegions.IsPrimaryInRegion( region, u32( p_u8 - mpBuffer ) );
+}
@@ -0,0 +1,1797 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+
+#include "stdafx.h"
+#include "CodeGeneratorX64.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+
+#include "Core/CPU.h"
+#include "Core/Memory.h"
+#include "Core/R4300.h"
+#include "Core/Registers.h"
+#include "Config/ConfigOptions.h"
+#include "Debug/DBGConsole.h"
+#include "OSHLE/ultra_R4300.h"
+#include "DynaRec/AssemblyUtils.h"
+#include "DynaRec/DynaRecProfile.h"
+#include "DynaRec/IndirectExitMap.h"
+#include "DynaRec/StaticAnalysis.h"
+#include "DynaRec/Trace.h"
+
+
+using namespace AssemblyUtils;
+
+// XX this optimisation works very well on the PSP, option to disable it was removed
+static const bool		gDynarecStackOptimisation = true;
+
+// Minimum live span (in instructions) for a register to be worth caching
+static const u32		MIN_CACHE_SPAN = 2;
+
+EnterDynaRecThunk		gEnterDynaRecThunk = NULL;
+
+DAEDALUS_STATIC_ASSERT( sizeof( MemFuncRead ) == 16 );
+DAEDALUS_STATIC_ASSERT( sizeof( MemFuncWrite ) == 16 );
+DAEDALUS_STATIC_ASSERT( NUM_X64_CACHE_REGISTERS <= SRegisterContract::MAX_SLOTS );
+
+//*****************************************************************************
+//	XXXX
+//*****************************************************************************
+void Dynarec_ClearedCPUStuffToDo()
+{
+}
+void Dynarec_SetCPUStuffToDo()
+{
+}
+
+//*****************************************************************************
+//	All the state we touch lives in gCPUState, which is addressed through r15
+//*****************************************************************************
+static inline s32 CPUStateOffset( const void * p_var )
+{
+	s32		offset( s32( reinterpret_cast< const u8 * >( p_var ) - reinterpret_cast< const u8 * >( &gCPUState ) ) );
+
+	DAEDALUS_ASSERT( offset >= 0 && u32( offset ) < sizeof( SCPUState ), "Variable is not in gCPUState" );
+	return offset;
+}
+
+static inline s32 GPROffset( EN64Reg reg )
+{
+	return CPUStateOffset( &gCPUState.CPU[ reg ] );
+}
+
+static inline s32 FPROffset( u32 reg )
+{
+	return CPUStateOffset( &gCPUState.FPU[ reg ] );
+}
+
+static inline s32 FCR31Offset()
+{
+	return CPUStateOffset( &gCPUState.FPUControl[ 31 ] );
+}
+
+//*****************************************************************************
+//	mxcsr values (all exceptions masked) for each FCR31 rounding mode:
+//	RN, RZ, RP, RM
+//*****************************************************************************
+static const u32		gMXCSRRoundingModes[ 4 ] = { 0x1F80, 0x7F80, 0x5F80, 0x3F80 };
+
+//*****************************************************************************
+//	KSEG0/KSEG1 RDRAM, which can be accessed straight through X64Reg_RamBase
+//*****************************************************************************
+static inline bool IsDirectRamAddress( u32 address, u32 bytes )
+{
+	return ( address >> 30 ) == 2 && ( address & 0x1FFFFFFF ) + bytes <= gRamSize && ( address & ( bytes - 1 ) ) == 0;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeGeneratorX64::CCodeGeneratorX64( CAssemblyBuffer * p_primary, CAssemblyBuffer * p_secondary )
+:	CCodeGenerator( )
+,	CAssemblyWriterX64( p_primary )
+,	mpPrimary( p_primary )
+,	mpSecondary( p_secondary )
+,	mHostRoundingMode( HRM_UNKNOWN )
+,	mUsedFixedRoundingMode( false )
+{
+	std::fill( mCachedRegisters, mCachedRegisters + NUM_N64_REGS, INVALID_CODE );
+}
+
+//*****************************************************************************
+//	Called once when the code buffer is created. Saves the callee saved
+//	registers we use in the fragments and sets up r15/r14:
+//		_EnterDynaRec( p_function, p_base_pointer, p_rebased_mem )
+//	The six pushes plus the call leave the stack 16 byte aligned inside the
+//	fragment, as the ABI requires for the calls we make from there.
+//*****************************************************************************
+EnterDynaRecThunk	CCodeGeneratorX64::GenerateEntryThunk( CAssemblyBuffer * p_buffer )
+{
+	CAssemblyWriterX64	writer( p_buffer );
+
+	writer.PUSH( RBX_CODE );
+	writer.PUSH( RBP_CODE );
+	writer.PUSH( R12_CODE );
+	writer.PUSH( R13_CODE );
+	writer.PUSH( R14_CODE );
+	writer.PUSH( R15_CODE );
+
+	writer.MOV( X64Reg_CPUState, X64Reg_Arg1, true );
+	writer.MOV( X64Reg_RamBase, X64Reg_Arg2, true );
+	writer.CALL_REG( X64Reg_Arg0 );
+
+	writer.POP( R15_CODE );
+	writer.POP( R14_CODE );
+	writer.POP( R13_CODE );
+	writer.POP( R12_CODE );
+	writer.POP( RBP_CODE );
+	writer.POP( RBX_CODE );
+	writer.RET();
+
+	return reinterpret_cast< EnterDynaRecThunk >( const_cast< void * >( p_buffer->GetStartAddress().GetTarget() ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::Finalise( ExceptionHandlerFn p_exception_handler_fn, const std::vector< CJumpLocation > & exception_handler_jumps )
+{
+	if( !exception_handler_jumps.empty() )
+	{
+		GenerateExceptionHander( p_exception_handler_fn, exception_handler_jumps );
+	}
+
+	SetAssemblyBuffer( NULL );
+	mpPrimary = NULL;
+	mpSecondary = NULL;
+}
+
+//*****************************************************************************
+//	Pick the registers with the longest live spans (base registers get a
+//	bonus as they're used for the address calculation) and load them up.
+//	Registers keep to the slots RegisterContract_AssignSlots() gives them, so
+//	linked exits from fragments which already hold them can skip the loads.
+//*****************************************************************************
+void	CCodeGeneratorX64::Initialise( u32 /*entry_address*/, u32 /*exit_address*/, u32 * hit_counter, const void * /*p_base*/, const SRegisterUsageInfo & register_usage )
+{
+	u32		scores[ NUM_N64_REGS ];
+	std::fill( scores, scores + NUM_N64_REGS, 0 );
+
+	for( RegisterSpanList::const_iterator it = register_usage.SpanList.begin(); it != register_usage.SpanList.end(); ++it )
+	{
+		const SRegisterSpan &	span( *it );
+		if( span.Register == N64Reg_R0 )
+			continue;
+
+		u32		length( span.SpanEnd - span.SpanStart + 1 );
+		if( length < MIN_CACHE_SPAN )
+			continue;
+
+		scores[ span.Register ] = length + (register_usage.IsBase( span.Register ) ? length / 2 : 0);
+	}
+
+	mConstants.SetEnabled( gDynarecConstantPropagation );
+
+	mHostRoundingMode = HRM_UNKNOWN;
+	mUsedFixedRoundingMode = false;
+
+	EN64Reg		slot_regs[ NUM_X64_CACHE_REGISTERS ];
+	RegisterContract_AssignSlots( scores, NUM_X64_CACHE_REGISTERS, slot_regs );
+
+	mEntryContract.Clear();
+	for( u32 i = 0; i < NUM_X64_CACHE_REGISTERS; ++i )
+	{
+		EN64Reg		reg( slot_regs[ i ] );
+		if( reg == N64Reg_R0 )
+			continue;
+
+		mCachedRegisters[ reg ] = gX64CacheRegisters[ i ];
+
+		// Registers which are written before they're read don't need loading. They're
+		// left out of the contract, as the slot doesn't hold them until then.
+		if( register_usage.IsLiveIn( reg ) )
+		{
+			mEntryContract.Slots[ i ] = u8( reg );
+			MOV_REG_MEM( gX64CacheRegisters[ i ], X64Reg_CPUState, INVALID_CODE, GPROffset( reg ), true );
+		}
+	}
+
+	// The cache is write-through, so every exit holds mEntryContract too
+	mLinkedEntryPoint = GetCurrentLocation();
+
+	if( hit_counter != NULL )
+	{
+		MOVI_PTR( RAX_CODE, hit_counter );
+		ADDI_MEM( RAX_CODE, 0, 1 );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::UpdateRegisterCaching( u32 /*instruction_idx*/ )
+{
+	// Registers are assigned for the whole fragment in Initialise()
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+RegisterSnapshotHandle	CCodeGeneratorX64::GetRegisterSnapshot()
+{
+	// The cache is write-through, so there's nothing to snapshot
+	return RegisterSnapshotHandle( 0 );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeLabel	CCodeGeneratorX64::GetEntryPoint() const
+{
+	return mpPrimary->GetStartAddress();
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeLabel	CCodeGeneratorX64::GetCurrentLocation() const
+{
+	return mpPrimary->GetLabel();
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32	CCodeGeneratorX64::GetCompiledCodeSize() const
+{
+	return mpPrimary->GetSize() + mpSecondary->GetSize();
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::LoadRegister( EX64Reg dst, EN64Reg src )
+{
+	EX64Reg		cached( GetCachedRegister( src ) );
+
+	if( src == N64Reg_R0 )
+	{
+		XOR( dst, dst, false );
+	}
+	else if( cached != INVALID_CODE )
+	{
+		MOV( dst, cached, true );
+	}
+	else
+	{
+		MOV_REG_MEM( dst, X64Reg_CPUState, INVALID_CODE, GPROffset( src ), true );
+	}
+}
+
+//*****************************************************************************
+//	Load the low 32 bits of src, zero extended
+//*****************************************************************************
+void	CCodeGeneratorX64::LoadRegister32( EX64Reg dst, EN64Reg src )
+{
+	EX64Reg		cached( GetCachedRegister( src ) );
+
+	if( src == N64Reg_R0 )
+	{
+		XOR( dst, dst, false );
+	}
+	else if( cached != INVALID_CODE )
+	{
+		MOV( dst, cached, false );
+	}
+	else
+	{
+		MOV_REG_MEM( dst, X64Reg_CPUState, INVALID_CODE, GPROffset( src ), false );
+	}
+}
+
+//*****************************************************************************
+//	Returns the host register holding src, loading it into scratch if it's not cached
+//*****************************************************************************
+EX64Reg	CCodeGeneratorX64::GetRegisterAndLoad( EN64Reg src, EX64Reg scratch )
+{
+	EX64Reg		cached( GetCachedRegister( src ) );
+	if( cached != INVALID_CODE )
+		return cached;
+
+	LoadRegister( scratch, src );
+	return scratch;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::StoreRegister( EN64Reg dst, EX64Reg src )
+{
+	DAEDALUS_ASSERT( dst != N64Reg_R0, "Writing to r0" );
+
+	EX64Reg		cached( GetCachedRegister( dst ) );
+
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, GPROffset( dst ), src, true );
+	if( cached != INVALID_CODE )
+	{
+		MOV( cached, src, true );
+	}
+}
+
+//*****************************************************************************
+//	Sign extend the low 32 bits of src and store
+//*****************************************************************************
+void	CCodeGeneratorX64::StoreRegister32s( EN64Reg dst, EX64Reg src )
+{
+	MOVSXD( src, src );
+	StoreRegister( dst, src );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::SetRegister32s( EN64Reg dst, s32 value )
+{
+	EX64Reg		cached( GetCachedRegister( dst ) );
+
+	MOVI_MEM64( X64Reg_CPUState, GPROffset( dst ), value );
+	if( cached != INVALID_CODE )
+	{
+		MOVI_S64( cached, value );
+	}
+}
+
+//*****************************************************************************
+//	Reload any cached registers in gpr_mask after calling out to C.
+//	Handlers may write r0, so put that back too. Doesn't touch the flags or rax.
+//*****************************************************************************
+void	CCodeGeneratorX64::ReloadCachedRegisters( u32 gpr_mask )
+{
+	if( gpr_mask & 1 )
+	{
+		MOVI_MEM64( X64Reg_CPUState, GPROffset( N64Reg_R0 ), 0 );
+	}
+
+	for( u32 reg = 1; reg < NUM_N64_REGS; ++reg )
+	{
+		EX64Reg		cached( mCachedRegisters[ reg ] );
+
+		if( cached != INVALID_CODE && (gpr_mask & (1 << reg)) )
+		{
+			MOV_REG_MEM( cached, X64Reg_CPUState, INVALID_CODE, GPROffset( EN64Reg( reg ) ), true );
+		}
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation CCodeGeneratorX64::GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment )
+{
+	DAEDALUS_ASSERT( !next_fragment.IsSet() || jump_address == 0, "Shouldn't be specifying a jump address if we have a next fragment?" );
+
+#ifdef _DEBUG
+	if(exit_address == u32(~0))
+	{
+		INT3();
+	}
+#endif
+
+	RestoreGuestRoundingMode();
+
+	MOVI( X64Reg_Arg0, num_instructions );
+	CALL( CCodeLabel( reinterpret_cast< const void * >( CPU_UpdateCounter ) ) );
+
+	// This jump may be NULL, in which case we patch it below
+	// This gets patched with a jump to the next fragment if the target is later found
+	CJumpLocation jump_to_next_fragment( GenerateBranchIfNotSet( const_cast< u32 * >( &gCPUState.StuffToDo ), next_fragment ) );
+
+	// If the flag was set, we need in initialise the pc/delay to exit with
+	CCodeLabel interpret_next_fragment( GetAssemblyBuffer()->GetLabel() );
+
+	u32		exit_delay;
+
+	if( jump_address != 0 )
+	{
+		SetVar( &gCPUState.TargetPC, jump_address );
+		exit_delay = EXEC_DELAY;
+	}
+	else
+	{
+		exit_delay = NO_DELAY;
+	}
+
+	SetVar( &gCPUState.Delay, exit_delay );
+	SetVar( &gCPUState.CurrentPC, exit_address );
+
+	// No need to call CPU_SetPC(), as this is handled by CFragment when we exit
+	RET();
+
+	// Patch up the exit jump
+	if( !next_fragment.IsSet() )
+	{
+		PatchJumpLong( jump_to_next_fragment, interpret_next_fragment );
+	}
+
+	return jump_to_next_fragment;
+}
+
+//*****************************************************************************
+// Handle branching back to the interpreter after an ERET
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * /*p_map*/ )
+{
+	RestoreGuestRoundingMode();
+
+	MOVI( X64Reg_Arg0, num_instructions );
+	CALL( CCodeLabel( reinterpret_cast< const void * >( CPU_UpdateCounter ) ) );
+
+	// We always exit to the interpreter, regardless of the state of gCPUState.StuffToDo
+
+	// Eret is a bit bodged so we exit at PC + 4
+	ADDI_MEM( X64Reg_CPUState, CPUStateOffset( &gCPUState.CurrentPC ), 4 );
+	SetVar( &gCPUState.Delay, NO_DELAY );
+
+	// No need to call CPU_SetPC(), as this is handled by CFragment when we exit
+
+	RET();
+}
+
+//*****************************************************************************
+// Handle branching back to the interpreter after an indirect jump
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map )
+{
+	RestoreGuestRoundingMode();
+
+	MOVI( X64Reg_Arg0, num_instructions );
+	CALL( CCodeLabel( reinterpret_cast< const void * >( CPU_UpdateCounter ) ) );
+
+	CCodeLabel		no_target( NULL );
+	CJumpLocation	jump_to_next_fragment( GenerateBranchIfNotSet( const_cast< u32 * >( &gCPUState.StuffToDo ), no_target ) );
+
+	CCodeLabel		exit_dynarec( GetAssemblyBuffer()->GetLabel() );
+	// New return address is in gCPUState.TargetPC
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, CPUStateOffset( &gCPUState.TargetPC ), false );
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, CPUStateOffset( &gCPUState.CurrentPC ), RAX_CODE, false );
+	SetVar( &gCPUState.Delay, NO_DELAY );
+
+	// No need to call CPU_SetPC(), as this is handled by CFragment when we exit
+
+	RET();
+
+	// gCPUState.StuffToDo == 0, try to jump to the indirect target
+	PatchJumpLong( jump_to_next_fragment, GetAssemblyBuffer()->GetLabel() );
+
+#ifdef DAEDALUS_ENABLE_DYNAREC_PROFILE
+	// Let IndirectExitMap_Lookup do the checks so that it sees every hit
+	const void *	p_lookup( reinterpret_cast< const void * >( IndirectExitMap_Lookup ) );
+#else
+	const void *	p_lookup( reinterpret_cast< const void * >( IndirectExitMap_LookupAndCache ) );
+
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, CPUStateOffset( &gCPUState.TargetPC ), false );
+
+	if( p_map->IsReturn() )
+	{
+		// rdx = gReturnStack.Entries[ Top-- & RETURN_STACK_MASK ]
+		MOVI_PTR( RDX_CODE, &gReturnStack );
+		MOV_REG_MEM( RCX_CODE, RDX_CODE, INVALID_CODE, offsetof( SReturnStack, Top ), false );
+		ADDI( RCX_CODE, -1, false );
+		MOV_MEM_REG( RDX_CODE, INVALID_CODE, offsetof( SReturnStack, Top ), RCX_CODE, false );
+		ADDI( RCX_CODE, 1, false );
+		ANDI( RCX_CODE, RETURN_STACK_MASK, false );
+		SHLI( RCX_CODE, 3, false );
+		MOV_REG_MEM( RDX_CODE, RDX_CODE, RCX_CODE, offsetof( SReturnStack, Entries ), true );
+
+		MOV_REG_MEM( RCX_CODE, RDX_CODE, INVALID_CODE, offsetof( SIndirectExitEntry, Address ), false );
+		CMP( RAX_CODE, RCX_CODE, false );
+		CJumpLocation	wrong_address( JNELong( CCodeLabel() ) );
+		MOV_REG_MEM( RDX_CODE, RDX_CODE, INVALID_CODE, offsetof( SIndirectExitEntry, Target ), true );
+		TEST( RDX_CODE, RDX_CODE, true );
+		CJumpLocation	not_compiled( JELong( CCodeLabel() ) );
+		JMP_REG( RDX_CODE );
+
+		CCodeLabel		check_cache( GetAssemblyBuffer()->GetLabel() );
+		PatchJumpLong( wrong_address, check_cache );
+		PatchJumpLong( not_compiled, check_cache );
+	}
+
+	// Filled entries always have a target
+	const SIndirectExitEntry *	entries( p_map->GetEntries() );
+	for( u32 i = 0; i < CIndirectExitMap::NUM_ENTRIES; ++i )
+	{
+		MOVI_PTR( RDX_CODE, &entries[ i ] );
+		MOV_REG_MEM( RCX_CODE, RDX_CODE, INVALID_CODE, offsetof( SIndirectExitEntry, Address ), false );
+		CMP( RAX_CODE, RCX_CODE, false );
+		CJumpLocation	miss( JNELong( CCodeLabel() ) );
+		MOV_REG_MEM( RDX_CODE, RDX_CODE, INVALID_CODE, offsetof( SIndirectExitEntry, Target ), true );
+		JMP_REG( RDX_CODE );
+		PatchJumpLong( miss, GetAssemblyBuffer()->GetLabel() );
+	}
+#endif
+
+	MOVI_PTR( X64Reg_Arg0, p_map );
+	MOV_REG_MEM( X64Reg_Arg1, X64Reg_CPUState, INVALID_CODE, CPUStateOffset( &gCPUState.TargetPC ), false );
+	CALL( CCodeLabel( p_lookup ) );
+
+	// If the target was not found, exit
+	TEST( RAX_CODE, RAX_CODE, true );
+	JELong( exit_dynarec );
+
+	JMP_REG( RAX_CODE );
+}
+
+//*****************************************************************************
+// gReturnStack.Entries[ ++Top & RETURN_STACK_MASK ] = p_return_site
+//*****************************************************************************
+void CCodeGeneratorX64::GeneratePushReturnAddress( SIndirectExitEntry * p_return_site )
+{
+	MOVI_PTR( RDX_CODE, &gReturnStack );
+	MOV_REG_MEM( RCX_CODE, RDX_CODE, INVALID_CODE, offsetof( SReturnStack, Top ), false );
+	ADDI( RCX_CODE, 1, false );
+	MOV_MEM_REG( RDX_CODE, INVALID_CODE, offsetof( SReturnStack, Top ), RCX_CODE, false );
+	ANDI( RCX_CODE, RETURN_STACK_MASK, false );
+	SHLI( RCX_CODE, 3, false );
+	MOVI_PTR( RAX_CODE, p_return_site );
+	MOV_MEM_REG( RDX_CODE, RCX_CODE, offsetof( SReturnStack, Entries ), RAX_CODE, true );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateExceptionHander( ExceptionHandlerFn p_exception_handler_fn, const std::vector< CJumpLocation > & exception_handler_jumps )
+{
+	CCodeLabel exception_handler( GetAssemblyBuffer()->GetLabel() );
+
+	mHostRoundingMode = HRM_UNKNOWN;
+	RestoreGuestRoundingMode();
+
+	CALL( CCodeLabel( reinterpret_cast< const void * >( p_exception_handler_fn ) ) );
+	RET();
+
+	for( std::vector< CJumpLocation >::const_iterator it = exception_handler_jumps.begin(); it != exception_handler_jumps.end(); ++it )
+	{
+		CJumpLocation	jump( *it );
+		PatchJumpLong( jump, exception_handler );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::SetVar( u32 * p_var, u32 value )
+{
+	MOVI_MEM( X64Reg_CPUState, CPUStateOffset( p_var ), value );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateBranchHandler( CJumpLocation branch_handler_jump, RegisterSnapshotHandle /*snapshot*/ )
+{
+	PatchJumpLong( branch_handler_jump, GetAssemblyBuffer()->GetLabel() );
+
+	// We're off the path the constants were tracked along
+	mConstants.Reset();
+	mHostRoundingMode = HRM_UNKNOWN;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateBranchAlways( CCodeLabel target )
+{
+	return JMPLong( target );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateBranchIfSet( const u32 * p_var, CCodeLabel target )
+{
+	CMPI_MEM( X64Reg_CPUState, CPUStateOffset( p_var ), 0 );
+
+	return JNELong( target );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateBranchIfNotSet( const u32 * p_var, CCodeLabel target )
+{
+	CMPI_MEM( X64Reg_CPUState, CPUStateOffset( p_var ), 0 );
+
+	return JELong( target );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateBranchIfEqual( const u32 * p_var, u32 value, CCodeLabel target )
+{
+	CMPI_MEM( X64Reg_CPUState, CPUStateOffset( p_var ), s32( value ) );
+
+	return JELong( target );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateBranchIfNotEqual( const u32 * p_var, u32 value, CCodeLabel target )
+{
+	CMPI_MEM( X64Reg_CPUState, CPUStateOffset( p_var ), s32( value ) );
+
+	return JNELong( target );
+}
+
+//*****************************************************************************
+//	Generates instruction handler for the specified op code.
+//	Returns a jump location if an exception handler is required
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateOpCode( const STraceEntry& ti, bool branch_delay_slot, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump)
+{
+	u32 address = ti.Address;
+	OpCode op_code = ti.OpCode;
+
+	CJumpLocation	exception_handler;
+	CCodeLabel		no_target( NULL );
+
+	if (op_code._u32 == 0)
+	{
+		if( branch_delay_slot )
+		{
+			SetVar( &gCPUState.Delay, NO_DELAY );
+		}
+		return CJumpLocation();
+	}
+
+	if( branch_delay_slot )
+	{
+		SetVar( &gCPUState.Delay, EXEC_DELAY );
+	}
+
+	const EN64Reg	rs = EN64Reg( op_code.rs );
+	const EN64Reg	rt = EN64Reg( op_code.rt );
+	const EN64Reg	rd = EN64Reg( op_code.rd );
+	const u32		sa = op_code.sa;
+
+	// Native branches set *p_branch_jump themselves. Anything without branch
+	// details (e.g. in a delay slot) goes through the interpreter.
+	const bool		can_branch( p_branch != NULL && p_branch_jump != NULL );
+
+	// Branches on known values always go the way the trace did, so there's nothing to check
+	bool			known_taken;
+	if( can_branch && mConstants.GetBranchTaken( op_code, &known_taken ) && known_taken == p_branch->ConditionalBranchTaken )
+	{
+		return CJumpLocation();
+	}
+
+	bool handled = false;
+	switch(op_code.op)
+	{
+		case OP_J:			handled = true; break;
+		case OP_JAL:		GenerateJAL( address ); handled = true; break;
+
+		case OP_BEQ:
+		case OP_BEQL:
+			if( can_branch ) { GenerateBranchCompare( rs, rt, X64Cond_E, p_branch, p_branch_jump ); handled = true; }
+			break;
+		case OP_BNE:
+		case OP_BNEL:
+			if( can_branch ) { GenerateBranchCompare( rs, rt, X64Cond_NE, p_branch, p_branch_jump ); handled = true; }
+			break;
+		case OP_BLEZ:
+		case OP_BLEZL:
+			if( can_branch ) { GenerateBranchZero( rs, X64Cond_LE, p_branch, p_branch_jump ); handled = true; }
+			break;
+		case OP_BGTZ:
+		case OP_BGTZL:
+			if( can_branch ) { GenerateBranchZero( rs, X64Cond_G, p_branch, p_branch_jump ); handled = true; }
+			break;
+
+		case OP_REGIMM:
+			switch( op_code.regimm_op )
+			{
+			case RegImmOp_BLTZ:
+			case RegImmOp_BLTZL:
+				if( can_branch ) { GenerateBranchZero( rs, X64Cond_L, p_branch, p_branch_jump ); handled = true; }
+				break;
+			case RegImmOp_BGEZ:
+			case RegImmOp_BGEZL:
+				if( can_branch ) { GenerateBranchZero( rs, X64Cond_GE, p_branch, p_branch_jump ); handled = true; }
+				break;
+			}
+			break;
+
+		case OP_ADDI:
+		case OP_ADDIU:		GenerateADDIU( rt, rs, s16( op_code.immediate ) ); handled = true; break;
+		case OP_DADDI:
+		case OP_DADDIU:		GenerateDADDIU( rt, rs, s16( op_code.immediate ) ); handled = true; break;
+		case OP_SLTI:		GenerateSLTI( rt, rs, s16( op_code.immediate ), false ); handled = true; break;
+		case OP_SLTIU:		GenerateSLTI( rt, rs, s16( op_code.immediate ), true ); handled = true; break;
+		case OP_ANDI:		GenerateANDI( rt, rs, op_code.immediate ); handled = true; break;
+		case OP_ORI:		GenerateORI( rt, rs, op_code.immediate ); handled = true; break;
+		case OP_XORI:		GenerateXORI( rt, rs, op_code.immediate ); handled = true; break;
+		case OP_LUI:		GenerateLUI( rt, op_code.immediate ); handled = true; break;
+
+		case OP_LB:			handled = GenerateLoad( &exception_handler, address, op_code, U8_TWIDDLE, 8, true ); break;
+		case OP_LBU:		handled = GenerateLoad( &exception_handler, address, op_code, U8_TWIDDLE, 8, false ); break;
+		case OP_LH:			handled = GenerateLoad( &exception_handler, address, op_code, U16_TWIDDLE, 16, true ); break;
+		case OP_LHU:		handled = GenerateLoad( &exception_handler, address, op_code, U16_TWIDDLE, 16, false ); break;
+		case OP_LW:			handled = GenerateLoad( &exception_handler, address, op_code, 0, 32, true ); break;
+		case OP_LWU:		handled = GenerateLoad( &exception_handler, address, op_code, 0, 32, false ); break;
+		case OP_SB:			handled = GenerateStore( &exception_handler, address, op_code, U8_TWIDDLE, 8 ); break;
+		case OP_SH:			handled = GenerateStore( &exception_handler, address, op_code, U16_TWIDDLE, 16 ); break;
+		case OP_SW:			handled = GenerateStore( &exception_handler, address, op_code, 0, 32 ); break;
+
+		case OP_COPRO1:		handled = GenerateCop1( op_code, can_branch ? p_branch : NULL, p_branch_jump ); break;
+
+		case OP_SPECOP:
+			switch( op_code.spec_op )
+			{
+			case SpecOp_SLL:
+			case SpecOp_SRL:
+			case SpecOp_SRA:	GenerateShift32( rd, rt, sa, op_code.spec_op ); handled = true; break;
+			case SpecOp_SLLV:
+			case SpecOp_SRLV:
+			case SpecOp_SRAV:	GenerateShift32V( rd, rt, rs, op_code.spec_op ); handled = true; break;
+			case SpecOp_DSLL:
+			case SpecOp_DSRL:
+			case SpecOp_DSRA:	GenerateShift64( rd, rt, sa, op_code.spec_op ); handled = true; break;
+			case SpecOp_DSLL32:
+			case SpecOp_DSRL32:
+			case SpecOp_DSRA32:	GenerateShift64( rd, rt, sa + 32, op_code.spec_op ); handled = true; break;
+			case SpecOp_DSLLV:
+			case SpecOp_DSRLV:
+			case SpecOp_DSRAV:	GenerateShift64V( rd, rt, rs, op_code.spec_op ); handled = true; break;
+
+			case SpecOp_ADD:
+			case SpecOp_ADDU:	GenerateADDU( rd, rs, rt ); handled = true; break;
+			case SpecOp_SUB:
+			case SpecOp_SUBU:	GenerateSUBU( rd, rs, rt ); handled = true; break;
+			case SpecOp_DADD:
+			case SpecOp_DADDU:
+			case SpecOp_DSUB:
+			case SpecOp_DSUBU:
+			case SpecOp_AND:
+			case SpecOp_OR:
+			case SpecOp_XOR:
+			case SpecOp_NOR:	GenerateLogical64( rd, rs, rt, op_code.spec_op ); handled = true; break;
+			case SpecOp_SLT:	GenerateSLT( rd, rs, rt, false ); handled = true; break;
+			case SpecOp_SLTU:	GenerateSLT( rd, rs, rt, true ); handled = true; break;
+
+			case SpecOp_MFHI:	GenerateMFHILO( rd, &gCPUState.MultHi ); handled = true; break;
+			case SpecOp_MFLO:	GenerateMFHILO( rd, &gCPUState.MultLo ); handled = true; break;
+			case SpecOp_MTHI:	GenerateMTHILO( rs, &gCPUState.MultHi ); handled = true; break;
+			case SpecOp_MTLO:	GenerateMTHILO( rs, &gCPUState.MultLo ); handled = true; break;
+
+			case SpecOp_JR:
+				if( can_branch ) { GenerateJR( rs, p_branch, p_branch_jump ); handled = true; }
+				break;
+			case SpecOp_JALR:
+				if( can_branch ) { GenerateJALR( rs, rd, address, p_branch, p_branch_jump ); handled = true; }
+				break;
+			}
+			break;
+	}
+
+	if( !handled )
+	{
+		bool	need_pc( R4300_InstructionHandlerNeedsPC( op_code ) );
+
+		if( need_pc )
+		{
+			SetVar( &gCPUState.CurrentPC, address );
+		}
+		GenerateGenericR4300( op_code, R4300_GetInstructionHandler( op_code ) );
+
+		if( need_pc )
+		{
+			exception_handler = GenerateBranchIfSet( const_cast< u32 * >( &gCPUState.StuffToDo ), no_target );
+		}
+
+		ReloadCachedRegisters( StaticAnalysis::GetGPRWriteMask( op_code ) );
+
+		if( op_code.op == OP_COPRO1 )
+		{
+			// The interpreter may have left mxcsr anywhere. CTC1 is the only op
+			// that changes the guest's rounding mode, so pick that up straight away.
+			mHostRoundingMode = HRM_UNKNOWN;
+			if( op_code.cop1_op == Cop1Op_CTC1 )
+			{
+				SetHostRoundingMode( HRM_GUEST );
+			}
+		}
+
+		// Check whether we want to invert the status of this branch
+		if( p_branch != NULL )
+		{
+			//
+			// Check if the branch has been taken
+			//
+			if( p_branch->Direct )
+			{
+				if( p_branch->ConditionalBranchTaken )
+				{
+					*p_branch_jump = GenerateBranchIfNotEqual( &gCPUState.Delay, DO_DELAY, no_target );
+				}
+				else
+				{
+					*p_branch_jump = GenerateBranchIfEqual( &gCPUState.Delay, DO_DELAY, no_target );
+				}
+			}
+			else
+			{
+				// XXXX eventually just exit here, and skip default exit code below
+				if( p_branch->Eret )
+				{
+					*p_branch_jump = GenerateBranchAlways( no_target );
+				}
+				else
+				{
+					*p_branch_jump = GenerateBranchIfNotEqual( &gCPUState.TargetPC, p_branch->TargetAddress, no_target );
+				}
+			}
+		}
+	}
+
+	if( p_branch == NULL && branch_delay_slot )
+	{
+		SetVar( &gCPUState.Delay, NO_DELAY );
+	}
+
+	mConstants.Update( address, op_code );
+
+	return exception_handler;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateGenericR4300( OpCode op_code, CPU_Instruction p_instruction )
+{
+	// XXXX Flush all fp registers before a generic call
+
+	// The interpreter's Cop1 handlers round with whatever mxcsr holds. They only
+	// set it when FCR31 changes, so a fixed mode left by FLOOR/CEIL/ROUND would leak in.
+	if( op_code.op == OP_COPRO1 && mUsedFixedRoundingMode )
+	{
+		SetHostRoundingMode( HRM_GUEST );
+	}
+
+	MOVI( X64Reg_Arg0, op_code._u32 );
+	CALL( CCodeLabel( reinterpret_cast< const void * >( p_instruction ) ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation CCodeGeneratorX64::ExecuteNativeFunction( CCodeLabel speed_hack, bool check_return )
+{
+	RestoreGuestRoundingMode();
+
+	CALL( speed_hack );
+	ReloadCachedRegisters( ~0 );
+	mConstants.Reset();
+	mHostRoundingMode = HRM_UNKNOWN;
+
+	if( check_return )
+	{
+		TEST( RAX_CODE, RAX_CODE, false );
+
+		return JELong( CCodeLabel(NULL) );
+	}
+	else
+	{
+		return CJumpLocation(NULL);
+	}
+}
+
+//*****************************************************************************
+//	eax = (base + offset) ^ twiddle
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateAddress( EN64Reg base, s16 offset, u32 twiddle )
+{
+	LoadRegister32( RAX_CODE, base );
+	ADDI( RAX_CODE, offset, false );
+	if( twiddle != 0 )
+	{
+		XORI( RAX_CODE, twiddle, false );
+	}
+}
+
+//*****************************************************************************
+//	rdx = p_table[ eax >> 18 ].pRead/pWrite
+//	Returns the jump to take when the pointer is NULL (i.e. a function needs calling)
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateLookup( const void * p_table )
+{
+	MOV( RCX_CODE, RAX_CODE, false );
+	SHRI( RCX_CODE, 18, false );
+	SHLI( RCX_CODE, 4, false );					// * sizeof( MemFuncRead )
+	MOVI_PTR( RDX_CODE, p_table );
+	MOV_REG_MEM( RDX_CODE, RDX_CODE, RCX_CODE, 0, true );
+	TEST( RDX_CODE, RDX_CODE, true );
+
+	return JELong( CCodeLabel( NULL ) );
+}
+
+//*****************************************************************************
+//	Out of line, call the interpreter to handle the access (hardware
+//	registers, TLB etc) and return to where we left off.
+//	Returns the exception check.
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateSlowPath( CJumpLocation slow_jump, u32 address, OpCode op_code )
+{
+	CCodeLabel		continue_location( GetAssemblyBuffer()->GetLabel() );
+	CCodeLabel		no_target( NULL );
+
+	SetAssemblyBuffer( mpSecondary );
+	PatchJumpLong( slow_jump, GetAssemblyBuffer()->GetLabel() );
+
+	SetVar( &gCPUState.CurrentPC, address );
+	GenerateGenericR4300( op_code, R4300_GetInstructionHandler( op_code ) );
+	CJumpLocation	exception_handler( GenerateBranchIfSet( const_cast< u32 * >( &gCPUState.StuffToDo ), no_target ) );
+	ReloadCachedRegisters( StaticAnalysis::GetGPRWriteMask( op_code ) );
+	JMPLong( continue_location );
+
+	SetAssemblyBuffer( mpPrimary );
+
+	return exception_handler;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool	CCodeGeneratorX64::GenerateLoad( CJumpLocation * p_exception, u32 address, OpCode op_code, u32 twiddle, u32 bits, bool sign_extend )
+{
+	const EN64Reg	rt = EN64Reg( op_code.rt );
+	const EN64Reg	base = EN64Reg( op_code.base );
+
+	// Rare, leave it to the interpreter
+	if( rt == N64Reg_R0 )
+		return false;
+
+	// Stack accesses and known RDRAM addresses skip the table lookup
+	u32				known_address;
+	bool			known_ram( mConstants.GetAccessAddress( op_code, &known_address ) && IsDirectRamAddress( known_address, bits / 8 ) );
+	bool			direct( known_ram || ( gDynarecStackOptimisation && base == N64Reg_SP ) );
+	EX64Reg			mem_base( direct ? X64Reg_RamBase : RDX_CODE );
+	CJumpLocation	slow_jump;
+
+	if( known_ram )
+	{
+		MOVI( RAX_CODE, ( ( known_address & 0x1FFFFFFF ) | 0x80000000 ) ^ twiddle );
+	}
+	else
+	{
+		GenerateAddress( base, s16( op_code.immediate ), twiddle );
+	}
+
+	if( !direct )
+	{
+		slow_jump = GenerateLookup( g_MemoryLookupTableRead );
+	}
+
+	switch( bits )
+	{
+	case 32:
+		MOV_REG_MEM( RAX_CODE, mem_base, RAX_CODE, 0, false );
+		break;
+	case 16:
+		if( sign_extend )	MOVSX16_REG_MEM( RAX_CODE, mem_base, RAX_CODE, 0 );
+		else				MOVZX16_REG_MEM( RAX_CODE, mem_base, RAX_CODE, 0 );
+		break;
+	case 8:
+		if( sign_extend )	MOVSX8_REG_MEM( RAX_CODE, mem_base, RAX_CODE, 0 );
+		else				MOVZX8_REG_MEM( RAX_CODE, mem_base, RAX_CODE, 0 );
+		break;
+	default:
+		DAEDALUS_ERROR( "Unhandled load size" );
+		break;
+	}
+
+	if( sign_extend )
+	{
+		MOVSXD( RAX_CODE, RAX_CODE );
+	}
+	StoreRegister( rt, RAX_CODE );
+
+	if( !direct )
+	{
+		*p_exception = GenerateSlowPath( slow_jump, address, op_code );
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//	SW goes through the write table (so hardware registers get their handlers).
+//	SH/SB go through ReadAddress(), as Write16Bits/Write8Bits do.
+//*****************************************************************************
+bool	CCodeGeneratorX64::GenerateStore( CJumpLocation * p_exception, u32 address, OpCode op_code, u32 twiddle, u32 bits )
+{
+	const EN64Reg	rt = EN64Reg( op_code.rt );
+	const EN64Reg	base = EN64Reg( op_code.base );
+
+	u32				known_address;
+	bool			known( mConstants.GetAccessAddress( op_code, &known_address ) );
+	bool			known_ram( known && IsDirectRamAddress( known_address, bits / 8 ) );
+
+	if( known && !known_ram && bits == 32 && GenerateKnownStore( p_exception, address, known_address, rt ) )
+	{
+		return true;
+	}
+
+	// Stack accesses and known RDRAM addresses skip the table lookup
+	bool			direct( known_ram || ( gDynarecStackOptimisation && base == N64Reg_SP ) );
+	EX64Reg			mem_base( direct ? X64Reg_RamBase : RDX_CODE );
+	CJumpLocation	slow_jump;
+
+	if( known_ram )
+	{
+		MOVI( RAX_CODE, ( ( known_address & 0x1FFFFFFF ) | 0x80000000 ) ^ twiddle );
+	}
+	else
+	{
+		GenerateAddress( base, s16( op_code.immediate ), twiddle );
+	}
+
+	if( !direct )
+	{
+		slow_jump = GenerateLookup( bits == 32 ? static_cast< const void * >( g_MemoryLookupTableWrite ) : static_cast< const void * >( g_MemoryLookupTableRead ) );
+	}
+
+	EX64Reg			value( GetRegisterAndLoad( rt, RCX_CODE ) );
+
+	switch( bits )
+	{
+	case 32:	MOV_MEM_REG( mem_base, RAX_CODE, 0, value, false );	break;
+	case 16:	MOV16_MEM_REG( mem_base, RAX_CODE, 0, value );		break;
+	case 8:		MOV8_MEM_REG( mem_base, RAX_CODE, 0, value );		break;
+	default:
+		DAEDALUS_ERROR( "Unhandled store size" );
+		break;
+	}
+
+	if( !direct )
+	{
+		*p_exception = GenerateSlowPath( slow_jump, address, op_code );
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//	Stores to a known hardware register call its write handler directly,
+//	which is what Write32Bits() would end up doing. Only KSEG0/KSEG1 are
+//	fixed, so TLB mapped addresses are left alone.
+//*****************************************************************************
+bool	CCodeGeneratorX64::GenerateKnownStore( CJumpLocation * p_exception, u32 address, u32 known_address, EN64Reg rt )
+{
+	if( ( known_address >> 30 ) != 2 || ( known_address & 3 ) != 0 )
+		return false;
+
+	const MemFuncWrite &	m( g_MemoryLookupTableWrite[ known_address >> 18 ] );
+	if( m.pWrite != NULL || m.WriteFunc == NULL )
+		return false;
+
+	CCodeLabel		no_target( NULL );
+
+	// The handler may raise an interrupt
+	SetVar( &gCPUState.CurrentPC, address );
+	LoadRegister32( X64Reg_Arg1, rt );
+	MOVI( X64Reg_Arg0, known_address );
+	CALL( CCodeLabel( reinterpret_cast< const void * >( m.WriteFunc ) ) );
+	*p_exception = GenerateBranchIfSet( const_cast< u32 * >( &gCPUState.StuffToDo ), no_target );
+
+	return true;
+}
+
+//*****************************************************************************
+//	ALU ops. Writes to r0 are discarded, as with the interpreter.
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateADDIU( EN64Reg rt, EN64Reg rs, s16 immediate )
+{
+	if( rt == N64Reg_R0 )
+		return;
+
+	if( mConstants.IsKnown( rs ) )
+	{
+		SetRegister32s( rt, s32( u32( mConstants.GetValue( rs ) ) + u32( s32( immediate ) ) ) );
+		return;
+	}
+
+	LoadRegister32( RAX_CODE, rs );
+	ADDI( RAX_CODE, immediate, false );
+	StoreRegister32s( rt, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateDADDIU( EN64Reg rt, EN64Reg rs, s16 immediate )
+{
+	if( rt == N64Reg_R0 )
+		return;
+
+	LoadRegister( RAX_CODE, rs );
+	ADDI( RAX_CODE, immediate, true );
+	StoreRegister( rt, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateSLTI( EN64Reg rt, EN64Reg rs, s16 immediate, bool is_unsigned )
+{
+	if( rt == N64Reg_R0 )
+		return;
+
+	EX64Reg		reg_a( GetRegisterAndLoad( rs, RAX_CODE ) );
+
+	XOR( RCX_CODE, RCX_CODE, false );
+	CMPI( reg_a, immediate, true );
+	SETCC( is_unsigned ? X64Cond_B : X64Cond_L, RCX_CODE );
+	StoreRegister( rt, RCX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateANDI( EN64Reg rt, EN64Reg rs, u16 immediate )
+{
+	if( rt == N64Reg_R0 )
+		return;
+
+	if( mConstants.IsKnown( rs ) )
+	{
+		SetRegister32s( rt, mConstants.GetValue( rs ) & immediate );
+		return;
+	}
+
+	LoadRegister32( RAX_CODE, rs );
+	ANDI( RAX_CODE, immediate, false );
+	StoreRegister( rt, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateORI( EN64Reg rt, EN64Reg rs, u16 immediate )
+{
+	if( rt == N64Reg_R0 )
+		return;
+
+	if( mConstants.IsKnown( rs ) )
+	{
+		SetRegister32s( rt, mConstants.GetValue( rs ) | immediate );
+		return;
+	}
+
+	LoadRegister( RAX_CODE, rs );
+	ORI( RAX_CODE, immediate, true );
+	StoreRegister( rt, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateXORI( EN64Reg rt, EN64Reg rs, u16 immediate )
+{
+	if( rt == N64Reg_R0 )
+		return;
+
+	if( mConstants.IsKnown( rs ) )
+	{
+		SetRegister32s( rt, mConstants.GetValue( rs ) ^ immediate );
+		return;
+	}
+
+	LoadRegister( RAX_CODE, rs );
+	XORI( RAX_CODE, immediate, true );
+	StoreRegister( rt, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateLUI( EN64Reg rt, u16 immediate )
+{
+	if( rt == N64Reg_R0 )
+		return;
+
+	SetRegister32s( rt, s32( u32( immediate ) << 16 ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateShift32( EN64Reg rd, EN64Reg rt, u32 sa, u32 spec_op )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	LoadRegister32( RAX_CODE, rt );
+	switch( spec_op )
+	{
+	case SpecOp_SLL:	SHLI( RAX_CODE, u8( sa ), false ); break;
+	case SpecOp_SRL:	SHRI( RAX_CODE, u8( sa ), false ); break;
+	case SpecOp_SRA:	SARI( RAX_CODE, u8( sa ), false ); break;
+	}
+	StoreRegister32s( rd, RAX_CODE );
+}
+
+// x86 masks the shift count with 0x1f/0x3f, the same as the R4300
+void CCodeGeneratorX64::GenerateShift32V( EN64Reg rd, EN64Reg rt, EN64Reg rs, u32 spec_op )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	LoadRegister32( RCX_CODE, rs );
+	LoadRegister32( RAX_CODE, rt );
+	switch( spec_op )
+	{
+	case SpecOp_SLLV:	SHL_CL( RAX_CODE, false ); break;
+	case SpecOp_SRLV:	SHR_CL( RAX_CODE, false ); break;
+	case SpecOp_SRAV:	SAR_CL( RAX_CODE, false ); break;
+	}
+	StoreRegister32s( rd, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateShift64( EN64Reg rd, EN64Reg rt, u32 sa, u32 spec_op )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	LoadRegister( RAX_CODE, rt );
+	switch( spec_op )
+	{
+	case SpecOp_DSLL:
+	case SpecOp_DSLL32:	SHLI( RAX_CODE, u8( sa ), true ); break;
+	case SpecOp_DSRL:
+	case SpecOp_DSRL32:	SHRI( RAX_CODE, u8( sa ), true ); break;
+	case SpecOp_DSRA:
+	case SpecOp_DSRA32:	SARI( RAX_CODE, u8( sa ), true ); break;
+	}
+	StoreRegister( rd, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateShift64V( EN64Reg rd, EN64Reg rt, EN64Reg rs, u32 spec_op )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	LoadRegister32( RCX_CODE, rs );
+	LoadRegister( RAX_CODE, rt );
+	switch( spec_op )
+	{
+	case SpecOp_DSLLV:	SHL_CL( RAX_CODE, true ); break;
+	case SpecOp_DSRLV:	SHR_CL( RAX_CODE, true ); break;
+	case SpecOp_DSRAV:	SAR_CL( RAX_CODE, true ); break;
+	}
+	StoreRegister( rd, RAX_CODE );
+}
+
+//*****************************************************************************
+//	ADD/SUB don't raise overflow exceptions in the interpreter either
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateADDU( EN64Reg rd, EN64Reg rs, EN64Reg rt )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	LoadRegister32( RAX_CODE, rs );
+	ADD( RAX_CODE, GetRegisterAndLoad( rt, RCX_CODE ), false );
+	StoreRegister32s( rd, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateSUBU( EN64Reg rd, EN64Reg rs, EN64Reg rt )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	LoadRegister32( RAX_CODE, rs );
+	SUB( RAX_CODE, GetRegisterAndLoad( rt, RCX_CODE ), false );
+	StoreRegister32s( rd, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateLogical64( EN64Reg rd, EN64Reg rs, EN64Reg rt, u32 spec_op )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	LoadRegister( RAX_CODE, rs );
+
+	EX64Reg		reg_b( GetRegisterAndLoad( rt, RCX_CODE ) );
+	switch( spec_op )
+	{
+	case SpecOp_DADD:
+	case SpecOp_DADDU:	ADD( RAX_CODE, reg_b, true ); break;
+	case SpecOp_DSUB:
+	case SpecOp_DSUBU:	SUB( RAX_CODE, reg_b, true ); break;
+	case SpecOp_AND:	AND( RAX_CODE, reg_b, true ); break;
+	case SpecOp_OR:		OR( RAX_CODE, reg_b, true ); break;
+	case SpecOp_XOR:	XOR( RAX_CODE, reg_b, true ); break;
+	case SpecOp_NOR:	OR( RAX_CODE, reg_b, true ); NOT( RAX_CODE, true ); break;
+	}
+	StoreRegister( rd, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateSLT( EN64Reg rd, EN64Reg rs, EN64Reg rt, bool is_unsigned )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	EX64Reg		reg_a( GetRegisterAndLoad( rs, RAX_CODE ) );
+	EX64Reg		reg_b( GetRegisterAndLoad( rt, RCX_CODE ) );
+
+	XOR( RDX_CODE, RDX_CODE, false );
+	CMP( reg_a, reg_b, true );
+	SETCC( is_unsigned ? X64Cond_B : X64Cond_L, RDX_CODE );
+	StoreRegister( rd, RDX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateMFHILO( EN64Reg rd, const REG64 * p_var )
+{
+	if( rd == N64Reg_R0 )
+		return;
+
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, CPUStateOffset( p_var ), true );
+	StoreRegister( rd, RAX_CODE );
+}
+
+void CCodeGeneratorX64::GenerateMTHILO( EN64Reg rs, REG64 * p_var )
+{
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, CPUStateOffset( p_var ), GetRegisterAndLoad( rs, RAX_CODE ), true );
+}
+
+//*****************************************************************************
+//	Branches. As on the PSP we don't set gCPUState.Delay, we just jump to
+//	the branch handler if the branch goes the other way to the trace.
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateJAL( u32 address )
+{
+	SetRegister32s( N64Reg_RA, s32( address + 8 ) );
+}
+
+void	CCodeGeneratorX64::GenerateJR( EN64Reg rs, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	LoadRegister32( RAX_CODE, rs );
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, CPUStateOffset( &gCPUState.TargetPC ), RAX_CODE, false );
+	CMPI( RAX_CODE, s32( p_branch->TargetAddress ), false );
+	*p_branch_jump = JNELong( CCodeLabel() );
+}
+
+void	CCodeGeneratorX64::GenerateJALR( EN64Reg rs, EN64Reg rd, u32 address, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	// Read rs before writing rd, they may be the same register
+	LoadRegister32( RAX_CODE, rs );
+	if( rd != N64Reg_R0 )
+	{
+		SetRegister32s( rd, s32( address + 8 ) );
+	}
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, CPUStateOffset( &gCPUState.TargetPC ), RAX_CODE, false );
+	CMPI( RAX_CODE, s32( p_branch->TargetAddress ), false );
+	*p_branch_jump = JNELong( CCodeLabel() );
+}
+
+void	CCodeGeneratorX64::GenerateBranchCompare( EN64Reg rs, EN64Reg rt, EX64Cond cond, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	DAEDALUS_ASSERT( p_branch->Direct, "Indirect branch for BEQ/BNE?" );
+
+	EX64Reg		reg_a( GetRegisterAndLoad( rs, RAX_CODE ) );
+	EX64Reg		reg_b( GetRegisterAndLoad( rt, RCX_CODE ) );
+
+	CMP( reg_a, reg_b, true );
+
+	// Jump to the handler when the branch doesn't go the way the trace did
+	*p_branch_jump = JCCLong( p_branch->ConditionalBranchTaken ? X64Cond_Invert( cond ) : cond, CCodeLabel() );
+}
+
+void	CCodeGeneratorX64::GenerateBranchZero( EN64Reg rs, EX64Cond cond, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	DAEDALUS_ASSERT( p_branch->Direct, "Indirect branch for BLEZ/BGTZ/BLTZ/BGEZ?" );
+
+	EX64Reg		reg_a( GetRegisterAndLoad( rs, RAX_CODE ) );
+
+	TEST( reg_a, reg_a, true );
+
+	*p_branch_jump = JCCLong( p_branch->ConditionalBranchTaken ? X64Cond_Invert( cond ) : cond, CCodeLabel() );
+}
+
+//*****************************************************************************
+//	Loads mxcsr with the rounding mode FCR31 asks for
+//*****************************************************************************
+void	CCodeGeneratorX64::LoadGuestRoundingMode()
+{
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, FCR31Offset(), false );
+	ANDI( RAX_CODE, FPCSR_RM_MASK, false );
+	SHLI( RAX_CODE, 2, false );
+	MOVI_PTR( RCX_CODE, gMXCSRRoundingModes );
+	LDMXCSR( RCX_CODE, RAX_CODE, 0 );
+}
+
+//*****************************************************************************
+//	Trashes rax and rcx
+//*****************************************************************************
+void	CCodeGeneratorX64::SetHostRoundingMode( EHostRoundingMode mode )
+{
+	DAEDALUS_ASSERT( mode != HRM_UNKNOWN, "Can't set an unknown rounding mode" );
+
+	if( mode == mHostRoundingMode )
+		return;
+
+	switch( mode )
+	{
+	case HRM_GUEST:		LoadGuestRoundingMode(); break;
+	case HRM_NEAREST:	MOVI_PTR( RCX_CODE, &gMXCSRRoundingModes[ FPCSR_RM_RN ] ); LDMXCSR( RCX_CODE, INVALID_CODE, 0 ); break;
+	case HRM_CEIL:		MOVI_PTR( RCX_CODE, &gMXCSRRoundingModes[ FPCSR_RM_RP ] ); LDMXCSR( RCX_CODE, INVALID_CODE, 0 ); break;
+	case HRM_FLOOR:		MOVI_PTR( RCX_CODE, &gMXCSRRoundingModes[ FPCSR_RM_RM ] ); LDMXCSR( RCX_CODE, INVALID_CODE, 0 ); break;
+	case HRM_UNKNOWN:	break;
+	}
+
+	if( mode != HRM_GUEST )
+	{
+		mUsedFixedRoundingMode = true;
+	}
+	mHostRoundingMode = mode;
+}
+
+//*****************************************************************************
+//	The interpreter and the next fragment expect mxcsr to follow FCR31
+//*****************************************************************************
+void	CCodeGeneratorX64::RestoreGuestRoundingMode()
+{
+	if( mUsedFixedRoundingMode && mHostRoundingMode != HRM_GUEST )
+	{
+		LoadGuestRoundingMode();
+	}
+}
+
+//*****************************************************************************
+//	Returns false to leave the op to the interpreter
+//*****************************************************************************
+bool	CCodeGeneratorX64::GenerateCop1( OpCode op_code, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	const EN64Reg	rt( EN64Reg( op_code.rt ) );
+	const u32		fd( op_code.fd );
+	const u32		fs( op_code.fs );
+	const u32		ft( op_code.ft );
+
+	switch( op_code.cop1_op )
+	{
+	case Cop1Op_MFC1:	GenerateMFC1( rt, fs, false ); return true;
+	case Cop1Op_MTC1:	GenerateMTC1( fs, rt, false ); return true;
+	case Cop1Op_DMFC1:	if( fs & 1 ) return false; GenerateMFC1( rt, fs, true ); return true;
+	case Cop1Op_DMTC1:	if( fs & 1 ) return false; GenerateMTC1( fs, rt, true ); return true;
+	case Cop1Op_CFC1:	GenerateCFC1( rt, fs ); return true;
+
+	case Cop1Op_BCInstr:
+		if( p_branch == NULL )
+			return false;
+		// BC1T/BC1TL have bit 0 set. Likely branches are handled like the others.
+		GenerateBranchCop1( ( op_code.cop1_bc & 1 ) != 0, p_branch, p_branch_jump );
+		return true;
+
+	case Cop1Op_SInstr:	return GenerateCop1Format( op_code.cop1_funct, fd, fs, ft, false );
+	case Cop1Op_DInstr:	return GenerateCop1Format( op_code.cop1_funct, fd, fs, ft, true );
+	case Cop1Op_WInstr:	return GenerateCop1Integer( op_code.cop1_funct, fd, fs, false );
+	case Cop1Op_LInstr:	return GenerateCop1Integer( op_code.cop1_funct, fd, fs, true );
+	}
+
+	// CTC1 goes through the interpreter, which keeps its own copy of the rounding mode
+	return false;
+}
+
+//*****************************************************************************
+//	S and D format ops
+//*****************************************************************************
+bool	CCodeGeneratorX64::GenerateCop1Format( u32 funct, u32 fd, u32 fs, u32 ft, bool is_double )
+{
+	// Registers which have to name a pair for doubles
+	const u32		odd_fs( is_double ? fs & 1 : 0 );
+	const u32		odd_ft( is_double ? ft & 1 : 0 );
+	const u32		odd_fd( is_double ? fd & 1 : 0 );
+
+	switch( funct )
+	{
+	case Cop1OpFunc_ADD:
+	case Cop1OpFunc_SUB:
+	case Cop1OpFunc_MUL:
+	case Cop1OpFunc_DIV:
+		if( odd_fd | odd_fs | odd_ft ) return false;
+		GenerateCop1Arithmetic( funct, fd, fs, ft, is_double );
+		return true;
+
+	case Cop1OpFunc_SQRT:
+		if( odd_fd | odd_fs ) return false;
+		GenerateCop1Arithmetic( funct, fd, fs, ft, is_double );
+		return true;
+
+	case Cop1OpFunc_ABS:
+	case Cop1OpFunc_MOV:
+	case Cop1OpFunc_NEG:
+		if( odd_fd | odd_fs ) return false;
+		GenerateCop1Sign( funct, fd, fs, is_double );
+		return true;
+
+	case Cop1OpFunc_ROUND_L:
+	case Cop1OpFunc_TRUNC_L:
+	case Cop1OpFunc_CEIL_L:
+	case Cop1OpFunc_FLOOR_L:
+	case Cop1OpFunc_CVT_L:
+		if( ( fd & 1 ) | odd_fs ) return false;
+		GenerateCop1ToInteger( funct, fd, fs, is_double );
+		return true;
+
+	case Cop1OpFunc_ROUND_W:
+	case Cop1OpFunc_TRUNC_W:
+	case Cop1OpFunc_CEIL_W:
+	case Cop1OpFunc_FLOOR_W:
+	case Cop1OpFunc_CVT_W:
+		if( odd_fs ) return false;
+		GenerateCop1ToInteger( funct, fd, fs, is_double );
+		return true;
+
+	case Cop1OpFunc_CVT_S:
+		if( !is_double || odd_fs ) return false;
+		GenerateCop1ToFloat( fd, fs, Cop1Op_DInstr, false );
+		return true;
+
+	case Cop1OpFunc_CVT_D:
+		if( is_double || ( fd & 1 ) ) return false;
+		GenerateCop1ToFloat( fd, fs, Cop1Op_SInstr, true );
+		return true;
+	}
+
+	if( funct >= Cop1OpFunc_CMP_F && funct <= Cop1OpFunc_CMP_NGT )
+	{
+		if( odd_fs | odd_ft ) return false;
+		GenerateCop1Compare( funct & 7, fs, ft, is_double );
+		return true;
+	}
+
+	return false;
+}
+
+//*****************************************************************************
+//	W and L format ops (only conversions are valid)
+//*****************************************************************************
+bool	CCodeGeneratorX64::GenerateCop1Integer( u32 funct, u32 fd, u32 fs, bool is64 )
+{
+	if( is64 && ( fs & 1 ) )
+		return false;
+
+	const u32		src_fmt( is64 ? Cop1Op_LInstr : Cop1Op_WInstr );
+
+	switch( funct )
+	{
+	case Cop1OpFunc_CVT_S:
+		GenerateCop1ToFloat( fd, fs, src_fmt, false );
+		return true;
+	case Cop1OpFunc_CVT_D:
+		if( fd & 1 ) return false;
+		GenerateCop1ToFloat( fd, fs, src_fmt, true );
+		return true;
+	}
+
+	return false;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateMFC1( EN64Reg rt, u32 fs, bool is64 )
+{
+	if( rt == N64Reg_R0 )
+		return;
+
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, FPROffset( fs ), is64 );
+	if( is64 )
+	{
+		StoreRegister( rt, RAX_CODE );
+	}
+	else
+	{
+		StoreRegister32s( rt, RAX_CODE );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateMTC1( u32 fs, EN64Reg rt, bool is64 )
+{
+	if( is64 )
+	{
+		LoadRegister( RAX_CODE, rt );
+	}
+	else
+	{
+		LoadRegister32( RAX_CODE, rt );
+	}
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, FPROffset( fs ), RAX_CODE, is64 );
+}
+
+//*****************************************************************************
+//	Only the revision and control/status registers exist
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateCFC1( EN64Reg rt, u32 fs )
+{
+	if( rt == N64Reg_R0 || ( fs != 0 && fs != 31 ) )
+		return;
+
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, CPUStateOffset( &gCPUState.FPUControl[ fs ] ), false );
+	StoreRegister32s( rt, RAX_CODE );
+}
+
+//*****************************************************************************
+//	fd = fs op ft, rounded as FCR31 says
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateCop1Arithmetic( u32 funct, u32 fd, u32 fs, u32 ft, bool is_double )
+{
+	SetHostRoundingMode( HRM_GUEST );
+
+	MOVS_REG_MEM( XMM0_CODE, X64Reg_CPUState, FPROffset( fs ), is_double );
+	if( funct != Cop1OpFunc_SQRT )
+	{
+		MOVS_REG_MEM( XMM1_CODE, X64Reg_CPUState, FPROffset( ft ), is_double );
+	}
+
+	switch( funct )
+	{
+	case Cop1OpFunc_ADD:	ADDS( XMM0_CODE, XMM1_CODE, is_double ); break;
+	case Cop1OpFunc_SUB:	SUBS( XMM0_CODE, XMM1_CODE, is_double ); break;
+	case Cop1OpFunc_MUL:	MULS( XMM0_CODE, XMM1_CODE, is_double ); break;
+	case Cop1OpFunc_DIV:	DIVS( XMM0_CODE, XMM1_CODE, is_double ); break;
+	case Cop1OpFunc_SQRT:	SQRTS( XMM0_CODE, XMM0_CODE, is_double ); break;
+	default:				DAEDALUS_ERROR( "Unhandled Cop1 arithmetic op" ); break;
+	}
+
+	MOVS_MEM_REG( X64Reg_CPUState, FPROffset( fd ), XMM0_CODE, is_double );
+}
+
+//*****************************************************************************
+//	MOV/ABS/NEG only touch the sign bit, so they're done on the raw bits
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateCop1Sign( u32 funct, u32 fd, u32 fs, bool is_double )
+{
+	const u64		sign_bit( is_double ? 0x8000000000000000ULL : 0x80000000ULL );
+
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, FPROffset( fs ), is_double );
+
+	switch( funct )
+	{
+	case Cop1OpFunc_ABS:
+		MOVI_64( RCX_CODE, ~sign_bit );
+		AND( RAX_CODE, RCX_CODE, is_double );
+		break;
+	case Cop1OpFunc_NEG:
+		MOVI_64( RCX_CODE, sign_bit );
+		XOR( RAX_CODE, RCX_CODE, is_double );
+		break;
+	case Cop1OpFunc_MOV:
+		break;
+	}
+
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, FPROffset( fd ), RAX_CODE, is_double );
+}
+
+//*****************************************************************************
+//	ROUND/TRUNC/CEIL/FLOOR/CVT to W or L. Only CVT uses the guest's mode,
+//	the others pick the mode they need, which stays set for the next one.
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateCop1ToInteger( u32 funct, u32 fd, u32 fs, bool is_double )
+{
+	const bool		to_long( funct == Cop1OpFunc_CVT_L || funct < Cop1OpFunc_ROUND_W );
+	const u32		rounding( funct == Cop1OpFunc_CVT_L || funct == Cop1OpFunc_CVT_W ? u32( ~0 ) : funct & 3 );
+
+	switch( rounding )
+	{
+	case 0:		SetHostRoundingMode( HRM_NEAREST ); break;		// ROUND
+	case 1:		break;											// TRUNC, see below
+	case 2:		SetHostRoundingMode( HRM_CEIL ); break;			// CEIL
+	case 3:		SetHostRoundingMode( HRM_FLOOR ); break;		// FLOOR
+	default:	SetHostRoundingMode( HRM_GUEST ); break;		// CVT
+	}
+
+	MOVS_REG_MEM( XMM0_CODE, X64Reg_CPUState, FPROffset( fs ), is_double );
+	if( rounding == 1 )
+	{
+		CVTTS2SI( RAX_CODE, XMM0_CODE, is_double, to_long );
+	}
+	else
+	{
+		CVTS2SI( RAX_CODE, XMM0_CODE, is_double, to_long );
+	}
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, FPROffset( fd ), RAX_CODE, to_long );
+}
+
+//*****************************************************************************
+//	CVT_S/CVT_D from any format. Widening S to D is exact, everything else
+//	rounds as FCR31 says.
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateCop1ToFloat( u32 fd, u32 fs, u32 src_fmt, bool to_double )
+{
+	const bool		exact( src_fmt == Cop1Op_SInstr || ( src_fmt == Cop1Op_WInstr && to_double ) );
+
+	if( !exact )
+	{
+		SetHostRoundingMode( HRM_GUEST );
+	}
+
+	switch( src_fmt )
+	{
+	case Cop1Op_SInstr:
+	case Cop1Op_DInstr:
+		MOVS_REG_MEM( XMM0_CODE, X64Reg_CPUState, FPROffset( fs ), src_fmt == Cop1Op_DInstr );
+		CVTS2S( XMM0_CODE, XMM0_CODE, src_fmt == Cop1Op_DInstr );
+		break;
+	case Cop1Op_WInstr:
+	case Cop1Op_LInstr:
+		MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, FPROffset( fs ), src_fmt == Cop1Op_LInstr );
+		CVTSI2S( XMM0_CODE, RAX_CODE, to_double, src_fmt == Cop1Op_LInstr );
+		break;
+	}
+
+	MOVS_MEM_REG( X64Reg_CPUState, FPROffset( fd ), XMM0_CODE, to_double );
+}
+
+//*****************************************************************************
+//	C.cond.fmt. Bit 0 of cond is unordered, bit 1 equal and bit 2 less than.
+//	The signalling variants (cond | 8) compare the same way.
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateCop1Compare( u32 cond, u32 fs, u32 ft, bool is_double )
+{
+	MOVS_REG_MEM( XMM0_CODE, X64Reg_CPUState, FPROffset( fs ), is_double );
+	MOVS_REG_MEM( XMM1_CODE, X64Reg_CPUState, FPROffset( ft ), is_double );
+
+	// ucomis sets ZF/PF/CF for unordered, ZF for equal and CF for less than
+	switch( cond )
+	{
+	case 0:		XOR( RCX_CODE, RCX_CODE, false ); break;													// F
+	case 1:		UCOMIS( XMM0_CODE, XMM1_CODE, is_double ); SETCC( X64Cond_P, RCX_CODE ); break;				// UN
+	case 2:		UCOMIS( XMM0_CODE, XMM1_CODE, is_double ); SETCC( X64Cond_E, RCX_CODE );					// EQ
+				SETCC( X64Cond_NP, RDX_CODE ); AND( RCX_CODE, RDX_CODE, false ); break;
+	case 3:		UCOMIS( XMM0_CODE, XMM1_CODE, is_double ); SETCC( X64Cond_E, RCX_CODE ); break;				// UEQ
+	case 4:		UCOMIS( XMM1_CODE, XMM0_CODE, is_double ); SETCC( X64Cond_A, RCX_CODE ); break;				// OLT
+	case 5:		UCOMIS( XMM0_CODE, XMM1_CODE, is_double ); SETCC( X64Cond_B, RCX_CODE ); break;				// ULT
+	case 6:		UCOMIS( XMM1_CODE, XMM0_CODE, is_double ); SETCC( X64Cond_AE, RCX_CODE ); break;			// OLE
+	case 7:		UCOMIS( XMM0_CODE, XMM1_CODE, is_double ); SETCC( X64Cond_BE, RCX_CODE ); break;			// ULE
+	}
+
+	MOVZX8( RCX_CODE, RCX_CODE );
+	SHLI( RCX_CODE, 23, false );				// FPCSR_C
+
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, FCR31Offset(), false );
+	ANDI( RAX_CODE, ~FPCSR_C, false );
+	OR( RAX_CODE, RCX_CODE, false );
+	MOV_MEM_REG( X64Reg_CPUState, INVALID_CODE, FCR31Offset(), RAX_CODE, false );
+}
+
+//*****************************************************************************
+//	BC1F/BC1T/BC1FL/BC1TL
+//*****************************************************************************
+void	CCodeGeneratorX64::GenerateBranchCop1( bool if_true, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	DAEDALUS_ASSERT( p_branch->Direct, "Indirect branch for BC1?" );
+
+	MOV_REG_MEM( RAX_CODE, X64Reg_CPUState, INVALID_CODE, FCR31Offset(), false );
+	ANDI( RAX_CODE, FPCSR_C, false );
+
+	EX64Cond	cond( if_true ? X64Cond_NE : X64Cond_E );
+
+	*p_branch_jump = JCCLong( p_branch->ConditionalBranchTaken ? X64Cond_Invert( cond ) : cond, CCodeLabel() );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void R4300_CALL_TYPE _EnterDynaRec( const void * p_function, const void * p_base_pointer, const void * p_rebased_mem, u32 /*mem_limit*/ )
+{
+	DAEDALUS_ASSERT( gEnterDynaRecThunk != NULL, "Dynarec buffer hasn't been initialised" );
+
+	gEnterDynaRecThunk( p_function, p_base_pointer, p_rebased_mem );
+}
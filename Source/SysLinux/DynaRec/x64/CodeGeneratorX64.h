@@ -0,0 +1,172 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef SYSLINUX_DYNAREC_X64_CODEGENERATORX64_H_
+#define SYSLINUX_DYNAREC_X64_CODEGENERATORX64_H_
+
+#include "DynaRec/CodeGenerator.h"
+#include "AssemblyWriterX64.h"
+#include "DynarecTargetX64.h"
+#include "DynaRec/ConstantPropagation.h"
+#include "DynaRec/TraceRecorder.h"
+
+// Generated at the start of the code buffer, see CCodeGeneratorX64::GenerateEntryThunk()
+typedef void (*EnterDynaRecThunk)( const void * p_function, const void * p_base_pointer, const void * p_rebased_mem );
+extern EnterDynaRecThunk	gEnterDynaRecThunk;
+
+class CCodeGeneratorX64 : public CCodeGenerator, public CAssemblyWriterX64
+{
+	public:
+		CCodeGeneratorX64( CAssemblyBuffer * p_primary, CAssemblyBuffer * p_secondary );
+
+		static EnterDynaRecThunk	GenerateEntryThunk( CAssemblyBuffer * p_buffer );
+
+		virtual void				Initialise( u32 entry_address, u32 exit_address, u32 * hit_counter, const void * p_base, const SRegisterUsageInfo & register_usage );
+		virtual void				Finalise( ExceptionHandlerFn p_exception_handler_fn, const std::vector< CJumpLocation > & exception_handler_jumps );
+
+		virtual void				UpdateRegisterCaching( u32 instruction_idx );
+
+		virtual RegisterSnapshotHandle	GetRegisterSnapshot();
+
+		virtual CCodeLabel			GetEntryPoint() const;
+		virtual CCodeLabel			GetLinkedEntryPoint() const					{ return mLinkedEntryPoint; }
+		virtual const SRegisterContract &	GetEntryContract() const			{ return mEntryContract; }
+		virtual CCodeLabel			GetCurrentLocation() const;
+		virtual u32					GetCompiledCodeSize() const;
+
+		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment );
+		virtual void				GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * p_map );
+		virtual void				GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map );
+		virtual void				GeneratePushReturnAddress( SIndirectExitEntry * p_return_site );
+
+		virtual void				GenerateBranchHandler( CJumpLocation branch_handler_jump, RegisterSnapshotHandle snapshot );
+
+		virtual CJumpLocation		GenerateOpCode( const STraceEntry& ti, bool branch_delay_slot, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump);
+
+		virtual CJumpLocation		ExecuteNativeFunction( CCodeLabel speed_hack, bool check_return );
+
+	private:
+				void				SetVar( u32 * p_var, u32 value );
+
+				CJumpLocation		GenerateBranchAlways( CCodeLabel target );
+				CJumpLocation		GenerateBranchIfSet( const u32 * p_var, CCodeLabel target );
+				CJumpLocation		GenerateBranchIfNotSet( const u32 * p_var, CCodeLabel target );
+				CJumpLocation		GenerateBranchIfEqual( const u32 * p_var, u32 value, CCodeLabel target );
+				CJumpLocation		GenerateBranchIfNotEqual( const u32 * p_var, u32 value, CCodeLabel target );
+
+				void				GenerateGenericR4300( OpCode op_code, CPU_Instruction p_instruction );
+
+				void				GenerateExceptionHander( ExceptionHandlerFn p_exception_handler_fn, const std::vector< CJumpLocation > & exception_handler_jumps );
+
+	private:
+		// Register cache. N64 registers are assigned to host registers for the
+		// whole fragment and written through to gCPUState, so nothing needs
+		// flushing on exit. After calling out we reload anything that may have changed.
+				EX64Reg				GetCachedRegister( EN64Reg reg ) const		{ return mCachedRegisters[ reg ]; }
+				void				LoadRegister( EX64Reg dst, EN64Reg src );
+				void				LoadRegister32( EX64Reg dst, EN64Reg src );
+				EX64Reg				GetRegisterAndLoad( EN64Reg src, EX64Reg scratch );
+				void				StoreRegister( EN64Reg dst, EX64Reg src );
+				void				StoreRegister32s( EN64Reg dst, EX64Reg src );
+				void				SetRegister32s( EN64Reg dst, s32 value );
+				void				ReloadCachedRegisters( u32 gpr_mask );
+
+	private:
+				EX64Reg				mCachedRegisters[ NUM_N64_REGS ];
+				SRegisterContract	mEntryContract;			// Slot i is gX64CacheRegisters[ i ]
+				CCodeLabel			mLinkedEntryPoint;
+
+				CConstantPropagation	mConstants;		// Along the trace, reset for anything off it
+
+				CAssemblyBuffer *	mpPrimary;
+				CAssemblyBuffer *	mpSecondary;
+
+	private:
+				void				GenerateAddress( EN64Reg base, s16 offset, u32 twiddle );
+				CJumpLocation		GenerateLookup( const void * p_table );
+				CJumpLocation		GenerateSlowPath( CJumpLocation slow_jump, u32 address, OpCode op_code );
+
+				bool				GenerateLoad( CJumpLocation * p_exception, u32 address, OpCode op_code, u32 twiddle, u32 bits, bool sign_extend );
+				bool				GenerateStore( CJumpLocation * p_exception, u32 address, OpCode op_code, u32 twiddle, u32 bits );
+				bool				GenerateKnownStore( CJumpLocation * p_exception, u32 address, u32 known_address, EN64Reg rt );
+
+				void				GenerateADDIU( EN64Reg rt, EN64Reg rs, s16 immediate );
+				void				GenerateDADDIU( EN64Reg rt, EN64Reg rs, s16 immediate );
+				void				GenerateSLTI( EN64Reg rt, EN64Reg rs, s16 immediate, bool is_unsigned );
+				void				GenerateANDI( EN64Reg rt, EN64Reg rs, u16 immediate );
+				void				GenerateORI( EN64Reg rt, EN64Reg rs, u16 immediate );
+				void				GenerateXORI( EN64Reg rt, EN64Reg rs, u16 immediate );
+				void				GenerateLUI( EN64Reg rt, u16 immediate );
+
+				void				GenerateShift32( EN64Reg rd, EN64Reg rt, u32 sa, u32 spec_op );
+				void				GenerateShift32V( EN64Reg rd, EN64Reg rt, EN64Reg rs, u32 spec_op );
+				void				GenerateShift64( EN64Reg rd, EN64Reg rt, u32 sa, u32 spec_op );
+				void				GenerateShift64V( EN64Reg rd, EN64Reg rt, EN64Reg rs, u32 spec_op );
+				void				GenerateADDU( EN64Reg rd, EN64Reg rs, EN64Reg rt );
+				void				GenerateSUBU( EN64Reg rd, EN64Reg rs, EN64Reg rt );
+				void				GenerateLogical64( EN64Reg rd, EN64Reg rs, EN64Reg rt, u32 spec_op );
+				void				GenerateSLT( EN64Reg rd, EN64Reg rs, EN64Reg rt, bool is_unsigned );
+				void				GenerateMFHILO( EN64Reg rd, const REG64 * p_var );
+				void				GenerateMTHILO( EN64Reg rs, REG64 * p_var );
+
+				void				GenerateJAL( u32 address );
+				void				GenerateJR( EN64Reg rs, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+				void				GenerateJALR( EN64Reg rs, EN64Reg rd, u32 address, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+				void				GenerateBranchCompare( EN64Reg rs, EN64Reg rt, EX64Cond cond, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+				void				GenerateBranchZero( EN64Reg rs, EX64Cond cond, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+
+	private:
+		// Cop1. FPRs aren't cached, ops work on gCPUState.FPU through xmm0/xmm1.
+		// Doubles use the even/odd pairs the interpreter keeps them in, so ops
+		// naming an odd register for a 64 bit value are left to the interpreter.
+				bool				GenerateCop1( OpCode op_code, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+				bool				GenerateCop1Format( u32 funct, u32 fd, u32 fs, u32 ft, bool is_double );
+				bool				GenerateCop1Integer( u32 funct, u32 fd, u32 fs, bool is64 );
+				void				GenerateMFC1( EN64Reg rt, u32 fs, bool is64 );
+				void				GenerateMTC1( u32 fs, EN64Reg rt, bool is64 );
+				void				GenerateCFC1( EN64Reg rt, u32 fs );
+				void				GenerateCop1Arithmetic( u32 funct, u32 fd, u32 fs, u32 ft, bool is_double );
+				void				GenerateCop1Sign( u32 funct, u32 fd, u32 fs, bool is_double );
+				void				GenerateCop1ToInteger( u32 funct, u32 fd, u32 fs, bool is_double );
+				void				GenerateCop1ToFloat( u32 fd, u32 fs, u32 src_fmt, bool to_double );
+				void				GenerateCop1Compare( u32 cond, u32 fs, u32 ft, bool is_double );
+				void				GenerateBranchCop1( bool if_true, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+
+		// What mxcsr is known to round with at this point in the fragment. It's
+		// only reloaded when an op needs something else, and put back to the
+		// guest's mode on the way out if we ever changed it.
+		enum EHostRoundingMode
+		{
+			HRM_UNKNOWN,
+			HRM_GUEST,			// As FCR31 says
+			HRM_NEAREST,
+			HRM_CEIL,
+			HRM_FLOOR,
+		};
+				void				SetHostRoundingMode( EHostRoundingMode mode );
+				void				LoadGuestRoundingMode();
+				void				RestoreGuestRoundingMode();
+
+				EHostRoundingMode	mHostRoundingMode;
+				bool				mUsedFixedRoundingMode;
+};
+
+#endif // SYSLINUX_DYNAREC_X64_CODEGENERATORX64_H_
@@ -0,0 +1,118 @@
+#include <stdafx.h>
+#include "SysLinux/DynaRec/x64/CodeGeneratorX64.h"
+#include "DynaRec/AssemblyBuffer.h"
+#include "DynaRec/StaticAnalysis.h"
+#include "DynaRec/Trace.h"
+#include "DynaRec/TraceRecorder.h"
+#include "Core/CPU.h"
+#include "Core/R4300.h"
+#include "OSHLE/ultra_R4300.h"
+
+#include <string.h>
+#include <sys/mman.h>
+#include <xmmintrin.h>
+
+#include <gtest/gtest.h>
+
+extern void R4300_Init();
+
+enum { FMT_S = 16, FMT_D = 17 };
+
+static u32 MakeCop1( u32 fmt, u32 ft, u32 fs, u32 fd, u32 funct )
+{
+	return (OP_COPRO1 << 26) | (fmt << 21) | (ft << 16) | (fs << 11) | (fd << 6) | funct;
+}
+
+static STraceEntry MakeEntry( u32 address, u32 op )
+{
+	STraceEntry entry;
+	entry.Address = address;
+	entry.OpCode._u32 = op;
+	entry.BranchIdx = ~0;
+	entry.BranchDelaySlot = false;
+	StaticAnalysis::Analyse( entry.OpCode, entry.Usage );
+	return entry;
+}
+
+// FPU registers hold doubles in consecutive pairs, starting at any register
+static void SetDouble( u32 reg, f64 value )		{ memcpy( &gCPUState.FPU[ reg ], &value, sizeof( value ) ); }
+static f64 GetDouble( u32 reg )					{ f64 value; memcpy( &value, &gCPUState.FPU[ reg ], sizeof( value ) ); return value; }
+static void SetFloat( u32 reg, f32 value )		{ memcpy( &gCPUState.FPU[ reg ], &value, sizeof( value ) ); }
+
+class CodeGeneratorX64Test : public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		mMemory = (u8 *)mmap( NULL, kMemorySize, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+		ASSERT_NE( MAP_FAILED, (void *)mMemory );
+
+		CAssemblyBuffer	thunk_buffer;
+		thunk_buffer.SetBuffer( mMemory );
+		mThunk = CCodeGeneratorX64::GenerateEntryThunk( &thunk_buffer );
+
+		memset( &gCPUState, 0, sizeof( gCPUState ) );
+		mSavedCSR = _mm_getcsr();
+	}
+
+	virtual void TearDown()
+	{
+		_mm_setcsr( mSavedCSR );
+		munmap( mMemory, kMemorySize );
+	}
+
+	// Compiles the ops as one straight line trace and runs it
+	void Run( const u32 * ops, u32 num_ops )
+	{
+		std::vector< STraceEntry >	trace;
+		for( u32 i = 0; i < num_ops; ++i )
+			trace.push_back( MakeEntry( 0x80000000 + i * 4, ops[ i ] ) );
+
+		SRegisterUsageInfo	usage;
+		CTraceRecorder::Analyse( trace, usage );
+
+		CAssemblyBuffer		primary;
+		CAssemblyBuffer		secondary;
+		primary.SetBuffer( mMemory + 4096 );
+		secondary.SetBuffer( mMemory + kMemorySize / 2 );
+
+		CCodeGeneratorX64	generator( &primary, &secondary );
+		generator.Initialise( 0x80000000, 0, NULL, &gCPUState, usage );
+		for( u32 i = 0; i < trace.size(); ++i )
+			generator.GenerateOpCode( trace[ i ], false, NULL, NULL );
+		generator.RET();
+
+		mThunk( generator.GetEntryPoint().GetTarget(), &gCPUState, NULL );
+	}
+
+	static const u32	kMemorySize = 64 * 1024;
+
+	u8 *				mMemory;
+	EnterDynaRecThunk	mThunk;
+	u32					mSavedCSR;
+};
+
+// FLOOR.W.S switches mxcsr to round down. ADD.D on an odd register pair isn't
+// compiled, so it goes through the interpreter, which must see the guest's
+// round to nearest mode rather than the FLOOR left behind.
+TEST_F(CodeGeneratorX64Test, InterpretedCop1OpUsesGuestRoundingMode)
+{
+	R4300_Init();
+	gCPUState.FPUControl[31]._u32 = FPCSR_RM_RN;
+
+	SetFloat( 10, -2.5f );
+	SetDouble( 1, -1.0 );
+	SetDouble( 3, -1e-30 );
+
+	const u32 ops[] =
+	{
+		MakeCop1( FMT_S, 0, 10, 12, 15 ),		// FLOOR.W.S f12, f10
+		MakeCop1( FMT_D, 3, 1, 5, 0 ),			// ADD.D f5, f1, f3
+	};
+	Run( ops, sizeof( ops ) / sizeof( ops[ 0 ] ) );
+
+	EXPECT_EQ( -3, gCPUState.FPU[ 12 ]._s32 );
+
+	// Rounding down would give the next double below -1.0
+	EXPECT_EQ( -1.0, GetDouble( 5 ) );
+}
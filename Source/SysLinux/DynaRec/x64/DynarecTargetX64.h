@@ -0,0 +1,89 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef SYSLINUX_DYNAREC_X64_DYNARECTARGETX64_H_
+#define SYSLINUX_DYNAREC_X64_DYNARECTARGETX64_H_
+
+// AMD64 register codes. Bit 3 is encoded in the REX prefix
+enum EX64Reg {
+	INVALID_CODE = 0xFFFFFFFF,
+	RAX_CODE = 0,
+	RCX_CODE = 1,
+	RDX_CODE = 2,
+	RBX_CODE = 3,
+	RSP_CODE = 4,
+	RBP_CODE = 5,
+	RSI_CODE = 6,
+	RDI_CODE = 7,
+	R8_CODE = 8,
+	R9_CODE = 9,
+	R10_CODE = 10,
+	R11_CODE = 11,
+	R12_CODE = 12,
+	R13_CODE = 13,
+	R14_CODE = 14,
+	R15_CODE = 15,
+
+	NUM_X64_REGISTERS = 16,
+};
+
+// SSE register codes. These are only used as scratch registers within an op
+enum EX64XmmReg {
+	XMM0_CODE = 0,
+	XMM1_CODE = 1,
+};
+
+// Condition codes for Jcc/SETcc (low nibble of the opcode)
+enum EX64Cond {
+	X64Cond_B	= 0x2,
+	X64Cond_AE	= 0x3,
+	X64Cond_E	= 0x4,
+	X64Cond_NE	= 0x5,
+	X64Cond_BE	= 0x6,
+	X64Cond_A	= 0x7,
+	X64Cond_P	= 0xa,
+	X64Cond_NP	= 0xb,
+	X64Cond_L	= 0xc,
+	X64Cond_GE	= 0xd,
+	X64Cond_LE	= 0xe,
+	X64Cond_G	= 0xf,
+};
+
+inline EX64Cond X64Cond_Invert( EX64Cond cond )		{ return EX64Cond( cond ^ 1 ); }
+
+//
+//	System V AMD64 register roles inside generated code.
+//	These are all callee saved, so they survive calls to the R4300 handlers.
+//
+static const EX64Reg	X64Reg_CPUState		= R15_CODE;		// &gCPUState
+static const EX64Reg	X64Reg_RamBase		= R14_CODE;		// g_pu8RamBase_8000
+
+// Registers available for caching N64 GPRs
+static const EX64Reg	gX64CacheRegisters[] = { RBX_CODE, RBP_CODE, R12_CODE, R13_CODE };
+static const u32		NUM_X64_CACHE_REGISTERS = sizeof( gX64CacheRegisters ) / sizeof( gX64CacheRegisters[0] );
+
+// Argument registers
+static const EX64Reg	X64Reg_Arg0			= RDI_CODE;
+static const EX64Reg	X64Reg_Arg1			= RSI_CODE;
+static const EX64Reg	X64Reg_Arg2			= RDX_CODE;
+static const EX64Reg	X64Reg_Arg3			= RCX_CODE;
+
+#endif // SYSLINUX_DYNAREC_X64_DYNARECTARGETX64_H_
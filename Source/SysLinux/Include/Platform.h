@@ -31,6 +31,46 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #define DAEDALUS_ENDIAN_MODE DAEDALUS_ENDIAN_LITTLE
 
+// The x86-64 (System V) dynarec backend lives in SysLinux/DynaRec/x64
+#if defined(__x86_64__)
+#define DAEDALUS_ENABLE_DYNAREC
+#endif
+
+// Assemble dynarec fragments on a worker thread (see DynaRec/FragmentCompiler.h)
+#ifdef DAEDALUS_ENABLE_DYNAREC
+#define DAEDALUS_ENABLE_BACKGROUND_COMPILE
+#endif
+
+// Keep the traces behind compiled fragments between runs (see DynaRec/TraceCache.h)
+#ifdef DAEDALUS_ENABLE_DYNAREC
+#define DAEDALUS_ENABLE_TRACE_CACHE
+#endif
+
+// KSEG0/KSEG1 accesses go through a reserved 4GB window (see Core/FastMem.h)
+#if defined(__x86_64__)
+#define DAEDALUS_ENABLE_FASTMEM
+#endif
+
+// Dispatch the cached interpreter through computed gotos (see Core/R4300_Threaded.inl)
+#ifdef __GNUC__
+#define DAEDALUS_THREADED_INTERPRETER
+#endif
+
+// Load zipped roms, indexed for random access (see Utility/ROMFileZipIndex.h)
+#define DAEDALUS_COMPRESSED_ROM_SUPPORT
+
+// Map uncompressed roms from disk instead of loading them (see Utility/ROMFileMapping.h)
+#define DAEDALUS_ROM_MMAP
+
+// Read ahead of sequential accesses to streamed roms (see Utility/ROMFileCache.h)
+#define DAEDALUS_ROM_READAHEAD
+
+// Write savestates out on a worker thread (see Core/SaveState.h)
+#define DAEDALUS_ASYNC_SAVESTATES
+
+// Keep recent states in memory to rewind to (see Core/Rewind.h)
+#define DAEDALUS_REWIND
+
 #ifdef __GNUC__
 #define DAEDALUS_EXPECT_LIKELY(c) __builtin_expect((c),1)
 #define DAEDALUS_EXPECT_UNLIKELY(c) __builtin_expect((c),0)
@@ -0,0 +1,361 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Core/FastMem.h"
+
+#ifdef DAEDALUS_ENABLE_FASTMEM
+
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "Core/Memory.h"
+#include "Debug/DBGConsole.h"
+
+u8 *						gFastMemBase = NULL;
+
+static const u64			kFastMemSize = 0x100000000ULL;
+static const u32			kKSeg0 = 0x80000000;
+static const u32			kKSeg1 = 0xA0000000;
+static const u32			kMaxRegions = 4;
+
+struct FastMemRegion
+{
+	u8 *		HostView;
+	u32			Size;
+};
+
+static FastMemRegion		gRegions[ kMaxRegions ];
+static u32					gNumRegions = 0;
+static struct sigaction		gPreviousSegvAction;
+
+// Map from x86 register number to the index in mcontext_t::gregs
+static const int			kGRegIndex[ 16 ] =
+{
+	REG_RAX, REG_RCX, REG_RDX, REG_RBX, REG_RSP, REG_RBP, REG_RSI, REG_RDI,
+	REG_R8,  REG_R9,  REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15,
+};
+
+struct FaultingAccess
+{
+	u32			Length;			// Instruction length in bytes
+	u32			Size;			// Access size in bytes
+	bool		IsLoad;
+	bool		ZeroExtend;		// movzx
+	bool		HighByte;		// ah/ch/dh/bh
+	u32			Reg;			// Register loaded/stored
+	uintptr_t	EffectiveAddress;
+};
+
+//*****************************************************************************
+//	Decode the load/store at the faulting instruction. Only the forms
+//	emitted by the accessors in Core/FastMem.h need to be handled.
+//*****************************************************************************
+static bool FastMem_DecodeAccess( const u8 * p_code, const greg_t * gregs, FaultingAccess & access )
+{
+	const u8 *	p = p_code;
+	bool		operand_size_16 = false;
+	u8			rex = 0;
+
+	if( *p == 0x66 )
+	{
+		operand_size_16 = true;
+		p++;
+	}
+	if( (*p & 0xf0) == 0x40 )
+	{
+		rex = *p++;
+	}
+
+	u32 default_size = (rex & 0x08) ? 8 : (operand_size_16 ? 2 : 4);
+
+	access.ZeroExtend = false;
+	switch( *p++ )
+	{
+	case 0x0f:
+		switch( *p++ )
+		{
+		case 0xb6:	access.IsLoad = true; access.Size = 1; access.ZeroExtend = true; break;
+		case 0xb7:	access.IsLoad = true; access.Size = 2; access.ZeroExtend = true; break;
+		default:	return false;
+		}
+		break;
+	case 0x8a:	access.IsLoad = true;  access.Size = 1; break;
+	case 0x8b:	access.IsLoad = true;  access.Size = default_size; break;
+	case 0x88:	access.IsLoad = false; access.Size = 1; break;
+	case 0x89:	access.IsLoad = false; access.Size = default_size; break;
+	default:
+		return false;
+	}
+
+	u8	modrm = *p++;
+	u32	mod = modrm >> 6;
+	u32	rm = modrm & 7;
+
+	if( mod == 3 )
+		return false;
+
+	access.Reg = ((modrm >> 3) & 7) | ((rex & 0x04) ? 8 : 0);
+	access.HighByte = false;
+	if( access.Size == 1 && !access.ZeroExtend && rex == 0 && access.Reg >= 4 )
+	{
+		access.HighByte = true;
+		access.Reg -= 4;
+	}
+
+	uintptr_t	address = 0;
+	bool		no_base = false;
+	if( rm == 4 )
+	{
+		u8	sib = *p++;
+		u32	scale = sib >> 6;
+		u32	index = ((sib >> 3) & 7) | ((rex & 0x02) ? 8 : 0);
+		u32	base = (sib & 7) | ((rex & 0x01) ? 8 : 0);
+
+		if( index != 4 )
+		{
+			address += uintptr_t( gregs[ kGRegIndex[ index ] ] ) << scale;
+		}
+		if( (base & 7) == 5 && mod == 0 )
+		{
+			no_base = true;
+		}
+		else
+		{
+			address += uintptr_t( gregs[ kGRegIndex[ base ] ] );
+		}
+	}
+	else if( rm == 5 && mod == 0 )
+	{
+		// RIP relative - never used for guest accesses
+		return false;
+	}
+	else
+	{
+		address += uintptr_t( gregs[ kGRegIndex[ rm | ((rex & 0x01) ? 8 : 0) ] ] );
+	}
+
+	if( mod == 1 )
+	{
+		address += intptr_t( s8( *p ) );
+		p += 1;
+	}
+	else if( mod == 2 || no_base )
+	{
+		s32 disp;
+		memcpy( &disp, p, sizeof( disp ) );
+		address += intptr_t( disp );
+		p += 4;
+	}
+
+	access.EffectiveAddress = address;
+	access.Length = u32( p - p_code );
+	return true;
+}
+
+//*****************************************************************************
+//	Perform the access through the memory lookup tables, in the same way
+//	the non-fastmem accessors in Memory.h would.
+//*****************************************************************************
+static bool FastMem_HandleFault( ucontext_t * context )
+{
+	greg_t *	gregs = context->uc_mcontext.gregs;
+	const u8 *	p_code = reinterpret_cast< const u8 * >( gregs[ REG_RIP ] );
+
+	FaultingAccess access;
+	if( !FastMem_DecodeAccess( p_code, gregs, access ) )
+		return false;
+
+	uintptr_t offset = access.EffectiveAddress - reinterpret_cast< uintptr_t >( gFastMemBase );
+	if( offset >= kFastMemSize )
+		return false;
+
+	u32			address = u32( offset );
+	greg_t &	reg = gregs[ kGRegIndex[ access.Reg ] ];
+
+	if( access.IsLoad )
+	{
+		u64 value;
+		switch( access.Size )
+		{
+		case 1:	value = *(u8 *)ReadAddress( address );	break;
+		case 2:	value = *(u16 *)ReadAddress( address );	break;
+		case 4:	value = *(u32 *)ReadAddress( address );	break;
+		default: value = *(u64 *)ReadAddress( address );	break;
+		}
+
+		if( access.ZeroExtend || access.Size >= 4 )
+		{
+			// 32 bit writes to a register clear the upper half
+			reg = greg_t( value );
+		}
+		else if( access.HighByte )
+		{
+			reg = greg_t( (u64( reg ) & ~0xff00ULL) | (value << 8) );
+		}
+		else
+		{
+			u64 mask = (access.Size == 1) ? 0xffULL : 0xffffULL;
+			reg = greg_t( (u64( reg ) & ~mask) | value );
+		}
+	}
+	else
+	{
+		u64 value = access.HighByte ? (u64( reg ) >> 8) : u64( reg );
+		switch( access.Size )
+		{
+		case 1:	*(u8 *)ReadAddress( address ) = u8( value );		break;
+		case 2:	*(u16 *)ReadAddress( address ) = u16( value );	break;
+		case 4:	WriteAddress( address, u32( value ) );				break;
+		default: *(u64 *)ReadAddress( address ) = value;			break;
+		}
+	}
+
+	gregs[ REG_RIP ] += access.Length;
+	return true;
+}
+
+static void FastMem_SignalHandler( int sig, siginfo_t * info, void * context )
+{
+	uintptr_t fault_address = reinterpret_cast< uintptr_t >( info->si_addr );
+	if( gFastMemBase != NULL &&
+		fault_address - reinterpret_cast< uintptr_t >( gFastMemBase ) < kFastMemSize &&
+		FastMem_HandleFault( reinterpret_cast< ucontext_t * >( context ) ) )
+	{
+		return;
+	}
+
+	// Not one of ours - pass it on
+	if( gPreviousSegvAction.sa_flags & SA_SIGINFO )
+	{
+		gPreviousSegvAction.sa_sigaction( sig, info, context );
+	}
+	else if( gPreviousSegvAction.sa_handler == SIG_DFL || gPreviousSegvAction.sa_handler == SIG_IGN )
+	{
+		// Restore the default action, and let the faulting instruction re-execute
+		sigaction( SIGSEGV, &gPreviousSegvAction, NULL );
+	}
+	else
+	{
+		gPreviousSegvAction.sa_handler( sig );
+	}
+}
+
+bool FastMem_Init()
+{
+	DAEDALUS_ASSERT( gFastMemBase == NULL, "Fastmem already initialised" );
+
+	void * base = mmap( NULL, kFastMemSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+	if( base == MAP_FAILED )
+	{
+		DBGConsole_Msg( 0, "Unable to reserve fastmem address space" );
+		return false;
+	}
+
+	struct sigaction action;
+	memset( &action, 0, sizeof( action ) );
+	action.sa_sigaction = FastMem_SignalHandler;
+	action.sa_flags = SA_SIGINFO;
+	sigemptyset( &action.sa_mask );
+
+	if( sigaction( SIGSEGV, &action, &gPreviousSegvAction ) != 0 )
+	{
+		munmap( base, kFastMemSize );
+		return false;
+	}
+
+	gFastMemBase = reinterpret_cast< u8 * >( base );
+	gNumRegions = 0;
+	return true;
+}
+
+void FastMem_Fini()
+{
+	if( gFastMemBase == NULL )
+		return;
+
+	for( u32 i = 0; i < gNumRegions; ++i )
+	{
+		munmap( gRegions[ i ].HostView, gRegions[ i ].Size );
+	}
+	gNumRegions = 0;
+
+	munmap( gFastMemBase, kFastMemSize );
+	gFastMemBase = NULL;
+
+	sigaction( SIGSEGV, &gPreviousSegvAction, NULL );
+}
+
+u8 * FastMem_MapRegion( u32 physical_address, u32 size )
+{
+	DAEDALUS_ASSERT( gFastMemBase != NULL, "Fastmem not initialised" );
+	DAEDALUS_ASSERT( gNumRegions < kMaxRegions, "Too many fastmem regions" );
+	DAEDALUS_ASSERT( ((physical_address | size) & (getpagesize() - 1)) == 0, "Fastmem regions must be page aligned" );
+
+	int fd = memfd_create( "daedalus-fastmem", MFD_CLOEXEC );
+	if( fd < 0 )
+		return NULL;
+
+	u8 * host_view = NULL;
+	if( ftruncate( fd, size ) == 0 )
+	{
+		void * p = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+		if( p != MAP_FAILED )
+		{
+			void * k0 = mmap( gFastMemBase + (kKSeg0 | physical_address), size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 );
+			void * k1 = mmap( gFastMemBase + (kKSeg1 | physical_address), size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 );
+
+			if( k0 != MAP_FAILED && k1 != MAP_FAILED )
+			{
+				host_view = reinterpret_cast< u8 * >( p );
+			}
+			else
+			{
+				munmap( p, size );
+			}
+		}
+	}
+
+	// The mappings keep the memory alive
+	close( fd );
+
+	if( host_view != NULL )
+	{
+		FastMemRegion & region = gRegions[ gNumRegions++ ];
+		region.HostView = host_view;
+		region.Size = size;
+	}
+
+	return host_view;
+}
+
+void FastMem_SetAccessible( u32 physical_address, u32 size, bool accessible )
+{
+	if( gFastMemBase == NULL )
+		return;
+
+	int prot = accessible ? (PROT_READ | PROT_WRITE) : PROT_NONE;
+	mprotect( gFastMemBase + (kKSeg0 | physical_address), size, prot );
+	mprotect( gFastMemBase + (kKSeg1 | physical_address), size, prot );
+}
+
+#endif // DAEDALUS_ENABLE_FASTMEM
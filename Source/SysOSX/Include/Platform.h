@@ -32,6 +32,18 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define DAEDALUS_COMPRESSED_ROM_SUPPORT
 #define DAEDALUS_ENABLE_OS_HOOKS
 
+// Map uncompressed roms from disk instead of loading them (see Utility/ROMFileMapping.h)
+#define DAEDALUS_ROM_MMAP
+
+// Read ahead of sequential accesses to streamed roms (see Utility/ROMFileCache.h)
+#define DAEDALUS_ROM_READAHEAD
+
+// Write savestates out on a worker thread (see Core/SaveState.h)
+#define DAEDALUS_ASYNC_SAVESTATES
+
+// Keep recent states in memory to rewind to (see Core/Rewind.h)
+#define DAEDALUS_REWIND
+
 #define DAEDALUS_ENDIAN_MODE DAEDALUS_ENDIAN_LITTLE
 
 #ifdef __GNUC__
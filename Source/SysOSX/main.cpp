@@ -127,7 +127,8 @@ int main(int argc, char **argv)
 }
 
 //FIXME: All this stuff needs tidying
-
+// The Linux x86-64 build provides these in SysLinux/DynaRec/x64
+#ifndef DAEDALUS_ENABLE_DYNAREC
 void Dynarec_ClearedCPUStuffToDo()
 {
 }
@@ -143,4 +144,5 @@ void _EnterDynaRec()
 	DAEDALUS_ASSERT(false, "Unimplemented");
 }
 }
+#endif // DAEDALUS_ENABLE_DYNAREC
 
@@ -103,6 +103,24 @@ bool	PatchJumpLongAndFlush( CJumpLocation jump, CCodeLabel target )
 	return false;
 }
 
+//*****************************************************************************
+//	Decode the target of a jump written by PatchJumpLong
+//*****************************************************************************
+CCodeLabel	GetJumpLongTarget( CJumpLocation jump )
+{
+	// Read through the uncached pointer, as that's what PatchJumpLong writes to
+	const PspOpCode &	op_code( *reinterpret_cast< const PspOpCode * >( jump.GetWritableU8P() ) );
+	u32					jump_address( u32( reinterpret_cast< uintptr_t >( jump.GetTargetU8P() ) ) );
+
+	if( op_code.op == OP_J || op_code.op == OP_JAL )
+	{
+		return CCodeLabel( reinterpret_cast< const void * >( ( jump_address & 0xf0000000 ) | ( op_code.target << 2 ) ) );
+	}
+
+	s32		offset( ( s32( s16( op_code.offset ) ) + 1 ) << 2 );
+	return CCodeLabel( jump.GetTargetU8P() + offset );
+}
+
 //*****************************************************************************
 //	Replace a branch instruction with an unconditional jump
 //*****************************************************************************
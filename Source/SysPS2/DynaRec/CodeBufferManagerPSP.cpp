@@ -19,6 +19,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "stdafx.h"
 #include "DynaRec/CodeBufferManager.h"
+#include "DynaRec/CodeBufferRegions.h"
 
 #include "Math/MathUtil.h"
 
@@ -30,57 +31,43 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 extern "C" { void _DaedalusICacheInvalidate( const void * address, u32 length ); }
 
+//	Each buffer is split into this many regions, which the fragment cache
+//	evicts one at a time (see CCodeBufferRegions).
+static const u32	NUM_REGIONS		= 4;
+
+// This is a bit of a hack. We assume that no single entry will generate more than
+// 32k of storage. If there appear to be problems with this assumption, this
+// value can be enlarged
+static const u32	MAX_BLOCK_SIZE	= 32768;
+
 struct SCodeBuffer
 {
 	u8	*						mpBuffer;
-	u32							mBufferPtr;
 	u32							mBufferSize;
 
 	SCodeBuffer()
 		:	mpBuffer( NULL )
-		,	mBufferPtr( 0 )
 		,	mBufferSize( 0 )
 	{
 	}
 
 	void	Initialise( u32 size)
 	{
-		mBufferPtr = 0;
 		mBufferSize = size;
 		mpBuffer = new u8[ size ];
 	}
 
 	void	Finalise()
 	{
-		sceKernelIcacheInvalidateRange( mpBuffer, mBufferPtr );
+		sceKernelIcacheInvalidateRange( mpBuffer, mBufferSize );
 		if (mpBuffer != NULL)
 		{
 			delete [] mpBuffer;
 			mpBuffer = NULL;
 		}
-		mBufferPtr = 0;
 		mBufferSize = 0;
 	}
 
-	void	Reset()
-	{
-		mBufferPtr = 0;
-	}
-
-	u8 *	StartNewBlock()
-	{
-		// Round up to 64 byte boundary - i.e. one cache line
-		u8 *	p_rounded( (u8*)AlignPow2( (u32)(mpBuffer + mBufferPtr), 64 ) );
-		mBufferPtr = p_rounded - mpBuffer;
-
-		// This is a bit of a hack. We assume that no single entry will generate more than
-		// 32k of storage. If there appear to be problems with this assumption, this
-		// value can be enlarged
-		DAEDALUS_ASSERT( mBufferPtr + 32768 <= mBufferSize, "Out of memory for dynamic recompiler" );
-
-		return mpBuffer + mBufferPtr;
-	}
-
 	void	Consume( const u8 * p_base, u32 used_size )
 	{
 		//	DAEDALUS_ASSERT( AlignPow2( (u32)p_base, 64 ) == (u32)p_base, "Base ptr is not aligned" );
@@ -95,8 +82,17 @@ struct SCodeBuffer
 		{
 			_DaedalusICacheInvalidate( p_lower, size );
 		}
+	}
 
-		mBufferPtr += used_size;
+	// Offset of the first 64 byte aligned address in the buffer
+	u32		GetAlignedStart() const
+	{
+		return (u8*)AlignPow2( (u32)mpBuffer, 64 ) - mpBuffer;
+	}
+
+	bool	Contains( const u8 * p ) const
+	{
+		return p >= mpBuffer && p < mpBuffer + mBufferSize;
 	}
 
 };
@@ -117,11 +113,20 @@ public:
 	virtual CCodeGenerator *	StartNewBlock();
 	virtual u32					FinaliseCurrentBlock();
 
+	virtual u32					GetNumRegions() const					{ return mRegions.GetNumRegions(); }
+	virtual u32					GetCurrentRegion() const				{ return mRegions.GetCurrentRegion(); }
+	virtual bool				IsRegionInUse( u32 region ) const		{ return mRegions.IsRegionInUse( region ); }
+	virtual u32					GetNumFreeBlocks() const				{ return mRegions.GetNumFreeBlocks(); }
+	virtual void				FreeRegion( u32 region )				{ mRegions.FreeRegion( region ); }
+	virtual bool				IsInRegion( u32 region, const void * p ) const;
+
 private:
 
 	SCodeBuffer					mPrimaryBuffer;
 	SCodeBuffer					mSecondaryBuffer;
 
+	CCodeBufferRegions			mRegions;
+
 private:
 	CAssemblyBuffer				mAssemblyBufferA;
 	CAssemblyBuffer				mAssemblyBufferB;
@@ -149,6 +154,9 @@ bool	CCodeBufferManagerPSP::Initialise()
 	mPrimaryBuffer.Initialise( 3 * 1024 * 1024 );
 	mSecondaryBuffer.Initialise( 3 * 1024 * 1024 );
 #endif
+	// Blocks start on a 64 byte boundary - i.e. one cache line
+	mRegions.Initialise( NUM_REGIONS, mPrimaryBuffer.GetAlignedStart(), mPrimaryBuffer.mBufferSize / NUM_REGIONS,
+						 mSecondaryBuffer.GetAlignedStart(), mSecondaryBuffer.mBufferSize / NUM_REGIONS, 64, MAX_BLOCK_SIZE );
 	return true;
 }
 
@@ -157,8 +165,7 @@ bool	CCodeBufferManagerPSP::Initialise()
 //*****************************************************************************
 void	CCodeBufferManagerPSP::Reset()
 {
-	mPrimaryBuffer.Reset();
-	mSecondaryBuffer.Reset();
+	mRegions.Reset();
 }
 
 //*****************************************************************************
@@ -175,8 +182,11 @@ void	CCodeBufferManagerPSP::Finalise()
 //*****************************************************************************
 CCodeGenerator * CCodeBufferManagerPSP::StartNewBlock()
 {
-	u8 * primary( mPrimaryBuffer.StartNewBlock() );
-	u8 * secondary( mSecondaryBuffer.StartNewBlock() );
+	bool ok( mRegions.StartNewBlock() );
+	DAEDALUS_ASSERT( ok, "Out of memory for dynamic recompiler" );
+
+	u8 * primary( mPrimaryBuffer.mpBuffer + mRegions.GetPrimaryPtr() );
+	u8 * secondary( mSecondaryBuffer.mpBuffer + mRegions.GetSecondaryPtr() );
 
 	mAssemblyBufferA.SetBuffer( primary );
 	mAssemblyBufferB.SetBuffer( secondary );
@@ -198,5 +208,22 @@ u32 CCodeBufferManagerPSP::FinaliseCurrentBlock()
 
 	mSecondaryBuffer.Consume( p_base_b, main_block_size_b );
 
+	mRegions.FinaliseBlock( main_block_size_a, main_block_size_b );
+
 	return main_block_size_a;
 }
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool CCodeBufferManagerPSP::IsInRegion( u32 region, const void * p ) const
+{
+	const u8 *	p_u8( reinterpret_cast< const u8 * >( p ) );
+
+	if( mSecondaryBuffer.Contains( p_u8 ) )
+	{
+		return mRegions.IsSecondaryInRegion( region, p_u8 - mSecondaryBuffer.mpBuffer );
+	}
+
+	return mRegions.IsPrimaryInRegion( region, p_u8 - mPrimaryBuffer.mpBuffer );
+}
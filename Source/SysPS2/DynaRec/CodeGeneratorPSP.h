@@ -45,12 +45,15 @@ class CCodeGeneratorPSP : public CCodeGenerator, public CAssemblyWriterPSP
 		virtual RegisterSnapshotHandle	GetRegisterSnapshot();
 
 		virtual CCodeLabel			GetEntryPoint() const;
+		virtual CCodeLabel			GetLinkedEntryPoint() const					{ return GetEntryPoint(); }
+		virtual const SRegisterContract &	GetEntryContract() const			{ return mEntryContract; }
 		virtual CCodeLabel			GetCurrentLocation() const;
 		virtual u32					GetCompiledCodeSize() const;
 
 		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment );
 		virtual void				GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * p_map );
 		virtual void				GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map );
+		virtual void				GeneratePushReturnAddress( SIndirectExitEntry * p_return_site );
 
 		virtual void				GenerateBranchHandler( CJumpLocation branch_handler_jump, RegisterSnapshotHandle snapshot );
 
@@ -303,6 +306,7 @@ private:
 
 				u32					mEntryAddress;
 				CCodeLabel			mLoopTop;
+				SRegisterContract	mEntryContract;		// Always empty, cached registers are loaded on demand and flushed on exit (see RegisterContract.h)
 				bool				mUseFixedRegisterAllocation;
 
 				std::vector< CN64RegisterCachePSP >	mRegisterSnapshots;
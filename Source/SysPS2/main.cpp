@@ -43,6 +43,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Core/Save.h"
 #include "Debug/DBGConsole.h"
 #include "Debug/DebugLog.h"
+#include "DynaRec/FragmentCache.h"
 #include "Graphics/GraphicsContext.h"
 #include "HLEGraphics/TextureCache.h"
 #include "Input/InputManager.h"
@@ -291,6 +292,14 @@ static void	DumpDynarecStats( float elapsed_time )
 		cached_regs_ratio = u32( fRatio );
 	}
 
+	u32		tlb_hit_ratio( 0 );
+	if(gTLBReadHit + gTLBReadMiss > 0)
+	{
+		float fRatio = float(gTLBReadHit * 100.0f / float(gTLBReadHit+gTLBReadMiss));
+
+		tlb_hit_ratio = u32( fRatio );
+	}
+
 	const char * const TERMINAL_SAVE_CURSOR			= "\033[s";
 	const char * const TERMINAL_RESTORE_CURSOR		= "\033[u";
 //	const char * const TERMINAL_TOP_LEFT			= "\033[2A\033[2K";
@@ -299,7 +308,10 @@ static void	DumpDynarecStats( float elapsed_time )
 	printf( TERMINAL_SAVE_CURSOR );
 	printf( TERMINAL_TOP_LEFT );
 
-	printf( "Frame: %dms, DynaRec %d%%, Regs cached %d%%, Lookup success %d/%d", u32(elapsed_time * 1000.0f), dynarec_ratio, cached_regs_ratio, gFragmentLookupSuccess, gFragmentLookupFailure );
+	printf( "Frame: %dms, DynaRec %d%%, Regs cached %d%%, Lookup success %d/%d, TLB hit %d%%", u32(elapsed_time * 1000.0f), dynarec_ratio, cached_regs_ratio, gFragmentLookupSuccess, gFragmentLookupFailure, tlb_hit_ratio );
+
+	const CFragmentCache::SStats &	cache_stats( gFragmentCache.GetStats() );
+	printf( ", Code %dKB, Evicted %d (%d), Invalidated %d, Recompiled %d", gFragmentCache.GetOutputLength() / 1024, cache_stats.Evictions, cache_stats.EvictedFragments, cache_stats.InvalidatedFragments, cache_stats.Recompilations );
 
 	printf( TERMINAL_RESTORE_CURSOR );
 	fflush( stdout );
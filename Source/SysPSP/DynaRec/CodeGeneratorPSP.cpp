@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "CodeGeneratorPSP.h"
 
 #include <limits.h>
+#include <stddef.h>
 #include <stdio.h>
 
 #include <algorithm>
@@ -35,6 +36,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Core/ROM.h"
 #include "Debug/DBGConsole.h"
 #include "DynaRec/AssemblyUtils.h"
+#include "DynaRec/IndirectExitMap.h"
 #include "DynaRec/Trace.h"
 #include "Math/MathUtil.h"
 #include "OSHLE/ultra_R4300.h"
@@ -1179,6 +1181,26 @@ void CCodeGeneratorPSP::GenerateIndirectExitCode( u32 num_instructions, CIndirec
 	}
 }
 
+//*****************************************************************************
+// gReturnStack.Entries[ ++Top & RETURN_STACK_MASK ] = p_return_site
+// _IndirectExitCheck pops it, and relies on these sizes
+//*****************************************************************************
+DAEDALUS_STATIC_ASSERT( sizeof( SIndirectExitEntry ) == 8 );
+DAEDALUS_STATIC_ASSERT( RETURN_STACK_MASK == 15 );
+
+void CCodeGeneratorPSP::GeneratePushReturnAddress( SIndirectExitEntry * p_return_site )
+{
+	LoadConstant( PspReg_V1, reinterpret_cast< s32 >( &gReturnStack ) );
+	LW( PspReg_V0, PspReg_V1, offsetof( SReturnStack, Top ) );
+	ADDIU( PspReg_V0, PspReg_V0, 1 );
+	SW( PspReg_V0, PspReg_V1, offsetof( SReturnStack, Top ) );
+	ANDI( PspReg_V0, PspReg_V0, RETURN_STACK_MASK );
+	SLL( PspReg_V0, PspReg_V0, 2 );
+	ADDU( PspReg_V1, PspReg_V1, PspReg_V0 );
+	LoadConstant( PspReg_V0, reinterpret_cast< s32 >( p_return_site ) );
+	SW( PspReg_V0, PspReg_V1, offsetof( SReturnStack, Entries ) );
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
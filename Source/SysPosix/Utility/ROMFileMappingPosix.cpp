@@ -0,0 +1,153 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Utility/ROMFileMapping.h"
+
+#include "Debug/DBGConsole.h"
+#include "Debug/Dump.h"
+#include "Math/MathUtil.h"
+#include "Utility/IO.h"
+#include "Utility/ROMFile.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	u8 *		MapFile( const char * filename, u32 length )
+	{
+		int fd( open( filename, O_RDONLY ) );
+		if( fd < 0 )
+			return NULL;
+
+		// The mapping holds its own reference to the file. It's private so
+		// writes to it stay in memory
+		void * p( mmap( NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 ) );
+		close( fd );
+
+		if( p == MAP_FAILED )
+			return NULL;
+
+		return static_cast< u8 * >( p );
+	}
+
+	// Size and timestamp alone don't catch a different rom copied in with an
+	// older mtime, so the swapped header (magic and both CRCs) must match too
+	bool		IsCacheValid( ROMFile * p_rom_file, const char * cache_filename, const char * rom_filename, u32 rom_size )
+	{
+		struct stat		rom_stat;
+		struct stat		cache_stat;
+
+		if( stat( rom_filename, &rom_stat ) != 0 || stat( cache_filename, &cache_stat ) != 0 )
+			return false;
+
+		if( cache_stat.st_size != off_t( rom_size ) || cache_stat.st_mtime < rom_stat.st_mtime )
+			return false;
+
+		const u32		HEADER_SIZE = 64;
+		u8				rom_header[ HEADER_SIZE ];
+		u8				cache_header[ HEADER_SIZE ];
+
+		if( rom_size < HEADER_SIZE || !p_rom_file->ReadChunk( 0, rom_header, HEADER_SIZE ) )
+			return false;
+
+		FILE * fh( fopen( cache_filename, "rb" ) );
+		if( fh == NULL )
+			return false;
+
+		bool	ok( fread( cache_header, 1, HEADER_SIZE, fh ) == HEADER_SIZE );
+		fclose( fh );
+
+		return ok && memcmp( rom_header, cache_header, HEADER_SIZE ) == 0;
+	}
+
+	// The cache is written to a temporary file and renamed into place, so another
+	// instance opening the same rom never maps a partially written cache
+	bool		WriteCache( ROMFile * p_rom_file, const char * cache_filename, u32 rom_size )
+	{
+		IO::Filename	temp_filename;
+		snprintf( temp_filename, sizeof( temp_filename ), "%s.%d", cache_filename, int( getpid() ) );
+
+		FILE * fh( fopen( temp_filename, "wb" ) );
+		if( fh == NULL )
+			return false;
+
+		const u32		TEMP_BUFFER_SIZE = 256 * 1024;
+		u8 *			p_temp_buffer( new u8[ TEMP_BUFFER_SIZE ] );
+		bool			ok( true );
+
+		for( u32 offset = 0; offset < rom_size && ok; offset += TEMP_BUFFER_SIZE )
+		{
+			u32		length( Min( rom_size - offset, TEMP_BUFFER_SIZE ) );
+
+			// ReadChunk hands the data back already swapped
+			ok = p_rom_file->ReadChunk( offset, p_temp_buffer, length ) &&
+				 fwrite( p_temp_buffer, 1, length, fh ) == length;
+		}
+
+		delete [] p_temp_buffer;
+
+		ok = fclose( fh ) == 0 && ok;
+		ok = ok && IO::File::Move( temp_filename, cache_filename );
+		if( !ok )
+		{
+			IO::File::Delete( temp_filename );
+		}
+		return ok;
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u8 * ROMFileMapping_Open( ROMFile * p_rom_file, const char * filename, u32 rom_size )
+{
+	if( p_rom_file->IsCompressed() || rom_size == 0 )
+		return NULL;
+
+	if( !p_rom_file->RequiresSwapping() )
+		return MapFile( filename, rom_size );
+
+	IO::Filename	cache_filename;
+	Dump_GetSaveDirectory( cache_filename, filename, ".romcache" );
+
+	if( !IsCacheValid( p_rom_file, cache_filename, filename, rom_size ) )
+	{
+#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Writing byteswapped rom to [C%s]", cache_filename );
+#endif
+		if( !WriteCache( p_rom_file, cache_filename, rom_size ) )
+			return NULL;
+	}
+
+	return MapFile( cache_filename, rom_size );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void ROMFileMapping_Close( u8 * p_bytes, u32 rom_size )
+{
+	munmap( p_bytes, rom_size );
+}
@@ -70,4 +70,26 @@ bool	PatchJumpLongAndFlush( CJumpLocation jump, CCodeLabel target )
 	return PatchJumpLong( jump, target );
 }
 
+//*****************************************************************************
+//	Decode the target of a jump written by PatchJumpLong
+//*****************************************************************************
+CCodeLabel	GetJumpLongTarget( CJumpLocation jump )
+{
+	const u8 *	p_jump_addr( jump.GetTargetU8P() );
+
+	if( *p_jump_addr == 0xe8 || *p_jump_addr == 0xe9 )
+	{
+		s32		offset( *reinterpret_cast< const s32 * >( p_jump_addr + 1 ) );
+		return CCodeLabel( p_jump_addr + 5 + offset );
+	}
+	else if( *p_jump_addr == 0x0f )
+	{
+		s32		offset( *reinterpret_cast< const s32 * >( p_jump_addr + 2 ) );
+		return CCodeLabel( p_jump_addr + 6 + offset );
+	}
+
+	DAEDALUS_ERROR( "Unhandled jump type" );
+	return CCodeLabel();
+}
+
 }
@@ -355,6 +355,7 @@ void CCodeGeneratorX86::GenerateIndirectExitCode( u32 num_instructions, CIndirec
 	RET();
 
 	// gCPUState.StuffToDo == 0, try to jump to the indirect target
+	// The return stack and inline cache are checked by IndirectExitMap_Lookup
 	PatchJumpLong( jump_to_next_fragment, GetAssemblyBuffer()->GetLabel() );
 
 	MOVI( ECX_CODE, reinterpret_cast< u32 >( p_map ) );
@@ -850,6 +851,21 @@ bool CCodeGeneratorX86::GenerateLWC1( u32 ft, EN64Reg base, s16 offset )
 	return false;
 }
 
+//*****************************************************************************
+// gReturnStack.Entries[ ++Top & RETURN_STACK_MASK ] = p_return_site
+//*****************************************************************************
+void CCodeGeneratorX86::GeneratePushReturnAddress( SIndirectExitEntry * p_return_site )
+{
+	MOV_REG_MEM( EAX_CODE, &gReturnStack.Top );
+	ADDI( EAX_CODE, 1 );
+	MOV_MEM_REG( &gReturnStack.Top, EAX_CODE );
+	ANDI( EAX_CODE, RETURN_STACK_MASK );
+	SHLI( EAX_CODE, 2 );
+	ADDI( EAX_CODE, reinterpret_cast< s32 >( gReturnStack.Entries ) );
+	MOVI( ECX_CODE, reinterpret_cast< u32 >( p_return_site ) );
+	MOV_MEM_BASE_REG( EAX_CODE, ECX_CODE );
+}
+
 void	CCodeGeneratorX86::GenerateJAL( u32 address )
 {
 	MOVI(EAX_CODE, address + 8);
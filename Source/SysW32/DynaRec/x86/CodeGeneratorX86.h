@@ -46,12 +46,15 @@ class CCodeGeneratorX86 : public CCodeGenerator, public CAssemblyWriterX86
 		virtual RegisterSnapshotHandle	GetRegisterSnapshot();
 
 		virtual CCodeLabel			GetEntryPoint() const;
+		virtual CCodeLabel			GetLinkedEntryPoint() const					{ return GetEntryPoint(); }
+		virtual const SRegisterContract &	GetEntryContract() const			{ return mEntryContract; }
 		virtual CCodeLabel			GetCurrentLocation() const;
 		virtual u32					GetCompiledCodeSize() const;
 
 		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment );
 		virtual void				GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * p_map );
 		virtual void				GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map );
+		virtual void				GeneratePushReturnAddress( SIndirectExitEntry * p_return_site );
 
 		virtual void				GenerateBranchHandler( CJumpLocation branch_handler_jump, RegisterSnapshotHandle snapshot );
 
@@ -80,6 +83,7 @@ class CCodeGeneratorX86 : public CCodeGenerator, public CAssemblyWriterX86
 
 				CAssemblyBuffer *	mpPrimary;
 				CAssemblyBuffer *	mpSecondary;
+				SRegisterContract	mEntryContract;		// Always empty, nothing is cached across instructions
 
 	private:
 				void	GenerateLoad(u32 memBase, EN64Reg base, s16 offset, u8 twiddle, u8 bits);
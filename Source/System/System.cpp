@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Core/PIF.h"
 #include "Core/ROMBuffer.h"
 #include "Core/RomSettings.h"
+#include "Core/Rewind.h"
 
 #include "Interface/RomDB.h"
 #ifdef DAEDALUS_PSP
@@ -55,6 +56,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Debug/DBGConsole.h"
 #include "Debug/DebugLog.h"
+#include "Debug/GuestProfiler.h"
 
 #include "Plugins/GraphicsPlugin.h"
 #include "Plugins/AudioPlugin.h"
@@ -206,10 +208,16 @@ static const RomEntityEntry gRomInitTable[] =
 	{"Graphics",			InitGraphicsPlugin,		DisposeGraphicsPlugin},
 	{"FramerateLimiter",	FramerateLimiter_Reset,	NULL},
 	//{"RSP", RSP_Reset, NULL},
+#ifdef DAEDALUS_ENABLE_GUEST_PROFILER
+	{"GuestProfiler",		GuestProfiler::Open,	GuestProfiler::Close},
+#endif
 	{"CPU",					CPU_RomOpen,			CPU_RomClose},
 	{"ROM",					ROM_ReBoot,				ROM_Unload},
 	{"Controller",			CController::Reset,		CController::RomClose},
 	{"Save",				Save_Reset,				Save_Fini},
+#ifdef DAEDALUS_REWIND
+	{"Rewind",				Rewind_Open,			Rewind_Close},
+#endif
 #ifdef DAEDALUS_ENABLE_SYNCHRONISATION
 	{"CSynchroniser",		CSynchroniser::InitialiseSynchroniser, CSynchroniser::Destroy},
 #endif
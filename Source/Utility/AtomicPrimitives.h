@@ -47,6 +47,11 @@ inline u32 AtomicBitSet( volatile u32 * ptr, u32 and_bits, u32 or_bits )
 	return _AtomicBitSet( ptr, and_bits, or_bits );
 }
 
+inline void AtomicMemoryBarrier()
+{
+	__asm__ __volatile__( "sync" : : : "memory" );
+}
+
 #elif defined( DAEDALUS_W32 )
 
 #include <intrin.h>
@@ -80,6 +85,11 @@ inline u32 AtomicBitSet( volatile u32 * ptr, u32 and_bits, u32 or_bits )
 	return new_value;
 }
 
+inline void AtomicMemoryBarrier()
+{
+	MemoryBarrier();
+}
+
 #elif defined( DAEDALUS_OSX ) || defined( DAEDALUS_LINUX )
 
 inline u32 AtomicIncrement( volatile u32 * ptr )
@@ -103,6 +113,11 @@ inline u32 AtomicBitSet( volatile u32 * ptr, u32 and_bits, u32 or_bits )
 	return r;
 }
 
+inline void AtomicMemoryBarrier()
+{
+	__sync_synchronize();
+}
+
 
 #else
 
@@ -0,0 +1,628 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Utility/ByteSwap.h"
+
+#include "Utility/Alignment.h"
+#include "Utility/Endian.h"
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define BYTESWAP_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BYTESWAP_TARGET( x )
+#else
+#define BYTESWAP_TARGET( x )	__attribute__(( target( x ) ))
+#endif
+#endif
+
+namespace
+{
+
+struct SByteSwapKernels
+{
+	void	(*Swap32)( void * p_bytes, u32 length );
+	void	(*Swap16)( void * p_bytes, u32 length );
+	void	(*CopyN64)( void * dst, const void * src, u32 length, u32 dst_twiddle );
+};
+
+//*****************************************************************************
+//	Scalar reference
+//*****************************************************************************
+inline u32 Reverse32( u32 x )
+{
+	return (x >> 24) | ((x >> 8) & 0xFF00) | ((x & 0xFF00) << 8) | (x << 24);
+}
+
+void Swap32_Scalar( void * p_bytes, u32 length )
+{
+	u32 * p( (u32 *)p_bytes );
+	for( u32 i = 0; i < length / 4; ++i )
+	{
+		p[ i ] = Reverse32( p[ i ] );
+	}
+}
+
+void Swap16_Scalar( void * p_bytes, u32 length )
+{
+	u32 * p( (u32 *)p_bytes );
+	for( u32 i = 0; i < length / 4; ++i )
+	{
+		p[ i ] = (p[ i ] >> 16) | (p[ i ] << 16);
+	}
+}
+
+//*****************************************************************************
+// Copy between two N64 buffers, shifting whole words across when the source
+// and destination don't line up (this was memcpy_byteswap) //Corn
+//*****************************************************************************
+void CopySwizzled_Scalar( void * dst, const void * src, u32 size )
+{
+	u8* src8 = (u8*)src;
+	u8* dst8 = (u8*)dst;
+	u32* src32;
+	u32* dst32;
+	// < 4 isn't worth trying any optimisations...
+	if(size>=4)
+	{
+		// Align dst on 4 bytes or just resume if already done
+		while (((((uintptr_t)dst8) & 0x3)!=0) )
+		{
+			*(u8*)((uintptr_t)dst8++ ^ U8_TWIDDLE) = *(u8*)((uintptr_t)src8++ ^ U8_TWIDDLE);
+			size--;
+		}
+		// We are dst aligned now but need at least 4 bytes to copy
+		if(size>=4)
+		{
+			src32 = (u32*)src8;
+			dst32 = (u32*)dst8;
+			u32 srcTmp;
+			u32 dstTmp;
+			u32 size32 = size >> 2;
+			size &= 0x3;
+			switch( (uintptr_t)src8&0x3 )
+			{
+				case 0:	//Both src and dst are aligned to 4 bytes
+					{
+						//This is faster than PSP's GCC memcpy
+						while (size32&0x3)
+						{
+							*dst32++ = *src32++;
+							size32--;
+						}
+
+						u32 size128 = size32 >> 2;
+						while (size128--)
+						{
+							*dst32++ = *src32++;
+							*dst32++ = *src32++;
+							*dst32++ = *src32++;
+							*dst32++ = *src32++;
+						}
+
+						src8 = (u8*)src32;
+					}
+					break;
+
+				case 1:	//Handle offset by 1
+					{
+						src32 = (u32*)((uintptr_t)src8 & ~0x3);
+						srcTmp = *src32++;
+						while(size32--)
+						{
+							dstTmp = srcTmp << 8;
+							srcTmp = *src32++;
+							dstTmp |= srcTmp >> 24;
+							*dst32++ = dstTmp;
+						}
+						src8 = (u8*)src32 - 3;
+					}
+					break;
+
+				case 2:	//Handle offset by 2
+					{
+						src32 = (u32*)((uintptr_t)src8 & ~0x3);
+						srcTmp = *src32++;
+						while(size32--)
+						{
+							dstTmp = srcTmp << 16;
+							srcTmp = *src32++;
+							dstTmp |= srcTmp >> 16;
+							*dst32++ = dstTmp;
+						}
+						src8 = (u8*)src32 - 2;
+					}
+					break;
+
+				case 3:	//Handle offset by 3
+					{
+						src32 = (u32*)((uintptr_t)src8 & ~0x3);
+						srcTmp = *src32++;
+						while(size32--)
+						{
+							dstTmp = srcTmp << 24;
+							srcTmp = *src32++;
+							dstTmp |= srcTmp >> 8;
+							*dst32++ = dstTmp;
+						}
+						src8 = (u8*)src32 - 1;
+					}
+					break;
+			}
+			dst8 = (u8*)dst32;
+		}
+	}
+
+	// Copy the remaing byte by byte...
+	while(size--)
+	{
+		*(u8*)((uintptr_t)dst8++ ^ U8_TWIDDLE) = *(u8*)((uintptr_t)src8++ ^ U8_TWIDDLE);
+	}
+}
+
+void CopyN64_Scalar( void * dst, const void * src, u32 length, u32 dst_twiddle )
+{
+	if( dst_twiddle == U8_TWIDDLE )
+	{
+		CopySwizzled_Scalar( dst, src, length );
+		return;
+	}
+
+	u8 *		d( (u8 *)dst );
+	const u8 *	s( (const u8 *)src );
+
+	// Whole words can be swapped across when the destination is word aligned
+	if( ( ( (uintptr_t)d | dst_twiddle ) & 0x3 ) == 0 && length >= 4 )
+	{
+		const u32 src_alignment( (uintptr_t)s & 0x3 );
+		if( src_alignment == 0 )
+		{
+			for( ; length >= 4; length -= 4, d += 4, s += 4 )
+			{
+				*(u32 *)( (uintptr_t)d ^ dst_twiddle ) = BSWAP32( *(const u32 *)s );
+			}
+		}
+		else
+		{
+			// Zelda and DK64 have unaligned TMEM loads, so merge each pair of
+			// source words rather than dropping to the byte loop. Only words
+			// holding at least one source byte are read.
+			const u32 *	src32( (const u32 *)( (uintptr_t)s & ~0x3 ) );
+			const u32	lshift( src_alignment << 3 );
+			const u32	rshift( 32 - lshift );
+			u32			src_tmp( *src32++ );
+
+			for( ; length >= 4; length -= 4, d += 4, s += 4 )
+			{
+				u32 dst_tmp( src_tmp << lshift );
+				src_tmp = *src32++;
+				dst_tmp |= src_tmp >> rshift;
+				*(u32 *)( (uintptr_t)d ^ dst_twiddle ) = BSWAP32( dst_tmp );
+			}
+		}
+	}
+
+	while( length-- )
+	{
+		*(u8 *)( (uintptr_t)d++ ^ dst_twiddle ) = *(const u8 *)( (uintptr_t)s++ ^ U8_TWIDDLE );
+	}
+}
+
+const SByteSwapKernels gScalarKernels = { Swap32_Scalar, Swap16_Scalar, CopyN64_Scalar };
+
+#ifdef BYTESWAP_X86
+//*****************************************************************************
+//	x86. CopyN64 works on 16 byte aligned blocks of dst; byte j of a block
+//	comes from byte ((r + (j ^ dst_twiddle)) ^ 3) of the source, counted from
+//	the word r bytes before it. That can span 20 bytes, so the shuffle is split
+//	across two loads.
+//*****************************************************************************
+typedef u32 (*CopyBlocksFunction)( u8 * d, const u8 * s, u32 length, u32 dst_twiddle );
+
+struct SCopyMasks
+{
+	ALIGNED_MEMBER( u8, Lo[ 16 ], 16 );
+	ALIGNED_MEMBER( u8, Hi[ 16 ], 16 );
+};
+
+SCopyMasks	gCopyMasks[ 4 ][ 16 ];		// [source misalignment][dst_twiddle]
+
+void BuildCopyMasks()
+{
+	for( u32 r = 0; r < 4; ++r )
+	{
+		for( u32 twiddle = 0; twiddle < 16; ++twiddle )
+		{
+			SCopyMasks & masks( gCopyMasks[ r ][ twiddle ] );
+			for( u32 j = 0; j < 16; ++j )
+			{
+				u32 idx( ( r + ( j ^ twiddle ) ) ^ 3 );
+				masks.Lo[ j ] = idx < 16 ? u8( idx ) : 0x80;
+				masks.Hi[ j ] = idx >= 16 ? u8( idx - 16 ) : 0x80;
+			}
+		}
+	}
+}
+
+void CopyN64_Blocks( void * dst, const void * src, u32 length, u32 dst_twiddle, CopyBlocksFunction copy_blocks )
+{
+	// Not worth setting up the blocks for short copies, or for twiddles
+	// that move bytes between blocks
+	if( length < 32 || dst_twiddle >= 16 )
+	{
+		CopyN64_Scalar( dst, src, length, dst_twiddle );
+		return;
+	}
+
+	u8 *		d( (u8 *)dst );
+	const u8 *	s( (const u8 *)src );
+
+	while( (uintptr_t)d & 15 )
+	{
+		*(u8 *)( (uintptr_t)d++ ^ dst_twiddle ) = *(const u8 *)( (uintptr_t)s++ ^ U8_TWIDDLE );
+		--length;
+	}
+
+	u32 done( copy_blocks( d, s, length, dst_twiddle ) );
+
+	CopyN64_Scalar( d + done, s + done, length - done, dst_twiddle );
+}
+
+//*****************************************************************************
+//	SSE2 - only whole word moves, so the source has to line up with dst
+//*****************************************************************************
+inline __m128i Reverse32_SSE2( __m128i v )
+{
+	v = _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+	v = _mm_shufflelo_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+	return _mm_shufflehi_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+}
+
+void Swap32_SSE2( void * p_bytes, u32 length )
+{
+	u8 * p( (u8 *)p_bytes );
+	for( ; length >= 16; length -= 16, p += 16 )
+	{
+		_mm_storeu_si128( (__m128i *)p, Reverse32_SSE2( _mm_loadu_si128( (const __m128i *)p ) ) );
+	}
+	Swap32_Scalar( p, length );
+}
+
+void Swap16_SSE2( void * p_bytes, u32 length )
+{
+	u8 * p( (u8 *)p_bytes );
+	for( ; length >= 16; length -= 16, p += 16 )
+	{
+		__m128i v( _mm_loadu_si128( (const __m128i *)p ) );
+		v = _mm_shufflelo_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		v = _mm_shufflehi_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		_mm_storeu_si128( (__m128i *)p, v );
+	}
+	Swap16_Scalar( p, length );
+}
+
+template< int kWordShuffle, bool kReverse >
+u32 CopyBlocksT_SSE2( u8 * d, const u8 * s, u32 length )
+{
+	u32 done( 0 );
+	for( ; length - done >= 16; done += 16 )
+	{
+		__m128i v( _mm_loadu_si128( (const __m128i *)( s + done ) ) );
+		if( kReverse )
+		{
+			v = Reverse32_SSE2( v );
+		}
+		_mm_store_si128( (__m128i *)( d + done ), _mm_shuffle_epi32( v, kWordShuffle ) );
+	}
+	return done;
+}
+
+u32 CopyBlocks_SSE2( u8 * d, const u8 * s, u32 length, u32 dst_twiddle )
+{
+	if( (uintptr_t)s & 0x3 )
+		return 0;
+
+	switch( dst_twiddle )
+	{
+	case 0:				return CopyBlocksT_SSE2< _MM_SHUFFLE( 3, 2, 1, 0 ), true >( d, s, length );
+	case 4:				return CopyBlocksT_SSE2< _MM_SHUFFLE( 2, 3, 0, 1 ), true >( d, s, length );
+	case 8:				return CopyBlocksT_SSE2< _MM_SHUFFLE( 1, 0, 3, 2 ), true >( d, s, length );
+	case U8_TWIDDLE:	return CopyBlocksT_SSE2< _MM_SHUFFLE( 3, 2, 1, 0 ), false >( d, s, length );
+	}
+	return 0;
+}
+
+void CopyN64_SSE2( void * dst, const void * src, u32 length, u32 dst_twiddle )
+{
+	CopyN64_Blocks( dst, src, length, dst_twiddle, CopyBlocks_SSE2 );
+}
+
+const SByteSwapKernels gSSE2Kernels = { Swap32_SSE2, Swap16_SSE2, CopyN64_SSE2 };
+
+//*****************************************************************************
+//	SSSE3
+//*****************************************************************************
+BYTESWAP_TARGET( "ssse3" )
+void Swap32_SSSE3( void * p_bytes, u32 length )
+{
+	const __m128i mask( _mm_setr_epi8( 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 ) );
+
+	u8 * p( (u8 *)p_bytes );
+	for( ; length >= 16; length -= 16, p += 16 )
+	{
+		_mm_storeu_si128( (__m128i *)p, _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *)p ), mask ) );
+	}
+	Swap32_Scalar( p, length );
+}
+
+BYTESWAP_TARGET( "ssse3" )
+u32 CopyBlocks_SSSE3( u8 * d, const u8 * s, u32 length, u32 dst_twiddle )
+{
+	const u32			r( (uintptr_t)s & 0x3 );
+	const u8 *			b4( s - r );
+	const SCopyMasks &	masks( gCopyMasks[ r ][ dst_twiddle ] );
+	const __m128i		lo_mask( _mm_load_si128( (const __m128i *)masks.Lo ) );
+	const __m128i		hi_mask( _mm_load_si128( (const __m128i *)masks.Hi ) );
+
+	u32 done( 0 );
+	if( r == 0 )
+	{
+		for( ; length - done >= 16; done += 16 )
+		{
+			__m128i v( _mm_loadu_si128( (const __m128i *)( b4 + done ) ) );
+			_mm_store_si128( (__m128i *)( d + done ), _mm_shuffle_epi8( v, lo_mask ) );
+		}
+	}
+	else
+	{
+		// The second load reads up to 31 bytes past b4, so stop short of the end
+		for( ; length - done >= 32; done += 16 )
+		{
+			__m128i lo( _mm_loadu_si128( (const __m128i *)( b4 + done ) ) );
+			__m128i hi( _mm_loadu_si128( (const __m128i *)( b4 + done + 16 ) ) );
+			_mm_store_si128( (__m128i *)( d + done ), _mm_or_si128( _mm_shuffle_epi8( lo, lo_mask ), _mm_shuffle_epi8( hi, hi_mask ) ) );
+		}
+	}
+	return done;
+}
+
+void CopyN64_SSSE3( void * dst, const void * src, u32 length, u32 dst_twiddle )
+{
+	CopyN64_Blocks( dst, src, length, dst_twiddle, CopyBlocks_SSSE3 );
+}
+
+const SByteSwapKernels gSSSE3Kernels = { Swap32_SSSE3, Swap16_SSE2, CopyN64_SSSE3 };
+
+//*****************************************************************************
+//	AVX2 - the shuffles stay within 16 byte lanes, so the same masks work
+//*****************************************************************************
+BYTESWAP_TARGET( "avx2" )
+void Swap32_AVX2( void * p_bytes, u32 length )
+{
+	const __m256i mask( _mm256_setr_epi8( 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+										  3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 ) );
+
+	u8 * p( (u8 *)p_bytes );
+	for( ; length >= 32; length -= 32, p += 32 )
+	{
+		_mm256_storeu_si256( (__m256i *)p, _mm256_shuffle_epi8( _mm256_loadu_si256( (const __m256i *)p ), mask ) );
+	}
+	Swap32_SSSE3( p, length );
+}
+
+BYTESWAP_TARGET( "avx2" )
+void Swap16_AVX2( void * p_bytes, u32 length )
+{
+	const __m256i mask( _mm256_setr_epi8( 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+										  2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13 ) );
+
+	u8 * p( (u8 *)p_bytes );
+	for( ; length >= 32; length -= 32, p += 32 )
+	{
+		_mm256_storeu_si256( (__m256i *)p, _mm256_shuffle_epi8( _mm256_loadu_si256( (const __m256i *)p ), mask ) );
+	}
+	Swap16_SSE2( p, length );
+}
+
+BYTESWAP_TARGET( "avx2" )
+u32 CopyBlocks_AVX2( u8 * d, const u8 * s, u32 length, u32 dst_twiddle )
+{
+	const u32			r( (uintptr_t)s & 0x3 );
+	const u8 *			b4( s - r );
+	const SCopyMasks &	masks( gCopyMasks[ r ][ dst_twiddle ] );
+	const __m256i		lo_mask( _mm256_broadcastsi128_si256( _mm_load_si128( (const __m128i *)masks.Lo ) ) );
+	const __m256i		hi_mask( _mm256_broadcastsi128_si256( _mm_load_si128( (const __m128i *)masks.Hi ) ) );
+
+	u32 done( 0 );
+	if( r == 0 )
+	{
+		for( ; length - done >= 32; done += 32 )
+		{
+			__m256i v( _mm256_loadu_si256( (const __m256i *)( b4 + done ) ) );
+			_mm256_storeu_si256( (__m256i *)( d + done ), _mm256_shuffle_epi8( v, lo_mask ) );
+		}
+	}
+	else
+	{
+		for( ; length - done >= 48; done += 32 )
+		{
+			__m256i lo( _mm256_loadu_si256( (const __m256i *)( b4 + done ) ) );
+			__m256i hi( _mm256_loadu_si256( (const __m256i *)( b4 + done + 16 ) ) );
+			_mm256_storeu_si256( (__m256i *)( d + done ), _mm256_or_si256( _mm256_shuffle_epi8( lo, lo_mask ), _mm256_shuffle_epi8( hi, hi_mask ) ) );
+		}
+	}
+
+	return done + CopyBlocks_SSSE3( d + done, s + done, length - done, dst_twiddle );
+}
+
+void CopyN64_AVX2( void * dst, const void * src, u32 length, u32 dst_twiddle )
+{
+	CopyN64_Blocks( dst, src, length, dst_twiddle, CopyBlocks_AVX2 );
+}
+
+const SByteSwapKernels gAVX2Kernels = { Swap32_AVX2, Swap16_AVX2, CopyN64_AVX2 };
+
+bool IsLevelSupported( EByteSwapLevel level )
+{
+	switch( level )
+	{
+	case BSL_SCALAR:
+	case BSL_SSE2:
+		return true;
+#ifdef _MSC_VER
+	case BSL_SSSE3:
+		{
+			int info[ 4 ];
+			__cpuid( info, 1 );
+			return ( info[ 2 ] & ( 1 << 9 ) ) != 0;
+		}
+	case BSL_AVX2:
+		{
+			int info[ 4 ];
+			__cpuid( info, 0 );
+			if( info[ 0 ] < 7 )
+				return false;
+			__cpuid( info, 1 );
+			const int osxsave_avx( ( 1 << 27 ) | ( 1 << 28 ) );
+			if( ( info[ 2 ] & osxsave_avx ) != osxsave_avx || ( _xgetbv( 0 ) & 0x6 ) != 0x6 )
+				return false;
+			__cpuidex( info, 7, 0 );
+			return ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+		}
+#else
+	case BSL_SSSE3:
+		return __builtin_cpu_supports( "ssse3" );
+	case BSL_AVX2:
+		return __builtin_cpu_supports( "avx2" );
+#endif
+	default:
+		return false;
+	}
+}
+#else
+bool IsLevelSupported( EByteSwapLevel level )
+{
+	return level == BSL_SCALAR;
+}
+#endif // BYTESWAP_X86
+
+//*****************************************************************************
+//	Dispatch. The table starts out pointing at stubs which pick the best
+//	kernels the first time any of them is called.
+//*****************************************************************************
+void Swap32_Select( void * p_bytes, u32 length );
+void Swap16_Select( void * p_bytes, u32 length );
+void CopyN64_Select( void * dst, const void * src, u32 length, u32 dst_twiddle );
+
+SByteSwapKernels	gKernels = { Swap32_Select, Swap16_Select, CopyN64_Select };
+EByteSwapLevel		gLevel( BSL_SCALAR );
+
+void SelectBestKernels()
+{
+	ByteSwap_SetLevel( ByteSwap_GetBestLevel() );
+}
+
+void Swap32_Select( void * p_bytes, u32 length )
+{
+	SelectBestKernels();
+	gKernels.Swap32( p_bytes, length );
+}
+
+void Swap16_Select( void * p_bytes, u32 length )
+{
+	SelectBestKernels();
+	gKernels.Swap16( p_bytes, length );
+}
+
+void CopyN64_Select( void * dst, const void * src, u32 length, u32 dst_twiddle )
+{
+	SelectBestKernels();
+	gKernels.CopyN64( dst, src, length, dst_twiddle );
+}
+
+} // anonymous namespace
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void ByteSwap_Swap32( void * p_bytes, u32 length )
+{
+	gKernels.Swap32( p_bytes, length );
+}
+
+void ByteSwap_Swap16( void * p_bytes, u32 length )
+{
+	gKernels.Swap16( p_bytes, length );
+}
+
+void ByteSwap_CopyN64( void * dst, const void * src, u32 length, u32 dst_twiddle )
+{
+	gKernels.CopyN64( dst, src, length, dst_twiddle );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+EByteSwapLevel ByteSwap_GetBestLevel()
+{
+	for( s32 level = NUM_BYTESWAP_LEVELS - 1; level > BSL_SCALAR; --level )
+	{
+		if( IsLevelSupported( EByteSwapLevel( level ) ) )
+			return EByteSwapLevel( level );
+	}
+	return BSL_SCALAR;
+}
+
+EByteSwapLevel ByteSwap_GetLevel()
+{
+	return gLevel;
+}
+
+bool ByteSwap_SetLevel( EByteSwapLevel level )
+{
+	if( !IsLevelSupported( level ) )
+		return false;
+
+	switch( level )
+	{
+#ifdef BYTESWAP_X86
+	case BSL_SSE2:	BuildCopyMasks(); gKernels = gSSE2Kernels;	break;
+	case BSL_SSSE3:	BuildCopyMasks(); gKernels = gSSSE3Kernels;	break;
+	case BSL_AVX2:	BuildCopyMasks(); gKernels = gAVX2Kernels;	break;
+#endif
+	default:		gKernels = gScalarKernels;					break;
+	}
+
+	gLevel = level;
+	return true;
+}
+
+const char * ByteSwap_GetLevelName( EByteSwapLevel level )
+{
+	switch( level )
+	{
+	case BSL_SCALAR:	return "Scalar";
+	case BSL_SSE2:		return "SSE2";
+	case BSL_SSSE3:		return "SSSE3";
+	case BSL_AVX2:		return "AVX2";
+	default:			return "?";
+	}
+}
@@ -0,0 +1,60 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef UTILITY_BYTESWAP_H_
+#define UTILITY_BYTESWAP_H_
+
+#include "Utility/DaedalusTypes.h"
+
+//
+//	Byte order kernels. N64 memory is kept as host order words, so byte n
+//	lives at n ^ U8_TWIDDLE; these convert between that and plain byte order.
+//	The best implementation the CPU supports is picked on first use, the
+//	scalar versions are the reference the others are tested against.
+//
+
+// Reverse the bytes of each u32 in place (e.g. .z64 roms, 3210)
+void	ByteSwap_Swap32( void * p_bytes, u32 length );
+
+// Swap the u16 halves of each u32 in place (e.g. .v64 roms, 2301)
+void	ByteSwap_Swap16( void * p_bytes, u32 length );
+
+// Copy length bytes of N64 memory at src, storing byte i at (dst + i) ^ dst_twiddle.
+// Twiddles are applied to the absolute addresses, so the alignment of dst and
+// src matters. A dst_twiddle of U8_TWIDDLE copies between two N64 buffers,
+// 0 unswizzles into plain byte order and 4/8 swap alternate words/dwords
+// as odd TMEM lines require.
+void	ByteSwap_CopyN64( void * dst, const void * src, u32 length, u32 dst_twiddle );
+
+enum EByteSwapLevel
+{
+	BSL_SCALAR = 0,
+	BSL_SSE2,
+	BSL_SSSE3,
+	BSL_AVX2,
+
+	NUM_BYTESWAP_LEVELS
+};
+
+EByteSwapLevel	ByteSwap_GetBestLevel();
+EByteSwapLevel	ByteSwap_GetLevel();
+bool			ByteSwap_SetLevel( EByteSwapLevel level );		// Fails if the CPU doesn't support it
+const char *	ByteSwap_GetLevelName( EByteSwapLevel level );
+
+#endif // UTILITY_BYTESWAP_H_
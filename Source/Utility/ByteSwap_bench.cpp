@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Throughput of the byte order kernels at every level the CPU supports.
+//	Swap32/Swap16 run over a rom sized buffer, CopyN64 over TMEM sized lines
+//	(4KB) both with the source word aligned and offset by one byte, for the
+//	plain (0) and N64 (U8_TWIDDLE) destination layouts.
+//
+//	Usage: ByteSwap_bench
+//
+
+#include "stdafx.h"
+#include "Utility/ByteSwap.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Utility/Endian.h"
+#include "Utility/Timing.h"
+
+namespace
+{
+	const u32	kSwapSize = 8 * 1024 * 1024;
+	const u32	kCopySize = 4 * 1024;
+	const u32	kCopyRepeats = 2048;
+	const u32	kNumRuns = 10;
+
+	u64 Now()
+	{
+		u64 time;
+		NTiming::GetPreciseTime( &time );
+		return time;
+	}
+
+	void Report( const char * level, const char * name, u64 ticks, u64 bytes )
+	{
+		u64 freq;
+		NTiming::GetPreciseFrequency( &freq );
+
+		double seconds( double( ticks ) / double( freq ) );
+		printf( "%-8s %-24s %8.2f GB/s\n", level, name, double( bytes ) / seconds / 1e9 );
+	}
+
+	void RunSwap( const char * level, const char * name, void (*swap)( void *, u32 ), u8 * p_bytes, u32 offset )
+	{
+		u64 best( ~0ULL );
+		for( u32 i = 0; i < kNumRuns; ++i )
+		{
+			u64 start( Now() );
+			swap( p_bytes + offset, kSwapSize );
+			u64 end( Now() );
+			if( end - start < best )	best = end - start;
+		}
+		Report( level, name, best, kSwapSize );
+	}
+
+	void RunCopy( const char * level, const char * name, u8 * dst, const u8 * src, u32 twiddle )
+	{
+		u64 best( ~0ULL );
+		for( u32 i = 0; i < kNumRuns; ++i )
+		{
+			u64 start( Now() );
+			for( u32 r = 0; r < kCopyRepeats; ++r )
+			{
+				ByteSwap_CopyN64( dst, src, kCopySize, twiddle );
+			}
+			u64 end( Now() );
+			if( end - start < best )	best = end - start;
+		}
+		Report( level, name, best, u64( kCopySize ) * kCopyRepeats );
+	}
+}
+
+int main( int argc, char * argv[] )
+{
+	// Extra room so the unaligned runs stay inside the buffers
+	u8 *	p_swap( new u8[ kSwapSize + 16 ] );
+	u8 *	p_src( new u8[ kCopySize + 16 ] );
+	u8 *	p_dst( new u8[ kCopySize + 16 ] );
+
+	for( u32 i = 0; i < kSwapSize + 16; ++i )		p_swap[ i ] = u8( i * 7 + 1 );
+	for( u32 i = 0; i < kCopySize + 16; ++i )		p_src[ i ] = u8( i * 13 + 5 );
+	memset( p_dst, 0, kCopySize + 16 );
+
+	// new[] is at least 8 byte aligned, which is all the kernels care about
+	u8 *	p_dst_aligned( p_dst + 8 );
+
+	for( u32 l = 0; l < NUM_BYTESWAP_LEVELS; ++l )
+	{
+		EByteSwapLevel	level( static_cast< EByteSwapLevel >( l ) );
+		if( !ByteSwap_SetLevel( level ) )
+			continue;
+
+		const char *	level_name( ByteSwap_GetLevelName( level ) );
+
+		// Swap32/Swap16 work on whole words, so only the address alignment varies
+		RunSwap( level_name, "Swap32 aligned", ByteSwap_Swap32, p_swap, 0 );
+		RunSwap( level_name, "Swap32 unaligned", ByteSwap_Swap32, p_swap, 1 );
+		RunSwap( level_name, "Swap16 aligned", ByteSwap_Swap16, p_swap, 0 );
+		RunSwap( level_name, "Swap16 unaligned", ByteSwap_Swap16, p_swap, 1 );
+
+		RunCopy( level_name, "CopyN64 plain aligned", p_dst_aligned, p_src + 8, 0 );
+		RunCopy( level_name, "CopyN64 plain unaligned", p_dst_aligned, p_src + 9, 0 );
+		RunCopy( level_name, "CopyN64 n64 aligned", p_dst_aligned, p_src + 8, U8_TWIDDLE );
+		RunCopy( level_name, "CopyN64 n64 unaligned", p_dst_aligned, p_src + 9, U8_TWIDDLE );
+	}
+
+	ByteSwap_SetLevel( ByteSwap_GetBestLevel() );
+
+	delete [] p_dst;
+	delete [] p_src;
+	delete [] p_swap;
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <stdafx.h>
+#include "Utility/ByteSwap.h"
+#include "Utility/Endian.h"
+#include "Utility/Alignment.h"
+
+#include <gtest/gtest.h>
+
+class ByteSwapCopyTest : public ::testing::TestWithParam< ::std::tr1::tuple<u32, u32, u32> >
+{
+protected:
+	virtual void SetUp()
+	{
+		for (u32 i = 0; i < 256; ++i)
+			mSrc[i] = (u8)(i * 7 + 1);
+		memset(mDst, 0, sizeof(mDst));
+		memset(mExpected, 0, sizeof(mExpected));
+	}
+
+	virtual void TearDown()
+	{
+		ByteSwap_SetLevel(ByteSwap_GetBestLevel());
+	}
+
+	ALIGNED_MEMBER(u8, mSrc[256], 64);
+	ALIGNED_MEMBER(u8, mDst[256], 64);
+	ALIGNED_MEMBER(u8, mExpected[256], 64);
+};
+
+// Byte i of the N64 memory at src lands at (dst + i) ^ twiddle
+static void copy_n64_reference( u8 * dst, u32 dst_off, const u8 * src, u32 src_off, u32 size, u32 twiddle )
+{
+	for (u32 i = 0; i < size; ++i)
+	{
+		dst[(dst_off + i) ^ twiddle] = src[(src_off + i) ^ U8_TWIDDLE];
+	}
+}
+
+TEST_P(ByteSwapCopyTest, MatchesReferenceAtEveryLevel)
+{
+	u32 src_off = ::std::tr1::get<0>(GetParam());
+	u32 dst_off = ::std::tr1::get<1>(GetParam());
+	u32 len = ::std::tr1::get<2>(GetParam());
+	static const u32 twiddles[] = { 0, U8_TWIDDLE, 0x4, 0x8 };
+
+	for (u32 level = 0; level < NUM_BYTESWAP_LEVELS; ++level)
+	{
+		if (!ByteSwap_SetLevel(EByteSwapLevel(level)))
+			continue;
+
+		for (u32 t = 0; t < ARRAYSIZE(twiddles); ++t)
+		{
+			memset(mDst, 0, sizeof(mDst));
+			memset(mExpected, 0, sizeof(mExpected));
+
+			ByteSwap_CopyN64(&mDst[16 + dst_off], &mSrc[src_off], len, twiddles[t]);
+			copy_n64_reference(mExpected, 16 + dst_off, mSrc, src_off, len, twiddles[t]);
+			EXPECT_EQ(0, memcmp(mExpected, mDst, sizeof(mDst))) << ByteSwap_GetLevelName(EByteSwapLevel(level)) << " twiddle " << twiddles[t];
+		}
+	}
+}
+
+INSTANTIATE_TEST_CASE_P(X, ByteSwapCopyTest, ::testing::Combine(::testing::Values(0,1,2,3,5,12),
+																::testing::Values(0,1,2,3,7,12),
+																::testing::Values(0,1,3,4,15,16,31,32,33,47,48,49,64,95,131)));
+
+TEST(ByteSwap, SwapsWordsAndHalfwordsAtEveryLevel)
+{
+	for (u32 level = 0; level < NUM_BYTESWAP_LEVELS; ++level)
+	{
+		if (!ByteSwap_SetLevel(EByteSwapLevel(level)))
+			continue;
+
+		for (u32 len = 0; len <= 96; len += 4)
+		{
+			u8 swap32[96];
+			u8 swap16[96];
+			for (u32 i = 0; i < 96; ++i)
+				swap32[i] = swap16[i] = (u8)i;
+
+			ByteSwap_Swap32(swap32, len);
+			ByteSwap_Swap16(swap16, len);
+			for (u32 i = 0; i < 96; ++i)
+			{
+				EXPECT_EQ(i < len ? (i ^ 3) : i, swap32[i]);
+				EXPECT_EQ(i < len ? (i ^ 2) : i, swap16[i]);
+			}
+		}
+	}
+	ByteSwap_SetLevel(ByteSwap_GetBestLevel());
+}
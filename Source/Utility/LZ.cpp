@@ -0,0 +1,236 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Utility/LZ.h"
+
+#include "Math/MathUtil.h"
+
+#include <string.h>
+
+namespace
+{
+	const u32	kHashBits = 12;
+	const u32	kMinMatch = 4;
+	const u32	kMaxOffset = 0xffff;
+	const u32	kSkipShift = 6;			// Step further through incompressible data the longer it goes on
+
+	inline u32 Read32( const u8 * p )
+	{
+		u32 v;
+		memcpy( &v, p, sizeof( v ) );
+		return v;
+	}
+
+	inline u64 Read64( const u8 * p )
+	{
+		u64 v;
+		memcpy( &v, p, sizeof( v ) );
+		return v;
+	}
+
+	inline u32 Hash( u32 v )
+	{
+		return ( v * 2654435761U ) >> ( 32 - kHashBits );
+	}
+
+	inline u8 * WriteLength( u8 * op, u32 length )
+	{
+		while( length >= 255 )
+		{
+			*op++ = 255;
+			length -= 255;
+		}
+		*op++ = u8( length );
+		return op;
+	}
+
+	u8 * WriteSequence( u8 * op, const u8 * literals, u32 num_literals, u32 offset, u32 match_length )
+	{
+		u8 *	token( op++ );
+		u32		match_code( match_length - kMinMatch );
+
+		*token = u8( ( Min< u32 >( num_literals, 15 ) << 4 ) | Min< u32 >( match_code, 15 ) );
+
+		if( num_literals >= 15 )
+			op = WriteLength( op, num_literals - 15 );
+
+		memcpy( op, literals, num_literals );
+		op += num_literals;
+
+		*op++ = u8( offset );
+		*op++ = u8( offset >> 8 );
+
+		if( match_code >= 15 )
+			op = WriteLength( op, match_code - 15 );
+
+		return op;
+	}
+
+	u8 * WriteLastLiterals( u8 * op, const u8 * literals, u32 num_literals )
+	{
+		*op++ = u8( Min< u32 >( num_literals, 15 ) << 4 );
+
+		if( num_literals >= 15 )
+			op = WriteLength( op, num_literals - 15 );
+
+		memcpy( op, literals, num_literals );
+		return op + num_literals;
+	}
+
+	inline bool ReadLength( const u8 *& ip, const u8 * ip_end, u32 * length )
+	{
+		u8 b;
+		do
+		{
+			if( ip >= ip_end )
+				return false;
+
+			b = *ip++;
+			*length += b;
+		}
+		while( b == 255 );
+
+		return true;
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 LZ_Compress( const void * src, u32 length, void * dst )
+{
+	// An empty stream is just the last (empty) literals token. src may be NULL
+	if( length == 0 )
+	{
+		*static_cast< u8 * >( dst ) = 0;
+		return 1;
+	}
+
+	const u8 *	base( static_cast< const u8 * >( src ) );
+	const u8 *	ip( base );
+	const u8 *	anchor( base );
+	const u8 *	end( base + length );
+	u8 *		op( static_cast< u8 * >( dst ) );
+
+	// Positions are stored relative to base, so zero is never a usable match for ip == base
+	u32			table[ 1 << kHashBits ];
+	memset( table, 0, sizeof( table ) );
+
+	u32			misses( 0 );
+
+	while( end - ip >= s32( kMinMatch ) )
+	{
+		u32				seq( Read32( ip ) );
+		u32				h( Hash( seq ) );
+		const u8 *		ref( base + table[ h ] );
+		table[ h ] = u32( ip - base );
+
+		u32				offset( u32( ip - ref ) );
+		if( offset == 0 || offset > kMaxOffset || Read32( ref ) != seq )
+		{
+			ip += 1 + ( misses++ >> kSkipShift );
+			continue;
+		}
+
+		u32				match_length( kMinMatch );
+		while( ip + match_length + sizeof( u64 ) <= end && Read64( ip + match_length ) == Read64( ref + match_length ) )
+		{
+			match_length += sizeof( u64 );
+		}
+		while( ip + match_length < end && ip[ match_length ] == ref[ match_length ] )
+		{
+			++match_length;
+		}
+
+		op = WriteSequence( op, anchor, u32( ip - anchor ), offset, match_length );
+
+		ip += match_length;
+		anchor = ip;
+		misses = 0;
+	}
+
+	op = WriteLastLiterals( op, anchor, u32( end - anchor ) );
+
+	return u32( op - static_cast< u8 * >( dst ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool LZ_Decompress( const void * src, u32 src_length, void * dst, u32 dst_length )
+{
+	const u8 *	ip( static_cast< const u8 * >( src ) );
+	const u8 *	ip_end( ip + src_length );
+	u8 *		op( static_cast< u8 * >( dst ) );
+	u8 *		op_base( op );
+	u8 *		op_end( op + dst_length );
+
+	// See LZ_Compress - dst may be NULL
+	if( dst_length == 0 )
+		return src_length == 1 && ip[ 0 ] == 0;
+
+	while( ip < ip_end )
+	{
+		u8		token( *ip++ );
+		u32		num_literals( token >> 4 );
+
+		if( num_literals == 15 && !ReadLength( ip, ip_end, &num_literals ) )
+			return false;
+
+		if( num_literals > u32( ip_end - ip ) || num_literals > u32( op_end - op ) )
+			return false;
+
+		memcpy( op, ip, num_literals );
+		ip += num_literals;
+		op += num_literals;
+
+		// The last sequence has no match
+		if( ip == ip_end )
+			return op == op_end;
+
+		if( ip_end - ip < 2 )
+			return false;
+
+		u32		offset( ip[ 0 ] | ( ip[ 1 ] << 8 ) );
+		ip += 2;
+
+		u32		match_length( token & 15 );
+		if( match_length == 15 && !ReadLength( ip, ip_end, &match_length ) )
+			return false;
+		match_length += kMinMatch;
+
+		if( offset == 0 || offset > u32( op - op_base ) || match_length > u32( op_end - op ) )
+			return false;
+
+		// When the match overlaps itself it repeats the last offset bytes, so
+		// copy what's there so far, which doubles each time round
+		const u8 *	ref( op - offset );
+		while( match_length > 0 )
+		{
+			u32 count( Min( match_length, u32( op - ref ) ) );
+			memcpy( op, ref, count );
+			op += count;
+			match_length -= count;
+		}
+	}
+
+	// Every stream ends with a literals only sequence, so this was cut short
+	return false;
+}
@@ -0,0 +1,45 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef UTILITY_LZ_H_
+#define UTILITY_LZ_H_
+
+#include "Utility/DaedalusTypes.h"
+
+//
+//	A small byte oriented LZ77 codec in the style of LZ4. It's much faster
+//	than zlib at the cost of ratio, so it suits data which is compressed
+//	often and kept in memory, rather than written to disk.
+//
+//	Each sequence is a token byte (literal count in the high nibble, match
+//	length - 4 in the low nibble, 15 meaning more length bytes follow), the
+//	literals, then a little endian u16 match offset. The stream ends after
+//	the literals of the last sequence.
+//
+
+// The largest output LZ_Compress can produce for length bytes of input
+inline u32	LZ_CompressBound( u32 length )		{ return length + length / 255 + 16; }
+
+// Returns the number of bytes written to dst, which must hold LZ_CompressBound( length )
+u32			LZ_Compress( const void * src, u32 length, void * dst );
+
+// Fails unless src decompresses to exactly dst_length bytes
+bool		LZ_Decompress( const void * src, u32 src_length, void * dst, u32 dst_length );
+
+#endif // UTILITY_LZ_H_
@@ -0,0 +1,121 @@
+#include <stdafx.h>
+#include "Utility/LZ.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+static void FillRandom( std::vector< u8 > & data, u32 seed )
+{
+	for (u32 i = 0; i < data.size(); ++i)
+	{
+		seed = seed * 1664525 + 1013904223;
+		data[i] = (u8)(seed >> 24);
+	}
+}
+
+static void FillPeriodic( std::vector< u8 > & data, u32 period )
+{
+	std::vector< u8 > pattern( period );
+	FillRandom( pattern, period );
+	for (u32 i = 0; i < data.size(); ++i)
+		data[i] = pattern[i % period];
+}
+
+// Compresses into a buffer with a guard after LZ_CompressBound(), and checks
+// that the guard is left alone and the data comes back unchanged
+static std::vector< u8 > CompressChecked( const std::vector< u8 > & src )
+{
+	const u8	kGuard = 0xa5;
+	const u32	kGuardSize = 64;
+
+	u32 bound = LZ_CompressBound( src.size() );
+	std::vector< u8 > compressed( bound + kGuardSize, kGuard );
+
+	u32 size = LZ_Compress( src.empty() ? NULL : &src[0], src.size(), &compressed[0] );
+	EXPECT_LE( size, bound );
+	for (u32 i = bound; i < compressed.size(); ++i)
+	{
+		EXPECT_EQ( kGuard, compressed[i] );
+	}
+	compressed.resize( size );
+
+	std::vector< u8 > decompressed( src.size() );
+	EXPECT_TRUE( LZ_Decompress( &compressed[0], compressed.size(), decompressed.empty() ? NULL : &decompressed[0], decompressed.size() ) );
+	EXPECT_TRUE( decompressed == src );
+	return compressed;
+}
+
+TEST(LZ, WorksWithZeroLength)
+{
+	std::vector< u8 > src;
+	std::vector< u8 > compressed = CompressChecked( src );
+	EXPECT_EQ( 1u, compressed.size() );
+}
+
+TEST(LZ, RoundTripsRandomData)
+{
+	for (u32 length = 1; length < 300; ++length)
+	{
+		std::vector< u8 > src( length );
+		FillRandom( src, length );
+		CompressChecked( src );
+	}
+
+	std::vector< u8 > src( 1024 * 1024 );
+	FillRandom( src, 1 );
+	CompressChecked( src );
+}
+
+TEST(LZ, RoundTripsZeroes)
+{
+	for (u32 length = 1; length < 300; ++length)
+	{
+		std::vector< u8 > src( length, 0 );
+		CompressChecked( src );
+	}
+
+	std::vector< u8 > src( 1024 * 1024, 0 );
+	std::vector< u8 > compressed = CompressChecked( src );
+	EXPECT_LT( compressed.size(), src.size() / 100 );
+}
+
+TEST(LZ, RoundTripsPeriodicData)
+{
+	// Periods either side of the largest match offset
+	static const u32 kPeriods[] = { 1, 2, 3, 4, 7, 8, 100, 4096, 65535, 65536, 70000 };
+	for (u32 i = 0; i < sizeof(kPeriods) / sizeof(kPeriods[0]); ++i)
+	{
+		std::vector< u8 > src( 256 * 1024 );
+		FillPeriodic( src, kPeriods[i] );
+		CompressChecked( src );
+	}
+}
+
+TEST(LZ, RejectsTruncatedStreams)
+{
+	std::vector< u8 > src( 64 * 1024 );
+	FillPeriodic( src, 1000 );
+	for (u32 i = 0; i < src.size(); i += 997)
+		src[i] ^= 0xff;
+
+	std::vector< u8 > compressed = CompressChecked( src );
+	std::vector< u8 > decompressed( src.size() );
+	for (u32 length = 0; length < compressed.size(); ++length)
+	{
+		EXPECT_FALSE( LZ_Decompress( &compressed[0], length, &decompressed[0], decompressed.size() ) ) << "Accepted " << length << " of " << compressed.size() << " bytes";
+	}
+}
+
+TEST(LZ, RejectsTheWrongLength)
+{
+	std::vector< u8 > src( 10000 );
+	FillPeriodic( src, 13 );
+
+	std::vector< u8 > compressed = CompressChecked( src );
+	std::vector< u8 > decompressed( src.size() + 1 );
+	EXPECT_FALSE( LZ_Decompress( &compressed[0], compressed.size(), &decompressed[0], src.size() - 1 ) );
+	EXPECT_FALSE( LZ_Decompress( &compressed[0], compressed.size(), &decompressed[0], src.size() + 1 ) );
+}
@@ -478,6 +478,10 @@ void SRomPreferences::Apply() const
 	gDynarecEnabled             = g_ROM.settings.DynarecSupported && DynarecEnabled;
 	gDynarecLoopOptimisation	= DynarecLoopOptimisation;	// && g_ROM.settings.DynarecLoopOptimisation;
 	gDynarecDoublesOptimisation	= g_ROM.settings.DynarecDoublesOptimisation || DynarecDoublesOptimisation;
+	gIdleLoopSkipEnabled		= g_ROM.settings.IdleLoopSkipEnabled;
+	gDynarecConstantPropagation	= g_ROM.settings.DynarecConstantPropagation;
+	gDynarecMaxTraceLength		= g_ROM.settings.DynarecMaxTraceLength;
+	gDynarecMaxInlineLength		= g_ROM.settings.DynarecMaxInlineLength;
 	gDoubleDisplayEnabled       = g_ROM.settings.DoubleDisplayEnabled && DoubleDisplayEnabled; // I don't know why DD won't disabled if we set ||
 	gCleanSceneEnabled          = g_ROM.settings.CleanSceneEnabled || CleanSceneEnabled;
 	gClearDepthFrameBuffer      = g_ROM.settings.ClearDepthFrameBuffer || ClearDepthFrameBuffer;
@@ -24,10 +24,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Debug/DBGConsole.h"
 
+#include "Utility/ByteSwap.h"
 #include "Utility/Stream.h"
 #include "Utility/IO.h"
 
-#include <algorithm>
 #include <string.h>
 
 bool IsRomfilename( const char * rom_filename )
@@ -136,12 +136,7 @@ void ROMFile::CorrectSwap( u8 * p_bytes, u32 length )
 // to              40 12 37 80
 void ROMFile::ByteSwap_2301( void * p_bytes, u32 length )
 {
-	u32* p = (u32*)p_bytes;
-	u32* maxp = (u32*)((u8*)p_bytes + length);
-	for(; p < maxp; p++)
-	{
-		std::swap(((u16*)p)[0], ((u16*)p)[1]);
-	}
+	ByteSwap_Swap16( p_bytes, length );
 }
 
 
@@ -149,11 +144,5 @@ void ROMFile::ByteSwap_2301( void * p_bytes, u32 length )
 // to              40 12 37 80
 void ROMFile::ByteSwap_3210( void * p_bytes, u32 length )
 {
-	u8* p = (u8*)p_bytes;
-	u8* maxp = (u8*)(p + length);
-	for(; p < maxp; p+=4)
-	{
-		std::swap(p[0], p[3]);
-		std::swap(p[1], p[2]);
-	}
+	ByteSwap_Swap32( p_bytes, length );
 }
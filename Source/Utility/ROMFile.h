@@ -45,6 +45,7 @@ public:
 	virtual bool		ReadChunk( u32 offset, u8 * p_dst, u32 length ) = 0;
 
 	virtual bool		IsCompressed() const = 0;
+	virtual bool		IsRandomAccess() const			{ return true; }	// ReadChunk is cheap at any offset
 			bool		RequiresSwapping() const;
 
 	virtual u32			GetRomSize() const = 0;
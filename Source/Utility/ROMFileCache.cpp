@@ -27,6 +27,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Debug/DBGConsole.h"
 
+#ifdef DAEDALUS_ROM_READAHEAD
+#include "Utility/Cond.h"
+#endif
+
 #ifdef DAEDALUS_PSP
 extern bool PSP_IS_SLIM;
 #endif
@@ -66,6 +70,16 @@ ROMFileCache::ROMFileCache()
 ,	mChunkMapEntries( 0 )
 ,	mpChunkMap( NULL )
 ,	mMRUIdx( 0 )
+#ifdef DAEDALUS_ROM_READAHEAD
+,	mLastLoadIdx( INVALID_ADDRESS )
+,	mFileMutex( "ROMFileCache" )
+,	mReadaheadMutex( "ROMReadahead" )
+,	mReadaheadWorkCond( CondCreate() )
+,	mReadaheadDoneCond( CondCreate() )
+,	mpReadaheadStorage( NULL )
+,	mReadaheadThread( kInvalidThreadHandle )
+,	mReadaheadQuit( false )
+#endif
 {
 #ifdef DAEDALUS_PSP
 	CHUNK_SIZE = 16 * 1024;
@@ -90,6 +104,10 @@ ROMFileCache::ROMFileCache()
 
 	mpStorage   = (u8*)CROMFileMemory::Get()->Alloc( STORAGE_BYTES );
 	mpChunkInfo = new SChunkInfo[ CACHE_SIZE ];
+
+#ifdef DAEDALUS_ROM_READAHEAD
+	mpReadaheadStorage = new u8[ kReadaheadChunks * CHUNK_SIZE ];
+#endif
 }
 
 //*****************************************************************************
@@ -97,6 +115,14 @@ ROMFileCache::ROMFileCache()
 //*****************************************************************************
 ROMFileCache::~ROMFileCache()
 {
+#ifdef DAEDALUS_ROM_READAHEAD
+	StopReadahead();
+
+	CondDestroy( mReadaheadWorkCond );
+	CondDestroy( mReadaheadDoneCond );
+	delete [] mpReadaheadStorage;
+#endif
+
 	CROMFileMemory::Get()->Free( mpStorage );
 
 	delete [] mpChunkInfo;
@@ -127,6 +153,9 @@ bool	ROMFileCache::Open( ROMFile * p_rom_file )
 		mpChunkInfo[ i ].LastUseIdx = 0;
 	}
 
+#ifdef DAEDALUS_ROM_READAHEAD
+	StartReadahead();
+#endif
 	return true;
 }
 
@@ -135,6 +164,11 @@ bool	ROMFileCache::Open( ROMFile * p_rom_file )
 //*****************************************************************************
 void	ROMFileCache::Close()
 {
+#ifdef DAEDALUS_ROM_READAHEAD
+	// The worker may be reading from the rom file
+	StopReadahead();
+#endif
+
 	delete [] mpChunkMap;
 	mpChunkMap = NULL;
 	mChunkMapEntries = 0;
@@ -189,6 +223,32 @@ void	ROMFileCache::PurgeChunk( CacheIdx cache_idx )
 	chunk_info.LastUseIdx = 0;
 }
 
+//*****************************************************************************
+//
+//*****************************************************************************
+void	ROMFileCache::LoadChunk( u32 chunk_map_idx, u8 * p_dst )
+{
+	u32		offset( chunk_map_idx * CHUNK_SIZE );
+
+#ifdef DAEDALUS_ROM_READAHEAD
+	bool	sequential( chunk_map_idx == mLastLoadIdx + 1 );
+	mLastLoadIdx = chunk_map_idx;
+
+	if( !TakeReadahead( chunk_map_idx, p_dst ) )
+	{
+		MutexLock lock( &mFileMutex );
+		mpROMFile->ReadChunk( offset, p_dst, CHUNK_SIZE );
+	}
+
+	if( sequential )
+	{
+		QueueReadahead( chunk_map_idx );
+	}
+#else
+	mpROMFile->ReadChunk( offset, p_dst, CHUNK_SIZE );
+#endif
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -235,7 +295,7 @@ ROMFileCache::CacheIdx	ROMFileCache::GetCacheIndex( u32 address )
 		u8 *	p_dst( mpStorage + storage_offset );
 
 		//DBGConsole_Msg( 0, "[CRomCache - loading %02x, %08x-%08x", selected_idx, chunk_info.StartOffset, chunk_info.StartOffset + CHUNK_SIZE );
-		mpROMFile->ReadChunk( chunk_info.StartOffset, p_dst, CHUNK_SIZE );
+		LoadChunk( chunk_map_idx, p_dst );
 
 		idx = selected_idx;
 	}
@@ -277,3 +337,187 @@ bool	ROMFileCache::GetChunk( u32 rom_offset, u8 ** p_p_chunk_base, u32 * p_chunk
 	}
 }
 
+
+#ifdef DAEDALUS_ROM_READAHEAD
+//*****************************************************************************
+//
+//*****************************************************************************
+void	ROMFileCache::StartReadahead()
+{
+	for( u32 i = 0; i < kReadaheadChunks; ++i )
+	{
+		mReadaheadSlots[ i ].ChunkMapIdx = INVALID_ADDRESS;
+		mReadaheadSlots[ i ].State = RA_EMPTY;
+	}
+
+	mLastLoadIdx = INVALID_ADDRESS;
+	mReadaheadQuit = false;
+	mReadaheadThread = CreateThread( "ROMReadahead", ReadaheadThread, this );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	ROMFileCache::StopReadahead()
+{
+	if( mReadaheadThread != kInvalidThreadHandle )
+	{
+		{
+			MutexLock lock( &mReadaheadMutex );
+			mReadaheadQuit = true;
+			CondSignal( mReadaheadWorkCond );
+		}
+		JoinThread( mReadaheadThread, -1 );
+		ReleaseThreadHandle( mReadaheadThread );
+		mReadaheadThread = kInvalidThreadHandle;
+	}
+}
+
+//*****************************************************************************
+//	Must be called with mReadaheadMutex held
+//*****************************************************************************
+ROMFileCache::SReadaheadSlot *	ROMFileCache::FindReadaheadSlot( u32 chunk_map_idx )
+{
+	for( u32 i = 0; i < kReadaheadChunks; ++i )
+	{
+		SReadaheadSlot & slot( mReadaheadSlots[ i ] );
+		if( slot.State != RA_EMPTY && slot.ChunkMapIdx == chunk_map_idx )
+		{
+			return &slot;
+		}
+	}
+	return NULL;
+}
+
+//*****************************************************************************
+//	If the worker has (or is about to have) this chunk, copy it out of the
+//	staging slot. Returns false if the caller has to read it itself.
+//*****************************************************************************
+bool	ROMFileCache::TakeReadahead( u32 chunk_map_idx, u8 * p_dst )
+{
+	if( mReadaheadThread == kInvalidThreadHandle )
+		return false;
+
+	MutexLock lock( &mReadaheadMutex );
+
+	SReadaheadSlot * slot( FindReadaheadSlot( chunk_map_idx ) );
+	if( slot == NULL )
+		return false;
+
+	while( slot->State == RA_LOADING )
+	{
+		CondWait( mReadaheadDoneCond, &mReadaheadMutex, kTimeoutInfinity );
+	}
+
+	bool	ready( slot->State == RA_READY && slot->ChunkMapIdx == chunk_map_idx );
+	if( ready )
+	{
+		memcpy( p_dst, mpReadaheadStorage + ( slot - mReadaheadSlots ) * CHUNK_SIZE, CHUNK_SIZE );
+	}
+
+	// Anything still pending is dropped, as we're about to read it ourselves
+	slot->State = RA_EMPTY;
+	return ready;
+}
+
+//*****************************************************************************
+//	Queue up the chunks following chunk_map_idx which aren't already cached
+//	or staged, recycling slots for chunks that are no longer ahead of us.
+//*****************************************************************************
+void	ROMFileCache::QueueReadahead( u32 chunk_map_idx )
+{
+	if( mReadaheadThread == kInvalidThreadHandle )
+		return;
+
+	MutexLock lock( &mReadaheadMutex );
+
+	bool	queued( false );
+	for( u32 ahead = 1; ahead <= kReadaheadChunks; ++ahead )
+	{
+		u32		next_idx( chunk_map_idx + ahead );
+		if( next_idx >= mChunkMapEntries )
+			break;
+
+		if( mpChunkMap[ next_idx ] != INVALID_IDX || FindReadaheadSlot( next_idx ) != NULL )
+			continue;
+
+		SReadaheadSlot * free_slot( NULL );
+		for( u32 i = 0; i < kReadaheadChunks && free_slot == NULL; ++i )
+		{
+			SReadaheadSlot & slot( mReadaheadSlots[ i ] );
+			bool	still_ahead( slot.ChunkMapIdx > chunk_map_idx && slot.ChunkMapIdx <= chunk_map_idx + kReadaheadChunks );
+
+			if( slot.State == RA_EMPTY || ( slot.State != RA_LOADING && !still_ahead ) )
+			{
+				free_slot = &slot;
+			}
+		}
+
+		if( free_slot == NULL )
+			break;
+
+		free_slot->ChunkMapIdx = next_idx;
+		free_slot->State = RA_PENDING;
+		queued = true;
+	}
+
+	if( queued )
+	{
+		CondSignal( mReadaheadWorkCond );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 DAEDALUS_THREAD_CALL_TYPE ROMFileCache::ReadaheadThread( void * arg )
+{
+	ROMFileCache * cache( static_cast< ROMFileCache * >( arg ) );
+	cache->RunReadahead();
+	return 0;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	ROMFileCache::RunReadahead()
+{
+	MutexLock lock( &mReadaheadMutex );
+
+	while( !mReadaheadQuit )
+	{
+		// Nearest chunk first
+		SReadaheadSlot * slot( NULL );
+		for( u32 i = 0; i < kReadaheadChunks; ++i )
+		{
+			SReadaheadSlot & candidate( mReadaheadSlots[ i ] );
+			if( candidate.State == RA_PENDING && ( slot == NULL || candidate.ChunkMapIdx < slot->ChunkMapIdx ) )
+			{
+				slot = &candidate;
+			}
+		}
+
+		if( slot == NULL )
+		{
+			CondWait( mReadaheadWorkCond, &mReadaheadMutex, kTimeoutInfinity );
+			continue;
+		}
+
+		slot->State = RA_LOADING;
+
+		u32		offset( slot->ChunkMapIdx * CHUNK_SIZE );
+		u8 *	p_dst( mpReadaheadStorage + ( slot - mReadaheadSlots ) * CHUNK_SIZE );
+		bool	ok;
+
+		mReadaheadMutex.Unlock();
+		{
+			MutexLock file_lock( &mFileMutex );
+			ok = mpROMFile->ReadChunk( offset, p_dst, CHUNK_SIZE );
+		}
+		mReadaheadMutex.Lock();
+
+		slot->State = ok ? RA_READY : RA_EMPTY;
+		CondSignal( mReadaheadDoneCond );
+	}
+}
+#endif // DAEDALUS_ROM_READAHEAD
@@ -24,9 +24,26 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Utility/DaedalusTypes.h"
 
+#ifdef DAEDALUS_ROM_READAHEAD
+#include "Utility/Mutex.h"
+#include "Utility/Thread.h"
+
+struct Cond;
+#endif
+
 class ROMFile;
 struct SChunkInfo;
 
+//
+//	Keeps the most recently used chunks of a streamed rom in memory.
+//
+//	With DAEDALUS_ROM_READAHEAD, a worker thread reads the chunks after a
+//	sequential run of misses (i.e. a PI DMA working through the cart) into a
+//	small set of staging slots, and the next miss copies its chunk out of
+//	there instead of waiting on the rom file. Only the emulation thread
+//	touches the cache itself; the slots are protected by mReadaheadMutex.
+//
+
 class ROMFileCache
 {
 		typedef u16			CacheIdx;
@@ -42,9 +59,37 @@ class ROMFileCache
 
 	private:
 		void				PurgeChunk( CacheIdx cache_idx );
+		void				LoadChunk( u32 chunk_map_idx, u8 * p_dst );
 
 		CacheIdx			GetCacheIndex( u32 address );
 
+#ifdef DAEDALUS_ROM_READAHEAD
+		enum EReadaheadState
+		{
+			RA_EMPTY = 0,
+			RA_PENDING,
+			RA_LOADING,
+			RA_READY,
+		};
+
+		struct SReadaheadSlot
+		{
+			u32				ChunkMapIdx;
+			EReadaheadState	State;
+		};
+
+		static const u32	kReadaheadChunks = 8;
+
+		void				StartReadahead();
+		void				StopReadahead();
+		bool				TakeReadahead( u32 chunk_map_idx, u8 * p_dst );
+		void				QueueReadahead( u32 chunk_map_idx );
+		SReadaheadSlot *	FindReadaheadSlot( u32 chunk_map_idx );
+
+		static u32 DAEDALUS_THREAD_CALL_TYPE ReadaheadThread( void * arg );
+		void				RunReadahead();
+#endif
+
 	private:
 		ROMFile *			mpROMFile;
 
@@ -56,6 +101,19 @@ class ROMFileCache
 
 		u32					mMRUIdx;			// Most recently used index
 
+#ifdef DAEDALUS_ROM_READAHEAD
+		u32					mLastLoadIdx;		// Chunk map index of the last miss
+
+		Mutex				mFileMutex;			// Held around reads from mpROMFile
+		Mutex				mReadaheadMutex;	// Protects the slots and mReadaheadQuit
+		Cond *				mReadaheadWorkCond;
+		Cond *				mReadaheadDoneCond;
+		SReadaheadSlot		mReadaheadSlots[ kReadaheadChunks ];
+		u8 *				mpReadaheadStorage;
+		ThreadHandle		mReadaheadThread;
+		bool				mReadaheadQuit;
+#endif
+
 		static const CacheIdx	INVALID_IDX = CacheIdx(-1);
 };
 
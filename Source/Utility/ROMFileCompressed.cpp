@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Math/MathUtil.h"
 
 #include "Debug/DBGConsole.h"
+#include "Debug/Dump.h"
 
 #include "Utility/IO.h"
 #include "Utility/Macros.h"
@@ -38,7 +39,11 @@ ROMFileCompressed::ROMFileCompressed( const char * filename )
 ,	mZipFile( NULL )
 ,	mFoundRom( false )
 ,	mRomSize( 0 )
+,	mCanIndex( false )
+,	mIndexFailed( false )
+,	mpIndex( NULL )
 {
+	memset( &mEntryInfo, 0, sizeof( mEntryInfo ) );
 }
 
 //*****************************************************************************
@@ -46,6 +51,8 @@ ROMFileCompressed::ROMFileCompressed( const char * filename )
 //*****************************************************************************
 ROMFileCompressed::~ROMFileCompressed()
 {
+	delete mpIndex;
+
 	if(mZipFile != NULL)
 	{
 		unzClose( mZipFile );
@@ -114,6 +121,14 @@ bool ROMFileCompressed::Open( COutputStream & messages )
 							unzCloseCurrentFile(mZipFile);
 							mRomSize = file_info.uncompressed_size;
 							mFoundRom = true;
+
+							mEntryInfo.CompressedSize = file_info.compressed_size;
+							mEntryInfo.UncompressedSize = file_info.uncompressed_size;
+							mEntryInfo.CRC = file_info.crc;
+							mEntryInfo.Stored = file_info.compression_method == 0;
+							mCanIndex = ( file_info.compression_method == 0 || file_info.compression_method == Z_DEFLATED ) &&
+										( file_info.flag & 1 ) == 0;
+
 							if (!SetHeaderMagic( magic ))
 							{
 								DBGConsole_Msg(0, "Bad header magic for [C%s]", rom_filename);
@@ -138,11 +153,24 @@ bool ROMFileCompressed::Open( COutputStream & messages )
 		{
 			mFoundRom = false;
 		}
+		else
+		{
+			// Where the entry's data starts, for reading it through the index
+			mEntryInfo.DataOffset = unzGetCurrentFileZStreamPos64(mZipFile);
+		}
 	}
 
 	return mFoundRom;
 }
 
+//*****************************************************************************
+//
+//*****************************************************************************
+bool ROMFileCompressed::IsRandomAccess() const
+{
+	return mFoundRom && mCanIndex && !mIndexFailed;
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -247,6 +275,27 @@ bool	ROMFileCompressed::Seek( u32 offset, u8 * p_scratch_block, u32 block_size )
 	return true;
 }
 
+//*****************************************************************************
+//	The index is opened (and built, the first time the zip is seen) on the
+//	first read, so roms that are loaded in one go with LoadData never pay for it.
+//*****************************************************************************
+bool	ROMFileCompressed::OpenIndex()
+{
+	IO::Filename	index_filename;
+	Dump_GetSaveDirectory( index_filename, mFilename, ".zidx" );
+
+	mpIndex = new ROMFileZipIndex();
+	if( !mpIndex->Open( mFilename, index_filename, mEntryInfo ) )
+	{
+		DBGConsole_Msg( 0, "Unable to index [C%s], falling back to seeking in the zip", mFilename );
+		delete mpIndex;
+		mpIndex = NULL;
+		mIndexFailed = true;
+		return false;
+	}
+	return true;
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -255,6 +304,17 @@ bool	ROMFileCompressed::ReadChunk( u32 offset, u8 * p_dst, u32 length )
 	DAEDALUS_ASSERT( mZipFile != NULL, "No open zipfile?" );
 	DAEDALUS_ASSERT( mFoundRom, "Why are we loading data when no rom was found?" );
 
+	if( mpIndex != NULL || ( mCanIndex && !mIndexFailed && OpenIndex() ) )
+	{
+		if( !mpIndex->Read( offset, p_dst, length ) )
+		{
+			return false;
+		}
+
+		CorrectSwap( p_dst, length );
+		return true;
+	}
+
 	if( !Seek( offset, p_dst, length ) )
 	{
 		return false;
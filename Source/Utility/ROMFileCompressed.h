@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <unzip.h>
 
 #include "ROMFile.h"
+#include "ROMFileZipIndex.h"
 
 class ROMFileCompressed : public ROMFile
 {
@@ -42,6 +43,7 @@ public:
 	virtual bool		Open( COutputStream & messages );
 
 	virtual bool		IsCompressed() const			{ return true; }
+	virtual bool		IsRandomAccess() const;
 	virtual u32			GetRomSize() const				{ return mRomSize; }
 	virtual bool		LoadRawData( u32 bytes_to_read, u8 *p_bytes, COutputStream & messages );
 
@@ -49,6 +51,7 @@ public:
 
 private:
 			bool		Seek( u32 offset, u8 * p_scratch_block, u32 block_size );
+			bool		OpenIndex();
 
 
 private:
@@ -56,6 +59,11 @@ private:
 	bool				mFoundRom;
 	u32					mRomSize;
 
+	ROMFileZipIndex::SEntryInfo	mEntryInfo;
+	bool				mCanIndex;			// The entry is stored or deflated, and not encrypted
+	bool				mIndexFailed;
+	ROMFileZipIndex *	mpIndex;
+
 };
 
 #endif // DAEDALUS_COMPRESSED_ROM_SUPPORT
@@ -0,0 +1,43 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef UTILITY_ROMFILEMAPPING_H_
+#define UTILITY_ROMFILEMAPPING_H_
+
+#include "Utility/DaedalusTypes.h"
+
+class ROMFile;
+
+//
+//	Map an opened rom copy-on-write, so that processes running the same rom
+//	share its pages and only the parts that are touched get read in. The
+//	emulator can write to it (guest stores to cartridge space go through the
+//	pointers it hands out), which only copies the pages written to and never
+//	reaches the file.
+//	The mapping has to be in host byte order, so roms that need swapping are
+//	converted once into a cache file in the save directory which is then
+//	mapped instead. On little endian hosts that is every rom, .z64 included,
+//	so each rom costs a full size copy in the save directory.
+//	Returns NULL if the rom can't be mapped, in which case it should be
+//	loaded as normal.
+//
+u8 *		ROMFileMapping_Open( ROMFile * p_rom_file, const char * filename, u32 rom_size );
+void		ROMFileMapping_Close( u8 * p_bytes, u32 rom_size );
+
+#endif // UTILITY_ROMFILEMAPPING_H_
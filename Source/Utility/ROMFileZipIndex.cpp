@@ -0,0 +1,463 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "ROMFileZipIndex.h"
+
+#ifdef DAEDALUS_COMPRESSED_ROM_SUPPORT
+
+#include <string.h>
+
+#include "Math/MathUtil.h"
+
+#include "Debug/DBGConsole.h"
+
+#include "Utility/IO.h"
+
+namespace
+{
+	const u32	kIndexMagic = 0x5849445a;		// 'ZDIX'
+	const u32	kIndexVersion = 1;
+	const u32	kInputSize = 16 * 1024;
+
+	//
+	//	The index file is this header, then one window per access point, then
+	//	the access points themselves. It's only ever read back on the machine
+	//	that wrote it, so everything is in host byte order.
+	//
+	struct SIndexHeader
+	{
+		u32			Magic;
+		u32			Version;
+		u32			CRC;
+		u32			CompressedSize;
+		u32			UncompressedSize;
+		u32			Span;
+		u32			NumPoints;
+		u32			Padding;
+	};
+	DAEDALUS_STATIC_ASSERT( sizeof( SIndexHeader ) == 32 );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+ROMFileZipIndex::ROMFileZipIndex()
+:	mZipFile( NULL )
+,	mIndexFile( NULL )
+,	mStreamActive( false )
+,	mStreamIn( 0 )
+,	mStreamOut( 0 )
+,	mpInput( new u8[ kInputSize ] )
+,	mpWindow( new u8[ kWindowSize ] )
+{
+	memset( &mEntry, 0, sizeof( mEntry ) );
+	memset( &mStream, 0, sizeof( mStream ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+ROMFileZipIndex::~ROMFileZipIndex()
+{
+	Close();
+
+	delete [] mpInput;
+	delete [] mpWindow;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool ROMFileZipIndex::Open( const char * zip_filename, const char * index_filename, const SEntryInfo & entry )
+{
+	Close();
+
+	mEntry = entry;
+	mZipFile = fopen( zip_filename, "rb" );
+	if( mZipFile == NULL )
+	{
+		return false;
+	}
+
+	// Stored entries can be read directly
+	if( mEntry.Stored )
+	{
+		return true;
+	}
+
+	if( Load( index_filename ) )
+	{
+		return true;
+	}
+
+#ifdef DAEDALUS_DEBUG_CONSOLE
+	DBGConsole_Msg( 0, "Building zip index [C%s]", index_filename );
+#endif
+	if( Build( index_filename ) && Load( index_filename ) )
+	{
+		return true;
+	}
+
+	Close();
+	return false;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void ROMFileZipIndex::Close()
+{
+	if( mStreamActive )
+	{
+		inflateEnd( &mStream );
+		mStreamActive = false;
+	}
+
+	if( mIndexFile != NULL )
+	{
+		fclose( mIndexFile );
+		mIndexFile = NULL;
+	}
+
+	if( mZipFile != NULL )
+	{
+		fclose( mZipFile );
+		mZipFile = NULL;
+	}
+
+	mPoints.clear();
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool ROMFileZipIndex::Load( const char * index_filename )
+{
+	FILE * fh( fopen( index_filename, "rb" ) );
+	if( fh == NULL )
+	{
+		return false;
+	}
+
+	SIndexHeader	header;
+	u32				max_points( mEntry.UncompressedSize / kSpan + 1 );
+
+	if( fread( &header, sizeof( header ), 1, fh ) != 1 ||
+		header.Magic != kIndexMagic ||
+		header.Version != kIndexVersion ||
+		header.CRC != mEntry.CRC ||
+		header.CompressedSize != mEntry.CompressedSize ||
+		header.UncompressedSize != mEntry.UncompressedSize ||
+		header.Span != kSpan ||
+		header.NumPoints == 0 || header.NumPoints > max_points )
+	{
+		fclose( fh );
+		return false;
+	}
+
+	mPoints.resize( header.NumPoints );
+	if( fseek( fh, sizeof( header ) + header.NumPoints * kWindowSize, SEEK_SET ) != 0 ||
+		fread( &mPoints[ 0 ], sizeof( SAccessPoint ), header.NumPoints, fh ) != header.NumPoints ||
+		mPoints[ 0 ].Out != 0 )
+	{
+		mPoints.clear();
+		fclose( fh );
+		return false;
+	}
+
+	mIndexFile = fh;
+	return true;
+}
+
+//*****************************************************************************
+//	A single pass over the whole entry. inflate is run with Z_BLOCK so that it
+//	stops at every block boundary, which is where it can be restarted from.
+//	The output is checked against the entry's crc as we go, so a corrupt zip
+//	never leaves an index behind.
+//*****************************************************************************
+bool ROMFileZipIndex::Build( const char * index_filename )
+{
+	IO::Filename	temp_filename;
+	snprintf( temp_filename, sizeof( temp_filename ), "%s.tmp", index_filename );
+
+	FILE * fh( fopen( temp_filename, "wb" ) );
+	if( fh == NULL )
+	{
+		return false;
+	}
+
+	SIndexHeader	header;
+	memset( &header, 0, sizeof( header ) );
+
+	z_stream		strm;
+	memset( &strm, 0, sizeof( strm ) );
+
+	bool			ok( fwrite( &header, sizeof( header ), 1, fh ) == 1 &&
+						fseek( mZipFile, long( mEntry.DataOffset ), SEEK_SET ) == 0 &&
+						inflateInit2( &strm, -MAX_WBITS ) == Z_OK );
+
+	// A raw deflate stream has no header for inflate to stop after, so the
+	// access point at the very start has to be added by hand
+	std::vector< SAccessPoint >	points( 1 );
+	points[ 0 ].Out = 0;
+	points[ 0 ].In = 0;
+	points[ 0 ].Bits = 0;
+
+	memset( mpWindow, 0, kWindowSize );
+	ok = ok && fwrite( mpWindow, 1, kWindowSize, fh ) == kWindowSize;
+
+	u32				bytes_read( 0 );
+	u32				total_in( 0 );
+	u32				total_out( 0 );
+	u32				last_point( 0 );
+	uLong			crc( crc32( 0L, Z_NULL, 0 ) );
+
+	while( ok )
+	{
+		// Once all the input has been read inflate may still have output to flush
+		if( strm.avail_in == 0 && bytes_read < mEntry.CompressedSize )
+		{
+			u32		bytes_to_read( Min( mEntry.CompressedSize - bytes_read, kInputSize ) );
+			if( fread( mpInput, 1, bytes_to_read, mZipFile ) != bytes_to_read )
+			{
+				ok = false;
+				break;
+			}
+			bytes_read += bytes_to_read;
+			strm.next_in = mpInput;
+			strm.avail_in = bytes_to_read;
+		}
+
+		if( strm.avail_out == 0 )
+		{
+			strm.next_out = mpWindow;
+			strm.avail_out = kWindowSize;
+		}
+
+		const u8 *	p_out( strm.next_out );
+		u32			avail_in( strm.avail_in );
+		u32			avail_out( strm.avail_out );
+
+		int			ret( inflate( &strm, Z_BLOCK ) );
+
+		total_in += avail_in - strm.avail_in;
+		total_out += avail_out - strm.avail_out;
+		crc = crc32( crc, p_out, avail_out - strm.avail_out );
+
+		if( ret == Z_STREAM_END )
+		{
+			break;
+		}
+		if( ret != Z_OK )
+		{
+			ok = false;
+			break;
+		}
+
+		// At a block boundary (other than the end of the last block)?
+		if( ( strm.data_type & 128 ) && !( strm.data_type & 64 ) &&
+			total_out - last_point > kSpan )
+		{
+			SAccessPoint	point;
+			point.Out = total_out;
+			point.In = total_in;
+			point.Bits = strm.data_type & 7;
+			points.push_back( point );
+
+			// The window is used as a ring, so write out the oldest part first
+			u32		left( strm.avail_out );
+			ok = fwrite( mpWindow + kWindowSize - left, 1, left, fh ) == left &&
+				 fwrite( mpWindow, 1, kWindowSize - left, fh ) == kWindowSize - left;
+
+			last_point = total_out;
+		}
+	}
+
+	inflateEnd( &strm );
+
+	ok = ok && total_out == mEntry.UncompressedSize &&
+		 crc == mEntry.CRC;
+
+	if( ok )
+	{
+		header.Magic = kIndexMagic;
+		header.Version = kIndexVersion;
+		header.CRC = mEntry.CRC;
+		header.CompressedSize = mEntry.CompressedSize;
+		header.UncompressedSize = mEntry.UncompressedSize;
+		header.Span = kSpan;
+		header.NumPoints = points.size();
+
+		ok = fwrite( &points[ 0 ], sizeof( SAccessPoint ), points.size(), fh ) == points.size() &&
+			 fseek( fh, 0, SEEK_SET ) == 0 &&
+			 fwrite( &header, sizeof( header ), 1, fh ) == 1;
+	}
+
+	ok = fclose( fh ) == 0 && ok;
+	ok = ok && IO::File::Move( temp_filename, index_filename );
+	if( !ok )
+	{
+		IO::File::Delete( temp_filename );
+	}
+	return ok;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool ROMFileZipIndex::Restart( u32 point_idx )
+{
+	if( mStreamActive )
+	{
+		inflateEnd( &mStream );
+		mStreamActive = false;
+	}
+
+	const SAccessPoint &	point( mPoints[ point_idx ] );
+
+	memset( &mStream, 0, sizeof( mStream ) );
+	if( inflateInit2( &mStream, -MAX_WBITS ) != Z_OK )
+	{
+		return false;
+	}
+	mStreamActive = true;
+
+	// If the block starts part way through a byte, feed inflate the leftover bits
+	mStreamIn = point.Bits ? point.In - 1 : point.In;
+	if( fseek( mZipFile, long( mEntry.DataOffset + mStreamIn ), SEEK_SET ) != 0 )
+	{
+		return false;
+	}
+
+	if( point.Bits )
+	{
+		int		c( getc( mZipFile ) );
+		if( c == EOF )
+		{
+			return false;
+		}
+		++mStreamIn;
+		inflatePrime( &mStream, point.Bits, c >> ( 8 - point.Bits ) );
+	}
+
+	if( fseek( mIndexFile, sizeof( SIndexHeader ) + point_idx * kWindowSize, SEEK_SET ) != 0 ||
+		fread( mpWindow, 1, kWindowSize, mIndexFile ) != kWindowSize ||
+		inflateSetDictionary( &mStream, mpWindow, kWindowSize ) != Z_OK )
+	{
+		return false;
+	}
+
+	mStreamOut = point.Out;
+	return true;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool ROMFileZipIndex::Inflate( u8 * p_dst, u32 length )
+{
+	mStream.next_out = p_dst;
+	mStream.avail_out = length;
+
+	while( mStream.avail_out > 0 )
+	{
+		if( mStream.avail_in == 0 && mStreamIn < mEntry.CompressedSize )
+		{
+			u32		bytes_to_read( Min( mEntry.CompressedSize - mStreamIn, kInputSize ) );
+			if( fread( mpInput, 1, bytes_to_read, mZipFile ) != bytes_to_read )
+			{
+				return false;
+			}
+			mStreamIn += bytes_to_read;
+			mStream.next_in = mpInput;
+			mStream.avail_in = bytes_to_read;
+		}
+
+		int		ret( inflate( &mStream, Z_NO_FLUSH ) );
+		if( ret == Z_STREAM_END )
+		{
+			if( mStream.avail_out != 0 )
+			{
+				return false;
+			}
+		}
+		else if( ret != Z_OK )
+		{
+			return false;
+		}
+	}
+
+	mStreamOut += length;
+	return true;
+}
+
+//*****************************************************************************
+//	Sequential reads carry on from where the last one left off, as long as
+//	there's no access point between the two that would be quicker to start from.
+//*****************************************************************************
+bool ROMFileZipIndex::Read( u32 offset, u8 * p_dst, u32 length )
+{
+	DAEDALUS_ASSERT( mZipFile != NULL, "Reading from a zip index that isn't open" );
+
+	if( offset > mEntry.UncompressedSize || length > mEntry.UncompressedSize - offset )
+	{
+		return false;
+	}
+
+	if( mEntry.Stored )
+	{
+		return fseek( mZipFile, long( mEntry.DataOffset + offset ), SEEK_SET ) == 0 &&
+			   fread( p_dst, 1, length, mZipFile ) == length;
+	}
+
+	// Find the last access point at or before offset
+	u32		lo( 0 );
+	u32		hi( mPoints.size() );
+	while( hi - lo > 1 )
+	{
+		u32		mid( ( lo + hi ) / 2 );
+		if( mPoints[ mid ].Out <= offset )
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	bool	ok( true );
+	if( !mStreamActive || mStreamOut > offset || mStreamOut < mPoints[ lo ].Out )
+	{
+		ok = Restart( lo );
+	}
+
+	while( ok && mStreamOut < offset )
+	{
+		ok = Inflate( mpWindow, Min( offset - mStreamOut, kWindowSize ) );
+	}
+
+	ok = ok && Inflate( p_dst, length );
+
+	if( !ok && mStreamActive )
+	{
+		inflateEnd( &mStream );
+		mStreamActive = false;
+	}
+	return ok;
+}
+
+#endif // DAEDALUS_COMPRESSED_ROM_SUPPORT
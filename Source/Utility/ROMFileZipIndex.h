@@ -0,0 +1,102 @@
+/*
+Copyright (C) 2026 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef UTILITY_ROMFILEZIPINDEX_H_
+#define UTILITY_ROMFILEZIPINDEX_H_
+
+#ifdef DAEDALUS_COMPRESSED_ROM_SUPPORT
+
+#include <stdio.h>
+#include <vector>
+
+#include <zlib.h>
+
+#include "Utility/DaedalusTypes.h"
+
+//
+//	Random access into a deflated zip entry, along the lines of zlib's zran
+//	example. A single pass over the entry records an access point every
+//	kSpan bytes of output: the position in the compressed stream and the 32KB
+//	of output preceding it, which is all inflate needs to restart there.
+//	Any range can then be read by inflating from the nearest access point.
+//
+//	The index is saved to a file keyed by the entry's crc and sizes, so it
+//	is only built the first time a zip is opened. Only the access points are
+//	held in memory; their windows are read back from the index file as needed.
+//
+//	Stored (uncompressed) entries are read straight from the zip.
+//
+class ROMFileZipIndex
+{
+public:
+	ROMFileZipIndex();
+	~ROMFileZipIndex();
+
+	struct SEntryInfo
+	{
+		u64			DataOffset;			// Offset of the entry's data within the zip
+		u32			CompressedSize;
+		u32			UncompressedSize;
+		u32			CRC;
+		bool		Stored;
+	};
+
+	// Loads the index from index_filename, or builds and saves it if it's missing or out of date
+	bool				Open( const char * zip_filename, const char * index_filename, const SEntryInfo & entry );
+	void				Close();
+
+	bool				Read( u32 offset, u8 * p_dst, u32 length );
+
+	static const u32	kSpan = 1024 * 1024;	// Uncompressed bytes between access points
+	static const u32	kWindowSize = 32 * 1024;
+
+private:
+	struct SAccessPoint
+	{
+		u32			Out;				// Offset of the first byte of output
+		u32			In;					// Offset of the first full byte of input
+		u32			Bits;				// Number of bits (0..7) from the byte before In
+	};
+
+	bool				Load( const char * index_filename );
+	bool				Build( const char * index_filename );
+
+	bool				Restart( u32 point_idx );
+	bool				Inflate( u8 * p_dst, u32 length );
+
+private:
+	FILE *						mZipFile;
+	FILE *						mIndexFile;
+	SEntryInfo					mEntry;
+	std::vector< SAccessPoint >	mPoints;
+
+	z_stream					mStream;
+	bool						mStreamActive;
+	u32							mStreamIn;			// Compressed bytes consumed from the zip so far
+	u32							mStreamOut;			// Offset of the next byte inflate will produce
+
+	u8 *						mpInput;
+	u8 *						mpWindow;
+};
+
+#endif // DAEDALUS_COMPRESSED_ROM_SUPPORT
+
+#endif // UTILITY_ROMFILEZIPINDEX_H_
@@ -204,7 +204,8 @@ bool	CInStream::ReadData( void * data, u32 length )
 				mBytesAvailable -= bytes_to_process;
 			}
 
-			if( mBytesAvailable == 0 )
+			// Don't fail if the last of the data ended the buffer
+			if( mBytesAvailable == 0 && bytes_remaining > 0 )
 			{
 				if( !Fill() )
 				{